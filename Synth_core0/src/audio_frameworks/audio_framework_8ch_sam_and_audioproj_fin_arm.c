@@ -85,6 +85,12 @@ BM_ADAU_DEVICE adau1761_local;
 // Driver for the A2B controller on the SHARC Audio Module board
 BM_AD2425W_CONTROLLER ad2425w;
 
+// How often (in seconds) the state of SHARC core 1's input AGC is logged
+#define AGC_LOG_INTERVAL_SECONDS    (10)
+
+// How often (in seconds) the output loudness measured on SHARC core 2 is logged
+#define LOUDNESS_LOG_INTERVAL_SECONDS   (10)
+
 #if ENABLE_A2B
 /**
  * @brief      Callback for GPIO-over-disance
@@ -543,6 +549,22 @@ void audioframework_wait_for_sharcs(void) {
     #endif
 }
 
+#if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+/**
+ * Writes the Audio Project Fin VU LEDs (bit 0 = VU1 ... bit 3 = VU4), touching
+ * only the ones that have changed since the last update.
+ */
+static void fin_vu_leds_update(uint32_t vu_leds, uint32_t * vu_leds_prev) {
+
+	uint32_t changed = vu_leds ^ *vu_leds_prev;
+	if (changed & 0x1) gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU1, (vu_leds & 0x1) ? GPIO_HIGH : GPIO_LOW);
+	if (changed & 0x2) gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU2, (vu_leds & 0x2) ? GPIO_HIGH : GPIO_LOW);
+	if (changed & 0x4) gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU3, (vu_leds & 0x4) ? GPIO_HIGH : GPIO_LOW);
+	if (changed & 0x8) gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU4, (vu_leds & 0x8) ? GPIO_HIGH : GPIO_LOW);
+	*vu_leds_prev = vu_leds;
+}
+#endif     // SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+
 void audioframework_background_loop(void) {
 
     /**
@@ -568,6 +590,33 @@ void audioframework_background_loop(void) {
         // Toggle the ARM core LED
         gpio_toggle(GPIO_SHARC_SAM_LED10);
 
+        // Periodically log the state of the input AGC running on SHARC core 1
+        static uint32_t agc_log_counter = 0;
+        if (++agc_log_counter >= AGC_LOG_INTERVAL_SECONDS) {
+            char message[128];
+            agc_log_counter = 0;
+            sprintf(message, "Input AGC: level %.1f / %.1f dB, gain %.1f / %.1f dB%s",
+                    multicore_data->agc_level_db_left,
+                    multicore_data->agc_level_db_right,
+                    multicore_data->agc_gain_db_left,
+                    multicore_data->agc_gain_db_right,
+                    multicore_data->agc_frozen ? " (frozen)" : "");
+            log_event(EVENT_INFO, message);
+        }
+
+        // Periodically log the output loudness measured on SHARC core 2
+        static uint32_t loudness_log_counter = 0;
+        if (++loudness_log_counter >= LOUDNESS_LOG_INTERVAL_SECONDS) {
+            char message[128];
+            loudness_log_counter = 0;
+            sprintf(message, "Output loudness: M %.1f / S %.1f / I %.1f LUFS, true peak %.1f dBTP",
+                    multicore_data->loudness_momentary_lufs,
+                    multicore_data->loudness_short_term_lufs,
+                    multicore_data->loudness_integrated_lufs,
+                    multicore_data->loudness_true_peak_dbtp);
+            log_event(EVENT_INFO, message);
+        }
+
 
 
 
@@ -577,30 +626,43 @@ void audioframework_background_loop(void) {
 			gpio_toggle(BM_GPIO_PORTPIN_MAKE(ADI_GPIO_PORT_F, 9));
         #endif
     }
-    // If the Audio Project Fin is attached, make a basic VU meter
+    // If the Audio Project Fin is attached, make a basic VU meter.  SHARC core 1
+    // publishes a new input level once per metering period, so the LEDs are only
+    // updated at that rate and only the ones that change are written.
+    //
+    // In tuner mode the same LEDs show the tuning instead: VU1 is flat, VU4 is
+    // sharp and VU2+VU3 together mean in tune (within 2 cents).
     #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
-    	if (multicore_data->audio_in_amplitude > -20.0) {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU4, GPIO_HIGH);
-    	} else {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU4, GPIO_LOW);
+    	static uint32_t level_sequence = 0;
+    	static uint32_t tuner_sequence = 0;
+    	static uint32_t vu_leds_prev = 0xFFFFFFFF;
+    	if (multicore_data->tuner_active) {
+    		if (multicore_data->tuner_sequence != tuner_sequence) {
+    			tuner_sequence = multicore_data->tuner_sequence;
+
+    			float cents = multicore_data->tuner_cents;
+    			uint32_t vu_leds = 0;
+    			if (multicore_data->tuner_locked) {
+    				if (cents < -10.0)      vu_leds = 0x1;
+    				else if (cents < -2.0)  vu_leds = 0x2;
+    				else if (cents <= 2.0)  vu_leds = 0x6;
+    				else if (cents <= 10.0) vu_leds = 0x4;
+    				else                    vu_leds = 0x8;
+    			}
+    			fin_vu_leds_update(vu_leds, &vu_leds_prev);
+    		}
     	}
+    	else if (multicore_data->audio_level_sequence != level_sequence) {
+    		level_sequence = multicore_data->audio_level_sequence;
 
-    	if (multicore_data->audio_in_amplitude > -30.0) {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU3, GPIO_HIGH);
-    	} else {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU3, GPIO_LOW);
-    	}
-
-    	if (multicore_data->audio_in_amplitude > -40.0) {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU2, GPIO_HIGH);
-    	} else {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU2, GPIO_LOW);
-    	}
+    		float level = multicore_data->audio_in_amplitude;
+    		uint32_t vu_leds = 0;
+    		if (level > -48.0) vu_leds |= 0x1;                 // Signal present
+    		if (level > -24.0) vu_leds |= 0x2;
+    		if (level > -12.0) vu_leds |= 0x4;
+    		if (multicore_data->audio_in_clipped) vu_leds |= 0x8;  // Clipped in the last second
 
-    	if (multicore_data->audio_in_amplitude > -50.0) {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU1, GPIO_HIGH);
-    	} else {
-    		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU1, GPIO_LOW);
+    		fin_vu_leds_update(vu_leds, &vu_leds_prev);
     	}
 	#endif     // SAM_AUDIOPROJ_FIN_BOARD_PRESENT
 
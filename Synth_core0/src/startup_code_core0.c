@@ -120,7 +120,7 @@ int main(int argc, const char *argv[]) {
     audioframework_initialize();
 
     // Initialize the effects presets
-	multicore_data->total_effects_presets = 10;
+	multicore_data->total_effects_presets = 15;
 	multicore_data->effects_preset = 0;
 	multicore_data->reverb_preset = 0;
 
@@ -53,6 +53,9 @@
 // Hooks into user processing functions
 #include "../callback_audio_processing.h"
 
+// Metering of the framework channels
+#include "audio_processing/audio_elements/level_meter.h"
+
 // Local function prototypes for our interrupt handlers
 void audioframework_dma_handler(uint32_t iid, void *arg);
 void audioframework_audiocallback_handler(uint32_t iid);
@@ -274,6 +277,18 @@ uint32_t audio_blocks_new_events_count = 0;
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
+/*
+ * Peak / RMS meters for every automotive input and output channel.  The audio
+ * callback only accumulates peaks and sums of squares; the ballistics run in
+ * audioframework_background_loop() once per metering period.
+ */
+#define CHANNEL_METER_PERIOD_MS          (25.0)
+#define CHANNEL_METER_HOLD_MS            (1000.0)
+#define CHANNEL_METER_DECAY_DB_PER_SEC   (20.0)
+#define CHANNEL_METER_RMS_TIME_MS        (300.0)
+LEVEL_METER automotive_in_meter;
+LEVEL_METER automotive_out_meter;
+
 // DMA & SPORT Configuration for SPORT 0 (ADAU1761 connection)
 SPORT_DMA_CONFIG SPR4_Automotive_16CH_Config = {
 
@@ -566,6 +581,10 @@ void audioframework_audiocallback_handler(uint32_t iid) {
         multicore_data->sharc_core1_cpu_load_mhz_peak = multicore_data->sharc_core1_cpu_load_mhz;
     }
 
+    // Meter all of the automotive channels (ballistics run in the background loop)
+    level_meter_read(&automotive_in_meter, automotive_audiochannels_in, AUDIO_BLOCK_SIZE);
+    level_meter_read(&automotive_out_meter, automotive_audiochannels_out, AUDIO_BLOCK_SIZE);
+
     // Increment our counter containing number of blocks processed
     audio_blocks_processed_count++;
 
@@ -595,6 +614,22 @@ void audioframework_initialize() {
     // Clear dropped frame counter
     multicore_data->sharc_core1_dropped_audio_frames = 0;
 
+    // Set up the channel meters
+    level_meter_setup(&automotive_in_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+    level_meter_setup(&automotive_out_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+
     // Initialize peripherals and DMA to configure audio data I/O flow
     audioflow_init_sport_dma(&SPR4_Automotive_16CH_Config);
 
@@ -633,5 +668,17 @@ void audioframework_start() {
     SPORT_ENABLE(4, B, 0, 1);
 }
 
+/**
+ * @brief      SHARC Core 1 audio framework background processing
+ *
+ * Called from the main loop.  Applies the peak hold / decay and RMS ballistics
+ * to the channel meters.
+ */
+void audioframework_background_loop() {
+
+    level_meter_process(&automotive_in_meter);
+    level_meter_process(&automotive_out_meter);
+}
+
 #endif // FRAMEWORK_16CH_SINGLE_OR_DUAL_CORE_AUTOMOTIVE
 int audio_framework_16ch_sam_and_automotive = 1;
@@ -156,6 +156,7 @@ extern float *audiochannel_automotive_7_right_out;
 
 void audioframework_initialize(void);
 void audioframework_start(void);
+void audioframework_background_loop(void);
 
 #ifdef __cplusplus
 }
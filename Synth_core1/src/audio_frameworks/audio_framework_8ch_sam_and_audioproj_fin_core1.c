@@ -45,6 +45,9 @@
 // Hooks into user processing functions
 #include "../callback_audio_processing.h"
 
+// Metering of the framework channels
+#include "audio_processing/audio_elements/level_meter.h"
+
 #if    defined(USE_FAUST_ALGORITHM_CORE1) && USE_FAUST_ALGORITHM_CORE1
 #include "audio_framework_faust_extension_core1.h"
 #endif
@@ -251,6 +254,24 @@ uint32_t audio_blocks_new_events_count = 0;
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
+/*
+ * Peak / RMS meters for every ADAU1761 input and output channel, and for the
+ * A2B channels when A2B is enabled.  The audio callback only accumulates peaks
+ * and sums of squares; the ballistics run in audioframework_background_loop()
+ * once per metering period, which also limits how often the VU LEDs on the
+ * Audio Project Fin are updated.
+ */
+#define CHANNEL_METER_PERIOD_MS          (25.0)
+#define CHANNEL_METER_HOLD_MS            (1000.0)
+#define CHANNEL_METER_DECAY_DB_PER_SEC   (20.0)
+#define CHANNEL_METER_RMS_TIME_MS        (300.0)
+LEVEL_METER adau1761_in_meter;
+LEVEL_METER adau1761_out_meter;
+#if (ENABLE_A2B)
+LEVEL_METER a2b_in_meter;
+LEVEL_METER a2b_out_meter;
+#endif
+
 // DMA & SPORT Configuration for SPORT 0 (ADAU1761 connection)
 SPORT_DMA_CONFIG SPR0_ADAU1761_8CH_Config = {
 
@@ -650,6 +671,14 @@ void audioframework_audiocallback_handler(uint32_t iid) {
     // Call user audio processing
     processaudio_callback();
 
+    // Meter all of the channels (ballistics run in the background loop)
+    level_meter_read(&adau1761_in_meter, adau1761_audiochannels_in, AUDIO_BLOCK_SIZE);
+    level_meter_read(&adau1761_out_meter, adau1761_audiochannels_out, AUDIO_BLOCK_SIZE);
+    #if (ENABLE_A2B)
+    level_meter_read(&a2b_in_meter, a2b_audiochannels_in, AUDIO_BLOCK_SIZE);
+    level_meter_read(&a2b_out_meter, a2b_audiochannels_out, AUDIO_BLOCK_SIZE);
+    #endif
+
     // Calculate our CPU load for this SHARC core based on our cycle counter
     multicore_data->sharc_core1_cpu_load_mhz = audioflow_get_cpu_load(cycle_cntr,
                                                                       AUDIO_BLOCK_SIZE,
@@ -660,19 +689,6 @@ void audioframework_audiocallback_handler(uint32_t iid) {
         multicore_data->sharc_core1_cpu_load_mhz_peak = multicore_data->sharc_core1_cpu_load_mhz;
     }
 
-
-	#if SAM_AUDIOPROJ_FIN_BOARD_PRESENT
-		float amplitude = 0;
-		for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
-			amplitude += fabs(audiochannel_0_left_in[i]);
-			amplitude += fabs(audiochannel_0_right_in[i]);
-		}
-
-		amplitude *= (1.0/AUDIO_BLOCK_SIZE);
-		multicore_data->audio_in_amplitude = 20.0*log10(amplitude);
-	#endif
-
-
     // Increment our counter containing number of blocks processed
     audio_blocks_processed_count++;
 
@@ -702,6 +718,38 @@ void audioframework_initialize() {
     // Clear dropped frame counter
     multicore_data->sharc_core1_dropped_audio_frames = 0;
 
+    // Set up the channel meters
+    level_meter_setup(&adau1761_in_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+    level_meter_setup(&adau1761_out_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+    #if (ENABLE_A2B)
+    level_meter_setup(&a2b_in_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+    level_meter_setup(&a2b_out_meter,
+                      AUDIO_CHANNELS,
+                      CHANNEL_METER_PERIOD_MS,
+                      CHANNEL_METER_HOLD_MS,
+                      CHANNEL_METER_DECAY_DB_PER_SEC,
+                      CHANNEL_METER_RMS_TIME_MS,
+                      AUDIO_SAMPLE_RATE);
+    #endif
+
     // If we're using Faust on either core, initialize the Faust engine
     #if (defined(USE_FAUST_ALGORITHM_CORE1) && USE_FAUST_ALGORITHM_CORE1) || defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
     faust_initialize();
@@ -757,5 +805,31 @@ void audioframework_start() {
     SPORT_ENABLE(0, B, 0, 1);
 }
 
+/**
+ * @brief      SHARC Core 1 audio framework background processing
+ *
+ * Called from the main loop.  Applies the peak hold / decay and RMS ballistics
+ * to the channel meters and, once per metering period, publishes the level
+ * of the first stereo input for the VU LEDs on the Audio Project Fin (which
+ * are driven by the ARM core).
+ */
+void audioframework_background_loop() {
+
+    bool updated = level_meter_process(&adau1761_in_meter);
+    level_meter_process(&adau1761_out_meter);
+    #if (ENABLE_A2B)
+    level_meter_process(&a2b_in_meter);
+    level_meter_process(&a2b_out_meter);
+    #endif
+
+	#if SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+    if (updated) {
+        multicore_data->audio_in_amplitude = level_meter_max_peak_hold_db(&adau1761_in_meter, 0, 2);
+        multicore_data->audio_in_clipped = level_meter_any_clipped(&adau1761_in_meter, 0, 2);
+        multicore_data->audio_level_sequence++;
+    }
+	#endif
+}
+
 #endif  // AUDIO_FRAMEWORK_8CH_SAM_AND_AUDIOPROJ_FIN
 int audio_framework_8ch_sam_and_audioproj_fin = 1;
@@ -168,6 +168,7 @@ extern uint32_t audio_blocks_processed_count;
 
 void audioframework_initialize(void);
 void audioframework_start(void);
+void audioframework_background_loop(void);
 
 #ifdef __cplusplus
 }
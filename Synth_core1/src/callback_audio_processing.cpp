@@ -248,6 +248,11 @@ void processaudio_callback(void) {
 
 	gain_buffer(audiochannel_0_left_out, 0.25, AUDIO_BLOCK_SIZE);
 	gain_buffer(audiochannel_0_right_out, 0.25, AUDIO_BLOCK_SIZE);
+
+	// Forward the line / mic input to SHARC core 2 on channel 1 where it is
+	// used as the vocoder modulator
+	copy_buffer(audiochannel_0_left_in, audiochannel_1_left_out, AUDIO_BLOCK_SIZE);
+	copy_buffer(audiochannel_0_right_in, audiochannel_1_right_out, AUDIO_BLOCK_SIZE);
 }
 
 /*
@@ -35,6 +35,9 @@
 #include "callback_audio_processing.h"
 #include "callback_midi_message.h"
 
+// Optional benchmarks of the audio elements
+#include "audio_processing/audio_benchmarks.h"
+
 /**
  * If you want to use command program arguments, then place them in the following string.
  */
@@ -120,6 +123,13 @@ int main(void){
 
     #endif
 
+    // Measure the audio elements before anything else is running on this core
+    #if (RUN_AUDIO_BENCHMARKS)
+        if (!audio_benchmarks_run()) {
+            log_event(EVENT_ERROR, "Audio benchmarks failed their limits (see the errors above)");
+        }
+    #endif
+
     // Set up our audio processing algorithms in our audio processing callback
     processaudio_setup();
 
@@ -135,6 +145,9 @@ int main(void){
     // Wait for audio block interrupts
     while (1) {
 
+        // Background work for the audio framework (e.g. channel meters)
+        audioframework_background_loop();
+
         // Call our optional background audio processing loop
         processaudio_background_loop();
     }
@@ -23,6 +23,9 @@
 #include "audio_processing/audio_elements/audio_utilities.h"
 #include "audio_processing/audio_elements/biquad_filter.h"
 #include "audio_processing/audio_elements/integer_delay_lpf.h"
+#include "audio_processing/audio_elements/stft_analyzer.h"
+#include "audio_processing/audio_elements/loudness_meter.h"
+#include "audio_processing/audio_effects/effect_vocoder.h"
 
 /*
  *
@@ -121,6 +124,31 @@ float pm lp_filter_coeffs[4];
 DELAY_LPF audio_delay;
 float    section("seg_sdram") delay_buffer[AUDIO_SAMPLE_RATE*2];
 
+// Spectrum analyzer for the output.  The callback only pushes samples; the
+// FFT runs in the background loop and the result is published in SDRAM so
+// the other cores can read it via multicore_data->sharc_core2_spectrum.
+// SDRAM is cached, so readers must go through stft_snapshot_read(), which
+// invalidates the lines the analyzer flushes after each frame.  (The
+// snapshot is too large for the uncached L2 region.)
+STFT_ANALYZER spectrum_analyzer;
+STFT_SNAPSHOT section("seg_sdram") spectrum_snapshot;
+#define SPECTRUM_FFT_SIZE		(1024)
+#define SPECTRUM_HOP_SIZE		(512)
+#define SPECTRUM_SMOOTHING		(0.7)
+
+// Loudness meter for the output (EBU R128).  The callback only K-weights and
+// sums squares; the gating and true-peak work runs in the background loop and
+// the results are published in multicore_data for the ARM to log.
+LOUDNESS_METER loudness_meter;
+
+// Channel vocoder.  The synth from core 1 (channel 0) is the carrier and the
+// line / mic input forwarded by core 1 (channel 1) is the modulator.  It
+// starts fully dry; MIDI CC8 sets the mix and CC9 the envelope release.
+VOCODER vocoder;
+#define VOCODER_BANDS			(32)
+#define VOCODER_ATTACK_MS		(2.0)
+#define VOCODER_RELEASE_MS		(30.0)
+
 void processaudio_setup(void) {
 	filter_setup(&lp_filter,
 				 BIQUAD_TYPE_LPF,
@@ -146,6 +174,30 @@ void processaudio_setup(void) {
 				0.8,  // Feedthrough
 				0.6,  // Feedback
 				0.0); // Dampening coefficient (0=no dampening)
+
+	// Crossfade between read heads (50ms) when CC5 changes the delay length
+	delay_modify_crossfade(&audio_delay, AUDIO_SAMPLE_RATE*0.05);
+
+	stft_analyzer_setup(&spectrum_analyzer,
+						&spectrum_snapshot,
+						SPECTRUM_FFT_SIZE,
+						SPECTRUM_HOP_SIZE,
+						SPECTRUM_SMOOTHING,
+						AUDIO_SAMPLE_RATE);
+	multicore_data->sharc_core2_spectrum = &spectrum_snapshot;
+
+	loudness_meter_setup(&loudness_meter, AUDIO_SAMPLE_RATE);
+	multicore_data->loudness_momentary_lufs = loudness_meter.momentary_lufs;
+	multicore_data->loudness_short_term_lufs = loudness_meter.short_term_lufs;
+	multicore_data->loudness_integrated_lufs = loudness_meter.integrated_lufs;
+	multicore_data->loudness_true_peak_dbtp = loudness_meter.true_peak_dbtp;
+
+	vocoder_setup(&vocoder,
+				  VOCODER_BANDS,
+				  VOCODER_ATTACK_MS,
+				  VOCODER_RELEASE_MS,
+				  0.0,
+				  AUDIO_SAMPLE_RATE);
 }
 
  /*
@@ -177,8 +229,11 @@ void processaudio_callback(void) {
 	clear_buffer(audio_temp, AUDIO_BLOCK_SIZE);
 	clear_buffer(audio_temp2, AUDIO_BLOCK_SIZE);
 
+	// Vocode the synth with the line / mic input
+	vocoder_read(&vocoder, audiochannel_1_left_in, audiochannel_0_left_in, audio_temp2, AUDIO_BLOCK_SIZE);
+
 	// Run filters on incoming L/R input audio
-	filter_read(&lp_filter, audiochannel_0_left_in, audio_temp, AUDIO_BLOCK_SIZE);
+	filter_read(&lp_filter, audio_temp2, audio_temp, AUDIO_BLOCK_SIZE);
 //	filter_read(&hp_filter, audio_temp, audio_temp2, AUDIO_BLOCK_SIZE);
 
 	// Run filtered audio through delay lines and send to L/R/ output audio
@@ -194,6 +249,12 @@ void processaudio_callback(void) {
         audiochannel_3_left_out[i]  = audiochannel_3_left_in[i];
         audiochannel_3_right_out[i] = audiochannel_3_right_in[i];
     }
+
+    // Hand the output to the spectrum analyzer (FFT runs in the background loop)
+    stft_analyzer_push(&spectrum_analyzer, audio_temp2, AUDIO_BLOCK_SIZE);
+
+    // Measure the loudness of the output (gating runs in the background loop)
+    loudness_meter_push(&loudness_meter, audiochannel_0_left_out, audiochannel_0_right_out, AUDIO_BLOCK_SIZE);
 }
 
 /*
@@ -201,6 +262,18 @@ void processaudio_callback(void) {
  * large FFTs in the background without interrupting the audio processing callback.
  */
 void processaudio_background_loop(void) {
+
+	// Analyze any new frames of audio
+	stft_analyzer_process(&spectrum_analyzer);
+
+	// Update and publish the output loudness
+	if (loudness_meter_process(&loudness_meter)) {
+		multicore_data->loudness_momentary_lufs = loudness_meter.momentary_lufs;
+		multicore_data->loudness_short_term_lufs = loudness_meter.short_term_lufs;
+		multicore_data->loudness_integrated_lufs = loudness_meter.integrated_lufs;
+		multicore_data->loudness_true_peak_dbtp = loudness_meter.true_peak_dbtp;
+	}
+
 	char val = multicore_data->midi_cc_values[4];
 	if (multicore_data->midi_cc_values_prev[4] != val)
 	{
@@ -219,6 +292,18 @@ void processaudio_background_loop(void) {
 		multicore_data->midi_cc_values_prev[6] = val;
 		filter_modify_freq(&lp_filter, (3000.f * (val / 128.f)) + 100.f);
 	}
+	val = multicore_data->midi_cc_values[8];
+	if (multicore_data->midi_cc_values_prev[8] != val)
+	{
+		multicore_data->midi_cc_values_prev[8] = val;
+		vocoder_modify_mix(&vocoder, val / 128.f);
+	}
+	val = multicore_data->midi_cc_values[9];
+	if (multicore_data->midi_cc_values_prev[9] != val)
+	{
+		multicore_data->midi_cc_values_prev[9] = val;
+		vocoder_modify_release(&vocoder, 5.f + 195.f * (val / 128.f));
+	}
 //	val = multicore_data->midi_cc_values[7];
 //	if (multicore_data->midi_cc_values_prev[7] != val)
 //	{
@@ -0,0 +1,799 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * These routines measure the cost of the audio elements and effects on the
+ * target.  They are only built when RUN_AUDIO_BENCHMARKS is set in
+ * audio_system_config.h and are run once on SHARC core 1 before the audio
+ * framework starts, so nothing else is competing for the core.
+ *
+ * Each benchmark processes BENCHMARK_BLOCKS blocks of AUDIO_BLOCK_SIZE
+ * samples of a test signal and reports the average and peak cycles per block
+ * to the event log.  For reference, a 32-sample block at 48 kHz leaves
+ * 300,000 cycles at 450 MHz.
+ *
+ * The benchmarks that also check behaviour have pass/fail limits.  A result
+ * outside its limit is logged as an EVENT_ERROR and audio_benchmarks_run()
+ * returns false.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "common/audio_system_config.h"
+#include "drivers/bm_audio_flow_driver/bm_audio_flow.h"
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+
+#include "audio_effects_selector.h"
+#include "audio_effects/effect_vocoder.h"
+#include "audio_benchmarks.h"
+
+#if (RUN_AUDIO_BENCHMARKS)
+
+#define BENCHMARK_BLOCKS		(256)
+
+// Cycle statistics for one benchmark
+typedef struct {
+	uint64_t	start;
+	uint64_t	total;
+	uint64_t	peak;
+	uint32_t	blocks;
+} BENCHMARK_STATS;
+
+// Test signal and output buffers shared by all of the benchmarks
+static float	bench_in_left[AUDIO_BLOCK_SIZE];
+static float	bench_in_right[AUDIO_BLOCK_SIZE];
+static float	bench_out_left[AUDIO_BLOCK_SIZE];
+static float	bench_out_right[AUDIO_BLOCK_SIZE];
+
+/**
+ * @brief Fills the input buffers with the next block of test signal
+ *
+ * A 220 Hz sine on the left and white noise on the right.
+ */
+static void benchmark_next_block(void) {
+
+	static float phase = 0.0;
+
+	for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
+		bench_in_left[i] = 0.5 * sinf(phase);
+		bench_in_right[i] = 0.5 * ((float) rand() / (float) RAND_MAX - 0.5);
+		phase += PI2 * 220.0 / AUDIO_SAMPLE_RATE;
+		if (phase > PI2) {
+			phase -= PI2;
+		}
+	}
+}
+
+static void benchmark_clear(BENCHMARK_STATS * s) {
+	s->total = 0;
+	s->peak = 0;
+	s->blocks = 0;
+}
+
+static inline void benchmark_start(BENCHMARK_STATS * s) {
+	s->start = audioflow_get_cpu_cycle_counter();
+}
+
+static inline void benchmark_stop(BENCHMARK_STATS * s) {
+	uint64_t cycles = audioflow_get_cpu_cycle_counter() - s->start;
+	s->total += cycles;
+	if (cycles > s->peak) {
+		s->peak = cycles;
+	}
+	s->blocks++;
+}
+
+/**
+ * @brief Sends the results of a benchmark to the event log
+ *
+ * @param name Name of the element / effect
+ * @param units Units that the results are also reported per ("tap", "band" etc.)
+ * @param count Number of units that were benchmarked (0 to skip per unit figure)
+ * @param s Pointer to the benchmark's statistics
+ */
+static void benchmark_report(const char * name,
+							 const char * units,
+							 uint32_t count,
+							 BENCHMARK_STATS * s) {
+
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	float average = (s->blocks > 0) ? (float) s->total / (float) s->blocks : 0.0;
+
+	if (count > 0) {
+		sprintf(message, "%s, %d %ss: %.0f avg / %d peak cycles per block, %.0f per %s",
+				name, (int) count, units, average, (int) s->peak, average / count, units);
+	}
+	else {
+		sprintf(message, "%s: %.0f avg / %d peak cycles per block",
+				name, average, (int) s->peak);
+	}
+	log_event(EVENT_INFO, message);
+}
+
+
+/******************************************************************************
+ * Modulated multitap delay (8, 16 and 32 taps)
+ *****************************************************************************/
+
+#define BENCH_MT_DELAY_LEN		(24000)
+
+static MOD_MULTITAP_DELAY		bench_mt_delay;
+static float section("seg_sdram") bench_mt_line_left[BENCH_MT_DELAY_LEN+1];
+static float section("seg_sdram") bench_mt_line_right[BENCH_MT_DELAY_LEN+1];
+
+static void benchmark_mod_multitap_delay(void) {
+
+	static const uint32_t tap_counts[] = {8, 16, 32};
+	MOD_MULTITAP_TAP_PARAMS taps[MOD_MULTITAP_DELAY_MAX_TAPS];
+	BENCHMARK_STATS stats;
+
+	for (int n=0;n<sizeof(tap_counts)/sizeof(tap_counts[0]);n++) {
+
+		uint32_t num_taps = tap_counts[n];
+
+		// Taps spread evenly along the line, alternating sides
+		for (int t=0;t<num_taps;t++) {
+			taps[t].source = (t & 1) ? MOD_MT_SOURCE_RIGHT : MOD_MT_SOURCE_LEFT;
+			taps[t].offset = (float) (t + 1) * (BENCH_MT_DELAY_LEN - 1000) / num_taps;
+			taps[t].gain = 0.5;
+			taps[t].pan = 2.0 * t / (num_taps - 1) - 1.0;
+			taps[t].tone_hz = 4000.0;
+			taps[t].mod_depth = 20.0;
+			taps[t].mod_rate_hz = 0.3 + 0.1 * t;
+			taps[t].mod_phase = (float) t / num_taps;
+			taps[t].feedback_left = (t & 1) ? 0.0 : 0.3 / num_taps;
+			taps[t].feedback_right = (t & 1) ? 0.3 / num_taps : 0.0;
+		}
+
+		mod_multitap_delay_setup(&bench_mt_delay,
+								 bench_mt_line_left,
+								 bench_mt_line_right,
+								 BENCH_MT_DELAY_LEN+1,
+								 num_taps,
+								 taps,
+								 1.0,
+								 AUDIO_SAMPLE_RATE);
+
+		benchmark_clear(&stats);
+		for (int b=0;b<BENCHMARK_BLOCKS;b++) {
+			benchmark_next_block();
+			benchmark_start(&stats);
+			mod_multitap_delay_read(&bench_mt_delay,
+									bench_in_left,
+									bench_in_right,
+									bench_out_left,
+									bench_out_right,
+									AUDIO_BLOCK_SIZE);
+			benchmark_stop(&stats);
+		}
+		benchmark_report("Modulated multitap delay", "tap", num_taps, &stats);
+	}
+}
+
+
+/******************************************************************************
+ * Delay line storage formats (float vs int16 vs fp16)
+ *
+ * The same 2/3 second echo (feedback 0.5, no dry signal) runs with each
+ * storage format next to a float reference echo.  The cycles of delay_read() and of packing and unpacking
+ * one block are reported with the memory each delay line takes and the SNR
+ * of the packed echo relative to the float one.
+ *****************************************************************************/
+
+#define BENCH_STORAGE_LEN		(32000)
+
+static DELAY_LPF	bench_storage_delay;
+static DELAY_LPF	bench_storage_ref;
+static float section("seg_sdram") bench_storage_line[BENCH_STORAGE_LEN];
+static float section("seg_sdram") bench_storage_ref_line[BENCH_STORAGE_LEN];
+
+static void benchmark_delay_storage(void) {
+
+	static const DELAY_STORAGE_FORMAT formats[] = {
+		DELAY_STORAGE_FLOAT,
+		DELAY_STORAGE_INT16,
+		DELAY_STORAGE_FP16
+	};
+	static const char * names[] = {
+		"Delay line float",
+		"Delay line int16",
+		"Delay line fp16"
+	};
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	BENCHMARK_STATS stats, convert_stats;
+
+	for (int f=0;f<sizeof(formats)/sizeof(formats[0]);f++) {
+
+		delay_setup_packed(&bench_storage_delay,
+						   bench_storage_line,
+						   BENCH_STORAGE_LEN,
+						   formats[f],
+						   BENCH_STORAGE_LEN-1000,
+						   0.5, 0.0, 0.0);
+		delay_setup(&bench_storage_ref,
+					bench_storage_ref_line,
+					BENCH_STORAGE_LEN,
+					BENCH_STORAGE_LEN-1000,
+					0.5, 0.0, 0.0);
+
+		// Run long enough for the echo to come round and measure its error
+		float signal = 0.0, noise = 0.0;
+		benchmark_clear(&stats);
+		for (int b=0;b<BENCH_STORAGE_LEN/AUDIO_BLOCK_SIZE + BENCHMARK_BLOCKS;b++) {
+			benchmark_next_block();
+			benchmark_start(&stats);
+			delay_read(&bench_storage_delay, bench_in_left, bench_out_left, AUDIO_BLOCK_SIZE);
+			benchmark_stop(&stats);
+			delay_read(&bench_storage_ref, bench_in_left, bench_out_right, AUDIO_BLOCK_SIZE);
+			for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
+				float error = bench_out_left[i] - bench_out_right[i];
+				signal += bench_out_right[i] * bench_out_right[i];
+				noise += error * error;
+			}
+		}
+		benchmark_report(names[f], "", 0, &stats);
+
+		// Cost of converting one block each way
+		benchmark_clear(&convert_stats);
+		for (int b=0;b<BENCHMARK_BLOCKS;b++) {
+			benchmark_start(&convert_stats);
+			delay_storage_pack(bench_in_left, bench_storage_line, formats[f], AUDIO_BLOCK_SIZE);
+			delay_storage_unpack(bench_storage_line, bench_out_left, formats[f], AUDIO_BLOCK_SIZE);
+			benchmark_stop(&convert_stats);
+		}
+
+		float snr_db = (noise > 0.0) ? 10.0 * log10f(signal / noise) : 999.0;
+		sprintf(message, "%s: %d KB per %d samples, pack+unpack %d cycles per block, SNR %.1f dB",
+				names[f],
+				(int) (BENCH_STORAGE_LEN * delay_storage_bytes_per_sample(formats[f]) / 1024),
+				BENCH_STORAGE_LEN,
+				(int) (convert_stats.total / convert_stats.blocks),
+				snr_db);
+		log_event(EVENT_INFO, message);
+	}
+}
+
+
+/******************************************************************************
+ * Early reflections (16, 32 and 64 reflections per channel)
+ *****************************************************************************/
+
+#define BENCH_ER_LEN		(8192)
+
+static EARLY_REFLECTIONS	bench_er;
+static float section("seg_sdram") bench_er_line[BENCH_ER_LEN];
+
+static void benchmark_early_reflections(void) {
+
+	static const uint32_t reflection_counts[] = {16, 32, 64};
+	BENCHMARK_STATS stats;
+
+	for (int n=0;n<sizeof(reflection_counts)/sizeof(reflection_counts[0]);n++) {
+
+		early_reflections_setup(&bench_er,
+								bench_er_line,
+								BENCH_ER_LEN,
+								EARLY_REFLECTIONS_ROOM_HALL,
+								reflection_counts[n],
+								0.3,
+								AUDIO_SAMPLE_RATE);
+
+		benchmark_clear(&stats);
+		for (int b=0;b<BENCHMARK_BLOCKS;b++) {
+			benchmark_next_block();
+			benchmark_start(&stats);
+			early_reflections_read_stereo(&bench_er,
+										  bench_in_left,
+										  bench_in_right,
+										  bench_out_left,
+										  bench_out_right,
+										  AUDIO_BLOCK_SIZE);
+			benchmark_stop(&stats);
+		}
+		benchmark_report("Early reflections", "reflection", reflection_counts[n], &stats);
+	}
+}
+
+
+/******************************************************************************
+ * Channel vocoder (16, 24 and 32 bands)
+ *****************************************************************************/
+
+static VOCODER	bench_vocoder;
+
+static void benchmark_vocoder(void) {
+
+	static const uint32_t band_counts[] = {16, 24, 32};
+	BENCHMARK_STATS stats;
+
+	for (int n=0;n<sizeof(band_counts)/sizeof(band_counts[0]);n++) {
+
+		vocoder_setup(&bench_vocoder, band_counts[n], 5.0, 50.0, 1.0, AUDIO_SAMPLE_RATE);
+
+		// Noise modulates the sine carrier
+		benchmark_clear(&stats);
+		for (int b=0;b<BENCHMARK_BLOCKS;b++) {
+			benchmark_next_block();
+			benchmark_start(&stats);
+			vocoder_read(&bench_vocoder,
+						 bench_in_right,
+						 bench_in_left,
+						 bench_out_left,
+						 AUDIO_BLOCK_SIZE);
+			benchmark_stop(&stats);
+		}
+		benchmark_report("Vocoder", "band", band_counts[n], &stats);
+	}
+}
+
+
+/******************************************************************************
+ * Harmonizer (1, 2 and 3 voices in each mode)
+ *
+ * The phase vocoder spreads each frame over the blocks of the next hop, so
+ * its peak cycles per block is the figure to watch.
+ *****************************************************************************/
+
+static HARMONIZER	bench_harmonizer;
+
+static void benchmark_harmonizer(void) {
+
+	static const HARMONIZER_MODE modes[] = {
+		HARMONIZER_MODE_GRANULAR,
+		HARMONIZER_MODE_PHASE_VOCODER
+	};
+	static const char * names[] = {
+		"Harmonizer granular",
+		"Harmonizer phase vocoder"
+	};
+	static const float intervals[HARMONIZER_MAX_VOICES] = {4.0, 7.0, -12.0};
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	BENCHMARK_STATS stats;
+
+	for (int m=0;m<sizeof(modes)/sizeof(modes[0]);m++) {
+
+		for (uint32_t num_voices=1;num_voices<=HARMONIZER_MAX_VOICES;num_voices++) {
+
+			harmonizer_setup(&bench_harmonizer, modes[m], num_voices, intervals, 0.5, AUDIO_SAMPLE_RATE);
+
+			benchmark_clear(&stats);
+			for (int b=0;b<BENCHMARK_BLOCKS;b++) {
+				benchmark_next_block();
+				benchmark_start(&stats);
+				harmonizer_read(&bench_harmonizer,
+								bench_in_left,
+								bench_out_left,
+								AUDIO_BLOCK_SIZE);
+				benchmark_stop(&stats);
+			}
+			benchmark_report(names[m], "voice", num_voices, &stats);
+		}
+
+		uint32_t latency = harmonizer_latency(&bench_harmonizer);
+		sprintf(message, "%s: %d samples (%.1f ms) latency",
+				names[m], (int) latency, 1000.0 * latency / AUDIO_SAMPLE_RATE);
+		log_event(EVENT_INFO, message);
+	}
+}
+
+
+/******************************************************************************
+ * Feedback suppressor
+ *
+ * A steady -20 dBFS tone stands in for feedback.  For each frequency this logs
+ * how long it took to detect, where the notch landed and how far the tone was
+ * attenuated at the end, along with the cycles of the background analysis.
+ * Each tone must be detected within BENCH_FS_MAX_DETECT_MS and attenuated by
+ * at least BENCH_FS_MIN_ATTENUATION_DB.  A melody that changes note every
+ * 100 ms (including a semitone step) must not trigger any detections.
+ *****************************************************************************/
+
+#define BENCH_FS_SECONDS		(2.0)
+#define BENCH_FS_SETTLED_SECONDS	(0.25)	// Attenuation is measured over the end of the run
+#define BENCH_FS_MAX_DETECT_MS		(250.0)
+#define BENCH_FS_MIN_ATTENUATION_DB	(15.0)
+
+static FEEDBACK_SUPPRESSOR	bench_fs;
+
+static bool benchmark_feedback_suppressor(void) {
+
+	static const float tones[] = {187.0, 1000.0, 3300.0, 7000.0};
+	static const float melody[] = {262.0, 330.0, 392.0, 523.0, 440.0, 349.0, 294.0, 247.0};
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	BENCHMARK_STATS stats;
+	bool passed = true;
+
+	uint32_t total_blocks = (uint32_t) (BENCH_FS_SECONDS * AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+	uint32_t settled_block = total_blocks - (uint32_t) (BENCH_FS_SETTLED_SECONDS * AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+
+	for (int t=0;t<=sizeof(tones)/sizeof(tones[0]);t++) {
+
+		bool melody_run = (t == sizeof(tones)/sizeof(tones[0]));
+		feedback_suppressor_setup(&bench_fs, 12, -18.0, 1.0, AUDIO_SAMPLE_RATE);
+
+		float phase = 0.0;
+		float in_power = 0.0, out_power = 0.0;
+		int32_t detect_block = -1;
+		uint32_t sample = 0;
+		benchmark_clear(&stats);
+
+		for (int b=0;b<total_blocks;b++) {
+
+			for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
+				float freq = melody_run ?
+							 melody[(sample / (AUDIO_SAMPLE_RATE / 10)) % (sizeof(melody)/sizeof(melody[0]))] :
+							 tones[t];
+				bench_in_left[i] = 0.1 * sinf(phase);
+				phase += PI2 * freq / AUDIO_SAMPLE_RATE;
+				if (phase > PI2) {
+					phase -= PI2;
+				}
+				sample++;
+			}
+
+			feedback_suppressor_read(&bench_fs, bench_in_left, bench_out_left, AUDIO_BLOCK_SIZE);
+
+			benchmark_start(&stats);
+			feedback_suppressor_process(&bench_fs);
+			benchmark_stop(&stats);
+
+			if (detect_block < 0 && bench_fs.detections > 0) {
+				detect_block = b;
+			}
+			if (b >= settled_block) {
+				for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
+					in_power += bench_in_left[i] * bench_in_left[i];
+					out_power += bench_out_left[i] * bench_out_left[i];
+				}
+			}
+		}
+
+		bool ok;
+		if (melody_run) {
+			ok = (bench_fs.detections == 0);
+			sprintf(message, "Feedback suppressor, melody: %d detections (%.1f Hz)",
+					(int) bench_fs.detections, bench_fs.last_detection_freq);
+		}
+		else if (detect_block < 0) {
+			ok = false;
+			sprintf(message, "Feedback suppressor, %.0f Hz: not detected", tones[t]);
+		}
+		else {
+			float detect_ms = 1000.0 * (detect_block + 1) * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE;
+			float level_db = 10.0 * log10f(out_power / in_power);
+			ok = (detect_ms <= BENCH_FS_MAX_DETECT_MS && level_db <= -BENCH_FS_MIN_ATTENUATION_DB);
+			sprintf(message, "Feedback suppressor, %.0f Hz: detected in %.0f ms at %.1f Hz, tone level %.1f dB after the notch",
+					tones[t], detect_ms, bench_fs.last_detection_freq, level_db);
+		}
+		log_event(ok ? EVENT_INFO : EVENT_ERROR, message);
+		passed = passed && ok;
+	}
+	benchmark_report("Feedback suppressor analysis", "", 0, &stats);
+
+	return passed;
+}
+
+
+/******************************************************************************
+ * Preset switching
+ *
+ * Two presets (an echo and early reflections, both with the dry signal) and
+ * bypass are switched through with the same crossfade and cycle budget as
+ * core 1, on a 220 Hz sine in both channels.  For each switch this logs how
+ * it was made, the largest step between two output samples while switching
+ * (compared with the largest in the steady state of the two presets) and the
+ * peak cycles per block.  The first switch to a preset that hasn't run yet
+ * should fade out and in; the rest should crossfade.
+ *
+ * A switch fails if its largest step is more than BENCH_PRESET_STEP_MARGIN
+ * times the steady state one (i.e. it clicked) or a block went over
+ * BENCH_PRESET_CYCLE_BUDGET.
+ *****************************************************************************/
+
+#define BENCH_PRESET_CROSSFADE_MS	(300.0)
+#define BENCH_PRESET_CYCLE_BUDGET	((uint32_t)(0.8 * CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE * AUDIO_BLOCK_SIZE))
+#define BENCH_PRESET_HOLD_BLOCKS	(AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE / 2)	// Half a second between switches
+#define BENCH_PRESET_STEP_MARGIN	(1.5)
+#define BENCH_PRESET_COUNT			(3)
+
+static float	bench_preset_pool[2*AUDIO_BLOCK_SIZE];
+static float *	bench_preset_in[2] = { bench_in_left, bench_in_right };
+static float *	bench_preset_out[2] = { bench_out_left, bench_out_right };
+
+static DELAY_LPF	bench_preset_echo;
+static EFFECT_GRAPH	bench_preset_echo_graph;
+static EFFECT_GRAPH	bench_preset_er_graph;
+static EFFECT_PRESETS	bench_presets;
+
+static void bench_node_echo(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	delay_read((DELAY_LPF *) instance, audio_in[0], audio_out[0], audio_block_size);
+	copy_buffer(audio_out[0], audio_out[1], audio_block_size);
+}
+
+static void bench_node_er(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	early_reflections_read_stereo((EARLY_REFLECTIONS *) instance,
+								  audio_in[0], audio_in[1], audio_out[0], audio_out[1], audio_block_size);
+}
+
+static const EFFECT_GRAPH_NODE bench_preset_echo_nodes[] = {
+	{ bench_node_echo, &bench_preset_echo, 1, 2, false }
+};
+static const EFFECT_GRAPH_EDGE bench_preset_echo_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 1, EFFECT_GRAPH_OUT, 1 }
+};
+static const EFFECT_GRAPH_NODE bench_preset_er_nodes[] = {
+	{ bench_node_er, &bench_er, 2, 2, false }
+};
+static const EFFECT_GRAPH_EDGE bench_preset_er_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 1, 0, 1 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 1, EFFECT_GRAPH_OUT, 1 }
+};
+
+static void bench_preset_echo_setup(void) {
+	delay_setup(&bench_preset_echo, bench_storage_ref_line, BENCH_STORAGE_LEN, AUDIO_SAMPLE_RATE / 4, 0.5, 1.0, 0.0);
+	effect_graph_setup(&bench_preset_echo_graph,
+					   bench_preset_echo_nodes, 1,
+					   bench_preset_echo_edges, 3,
+					   bench_preset_in, 2, bench_preset_out, 2,
+					   bench_preset_pool, 2, AUDIO_BLOCK_SIZE);
+}
+
+static void bench_preset_er_setup(void) {
+	early_reflections_setup(&bench_er, bench_er_line, BENCH_ER_LEN, EARLY_REFLECTIONS_ROOM_MEDIUM, 32, 0.3, AUDIO_SAMPLE_RATE);
+	effect_graph_setup(&bench_preset_er_graph,
+					   bench_preset_er_nodes, 1,
+					   bench_preset_er_edges, 4,
+					   bench_preset_in, 2, bench_preset_out, 2,
+					   bench_preset_pool, 2, AUDIO_BLOCK_SIZE);
+}
+
+static const EFFECT_PRESET bench_preset_table[] = {
+	{ NULL,						NULL,	NULL,						NULL, 0 },
+	{ bench_preset_echo_setup,	NULL,	&bench_preset_echo_graph,	NULL, 0 },
+	{ bench_preset_er_setup,	NULL,	&bench_preset_er_graph,		NULL, 0 }
+};
+
+static uint32_t bench_preset_cycle_counter(void) {
+	return (uint32_t) audioflow_get_cpu_cycle_counter();
+}
+
+static bool benchmark_preset_switching(void) {
+
+	static const uint32_t sequence[] = {1, 2, 1, 0, 2};
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	BENCHMARK_STATS stats;
+	float last_out[2];
+	float steady_step[BENCH_PRESET_COUNT] = {0.0, 0.0, 0.0};	// Per preset, outside the switches
+	bool first_block = true;
+	bool passed = true;
+
+	effect_presets_setup(&bench_presets, bench_preset_table, BENCH_PRESET_COUNT, bench_preset_in, bench_preset_out, 2, 4096);
+	effect_presets_modify_crossfade(&bench_presets,
+									(uint32_t) (BENCH_PRESET_CROSSFADE_MS * 0.001 * AUDIO_SAMPLE_RATE));
+	effect_presets_modify_cycle_budget(&bench_presets, bench_preset_cycle_counter, BENCH_PRESET_CYCLE_BUDGET);
+
+	uint32_t from = 0;
+	for (int n=0;n<sizeof(sequence)/sizeof(sequence[0]);n++) {
+
+		uint32_t to = sequence[n];
+		uint32_t crossfades = bench_presets.crossfades;
+		float switch_step = 0.0;
+		effect_presets_select(&bench_presets, to);
+		benchmark_clear(&stats);
+
+		for (int b=0;b<BENCH_PRESET_HOLD_BLOCKS;b++) {
+
+			// Background loop, then the audio callback
+			effect_presets_process(&bench_presets);
+
+			benchmark_next_block();
+			copy_buffer(bench_in_left, bench_in_right, AUDIO_BLOCK_SIZE);
+			bool switching = (bench_presets.pending != EFFECT_PRESETS_NO_CHANGE ||
+							  bench_presets.switching != EFFECT_PRESETS_SWITCH_NONE);
+
+			benchmark_start(&stats);
+			effect_presets_read(&bench_presets, AUDIO_BLOCK_SIZE);
+			benchmark_stop(&stats);
+
+			for (int ch=0;ch<2;ch++) {
+				float * out = bench_preset_out[ch];
+				if (first_block) {
+					last_out[ch] = out[0];
+				}
+				for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
+					float step = fabsf(out[i] - last_out[ch]);
+					last_out[ch] = out[i];
+					if (switching && step > switch_step) {
+						switch_step = step;
+					}
+					else if (!switching && step > steady_step[to]) {
+						steady_step[to] = step;
+					}
+				}
+			}
+			first_block = false;
+		}
+
+		// Both presets have run in their steady state by the end of the hold
+		float steady = (steady_step[from] > steady_step[to]) ? steady_step[from] : steady_step[to];
+		bool ok = (switch_step <= BENCH_PRESET_STEP_MARGIN * steady &&
+				   stats.peak <= BENCH_PRESET_CYCLE_BUDGET);
+
+		sprintf(message, "Preset switch %d -> %d: %s, max step %.4f (%.4f steady), %d peak cycles per block",
+				(int) from, (int) to,
+				(bench_presets.crossfades != crossfades) ? "crossfade" : "fade out/in",
+				switch_step, steady, (int) stats.peak);
+		log_event(ok ? EVENT_INFO : EVENT_ERROR, message);
+		passed = passed && ok;
+		from = to;
+	}
+
+	sprintf(message, "Preset switching: %d crossfades shortened, budget %d cycles per block",
+			(int) bench_presets.crossfades_shortened, (int) BENCH_PRESET_CYCLE_BUDGET);
+	log_event(EVENT_INFO, message);
+
+	return passed;
+}
+
+
+/******************************************************************************
+ * Preset lifecycle
+ *
+ * Checks that a preset is only set up when it is first selected, that its
+ * buffers (a float line and an odd length int16 line) are completely zeroed
+ * first, and that it is released once it has been switched away from and set
+ * up from scratch the next time it is selected.
+ *****************************************************************************/
+
+#define BENCH_LIFECYCLE_PACKED_LEN	(4001)
+
+static int16_t section("seg_sdram") bench_lifecycle_packed[BENCH_LIFECYCLE_PACKED_LEN];
+static uint32_t	bench_lifecycle_setups;
+
+// The echo preset's graph, with the setups counted
+static void bench_lifecycle_setup(void) {
+	bench_lifecycle_setups++;
+	bench_preset_echo_setup();
+}
+
+static const EFFECT_PRESET_BUFFER bench_lifecycle_buffers[] = {
+	{ bench_storage_line, sizeof(bench_storage_line) },
+	{ bench_lifecycle_packed, sizeof(bench_lifecycle_packed) }
+};
+
+static const EFFECT_PRESET bench_lifecycle_table[] = {
+	{ NULL,						NULL,	NULL,						NULL, 0 },
+	{ bench_lifecycle_setup,	NULL,	&bench_preset_echo_graph,	bench_lifecycle_buffers, 2 }
+};
+
+/**
+ * @brief Fills the buffers of the lifecycle preset with something other than zero
+ */
+static void bench_lifecycle_fill(void) {
+	for (int i=0;i<BENCH_STORAGE_LEN;i++) {
+		bench_storage_line[i] = 1.0;
+	}
+	for (int i=0;i<BENCH_LIFECYCLE_PACKED_LEN;i++) {
+		bench_lifecycle_packed[i] = 0x1234;
+	}
+}
+
+/**
+ * @return true if all of the buffers of the lifecycle preset are zero
+ */
+static bool bench_lifecycle_cleared(void) {
+	for (int i=0;i<BENCH_STORAGE_LEN;i++) {
+		if (bench_storage_line[i] != 0.0) {
+			return false;
+		}
+	}
+	for (int i=0;i<BENCH_LIFECYCLE_PACKED_LEN;i++) {
+		if (bench_lifecycle_packed[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Selects a preset and runs the background loop and audio callback
+ * long enough for the switch to finish
+ */
+static void bench_lifecycle_select(uint32_t preset) {
+	effect_presets_select(&bench_presets, preset);
+	for (int b=0;b<BENCH_PRESET_HOLD_BLOCKS;b++) {
+		effect_presets_process(&bench_presets);
+		benchmark_next_block();
+		effect_presets_read(&bench_presets, AUDIO_BLOCK_SIZE);
+	}
+}
+
+static bool benchmark_preset_lifecycle(void) {
+
+	char message[MAX_EVENT_MESSAGE_LENGTH];
+	const char * failed = NULL;
+
+	bench_lifecycle_setups = 0;
+	bench_lifecycle_fill();
+	effect_presets_setup(&bench_presets, bench_lifecycle_table, 2, bench_preset_in, bench_preset_out, 2, 1024);
+	effect_presets_modify_crossfade(&bench_presets,
+									(uint32_t) (BENCH_PRESET_CROSSFADE_MS * 0.001 * AUDIO_SAMPLE_RATE));
+	bench_lifecycle_select(0);
+
+	if (bench_lifecycle_setups != 0) {
+		failed = "set up before it was selected";
+	}
+
+	if (failed == NULL) {
+		bench_lifecycle_select(1);
+		if (bench_lifecycle_setups != 1 || bench_presets.state[1] != EFFECT_PRESET_ACTIVE) {
+			failed = "not set up when selected";
+		}
+		else if (!bench_lifecycle_cleared()) {
+			failed = "buffers not zeroed";
+		}
+	}
+
+	if (failed == NULL) {
+		bench_lifecycle_select(0);
+		if (bench_presets.state[1] != EFFECT_PRESET_RELEASED) {
+			failed = "not released after switching away";
+		}
+	}
+
+	if (failed == NULL) {
+		bench_lifecycle_fill();
+		bench_lifecycle_select(1);
+		if (bench_lifecycle_setups != 2) {
+			failed = "not set up again when reselected";
+		}
+		else if (!bench_lifecycle_cleared()) {
+			failed = "buffers not zeroed when reselected";
+		}
+	}
+
+	if (failed == NULL) {
+		sprintf(message, "Preset lifecycle: ok, %d background passes zeroing buffers",
+				(int) bench_presets.clear_passes);
+		log_event(EVENT_INFO, message);
+	}
+	else {
+		sprintf(message, "Preset lifecycle: %s", failed);
+		log_event(EVENT_ERROR, message);
+	}
+
+	return (failed == NULL);
+}
+
+
+/**
+ * @brief Runs all of the benchmarks and logs the results
+ *
+ * @return true if every benchmark with pass/fail limits passed
+ */
+bool	audio_benchmarks_run(void) {
+
+	bool passed = true;
+
+	log_event(EVENT_INFO, "Running audio benchmarks");
+
+	benchmark_mod_multitap_delay();
+	benchmark_delay_storage();
+	benchmark_early_reflections();
+	benchmark_vocoder();
+	benchmark_harmonizer();
+	passed = benchmark_feedback_suppressor() && passed;
+	passed = benchmark_preset_switching() && passed;
+	passed = benchmark_preset_lifecycle() && passed;
+
+	log_event(EVENT_INFO, "Audio benchmarks complete");
+
+	return passed;
+}
+
+#endif	// RUN_AUDIO_BENCHMARKS
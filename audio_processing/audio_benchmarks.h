@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .cpp file for documentation.
+ *
+ */
+
+#ifndef _AUDIO_BENCHMARKS_H
+#define _AUDIO_BENCHMARKS_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool	audio_benchmarks_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_BENCHMARKS_H
@@ -25,6 +25,10 @@
 #define  AUTOWAH_Q_MIN          (0.0)
 #define  AUTOWAH_Q_MAX          (1.0)
 #define  AUTOWAH_MAX_BF_FREQ    (800.0)
+#define  AUTOWAH_RELEASE_MS_MAX (10000.0)
+
+// Static function prototypes
+static float autowah_decay_to_release_ms(float decay, float audio_sample_rate);
 
 /**
  * @brief Initializes instance of an autowah
@@ -82,7 +86,17 @@ RESULT_AUTOWAH  autowah_setup(AUTOWAH * c,
                 audio_sample_rate);
 
     c->depth = 1000.0 * depth;
-    c->decay = 0.999 + (0.001 * decay);
+    c->decay = decay;
+    c->audio_sample_rate = audio_sample_rate;
+
+    // Peak follower with instant attack, decay sets the release time
+    c->measured_ampitude = 0.0;
+    envelope_follower_setup(&c->amp_env,
+                            ENV_FOLLOWER_PEAK,
+                            0.0,
+                            autowah_decay_to_release_ms(decay, audio_sample_rate),
+                            1,
+                            audio_sample_rate);
 
     c->initialized = true;
     return AUTOWAH_OK;
@@ -121,7 +135,9 @@ RESULT_AUTOWAH    autowah_modify_decay(AUTOWAH * c, float decay_new) {
         res = AUTOWAH_OK;
     }
 
-    c->decay = 0.999 + (0.001 * decay);
+    c->decay = decay;
+    envelope_follower_modify_release(&c->amp_env,
+                                     autowah_decay_to_release_ms(decay, c->audio_sample_rate));
 
     return res;
 }
@@ -236,9 +252,10 @@ void    autowah_read(AUTOWAH * c,
     }
 
     // Update amplitude
-    for (int i=0;i<audio_block_size;i++) {
-        measure_amp_peak(audio_in[i], &c->measured_ampitude, c->decay);
-    }
+    c->measured_ampitude = envelope_follower_read(&c->amp_env,
+                                                  audio_in,
+                                                  NULL,
+                                                  audio_block_size);
 
     float env_freq = c->measured_ampitude*c->depth;
     if (env_freq > AUTOWAH_MAX_BF_FREQ) env_freq = AUTOWAH_MAX_BF_FREQ;
@@ -262,3 +279,23 @@ void    autowah_read(AUTOWAH * c,
                 audio_out,
                 audio_block_size);
 }
+
+/**
+ * @brief Converts the decay parameter to an envelope release time
+ *
+ * A decay of 0.0->1.0 corresponds to a per-sample decay factor of
+ * 0.999->1.0 (i.e. a time constant of 1000 samples -> infinite).
+ *
+ * @param decay Decay parameter (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Release time in milliseconds
+ */
+static float autowah_decay_to_release_ms(float decay, float audio_sample_rate) {
+
+    float one_minus_decay = 0.001*(1.0 - decay);
+    float release_ms = AUTOWAH_RELEASE_MS_MAX;
+    if (one_minus_decay*AUTOWAH_RELEASE_MS_MAX*audio_sample_rate > 1000.0) {
+        release_ms = 1000.0/(one_minus_decay*audio_sample_rate);
+    }
+    return release_ms;
+}
@@ -10,6 +10,7 @@
 #include  <stdint.h>
 
 #include "../audio_elements/biquad_filter.h"
+#include "../audio_elements/envelope_follower.h"
 #include "../audio_elements/audio_elements_common.h"
 
 // Result enumerations
@@ -28,12 +29,14 @@ typedef struct {
     bool            initialized;
     BIQUAD_FILTER   bpf1, bpf2, bpf3;
     float           bpf_coeffs1[6], bpf_coeffs2[6], bpf_coeffs3[6];
+    ENVELOPE_FOLLOWER   amp_env;
     float           measured_ampitude;
     float           freq_start;
     float           depth;
     float           decay;
     float           q;
     float           q_last;
+    float           audio_sample_rate;
 
 } AUTOWAH;
 
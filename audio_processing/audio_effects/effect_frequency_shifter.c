@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ * 
+ * A frequency shifter moves every frequency in the incoming signal up or
+ * down by the same number of Hz.  Unlike a pitch shifter, this doesn't
+ * preserve the harmonic relationships in the signal, so small shifts give
+ * a swirling, phaser-like sound and larger shifts turn notes into
+ * inharmonic, bell-like tones.  Unlike a ring modulator, only one sideband
+ * is produced.
+ * 
+ * The input is split into two signals that are 90 degrees apart (an analytic
+ * signal, I + jQ) by a Hilbert network built from two chains of four
+ * second-order allpass sections, and then multiplied by a complex carrier
+ * from a quadrature oscillator:
+ * 
+ *      out = I*cos(wt) - Q*sin(wt)
+ * 
+ * A negative shift simply runs the carrier backwards.  The allpass
+ * coefficients keep the two chains within about a degree of 90 degrees
+ * apart from ~30 Hz to ~20 kHz.
+ */
+#include <stdlib.h>
+
+#include "effect_frequency_shifter.h"
+
+// Min/max limits and other constants
+#define FREQ_SHIFTER_SHIFT_HZ_MIN   (-5000.0)
+#define FREQ_SHIFTER_SHIFT_HZ_MAX   (5000.0)
+#define FREQ_SHIFTER_MIX_MIN        (0.0)
+#define FREQ_SHIFTER_MIX_MAX        (1.0)
+
+// Allpass coefficients for the in-phase and quadrature chains
+static const float freq_shifter_coeffs_i[FREQ_SHIFTER_HILBERT_STAGES] = {
+    0.4021921162426, 0.8561710882420, 0.9722909545651, 0.9952884791278 };
+static const float freq_shifter_coeffs_q[FREQ_SHIFTER_HILBERT_STAGES] = {
+    0.6923878000000, 0.9360654322959, 0.9882295226860, 0.9987488452737 };
+
+// Static function prototypes
+static void freq_shifter_allpass_chain(FREQ_SHIFTER_ALLPASS * stages,
+                                       float * audio_in,
+                                       float * audio_out,
+                                       uint32_t audio_block_size);
+
+
+/**
+ * @brief Initializes instance of a frequency shifter
+ *
+ * @param c Pointer to instance structure
+ * @param shift_hz Frequency shift in Hz (-5000.0->5000.0)
+ * @param mix Mix of shifted signal (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Frequency shifter result (enumeration)
+ */
+RESULT_FREQ_SHIFTER freq_shifter_setup(FREQ_SHIFTER * c,
+                                       float shift_hz,
+                                       float mix,
+                                       float audio_sample_rate) {
+
+    if (c == NULL) {
+        return FREQ_SHIFTER_INVALID_INSTANCE_POINTER;
+    }
+
+    c->initialized = false;
+
+    if (shift_hz > FREQ_SHIFTER_SHIFT_HZ_MAX ||
+        shift_hz < FREQ_SHIFTER_SHIFT_HZ_MIN) {
+        return FREQ_SHIFTER_INVALID_SHIFT;
+    }
+    if (mix > FREQ_SHIFTER_MIX_MAX ||
+        mix < FREQ_SHIFTER_MIX_MIN) {
+        return FREQ_SHIFTER_INVALID_MIX;
+    }
+
+    // Allpass sections use the square of the published coefficients
+    for (int i=0;i<FREQ_SHIFTER_HILBERT_STAGES;i++) {
+        c->hilbert_i[i].coeff = freq_shifter_coeffs_i[i]*freq_shifter_coeffs_i[i];
+        c->hilbert_i[i].x1 = c->hilbert_i[i].x2 = 0.0;
+        c->hilbert_i[i].y1 = c->hilbert_i[i].y2 = 0.0;
+
+        c->hilbert_q[i].coeff = freq_shifter_coeffs_q[i]*freq_shifter_coeffs_q[i];
+        c->hilbert_q[i].x1 = c->hilbert_q[i].x2 = 0.0;
+        c->hilbert_q[i].y1 = c->hilbert_q[i].y2 = 0.0;
+    }
+    c->q_delay = 0.0;
+
+    quad_osc_setup(&c->oscillator, shift_hz, audio_sample_rate);
+
+    c->shift_hz = shift_hz;
+    c->mix = mix;
+    c->audio_sample_rate = audio_sample_rate;
+
+    // Instance was successfully initialized
+    c->initialized = true;
+    return FREQ_SHIFTER_OK;
+
+}
+
+/**
+ * @brief Modify frequency shift
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param new_shift_hz New frequency shift in Hz (-5000.0->5000.0)
+ * @return Frequency shifter result (enumeration)
+ */
+RESULT_FREQ_SHIFTER freq_shifter_modify_shift(FREQ_SHIFTER * c,
+                                              float shift_hz_new) {
+
+    RESULT_FREQ_SHIFTER res;
+
+    float shift_hz;
+    if (shift_hz_new < FREQ_SHIFTER_SHIFT_HZ_MIN) {
+        shift_hz = FREQ_SHIFTER_SHIFT_HZ_MIN;
+        res = FREQ_SHIFTER_INVALID_SHIFT;
+    } else if (shift_hz_new > FREQ_SHIFTER_SHIFT_HZ_MAX) {
+        shift_hz = FREQ_SHIFTER_SHIFT_HZ_MAX;
+        res = FREQ_SHIFTER_INVALID_SHIFT;
+    } else {
+        shift_hz = shift_hz_new;
+        res = FREQ_SHIFTER_OK;
+    } 
+
+    // Update instance parameters
+    c->shift_hz = shift_hz;
+    quad_osc_modify_freq(&c->oscillator, shift_hz);
+
+    return res;
+
+}
+
+/**
+ * @brief Modify mix of shifted signal
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param new_mix New mix (0.0->1.0)
+ * @return Frequency shifter result (enumeration)
+ */
+RESULT_FREQ_SHIFTER freq_shifter_modify_mix(FREQ_SHIFTER * c,
+                                            float mix_new) {
+
+    RESULT_FREQ_SHIFTER res;
+
+    float mix;
+    if (mix_new < FREQ_SHIFTER_MIX_MIN) {
+        mix = FREQ_SHIFTER_MIX_MIN;
+        res = FREQ_SHIFTER_INVALID_MIX;
+    } else if (mix_new > FREQ_SHIFTER_MIX_MAX) {
+        mix = FREQ_SHIFTER_MIX_MAX;
+        res = FREQ_SHIFTER_INVALID_MIX;
+    } else {
+        mix = mix_new;
+        res = FREQ_SHIFTER_OK;
+    } 
+
+    // Update instance parameters
+    c->mix = mix;
+
+    return res;
+
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ * 
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    freq_shifter_read(FREQ_SHIFTER * c,
+                          float * audio_in,
+                          float * audio_out,
+                          uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] = audio_in[i];
+        }
+        return;
+    }
+
+    float sig_i[MAX_AUDIO_BLOCK_SIZE], sig_q[MAX_AUDIO_BLOCK_SIZE];
+    float osc_sin[MAX_AUDIO_BLOCK_SIZE], osc_cos[MAX_AUDIO_BLOCK_SIZE];
+
+    // Split input into in-phase and quadrature signals
+    freq_shifter_allpass_chain(c->hilbert_i, audio_in, sig_i, audio_block_size);
+    freq_shifter_allpass_chain(c->hilbert_q, audio_in, sig_q, audio_block_size);
+
+    // Generate carrier
+    quad_osc_read(&c->oscillator, osc_sin, osc_cos, audio_block_size);
+
+    // Single sideband modulation (quadrature chain is delayed by one sample)
+    float dry = 1.0-c->mix;
+    float wet = c->mix;
+    float q_last = c->q_delay;
+    for (int i=0;i<audio_block_size;i++) {
+        float q = q_last;
+        q_last = sig_q[i];
+        float shifted = sig_i[i]*osc_cos[i] - q*osc_sin[i];
+        audio_out[i] = dry*audio_in[i] + wet*shifted;
+    }
+    c->q_delay = q_last;
+
+}
+
+/**
+ * @brief Runs a block of audio through a chain of second-order allpass sections
+ *
+ * Each section implements y[n] = a*(x[n] + y[n-2]) - x[n-2].  The sections
+ * are processed one at a time across the whole block.
+ *
+ * @param stages Pointer to allpass sections
+ * @param audio_in Pointer to floating point audio input buffer
+ * @param audio_out Pointer to floating point output buffer
+ * @param audio_block_size The number of floating-point words to process
+ */
+static void freq_shifter_allpass_chain(FREQ_SHIFTER_ALLPASS * stages,
+                                       float * audio_in,
+                                       float * audio_out,
+                                       uint32_t audio_block_size) {
+
+    float * in = audio_in;
+    for (int s=0;s<FREQ_SHIFTER_HILBERT_STAGES;s++) {
+
+        FREQ_SHIFTER_ALLPASS * ap = &stages[s];
+        float a = ap->coeff;
+        float x1 = ap->x1, x2 = ap->x2;
+        float y1 = ap->y1, y2 = ap->y2;
+
+        for (int i=0;i<audio_block_size;i++) {
+            float x = in[i];
+            float y = a*(x + y2) - x2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            audio_out[i] = y;
+        }
+
+        ap->x1 = x1;
+        ap->x2 = x2;
+        ap->y1 = y1;
+        ap->y2 = y2;
+
+        // Subsequent sections process in place
+        in = audio_out;
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ * 
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_FREQUENCY_SHIFTER_H
+#define _AUDIO_EFFECT_FREQUENCY_SHIFTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/quadrature_oscillator.h"
+
+#define FREQ_SHIFTER_HILBERT_STAGES     (4)
+
+// Result enumerations
+typedef enum
+{
+    FREQ_SHIFTER_OK,
+    FREQ_SHIFTER_INVALID_INSTANCE_POINTER,
+    FREQ_SHIFTER_INVALID_SHIFT,
+    FREQ_SHIFTER_INVALID_MIX
+} RESULT_FREQ_SHIFTER;
+
+// State of one second-order allpass section of the Hilbert network
+typedef struct {
+    float   coeff;
+    float   x1, x2;
+    float   y1, y2;
+} FREQ_SHIFTER_ALLPASS;
+
+// C struct with parameters and state information
+typedef struct {
+
+    bool    initialized;
+
+    QUAD_OSC    oscillator;
+
+    // Two allpass chains with outputs 90 degrees apart
+    FREQ_SHIFTER_ALLPASS    hilbert_i[FREQ_SHIFTER_HILBERT_STAGES];
+    FREQ_SHIFTER_ALLPASS    hilbert_q[FREQ_SHIFTER_HILBERT_STAGES];
+    float   q_delay;
+
+    float   shift_hz;
+    float   mix;
+    float   audio_sample_rate;
+
+} FREQ_SHIFTER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_FREQ_SHIFTER freq_shifter_setup(FREQ_SHIFTER * c,
+                                       float shift_hz,
+                                       float mix,
+                                       float audio_sample_rate);
+
+RESULT_FREQ_SHIFTER freq_shifter_modify_shift(FREQ_SHIFTER * c,
+                                              float new_shift_hz);
+
+RESULT_FREQ_SHIFTER freq_shifter_modify_mix(FREQ_SHIFTER * c,
+                                            float new_mix);
+
+void    freq_shifter_read(FREQ_SHIFTER * c,
+                          float * audio_in,
+                          float * audio_out,
+                          uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_EFFECT_FREQUENCY_SHIFTER_H
@@ -5,6 +5,10 @@
  * same frequency that is currently being played.  It does this by first 
  * determining the frequency being played using a zero-crossing detector.  
  * Based on the detected frequency, it synthesis additional waveforms.  
+ *
+ * The zero-crossing detector can be swapped for the pitch_detector element
+ * (McLeod / NSDF) with guitar_synth_select_detector().  It locks faster and
+ * tracks chords and harmonic-rich tones much more reliably.
  * 
  * This audio effect also serves as an example of how to utilize the
  * zero_crossing_detector, simple synth and biquad filter audio elements.
@@ -18,6 +22,10 @@
 #define  GUITAR_SYNTH_CLEAN_MIX_MAX      (1.0)
 #define  GUITAR_SYNTH_SYNTH_MIX_MIN      (0.0)
 #define  GUITAR_SYNTH_SYNTH_MIX_MAX      (1.0)
+#define  GUITAR_SYNTH_AMP_RELEASE_MS     (208.0)     // ~0.9999 decay per sample at 48kHz
+#define  GUITAR_SYNTH_PITCH_MIN_FREQ     (60.0)      // Below low E (82.4Hz) for drop tunings
+#define  GUITAR_SYNTH_PITCH_MAX_FREQ     (1500.0)
+#define  GUITAR_SYNTH_PITCH_THRESHOLD    (0.8)       // NSDF confidence for a lock
 
 
 /**
@@ -52,8 +60,24 @@ RESULT_GUITAR_SYNTH guitar_synth_setup(GUITAR_SYNTH * c,
     c->synth_volume = 0.5;
     c->measured_ampitude = 0;
 
-    // Set up zero-crossing detector
+    // Peak follower for the input amplitude (instant attack, ~200ms release)
+    envelope_follower_setup(&c->amp_env,
+                            ENV_FOLLOWER_PEAK,
+                            0.0,
+                            GUITAR_SYNTH_AMP_RELEASE_MS,
+                            1,
+                            audio_sample_rate);
+
+    // Set up pitch detectors (zero-crossing is used by default)
+    c->detector = GUITAR_SYNTH_DETECT_ZERO_CROSSING;
     zero_cross_setup(&c->zc_detect, ZC_DEFAULT_THRESHOLD, audio_sample_rate);
+    pitch_detect_setup(&c->pitch_detect,
+                       GUITAR_SYNTH_PITCH_MIN_FREQ,
+                       GUITAR_SYNTH_PITCH_MAX_FREQ,
+                       GUITAR_SYNTH_PITCH_THRESHOLD,
+                       audio_sample_rate);
+    c->detected_frequency = 0.0;
+    c->detected_confidence = 0.0;
 
     // Set up synthesizers
     synth_setup(&c->synth,
@@ -169,6 +193,27 @@ RESULT_GUITAR_SYNTH    guitar_synth_modify_synth_mix(GUITAR_SYNTH * c,
 }
 
 
+/**
+ * @brief Select the method used to detect the pitch being played
+ *
+ * @param c Pointer to instance structure
+ * @param detector Pitch detection method (see enumeration)
+ * @return Guitar synth result (enumeration)
+ */
+RESULT_GUITAR_SYNTH    guitar_synth_select_detector(GUITAR_SYNTH * c,
+                                                    GUITAR_SYNTH_DETECTOR detector) {
+
+    if (detector != GUITAR_SYNTH_DETECT_ZERO_CROSSING &&
+        detector != GUITAR_SYNTH_DETECT_NSDF) {
+        return GUITAR_SYNTH_INVALID_DETECTOR;
+    }
+
+    c->detector = detector;
+
+    return GUITAR_SYNTH_OK;
+}
+
+
 /**
  * @brief Apply effect/process to a block of audio data
  * 
@@ -195,10 +240,18 @@ void   guitar_synth_read(GUITAR_SYNTH * c,
           synth_out_3[MAX_AUDIO_BLOCK_SIZE];
 
 
-    c->current_lock = zero_crossing_read(&c->zc_detect, 
-                                         audio_in, 
-                                         audio_block_size,
-                                         &c->detected_frequency);
+    if (c->detector == GUITAR_SYNTH_DETECT_NSDF) {
+        c->current_lock = pitch_detect_read(&c->pitch_detect,
+                                            audio_in,
+                                            audio_block_size,
+                                            &c->detected_frequency,
+                                            &c->detected_confidence);
+    } else {
+        c->current_lock = zero_crossing_read(&c->zc_detect, 
+                                             audio_in, 
+                                             audio_block_size,
+                                             &c->detected_frequency);
+    }
 
     if (c->current_lock) {
         c->lock_cntr++;
@@ -240,11 +293,14 @@ void   guitar_synth_read(GUITAR_SYNTH * c,
     synth_read(&c->synth_octave_low_2, synth_out_3, audio_block_size);
 
     // Mix it together
-    float amplitude;
+    float amplitude[MAX_AUDIO_BLOCK_SIZE];
+    c->measured_ampitude = envelope_follower_read(&c->amp_env,
+                                                  audio_in,
+                                                  amplitude,
+                                                  audio_block_size);
     for (int i=0;i<audio_block_size;i++) {
-        measure_amp_peak(audio_in[i], &c->measured_ampitude, 0.9999);
         audio_out[i] = (audio_in[i] * c->clean_mix *2.0) +
-                       (synth_out_1[i]*0.5+synth_out_2[i]*0.95+synth_out_3[i]*0.5)*4.0*c->measured_ampitude*c->synth_mix;
+                       (synth_out_1[i]*0.5+synth_out_2[i]*0.95+synth_out_3[i]*0.5)*4.0*amplitude[i]*c->synth_mix;
 
     }
 
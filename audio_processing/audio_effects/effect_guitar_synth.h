@@ -10,6 +10,8 @@
 #include "../audio_elements/audio_elements_common.h"
 
 #include "../audio_elements/zero_crossing_detector.h"
+#include "../audio_elements/pitch_detector.h"
+#include "../audio_elements/envelope_follower.h"
 #include "../audio_elements/simple_synth.h"
 #include "../audio_elements/audio_utilities.h"
 
@@ -22,13 +24,23 @@ typedef enum
     GUITAR_SYNTH_OK,
     GUITAR_SYNTH_INVALID_INSTANCE_POINTER,
     GUITAR_SYNTH_INVALID_CLEAN_MIX,
-    GUITAR_SYNTH_INVALID_SYNTH_MIX
+    GUITAR_SYNTH_INVALID_SYNTH_MIX,
+    GUITAR_SYNTH_INVALID_DETECTOR
 } RESULT_GUITAR_SYNTH;
 
+// Pitch detection methods
+typedef enum
+{
+    GUITAR_SYNTH_DETECT_ZERO_CROSSING,      // Zero-crossing period tracking
+    GUITAR_SYNTH_DETECT_NSDF                // McLeod (NSDF) pitch detector
+} GUITAR_SYNTH_DETECTOR;
+
 typedef struct {
 
     bool            initialized;
+    GUITAR_SYNTH_DETECTOR   detector;
     ZERO_CROSSING_DETECTOR  zc_detect;
+    PITCH_DETECTOR          pitch_detect;
 
     BIQUAD_FILTER           env_filter;
     float                   env_filter_coeffs[6];
@@ -50,7 +62,9 @@ typedef struct {
     bool            current_lock;
 
     float           detected_frequency;
+    float           detected_confidence;
     float           measured_ampitude;
+    ENVELOPE_FOLLOWER   amp_env;
     
     float           audio_sample_rate;
     uint32_t        audio_block_size;
@@ -75,6 +89,9 @@ RESULT_GUITAR_SYNTH    guitar_synth_modify_clean_mix(GUITAR_SYNTH * c,
 RESULT_GUITAR_SYNTH    guitar_synth_modify_synth_mix(GUITAR_SYNTH * c,
                                        float synth_mix_new);
 
+RESULT_GUITAR_SYNTH    guitar_synth_select_detector(GUITAR_SYNTH * c,
+                                                    GUITAR_SYNTH_DETECTOR detector);
+
 void    guitar_synth_read(GUITAR_SYNTH * c,
                          float * audio_in,
                          float * audio_out,
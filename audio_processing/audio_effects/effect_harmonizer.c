@@ -0,0 +1,736 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A harmonizer adds up to three pitch shifted copies of the input at fixed
+ * musical intervals (e.g. a third and a fifth above).  Two pitch shifting
+ * algorithms are available and can be switched at run time:
+ *
+ * HARMONIZER_MODE_GRANULAR - a time domain "rotating tape head" shifter.
+ * Each voice reads the input from a delay line with two taps whose delay
+ * sweeps across a short grain (~30 ms) at a rate set by the pitch ratio.  The
+ * taps are half a grain apart and each is faded with a Hann shaped window so
+ * that one tap is silent while the other jumps back to the start of the
+ * grain.  This has very low latency (half a grain on average) and a small
+ * fixed cost per voice, but can warble on chords and dense material.
+ *
+ * HARMONIZER_MODE_PHASE_VOCODER - a frequency domain shifter.  The input is
+ * analyzed with a Hann windowed FFT (1024 points, 4x overlap).  The true
+ * frequency of each bin is estimated from its phase advance between frames,
+ * then for each voice the bins are moved to their shifted frequencies and the
+ * phases are re-accumulated.  The voices are summed in the frequency domain
+ * so a single inverse FFT and overlap-add produces all of them.  This sounds
+ * smoother on complex material but adds FFT_SIZE samples of latency (the dry
+ * signal is delayed by the same amount so the two stay aligned).
+ *
+ * Rather than processing a whole frame in the block where its last hop
+ * arrives, the work is spread across the blocks of the following hop: the
+ * analysis in one block, each voice in the next ones and the inverse FFT
+ * after that.  This costs one hop of extra latency but keeps the peak cycles
+ * per block close to the cost of the largest step instead of all of them.
+ *
+ * Both modes take their intervals in semitones (-24->+24), i.e. a pitch ratio
+ * of 2^(semitones/12).
+ *
+ * Switching modes clears the state of the new mode (~12k words), which is too
+ * much to do in the audio callback.  harmonizer_modify_mode() only records the
+ * request, and harmonizer_process() should be called from the background loop
+ * to clear the new mode's state and then switch.  The two modes don't share
+ * any state so the callback can keep running the old mode in the meantime.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "effect_harmonizer.h"
+
+// Min/max limits and other constants
+#define HARMONIZER_SEMITONES_MIN        (-24.0)
+#define HARMONIZER_SEMITONES_MAX        (24.0)
+#define HARMONIZER_LEVEL_MIN            (0.0)
+#define HARMONIZER_LEVEL_MAX            (1.0)
+#define HARMONIZER_MIX_MIN              (0.0)
+#define HARMONIZER_MIX_MAX              (1.0)
+
+#define HARMONIZER_DELAY_MASK           (HARMONIZER_DELAY_LEN-1)
+#define HARMONIZER_GRAIN_MS             (30.0)
+#define HARMONIZER_MIN_DELAY            (2.0)       // Keeps interpolation behind the write pointer
+
+#define HARMONIZER_FIFO_START           (HARMONIZER_FFT_SIZE-HARMONIZER_HOP_SIZE)
+#define HARMONIZER_LATENCY_PV           (HARMONIZER_FIFO_START+HARMONIZER_HOP_SIZE)
+
+// Overlap-add gain for Hann analysis and synthesis windows
+#define HARMONIZER_OLA_GAIN             (1.0/(0.375*HARMONIZER_OVERSAMPLING))
+
+// Static function prototypes
+static void     harmonizer_reset_granular(HARMONIZER * c);
+static void     harmonizer_reset_phase_vocoder(HARMONIZER * c);
+static void     harmonizer_read_granular(HARMONIZER * c,
+                                         float * audio_in,
+                                         float * audio_out,
+                                         uint32_t audio_block_size);
+static void     harmonizer_read_phase_vocoder(HARMONIZER * c,
+                                              float * audio_in,
+                                              float * audio_out,
+                                              uint32_t audio_block_size);
+static void     harmonizer_pv_next_hop(HARMONIZER * c);
+static void     harmonizer_pv_step(HARMONIZER * c);
+static void     harmonizer_pv_analysis(HARMONIZER * c);
+static void     harmonizer_pv_voice(HARMONIZER * c,
+                                    HARMONIZER_VOICE * voice);
+static void     harmonizer_pv_synthesis(HARMONIZER * c);
+
+
+/**
+ * @brief Initializes instance of a harmonizer
+ *
+ * @param c Pointer to instance structure
+ * @param mode Pitch shifting algorithm (enumeration)
+ * @param num_voices Number of harmony voices (1->HARMONIZER_MAX_VOICES)
+ * @param semitones Pointer to the interval of each voice in semitones (-24.0->24.0)
+ * @param mix Mix of the harmony voices (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Harmonizer result (enumeration)
+ */
+RESULT_HARMONIZER harmonizer_setup(HARMONIZER * c,
+                                   HARMONIZER_MODE mode,
+                                   uint32_t num_voices,
+                                   const float * semitones,
+                                   float mix,
+                                   float audio_sample_rate) {
+
+    if (c == NULL) {
+        return HARMONIZER_INVALID_INSTANCE_POINTER;
+    }
+
+    c->initialized = false;
+
+    if (mode != HARMONIZER_MODE_GRANULAR &&
+        mode != HARMONIZER_MODE_PHASE_VOCODER) {
+        return HARMONIZER_INVALID_MODE;
+    }
+    if (num_voices < 1 || num_voices > HARMONIZER_MAX_VOICES) {
+        return HARMONIZER_INVALID_NUM_VOICES;
+    }
+    if (semitones == NULL) {
+        return HARMONIZER_INVALID_INTERVAL;
+    }
+    for (int v=0;v<num_voices;v++) {
+        if (semitones[v] > HARMONIZER_SEMITONES_MAX ||
+            semitones[v] < HARMONIZER_SEMITONES_MIN) {
+            return HARMONIZER_INVALID_INTERVAL;
+        }
+    }
+    if (mix > HARMONIZER_MIX_MAX ||
+        mix < HARMONIZER_MIX_MIN) {
+        return HARMONIZER_INVALID_MIX;
+    }
+
+    c->mode = mode;
+    c->mode_requested = mode;
+    c->num_voices = num_voices;
+    c->mix = mix;
+    c->audio_sample_rate = audio_sample_rate;
+
+    for (int v=0;v<num_voices;v++) {
+        HARMONIZER_VOICE * voice = &c->voices[v];
+        voice->semitones = semitones[v];
+        voice->ratio = powf(2.0, semitones[v]/12.0);
+        voice->level = 1.0/num_voices;
+    }
+
+    // Grain length, limited so the longest delay still fits in the delay line
+    c->grain_len = HARMONIZER_GRAIN_MS*0.001*audio_sample_rate;
+    if (c->grain_len > HARMONIZER_DELAY_LEN - 2*HARMONIZER_MIN_DELAY) {
+        c->grain_len = HARMONIZER_DELAY_LEN - 2*HARMONIZER_MIN_DELAY;
+    }
+
+    // sin^2 grain window.  Two taps half a grain apart always sum to 1.0
+    for (int i=0;i<=HARMONIZER_GRAIN_TABLE_SIZE;i++) {
+        float s = sinf(PI*i/HARMONIZER_GRAIN_TABLE_SIZE);
+        c->grain_window[i] = s*s;
+    }
+
+    // Periodic Hann window for analysis and synthesis
+    for (int i=0;i<HARMONIZER_FFT_SIZE;i++) {
+        c->window[i] = 0.5 - 0.5*cosf(PI2*i/HARMONIZER_FFT_SIZE);
+    }
+    real_fft_setup(&c->fft, HARMONIZER_FFT_SIZE);
+
+    harmonizer_reset_granular(c);
+    harmonizer_reset_phase_vocoder(c);
+
+    // Instance was successfully initialized
+    c->initialized = true;
+    return HARMONIZER_OK;
+
+}
+
+/**
+ * @brief Modify the pitch shifting algorithm
+ *
+ * The new mode takes effect on the next call to harmonizer_process(), which
+ * clears its state first.
+ *
+ * @param c Pointer to instance structure
+ * @param mode_new New mode (enumeration)
+ * @return Harmonizer result (enumeration)
+ */
+RESULT_HARMONIZER harmonizer_modify_mode(HARMONIZER * c,
+                                         HARMONIZER_MODE mode_new) {
+
+    if (mode_new != HARMONIZER_MODE_GRANULAR &&
+        mode_new != HARMONIZER_MODE_PHASE_VOCODER) {
+        return HARMONIZER_INVALID_MODE;
+    }
+
+    c->mode_requested = mode_new;
+
+    return HARMONIZER_OK;
+
+}
+
+/**
+ * @brief Modify the interval of a harmony voice
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param voice Voice to modify (0->num_voices-1)
+ * @param semitones_new New interval in semitones (-24.0->24.0)
+ * @return Harmonizer result (enumeration)
+ */
+RESULT_HARMONIZER harmonizer_modify_interval(HARMONIZER * c,
+                                             uint32_t voice,
+                                             float semitones_new) {
+
+    if (voice >= c->num_voices) {
+        return HARMONIZER_INVALID_VOICE;
+    }
+
+    RESULT_HARMONIZER res;
+
+    float semitones;
+    if (semitones_new < HARMONIZER_SEMITONES_MIN) {
+        semitones = HARMONIZER_SEMITONES_MIN;
+        res = HARMONIZER_INVALID_INTERVAL;
+    } else if (semitones_new > HARMONIZER_SEMITONES_MAX) {
+        semitones = HARMONIZER_SEMITONES_MAX;
+        res = HARMONIZER_INVALID_INTERVAL;
+    } else {
+        semitones = semitones_new;
+        res = HARMONIZER_OK;
+    }
+
+    // Update instance parameters (only recompute the ratio if it changed)
+    if (semitones != c->voices[voice].semitones) {
+        c->voices[voice].semitones = semitones;
+        c->voices[voice].ratio = powf(2.0, semitones/12.0);
+    }
+
+    return res;
+
+}
+
+/**
+ * @brief Modify the level of a harmony voice
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param voice Voice to modify (0->num_voices-1)
+ * @param level_new New level (0.0->1.0)
+ * @return Harmonizer result (enumeration)
+ */
+RESULT_HARMONIZER harmonizer_modify_voice_level(HARMONIZER * c,
+                                                uint32_t voice,
+                                                float level_new) {
+
+    if (voice >= c->num_voices) {
+        return HARMONIZER_INVALID_VOICE;
+    }
+
+    RESULT_HARMONIZER res;
+
+    float level;
+    if (level_new < HARMONIZER_LEVEL_MIN) {
+        level = HARMONIZER_LEVEL_MIN;
+        res = HARMONIZER_INVALID_LEVEL;
+    } else if (level_new > HARMONIZER_LEVEL_MAX) {
+        level = HARMONIZER_LEVEL_MAX;
+        res = HARMONIZER_INVALID_LEVEL;
+    } else {
+        level = level_new;
+        res = HARMONIZER_OK;
+    }
+
+    // Update instance parameters
+    c->voices[voice].level = level;
+
+    return res;
+
+}
+
+/**
+ * @brief Modify mix of the harmony voices
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param mix_new New mix (0.0->1.0)
+ * @return Harmonizer result (enumeration)
+ */
+RESULT_HARMONIZER harmonizer_modify_mix(HARMONIZER * c,
+                                        float mix_new) {
+
+    RESULT_HARMONIZER res;
+
+    float mix;
+    if (mix_new < HARMONIZER_MIX_MIN) {
+        mix = HARMONIZER_MIX_MIN;
+        res = HARMONIZER_INVALID_MIX;
+    } else if (mix_new > HARMONIZER_MIX_MAX) {
+        mix = HARMONIZER_MIX_MAX;
+        res = HARMONIZER_INVALID_MIX;
+    } else {
+        mix = mix_new;
+        res = HARMONIZER_OK;
+    }
+
+    // Update instance parameters
+    c->mix = mix;
+
+    return res;
+
+}
+
+/**
+ * @brief Returns the latency of the harmony voices in samples
+ *
+ * For the granular mode this is the average delay of the grain taps.
+ *
+ * @param c Pointer to instance structure
+ * @return Latency in samples
+ */
+uint32_t harmonizer_latency(HARMONIZER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return 0;
+    }
+
+    if (c->mode == HARMONIZER_MODE_PHASE_VOCODER) {
+        return HARMONIZER_LATENCY_PV;
+    }
+    return (uint32_t) (HARMONIZER_MIN_DELAY + 0.5*c->grain_len);
+}
+
+/**
+ * @brief Switches to the requested mode (call from the background loop)
+ *
+ * @param c Pointer to instance structure
+ */
+void    harmonizer_process(HARMONIZER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    HARMONIZER_MODE mode = c->mode_requested;
+    if (mode == c->mode) {
+        return;
+    }
+
+    // The callback is still running the old mode so this state is unused
+    if (mode == HARMONIZER_MODE_PHASE_VOCODER) {
+        harmonizer_reset_phase_vocoder(c);
+    }
+    else {
+        harmonizer_reset_granular(c);
+    }
+    c->mode = mode;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    harmonizer_read(HARMONIZER * c,
+                        float * audio_in,
+                        float * audio_out,
+                        uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] = audio_in[i];
+        }
+        return;
+    }
+
+    if (c->mode == HARMONIZER_MODE_PHASE_VOCODER) {
+        harmonizer_read_phase_vocoder(c, audio_in, audio_out, audio_block_size);
+    }
+    else {
+        harmonizer_read_granular(c, audio_in, audio_out, audio_block_size);
+    }
+
+}
+
+/**
+ * @brief Clears the delay line and grain phases
+ *
+ * @param c Pointer to instance structure
+ */
+static void     harmonizer_reset_granular(HARMONIZER * c) {
+
+    for (int i=0;i<HARMONIZER_DELAY_LEN;i++) {
+        c->delay_line[i] = 0.0;
+    }
+    c->delay_write = 0;
+
+    for (int v=0;v<HARMONIZER_MAX_VOICES;v++) {
+        c->voices[v].grain_phase = 0.0;
+    }
+}
+
+/**
+ * @brief Clears the FIFOs and phase accumulators
+ *
+ * @param c Pointer to instance structure
+ */
+static void     harmonizer_reset_phase_vocoder(HARMONIZER * c) {
+
+    for (int i=0;i<HARMONIZER_FFT_SIZE;i++) {
+        c->in_fifo[i] = 0.0;
+        c->out_fifo[i] = 0.0;
+        c->out_accum[i] = 0.0;
+    }
+    for (int i=0;i<HARMONIZER_HOP_SIZE;i++) {
+        c->dry_fifo[i] = 0.0;
+    }
+    c->rover = HARMONIZER_FIFO_START;
+    c->pv_stage = 0;
+
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+        c->last_phase[k] = 0.0;
+    }
+
+    for (int v=0;v<HARMONIZER_MAX_VOICES;v++) {
+        for (int k=0;k<HARMONIZER_BINS;k++) {
+            c->voices[v].sum_phase[k] = 0.0;
+        }
+    }
+}
+
+/**
+ * @brief Granular pitch shifting of each voice
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     harmonizer_read_granular(HARMONIZER * c,
+                                         float * audio_in,
+                                         float * audio_out,
+                                         uint32_t audio_block_size) {
+
+    float voice_out[MAX_AUDIO_BLOCK_SIZE];
+    float wet[MAX_AUDIO_BLOCK_SIZE];
+
+    // Write the whole block first.  Taps are at least HARMONIZER_MIN_DELAY
+    // behind the sample being processed so they only read written samples.
+    uint32_t write_start = c->delay_write;
+    for (int i=0;i<audio_block_size;i++) {
+        c->delay_line[(write_start + i) & HARMONIZER_DELAY_MASK] = audio_in[i];
+    }
+    c->delay_write = (write_start + audio_block_size) & HARMONIZER_DELAY_MASK;
+
+    for (int i=0;i<audio_block_size;i++) {
+        wet[i] = 0.0;
+    }
+
+    float grain_len = c->grain_len;
+    float * dl = c->delay_line;
+
+    for (int v=0;v<c->num_voices;v++) {
+
+        HARMONIZER_VOICE * voice = &c->voices[v];
+
+        // Delay shrinks (ratio > 1) or grows (ratio < 1) by this much per sample
+        float phase_inc = (1.0 - voice->ratio)/grain_len;
+        float phase = voice->grain_phase;
+
+        for (int i=0;i<audio_block_size;i++) {
+
+            phase += phase_inc;
+            if (phase >= 1.0) phase -= 1.0;
+            if (phase < 0.0) phase += 1.0;
+
+            float sum = 0.0;
+            float tap_phase = phase;
+            for (int t=0;t<2;t++) {
+
+                // Fractional read from the delay line
+                float read_pos = (float) ((write_start + i) & HARMONIZER_DELAY_MASK) -
+                                 (HARMONIZER_MIN_DELAY + tap_phase*grain_len);
+                if (read_pos < 0.0) read_pos += HARMONIZER_DELAY_LEN;
+                uint32_t idx = (uint32_t) read_pos;
+                float frac = read_pos - idx;
+                float a = dl[idx & HARMONIZER_DELAY_MASK];
+                float b = dl[(idx + 1) & HARMONIZER_DELAY_MASK];
+                float tap = a + frac*(b - a);
+
+                // Grain window
+                float w_pos = tap_phase*HARMONIZER_GRAIN_TABLE_SIZE;
+                uint32_t w_idx = (uint32_t) w_pos;
+                float w_frac = w_pos - w_idx;
+                float w = c->grain_window[w_idx] +
+                          w_frac*(c->grain_window[w_idx+1] - c->grain_window[w_idx]);
+
+                sum += tap*w;
+
+                // Second tap is half a grain away
+                tap_phase += 0.5;
+                if (tap_phase >= 1.0) tap_phase -= 1.0;
+            }
+            voice_out[i] = sum;
+        }
+        voice->grain_phase = phase;
+
+        float level = voice->level;
+        for (int i=0;i<audio_block_size;i++) {
+            wet[i] += level*voice_out[i];
+        }
+    }
+
+    float dry_gain = 1.0 - c->mix;
+    float wet_gain = c->mix;
+    for (int i=0;i<audio_block_size;i++) {
+        audio_out[i] = dry_gain*audio_in[i] + wet_gain*wet[i];
+    }
+}
+
+/**
+ * @brief Phase vocoder pitch shifting of each voice
+ *
+ * Samples are buffered until a hop is complete, then the frame is processed a
+ * step at a time over the blocks of the next hop.  The dry signal is taken
+ * from the input FIFO and delayed by one more hop so it has the same latency
+ * as the harmony voices.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     harmonizer_read_phase_vocoder(HARMONIZER * c,
+                                              float * audio_in,
+                                              float * audio_out,
+                                              uint32_t audio_block_size) {
+
+    float dry_gain = 1.0 - c->mix;
+    float wet_gain = c->mix;
+
+    // Spread the remaining steps of the frame over the blocks left in this hop
+    if (c->pv_stage != 0) {
+        uint32_t steps_left = c->num_voices + 3 - c->pv_stage;
+        uint32_t blocks_left = (HARMONIZER_FFT_SIZE - c->rover + audio_block_size - 1)/audio_block_size;
+        uint32_t steps = (steps_left + blocks_left - 1)/blocks_left;
+        for (int s=0;s<steps;s++) {
+            harmonizer_pv_step(c);
+        }
+    }
+
+    for (int i=0;i<audio_block_size;i++) {
+
+        c->in_fifo[c->rover] = audio_in[i];
+
+        uint32_t delayed = c->rover - HARMONIZER_FIFO_START;
+        float dry = c->dry_fifo[delayed];
+        c->dry_fifo[delayed] = c->in_fifo[delayed];
+        audio_out[i] = dry_gain*dry + wet_gain*c->out_fifo[delayed];
+
+        c->rover++;
+        if (c->rover >= HARMONIZER_FFT_SIZE) {
+            c->rover = HARMONIZER_FIFO_START;
+            harmonizer_pv_next_hop(c);
+        }
+    }
+}
+
+/**
+ * @brief Outputs the last frame's hop and starts on the frame just completed
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     harmonizer_pv_next_hop(HARMONIZER * c) {
+
+    // The previous frame is normally finished by now, but make sure
+    while (c->pv_stage != 0) {
+        harmonizer_pv_step(c);
+    }
+
+    // Output one hop and shift the accumulator
+    for (int i=0;i<HARMONIZER_HOP_SIZE;i++) {
+        c->out_fifo[i] = c->out_accum[i];
+    }
+    for (int i=0;i<HARMONIZER_FIFO_START;i++) {
+        c->out_accum[i] = c->out_accum[i + HARMONIZER_HOP_SIZE];
+    }
+    for (int i=HARMONIZER_FIFO_START;i<HARMONIZER_FFT_SIZE;i++) {
+        c->out_accum[i] = 0.0;
+    }
+
+    // Window the new frame before the input FIFO is shifted
+    for (int i=0;i<HARMONIZER_FFT_SIZE;i++) {
+        c->frame[i] = c->in_fifo[i]*c->window[i];
+    }
+    for (int i=0;i<HARMONIZER_FIFO_START;i++) {
+        c->in_fifo[i] = c->in_fifo[i + HARMONIZER_HOP_SIZE];
+    }
+
+    c->pv_stage = 1;
+}
+
+/**
+ * @brief Runs the next step of the frame being processed
+ *
+ * Step 1 is the analysis, steps 2->num_voices+1 shift one voice each and the
+ * last step is the synthesis.
+ *
+ * @param c Pointer to instance structure
+ */
+static void     harmonizer_pv_step(HARMONIZER * c) {
+
+    uint32_t stage = c->pv_stage;
+
+    if (stage == 1) {
+        harmonizer_pv_analysis(c);
+    }
+    else if (stage <= c->num_voices + 1) {
+        harmonizer_pv_voice(c, &c->voices[stage - 2]);
+    }
+    else {
+        harmonizer_pv_synthesis(c);
+        c->pv_stage = 0;
+        return;
+    }
+    c->pv_stage = stage + 1;
+}
+
+/**
+ * @brief Estimates the magnitude and true frequency of each bin of the frame
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     harmonizer_pv_analysis(HARMONIZER * c) {
+
+    const float expected = PI2/HARMONIZER_OVERSAMPLING;    // Phase advance of bin 1 per hop
+    float * re = c->work_re;
+    float * im = c->work_im;
+
+    real_fft_forward(&c->fft, c->frame, re, im);
+
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+
+        float phase = atan2f(im[k], re[k]);
+        float delta = phase - c->last_phase[k];
+        c->last_phase[k] = phase;
+
+        // Deviation from the bin centre, wrapped to +/-PI
+        delta -= k*expected;
+        delta -= PI2*floorf((delta + PI)/PI2);
+
+        // True frequency in bins
+        c->ana_freq[k] = k + delta*HARMONIZER_OVERSAMPLING/PI2;
+        c->ana_mag[k] = sqrtf(re[k]*re[k] + im[k]*im[k]);
+    }
+
+    // The voices are summed into the same spectrum
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+        re[k] = 0.0;
+        im[k] = 0.0;
+    }
+}
+
+/**
+ * @brief Shifts one voice and adds it to the synthesis spectrum
+ *
+ * @param c Pointer to instance structure
+ * @param voice Pointer to the voice
+ */
+#pragma optimize_for_speed
+static void     harmonizer_pv_voice(HARMONIZER * c,
+                                    HARMONIZER_VOICE * voice) {
+
+    const float expected = PI2/HARMONIZER_OVERSAMPLING;
+    const uint32_t last_bin = HARMONIZER_BINS - 1;
+    float * re = c->work_re;
+    float * im = c->work_im;
+    float ratio = voice->ratio;
+    float level = voice->level;
+
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+        c->syn_mag[k] = 0.0;
+        c->syn_freq[k] = 0.0;
+    }
+
+    // Move each bin to its shifted frequency
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+        uint32_t dest = (uint32_t) (k*ratio + 0.5);
+        if (dest > last_bin) {
+            break;
+        }
+        c->syn_mag[dest] += c->ana_mag[k];
+        c->syn_freq[dest] = c->ana_freq[k]*ratio;
+    }
+
+    // Accumulate phase at the new frequencies
+    for (int k=0;k<HARMONIZER_BINS;k++) {
+        float advance = (c->syn_freq[k] - k)*PI2/HARMONIZER_OVERSAMPLING + k*expected;
+        float phase = voice->sum_phase[k] + advance;
+        phase -= PI2*floorf((phase + PI)/PI2);
+        voice->sum_phase[k] = phase;
+
+        float mag = level*c->syn_mag[k];
+        re[k] += mag*cosf(phase);
+        im[k] += mag*sinf(phase);
+    }
+}
+
+/**
+ * @brief Resynthesizes the summed voices and overlap-adds the frame
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     harmonizer_pv_synthesis(HARMONIZER * c) {
+
+    const uint32_t last_bin = HARMONIZER_BINS - 1;
+    float * re = c->work_re;
+    float * im = c->work_im;
+
+    // DC and Nyquist bins must be real
+    im[0] = 0.0;
+    im[last_bin] = 0.0;
+
+    real_fft_inverse(&c->fft, re, im, c->frame);
+
+    for (int i=0;i<HARMONIZER_FFT_SIZE;i++) {
+        c->out_accum[i] += c->window[i]*c->frame[i]*HARMONIZER_OLA_GAIN;
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_HARMONIZER_H
+#define _AUDIO_EFFECT_HARMONIZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/real_fft.h"
+
+#define HARMONIZER_MAX_VOICES           (3)
+
+// Granular (time domain) mode
+#define HARMONIZER_DELAY_LEN            (4096)      // Power of 2
+#define HARMONIZER_GRAIN_TABLE_SIZE     (512)
+
+// Phase vocoder mode
+#define HARMONIZER_FFT_SIZE             (1024)
+#define HARMONIZER_OVERSAMPLING         (4)
+#define HARMONIZER_HOP_SIZE             (HARMONIZER_FFT_SIZE/HARMONIZER_OVERSAMPLING)
+#define HARMONIZER_BINS                 (HARMONIZER_FFT_SIZE/2+1)
+
+// Pitch shifting algorithms
+typedef enum
+{
+    HARMONIZER_MODE_GRANULAR,       // Low latency, some warble on complex material
+    HARMONIZER_MODE_PHASE_VOCODER   // Smoother, HARMONIZER_FFT_SIZE latency
+} HARMONIZER_MODE;
+
+// Result enumerations
+typedef enum
+{
+    HARMONIZER_OK,
+    HARMONIZER_INVALID_INSTANCE_POINTER,
+    HARMONIZER_INVALID_MODE,
+    HARMONIZER_INVALID_NUM_VOICES,
+    HARMONIZER_INVALID_VOICE,
+    HARMONIZER_INVALID_INTERVAL,
+    HARMONIZER_INVALID_LEVEL,
+    HARMONIZER_INVALID_MIX
+} RESULT_HARMONIZER;
+
+// Parameters and state of one harmony voice
+typedef struct {
+
+    float   semitones;
+    float   ratio;
+    float   level;
+
+    // Granular mode
+    float   grain_phase;
+
+    // Phase vocoder mode
+    float   sum_phase[HARMONIZER_BINS];
+
+} HARMONIZER_VOICE;
+
+// C struct with parameters and state information
+typedef struct {
+
+    bool    initialized;
+
+    volatile HARMONIZER_MODE mode;
+    volatile HARMONIZER_MODE mode_requested;    // Switched to by harmonizer_process()
+    uint32_t    num_voices;
+    HARMONIZER_VOICE    voices[HARMONIZER_MAX_VOICES];
+
+    float   mix;
+    float   audio_sample_rate;
+
+    // Granular mode
+    float   delay_line[HARMONIZER_DELAY_LEN];
+    uint32_t    delay_write;
+    float   grain_len;
+    float   grain_window[HARMONIZER_GRAIN_TABLE_SIZE+1];
+
+    // Phase vocoder mode
+    REAL_FFT    fft;
+    float   window[HARMONIZER_FFT_SIZE];
+    float   in_fifo[HARMONIZER_FFT_SIZE];
+    float   out_fifo[HARMONIZER_FFT_SIZE];
+    float   out_accum[HARMONIZER_FFT_SIZE];
+    float   dry_fifo[HARMONIZER_HOP_SIZE];
+    uint32_t    rover;
+    uint32_t    pv_stage;       // Next step of the frame being processed (0 when done)
+    float   frame[HARMONIZER_FFT_SIZE];
+    float   work_re[HARMONIZER_BINS];
+    float   work_im[HARMONIZER_BINS];
+    float   last_phase[HARMONIZER_BINS];
+    float   ana_mag[HARMONIZER_BINS];
+    float   ana_freq[HARMONIZER_BINS];
+    float   syn_mag[HARMONIZER_BINS];
+    float   syn_freq[HARMONIZER_BINS];
+
+} HARMONIZER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_HARMONIZER harmonizer_setup(HARMONIZER * c,
+                                   HARMONIZER_MODE mode,
+                                   uint32_t num_voices,
+                                   const float * semitones,
+                                   float mix,
+                                   float audio_sample_rate);
+
+RESULT_HARMONIZER harmonizer_modify_mode(HARMONIZER * c,
+                                         HARMONIZER_MODE mode_new);
+
+RESULT_HARMONIZER harmonizer_modify_interval(HARMONIZER * c,
+                                             uint32_t voice,
+                                             float semitones_new);
+
+RESULT_HARMONIZER harmonizer_modify_voice_level(HARMONIZER * c,
+                                                uint32_t voice,
+                                                float level_new);
+
+RESULT_HARMONIZER harmonizer_modify_mix(HARMONIZER * c,
+                                        float mix_new);
+
+uint32_t harmonizer_latency(HARMONIZER * c);
+
+void    harmonizer_process(HARMONIZER * c);
+
+void    harmonizer_read(HARMONIZER * c,
+                        float * audio_in,
+                        float * audio_out,
+                        uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_EFFECT_HARMONIZER_H
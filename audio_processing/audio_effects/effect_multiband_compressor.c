@@ -6,13 +6,17 @@
  * each band independently.  Thus each band of audio can be compressed
  * using unique compression parameters.
  * 
- * This implementaton is comprised of a low-pass and high-pass with the
- * same cutoff frequency this the input signal is split into two bands.
- * The output of each filter feeds into an independent compressor with 
- * its own state and parameters.
+ * This implementation splits the input into 2 to 5 bands with a 4th order
+ * Linkwitz-Riley crossover so the bands sum back flat when no compression
+ * is applied.  Each band feeds an independent compressor with its own state
+ * and parameters.
+ * 
+ * The threshold and ratio can be set for each band individually or for all
+ * bands at once.  When set for all bands, the per-band offset/scale tables
+ * below are applied so the low end is compressed a bit harder than the top.
  * 
  * This audio effect also serves as an example of how to utilize the
- * biquad filter and compressor audio elements.
+ * crossover and compressor audio elements.
  * 
  */
 
@@ -21,24 +25,36 @@
 #include "effect_multiband_compressor.h"
 
 // Min/max limits and other constants
-#define MULTIBAND_COMP_CROSSOVER_MIN    (100.0)
-#define MULTIBAND_COMP_CROSSOVER_MAX    (800.0)
 #define MULTIBAND_COMP_GAIN_MIN         (0.1)
 #define MULTIBAND_COMP_GAIN_MAX         (5.0)
 #define MULTIBAND_COMP_THRESHOLD_MIN    (-100.0)
 #define MULTIBAND_COMP_THRESHOLD_MAX    (30.0)
+#define MULTIBAND_COMP_RATIO_MIN        (1.0)
+#define MULTIBAND_COMP_RATIO_MAX        (100.0)
+#define MULTIBAND_COMP_DEFAULT_RATIO    (4.0)
+#define MULTIBAND_COMP_OUTPUT_GAIN      (2.0)
+
+// Per-band settings (lowest band first).  Change these to change the mix
+// and dynamics of the different bands.
+static const float multiband_comp_thresh_offset_db[MULTIBAND_COMP_MAX_BANDS] = { -5.0, -2.0, 0.0, 0.0, 2.0 };
+static const float multiband_comp_ratio_scale[MULTIBAND_COMP_MAX_BANDS]      = { 1.5, 1.25, 1.0, 1.0, 0.75 };
+static const float multiband_comp_band_gain[MULTIBAND_COMP_MAX_BANDS]        = { 1.4, 1.0, 1.0, 1.0, 1.0 };
+static const float multiband_comp_attack_ms[MULTIBAND_COMP_MAX_BANDS]        = { 100.0, 60.0, 50.0, 30.0, 20.0 };
+static const float multiband_comp_release_ms[MULTIBAND_COMP_MAX_BANDS]       = { 100.0, 80.0, 50.0, 40.0, 30.0 };
 
 /**
  * @brief Initializes instance of a multiband compressor
  *
  * @param c Pointer to instance structure
- * @param cross_over Crossover frequency between LPF and HPF (100.0->800.0)
+ * @param num_bands Number of bands (2->5)
+ * @param crossover_freqs Array of num_bands-1 crossover frequencies (ascending)
  * @param threshold Compressor threshold
  * @param audio_sample_rate The system audio sample rate
  * @return multiband compressor result (enumeration)
  */
 RESULT_MULTIBAND_COMP multiband_comp_setup(MULTIBAND_COMPRESSOR * c,
-                                           float cross_over,
+                                           uint32_t num_bands,
+                                           const float * crossover_freqs,
                                            float threshold,
                                            float audio_sample_rate) {
 
@@ -48,9 +64,8 @@ RESULT_MULTIBAND_COMP multiband_comp_setup(MULTIBAND_COMPRESSOR * c,
 
     c->initialized = false;
 
-    if (cross_over < MULTIBAND_COMP_CROSSOVER_MIN || 
-        cross_over > MULTIBAND_COMP_CROSSOVER_MAX) {
-        return MULTIBAND_COMP_INVALID_CROSSOVER_FREQ;
+    if (num_bands < 2 || num_bands > MULTIBAND_COMP_MAX_BANDS) {
+        return MULTIBAND_COMP_INVALID_NUM_BANDS;
     }
 
     if (threshold < MULTIBAND_COMP_THRESHOLD_MIN || 
@@ -58,32 +73,38 @@ RESULT_MULTIBAND_COMP multiband_comp_setup(MULTIBAND_COMPRESSOR * c,
         return MULTIBAND_COMP_INVALID_THRESHOLD;
     }
 
-    // Change these gain settings to change the mix of low and high end
-    c->gain_low = 1.4;
-    c->gain_high = 1.0;
+    // Initialize crossover
+    if (lr_crossover_setup(&c->crossover,
+                           num_bands,
+                           crossover_freqs,
+                           audio_sample_rate) != LR_CROSSOVER_OK) {
+        return MULTIBAND_COMP_INVALID_CROSSOVER_FREQ;
+    }
 
-    // Initialize filters
-    filter_setup(&c->lpf,
-                BIQUAD_TYPE_LPF,
-                BIQUAD_TRANS_MED,
-                (pm float *) c->lpf_filter_coeffs,
-                cross_over,
-                1.0,
-                1.0,
-                audio_sample_rate);
+    c->num_bands = num_bands;
 
-    filter_setup(&c->hpf,
-                BIQUAD_TYPE_HPF,
-                BIQUAD_TRANS_MED,
-                (pm float *) c->hpf_filter_coeffs,
-                cross_over,
-                1.0,
-                1.0,
-                audio_sample_rate);
+    // Initialize a compressor for each band
+    for (int b=0;b<num_bands;b++) {
 
+        float ratio = 1.0 + (MULTIBAND_COMP_DEFAULT_RATIO-1.0)*multiband_comp_ratio_scale[b];
 
-    compressor_setup(&c->compressor_low, -30.0, 100.0, 100, 100, 2.0, audio_sample_rate );
-    compressor_setup(&c->compressor_high, -35.0, 100.0, 50, 50, 2.2, audio_sample_rate );
+        float band_threshold = threshold + multiband_comp_thresh_offset_db[b];
+        if (band_threshold < MULTIBAND_COMP_THRESHOLD_MIN) {
+            band_threshold = MULTIBAND_COMP_THRESHOLD_MIN;
+        } else if (band_threshold > MULTIBAND_COMP_THRESHOLD_MAX) {
+            band_threshold = MULTIBAND_COMP_THRESHOLD_MAX;
+        }
+
+        compressor_setup(&c->compressors[b],
+                         band_threshold,
+                         ratio,
+                         multiband_comp_attack_ms[b],
+                         multiband_comp_release_ms[b],
+                         MULTIBAND_COMP_OUTPUT_GAIN,
+                         audio_sample_rate);
+
+        c->gain_band[b] = multiband_comp_band_gain[b];
+    }
 
     c->initialized = true;
     return MULTIBAND_COMP_OK;
@@ -91,56 +112,94 @@ RESULT_MULTIBAND_COMP multiband_comp_setup(MULTIBAND_COMPRESSOR * c,
 }
 
 /**
- * @brief Modify the cross over frequency between the LPF and HPF
+ * @brief Modify one of the crossover frequencies between bands
  *
  * If the input parameter is out of bounds, it is clipped to the corresponding 
  * min/max value.  This function will return a value indicating an
  * invalid input parameter was supplied but the effect will continue to operate.
  * 
  * @param c Pointer to instance structure
- * @param crossover_freq_new New crossover frequency (100.0->800.0)
+ * @param index Crossover point to modify (0->num_bands-2)
+ * @param crossover_freq_new New crossover frequency (kept between neighbours)
  * 
  * @return multiband compressor result (enumeration)
  */
 RESULT_MULTIBAND_COMP multiband_comp_change_xover(MULTIBAND_COMPRESSOR * c,
+                                                  uint32_t index,
                                                   float crossover_freq_new) {
 
+    RESULT_LR_CROSSOVER res = lr_crossover_modify_freq(&c->crossover,
+                                                       index,
+                                                       crossover_freq_new);
+    if (res == LR_CROSSOVER_INVALID_INDEX) {
+        return MULTIBAND_COMP_INVALID_BAND;
+    }
+    if (res != LR_CROSSOVER_OK) {
+        return MULTIBAND_COMP_INVALID_CROSSOVER_FREQ;
+    }
+
+    return MULTIBAND_COMP_OK;
+}
+
+/**
+ * @brief Modify multiband compressor threshold
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param threshold_db_new Updated threshold vale
+ * 
+ * @return multiband compressor result (enumeration)
+ */
+RESULT_MULTIBAND_COMP multiband_comp_change_thresh(MULTIBAND_COMPRESSOR * c,
+                                                  float threshold_db_new) {
 
     RESULT_MULTIBAND_COMP res;
 
-    float crossover_freq;
-    if (crossover_freq_new < MULTIBAND_COMP_CROSSOVER_MIN) {
-        crossover_freq = MULTIBAND_COMP_CROSSOVER_MIN;
-        res = MULTIBAND_COMP_INVALID_CROSSOVER_FREQ;
-    } else if (crossover_freq_new > MULTIBAND_COMP_CROSSOVER_MAX) {
-        crossover_freq = MULTIBAND_COMP_CROSSOVER_MAX;
-        res = MULTIBAND_COMP_INVALID_CROSSOVER_FREQ;
+    float threshold_db;
+    if (threshold_db_new < MULTIBAND_COMP_THRESHOLD_MIN) {
+        threshold_db = MULTIBAND_COMP_THRESHOLD_MIN;
+        res = MULTIBAND_COMP_INVALID_THRESHOLD;
+    } else if (threshold_db_new > MULTIBAND_COMP_THRESHOLD_MAX) {
+        threshold_db = MULTIBAND_COMP_THRESHOLD_MAX;
+        res = MULTIBAND_COMP_INVALID_THRESHOLD;
     } else {
-        crossover_freq = crossover_freq_new;
+        threshold_db = threshold_db_new;
         res = MULTIBAND_COMP_OK;
-    } 
+    }  
+
 
     // Update instance parameters
-    filter_modify_freq(&c->lpf, crossover_freq);
-    filter_modify_freq(&c->hpf, crossover_freq);
+    for (int b=0;b<c->num_bands;b++) {
+        compressor_modify_threshold(&c->compressors[b],
+                                    threshold_db + multiband_comp_thresh_offset_db[b]);
+    }
 
-    return MULTIBAND_COMP_OK;
+    return res;
 }
 
 /**
- * @brief Modify multiband compressor threshold
+ * @brief Modify the compressor threshold of a single band
  *
  * If the input parameter is out of bounds, it is clipped to the corresponding 
  * min/max value.  This function will return a value indicating an
  * invalid input parameter was supplied but the effect will continue to operate.
  * 
  * @param c Pointer to instance structure
- * @param threshold_db_new Updated threshold vale
+ * @param band Band to modify (0 = lowest)
+ * @param threshold_db_new Updated threshold value
  * 
  * @return multiband compressor result (enumeration)
  */
-RESULT_MULTIBAND_COMP multiband_comp_change_thresh(MULTIBAND_COMPRESSOR * c,
-                                                  float threshold_db_new) {
+RESULT_MULTIBAND_COMP multiband_comp_change_band_thresh(MULTIBAND_COMPRESSOR * c,
+                                                        uint32_t band,
+                                                        float threshold_db_new) {
+
+    if (band >= c->num_bands) {
+        return MULTIBAND_COMP_INVALID_BAND;
+    }
 
     RESULT_MULTIBAND_COMP res;
 
@@ -156,10 +215,90 @@ RESULT_MULTIBAND_COMP multiband_comp_change_thresh(MULTIBAND_COMPRESSOR * c,
         res = MULTIBAND_COMP_OK;
     }  
 
+    // Update instance parameters
+    compressor_modify_threshold(&c->compressors[band], threshold_db);
+
+    return res;
+}
+
+/**
+ * @brief Modify multiband compressor ratio
+ *
+ * The ratio of each band is scaled relative to this value (see the per-band
+ * ratio scale table).
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param ratio_new Updated compression ratio (1.0->100.0)
+ * 
+ * @return multiband compressor result (enumeration)
+ */
+RESULT_MULTIBAND_COMP multiband_comp_change_ratio(MULTIBAND_COMPRESSOR * c,
+                                                  float ratio_new) {
+
+    RESULT_MULTIBAND_COMP res;
+
+    float ratio;
+    if (ratio_new < MULTIBAND_COMP_RATIO_MIN) {
+        ratio = MULTIBAND_COMP_RATIO_MIN;
+        res = MULTIBAND_COMP_INVALID_RATIO;
+    } else if (ratio_new > MULTIBAND_COMP_RATIO_MAX) {
+        ratio = MULTIBAND_COMP_RATIO_MAX;
+        res = MULTIBAND_COMP_INVALID_RATIO;
+    } else {
+        ratio = ratio_new;
+        res = MULTIBAND_COMP_OK;
+    }
+
+    // Update instance parameters
+    for (int b=0;b<c->num_bands;b++) {
+        compressor_modify_ratio(&c->compressors[b],
+                                1.0 + (ratio-1.0)*multiband_comp_ratio_scale[b]);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Modify the compressor ratio of a single band
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param band Band to modify (0 = lowest)
+ * @param ratio_new Updated compression ratio (1.0->100.0)
+ * 
+ * @return multiband compressor result (enumeration)
+ */
+RESULT_MULTIBAND_COMP multiband_comp_change_band_ratio(MULTIBAND_COMPRESSOR * c,
+                                                       uint32_t band,
+                                                       float ratio_new) {
+
+    if (band >= c->num_bands) {
+        return MULTIBAND_COMP_INVALID_BAND;
+    }
+
+    RESULT_MULTIBAND_COMP res;
+
+    float ratio;
+    if (ratio_new < MULTIBAND_COMP_RATIO_MIN) {
+        ratio = MULTIBAND_COMP_RATIO_MIN;
+        res = MULTIBAND_COMP_INVALID_RATIO;
+    } else if (ratio_new > MULTIBAND_COMP_RATIO_MAX) {
+        ratio = MULTIBAND_COMP_RATIO_MAX;
+        res = MULTIBAND_COMP_INVALID_RATIO;
+    } else {
+        ratio = ratio_new;
+        res = MULTIBAND_COMP_OK;
+    }
 
     // Update instance parameters
-    compressor_modify_threshold(&c->compressor_low, threshold_db-5.0);
-    compressor_modify_threshold(&c->compressor_high, threshold_db);
+    compressor_modify_ratio(&c->compressors[band], ratio);
 
     return res;
 }
@@ -194,8 +333,9 @@ RESULT_MULTIBAND_COMP multiband_comp_change_gain(MULTIBAND_COMPRESSOR * c,
     }      
 
     // Update instance parameters
-    compressor_modify_gain(&c->compressor_low, gain);
-    compressor_modify_gain(&c->compressor_high, gain);
+    for (int b=0;b<c->num_bands;b++) {
+        compressor_modify_gain(&c->compressors[b], gain);
+    }
 
     return res;
 }
@@ -222,33 +362,32 @@ void multiband_comp_read(MULTIBAND_COMPRESSOR * c,
         return;
     }
 
-    float temp_audio_low[MAX_AUDIO_BLOCK_SIZE];
-    float temp_audio_high[MAX_AUDIO_BLOCK_SIZE];
-
-    // Apply lpf / hpf
-    filter_read(&c->lpf,
-            audio_in,
-                temp_audio_low,
-                audio_block_size);
+    float band_audio[MULTIBAND_COMP_MAX_BANDS][MAX_AUDIO_BLOCK_SIZE];
+    float * bands[MULTIBAND_COMP_MAX_BANDS];
+    for (int b=0;b<c->num_bands;b++) {
+        bands[b] = band_audio[b];
+    }
 
-    filter_read(&c->hpf,
-                audio_in,
-                temp_audio_high,
-                audio_block_size);
+    // Split into bands
+    lr_crossover_read(&c->crossover,
+                      audio_in,
+                      bands,
+                      audio_block_size);
 
-    gain_buffer(temp_audio_low, c->gain_low, audio_block_size);
-    gain_buffer(temp_audio_high, c->gain_high, audio_block_size);
+    // Compress each band and sum
+    for (int i=0;i<audio_block_size;i++) {
+        audio_out[i] = 0.0;
+    }
+    for (int b=0;b<c->num_bands;b++) {
 
-    compressor_read(&c->compressor_low,
-                    temp_audio_low,
-                    temp_audio_low,
-                    audio_block_size);
+        gain_buffer(bands[b], c->gain_band[b], audio_block_size);
 
-    compressor_read(&c->compressor_high,
-                    temp_audio_high,
-                    temp_audio_high,
-                    audio_block_size);
+        compressor_read(&c->compressors[b],
+                        bands[b],
+                        bands[b],
+                        audio_block_size);
 
-    mix_2x1(temp_audio_low, temp_audio_high, audio_out, audio_block_size);
+        mix_2x1(audio_out, bands[b], audio_out, audio_block_size);
+    }
 
 }
@@ -15,17 +15,21 @@
 #include "../audio_elements/audio_elements_common.h"
 
 #include "../audio_elements/compressor.h"
-#include "../audio_elements/biquad_filter.h"
+#include "../audio_elements/linkwitz_riley_crossover.h"
 #include "../audio_elements/audio_utilities.h"
 
+#define MULTIBAND_COMP_MAX_BANDS        (LR_CROSSOVER_MAX_BANDS)
 
 // Result enumerations
 typedef enum
 {
     MULTIBAND_COMP_OK,
     MULTIBAND_COMP_INVALID_INSTANCE_POINTER,
+    MULTIBAND_COMP_INVALID_NUM_BANDS,
+    MULTIBAND_COMP_INVALID_BAND,
     MULTIBAND_COMP_INVALID_CROSSOVER_FREQ,
     MULTIBAND_COMP_INVALID_THRESHOLD,
+    MULTIBAND_COMP_INVALID_RATIO,
     MULTIBAND_COMP_INVALID_GAIN
 
 
@@ -37,23 +41,13 @@ typedef struct  {
 
     bool    initialized;
 
-    float   thresh_lpf;
-    float   thresh_hpf;
-    float   thresh_last;
+    uint32_t    num_bands;
 
-    float   gain_low;
-    float   gain_high;
+    float   gain_band[MULTIBAND_COMP_MAX_BANDS];
 
-    float   gain_out;
+    LR_CROSSOVER   crossover;
 
-    BIQUAD_FILTER  lpf;
-    BIQUAD_FILTER  hpf;
-
-    COMPRESSOR     compressor_low;
-    COMPRESSOR     compressor_high;
-
-    float   lpf_filter_coeffs[6];
-    float   hpf_filter_coeffs[6];
+    COMPRESSOR     compressors[MULTIBAND_COMP_MAX_BANDS];
 
 }  MULTIBAND_COMPRESSOR;
 
@@ -63,15 +57,28 @@ extern "C" {
 #endif
 
 RESULT_MULTIBAND_COMP multiband_comp_setup(MULTIBAND_COMPRESSOR * c,
-                                           float cross_over,
+                                           uint32_t num_bands,
+                                           const float * crossover_freqs,
                                            float threshold,
                                            float audio_sample_rate);
 
 RESULT_MULTIBAND_COMP multiband_comp_change_xover(MULTIBAND_COMPRESSOR * c,
+                                                  uint32_t index,
                                                   float crossover_freq_new);
 
 RESULT_MULTIBAND_COMP multiband_comp_change_thresh(MULTIBAND_COMPRESSOR * c,
-                                                  float threshold_db_new);
+                                                   float threshold_db_new);
+
+RESULT_MULTIBAND_COMP multiband_comp_change_band_thresh(MULTIBAND_COMPRESSOR * c,
+                                                        uint32_t band,
+                                                        float threshold_db_new);
+
+RESULT_MULTIBAND_COMP multiband_comp_change_ratio(MULTIBAND_COMPRESSOR * c,
+                                                  float ratio_new);
+
+RESULT_MULTIBAND_COMP multiband_comp_change_band_ratio(MULTIBAND_COMPRESSOR * c,
+                                                       uint32_t band,
+                                                       float ratio_new);
 
 RESULT_MULTIBAND_COMP multiband_comp_change_gain(MULTIBAND_COMPRESSOR * c,
                                                  float gain_new);
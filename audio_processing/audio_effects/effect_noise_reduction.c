@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A spectral noise reduction effect for removing steady hum and hiss (e.g.
+ * from long microphone cables or noisy pickups).
+ *
+ * The input is analyzed with a Hann windowed FFT (512 points, 4x overlap).
+ * A noise profile (the average power in each bin) is learned by calling
+ * noise_reduction_learn() while only the noise is present.  After that, each
+ * bin is scaled by a Wiener gain computed from its SNR against the profile
+ * and the frame is resynthesized with an overlap-add.  Until a profile has
+ * been learned the effect passes the audio through (delayed).
+ *
+ * Spectral subtraction tends to leave "musical noise": isolated bins that
+ * briefly poke above the profile and turn into random tones.  Three things
+ * keep this down:
+ *
+ *  - The a priori SNR is estimated with the decision-directed method, which
+ *    mixes the clean power of the previous frame with the current one.
+ *    This smooths the gain of noise-only bins over time.
+ *  - The gain mask is smoothed across neighbouring bins.
+ *  - No bin is attenuated by more than the floor (e.g. -20 dB), so a little
+ *    of the original noise is left to mask what remains.
+ *
+ * The hop is 128 samples, which is a whole number of audio blocks for every
+ * supported AUDIO_BLOCK_SIZE.  Rather than doing all of the work of a frame
+ * in the block that completes a hop, the work is split into four stages
+ * (forward FFT, gain mask, inverse FFT, overlap-add) which are spread evenly
+ * over the blocks of the next hop.  This keeps the cost per block roughly
+ * flat so it can be planned against the core budget, at the cost of one
+ * extra hop of latency (NOISE_REDUCTION_LATENCY samples in total).
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "effect_noise_reduction.h"
+
+// Min/max limits and other constants
+#define NOISE_REDUCTION_FLOOR_DB_MIN    (-40.0)
+#define NOISE_REDUCTION_FLOOR_DB_MAX    (0.0)
+#define NOISE_REDUCTION_OVERSUB_MIN     (0.5)
+#define NOISE_REDUCTION_OVERSUB_MAX     (4.0)
+
+#define NOISE_REDUCTION_RING_MASK       (NOISE_REDUCTION_RING_SIZE-1)
+#define NOISE_REDUCTION_NUM_STAGES      (4)
+#define NOISE_REDUCTION_LEARN_MS        (1000.0)
+#define NOISE_REDUCTION_DD_ALPHA        (0.98)      // Decision-directed smoothing
+#define NOISE_REDUCTION_MIN_POWER       (1e-12)
+
+// Overlap-add gain for Hann analysis and synthesis windows
+#define NOISE_REDUCTION_OLA_GAIN        (1.0/(0.375*NOISE_REDUCTION_OVERLAP))
+
+// Frame processing stages
+enum {
+    NOISE_REDUCTION_STAGE_FORWARD,
+    NOISE_REDUCTION_STAGE_MASK,
+    NOISE_REDUCTION_STAGE_INVERSE,
+    NOISE_REDUCTION_STAGE_OLA
+};
+
+// Static function prototypes
+static void     noise_reduction_reset_state(NOISE_REDUCTION * c);
+static void     noise_reduction_run_stage(NOISE_REDUCTION * c);
+static void     noise_reduction_update_mask(NOISE_REDUCTION * c);
+
+
+/**
+ * @brief Initializes instance of the noise reduction effect
+ *
+ * @param c Pointer to instance structure
+ * @param floor_db Largest attenuation of any bin in dB (-40.0->0.0)
+ * @param oversubtraction Noise profile multiplier (0.5->4.0)
+ * @param audio_block_size The number of samples per call to noise_reduction_read()
+ *        (must divide NOISE_REDUCTION_HOP_SIZE)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Noise reduction result (enumeration)
+ */
+RESULT_NOISE_REDUCTION noise_reduction_setup(NOISE_REDUCTION * c,
+                                             float floor_db,
+                                             float oversubtraction,
+                                             uint32_t audio_block_size,
+                                             float audio_sample_rate) {
+
+    if (c == NULL) {
+        return NOISE_REDUCTION_INVALID_INSTANCE_POINTER;
+    }
+
+    c->initialized = false;
+
+    if (audio_block_size < 1 ||
+        audio_block_size > NOISE_REDUCTION_HOP_SIZE ||
+        (NOISE_REDUCTION_HOP_SIZE % audio_block_size) != 0) {
+        return NOISE_REDUCTION_INVALID_BLOCK_SIZE;
+    }
+    if (floor_db > NOISE_REDUCTION_FLOOR_DB_MAX ||
+        floor_db < NOISE_REDUCTION_FLOOR_DB_MIN) {
+        return NOISE_REDUCTION_INVALID_FLOOR;
+    }
+    if (oversubtraction > NOISE_REDUCTION_OVERSUB_MAX ||
+        oversubtraction < NOISE_REDUCTION_OVERSUB_MIN) {
+        return NOISE_REDUCTION_INVALID_OVERSUBTRACTION;
+    }
+
+    c->floor_db = floor_db;
+    c->floor = powf(10.0, floor_db/20.0);
+    c->oversubtraction = oversubtraction;
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->blocks_per_hop = NOISE_REDUCTION_HOP_SIZE/audio_block_size;
+    c->learn_frames = (uint32_t)(NOISE_REDUCTION_LEARN_MS*0.001*audio_sample_rate/NOISE_REDUCTION_HOP_SIZE);
+    if (c->learn_frames < 1) {
+        c->learn_frames = 1;
+    }
+
+    // Periodic Hann window for analysis and synthesis
+    for (int i=0;i<NOISE_REDUCTION_FFT_SIZE;i++) {
+        c->window[i] = 0.5 - 0.5*cosf(PI2*i/NOISE_REDUCTION_FFT_SIZE);
+    }
+    real_fft_setup(&c->fft, NOISE_REDUCTION_FFT_SIZE);
+
+    c->learning = false;
+    c->profile_valid = false;
+    for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+        c->noise_power[k] = 0.0;
+    }
+
+    noise_reduction_reset_state(c);
+
+    // Instance was successfully initialized
+    c->initialized = true;
+    return NOISE_REDUCTION_OK;
+
+}
+
+/**
+ * @brief Modify the noise floor (largest attenuation)
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param floor_db_new New floor in dB (-40.0->0.0)
+ * @return Noise reduction result (enumeration)
+ */
+RESULT_NOISE_REDUCTION noise_reduction_modify_floor(NOISE_REDUCTION * c,
+                                                    float floor_db_new) {
+
+    RESULT_NOISE_REDUCTION res;
+
+    float floor_db;
+    if (floor_db_new < NOISE_REDUCTION_FLOOR_DB_MIN) {
+        floor_db = NOISE_REDUCTION_FLOOR_DB_MIN;
+        res = NOISE_REDUCTION_INVALID_FLOOR;
+    } else if (floor_db_new > NOISE_REDUCTION_FLOOR_DB_MAX) {
+        floor_db = NOISE_REDUCTION_FLOOR_DB_MAX;
+        res = NOISE_REDUCTION_INVALID_FLOOR;
+    } else {
+        floor_db = floor_db_new;
+        res = NOISE_REDUCTION_OK;
+    }
+
+    // Update instance parameters (only recompute the gain if it changed)
+    if (floor_db != c->floor_db) {
+        c->floor_db = floor_db;
+        c->floor = powf(10.0, floor_db/20.0);
+    }
+
+    return res;
+
+}
+
+/**
+ * @brief Modify the oversubtraction (how hard the noise profile is applied)
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param oversubtraction_new New noise profile multiplier (0.5->4.0)
+ * @return Noise reduction result (enumeration)
+ */
+RESULT_NOISE_REDUCTION noise_reduction_modify_oversubtraction(NOISE_REDUCTION * c,
+                                                              float oversubtraction_new) {
+
+    RESULT_NOISE_REDUCTION res;
+
+    if (oversubtraction_new < NOISE_REDUCTION_OVERSUB_MIN) {
+        c->oversubtraction = NOISE_REDUCTION_OVERSUB_MIN;
+        res = NOISE_REDUCTION_INVALID_OVERSUBTRACTION;
+    } else if (oversubtraction_new > NOISE_REDUCTION_OVERSUB_MAX) {
+        c->oversubtraction = NOISE_REDUCTION_OVERSUB_MAX;
+        res = NOISE_REDUCTION_INVALID_OVERSUBTRACTION;
+    } else {
+        c->oversubtraction = oversubtraction_new;
+        res = NOISE_REDUCTION_OK;
+    }
+
+    return res;
+
+}
+
+/**
+ * @brief Starts learning a new noise profile
+ *
+ * The profile is averaged over the next second of audio, which should
+ * contain only the noise.  The previous profile stays in use until the new
+ * one is complete.
+ *
+ * @param c Pointer to instance structure
+ */
+void    noise_reduction_learn(NOISE_REDUCTION * c) {
+
+    for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+        c->learn_accum[k] = 0.0;
+    }
+    c->learn_count = 0;
+    c->learning = true;
+}
+
+/**
+ * @brief Process a block of audio
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ *        (must match the value passed to noise_reduction_setup())
+ */
+#pragma optimize_for_speed
+void    noise_reduction_read(NOISE_REDUCTION * c,
+                             float * audio_in,
+                             float * audio_out,
+                             uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t in_write = c->in_write;
+    uint32_t out_read = c->out_read;
+    for (int i=0;i<audio_block_size;i++) {
+        c->in_ring[in_write] = audio_in[i];
+        in_write = (in_write + 1) & NOISE_REDUCTION_RING_MASK;
+
+        audio_out[i] = c->out_ring[out_read];
+        c->out_ring[out_read] = 0.0;
+        out_read = (out_read + 1) & NOISE_REDUCTION_RING_MASK;
+    }
+    c->in_write = in_write;
+    c->out_read = out_read;
+
+    // Work through the stages of the previous frame so that they are all
+    // done by the last block of the hop
+    uint32_t stages_due = ((c->block_in_hop + 1)*NOISE_REDUCTION_NUM_STAGES + c->blocks_per_hop - 1)/c->blocks_per_hop;
+    while (c->stage < stages_due) {
+        noise_reduction_run_stage(c);
+        c->stage++;
+    }
+
+    // At the end of a hop, start on the frame that has just been completed.
+    // Its output follows straight after the hop that is now in the output ring.
+    c->block_in_hop++;
+    if (c->block_in_hop >= c->blocks_per_hop) {
+        c->block_in_hop = 0;
+        c->stage = 0;
+        c->frame_start = (in_write - NOISE_REDUCTION_FFT_SIZE) & NOISE_REDUCTION_RING_MASK;
+        c->ola_start = (out_read + NOISE_REDUCTION_HOP_SIZE) & NOISE_REDUCTION_RING_MASK;
+    }
+}
+
+/**
+ * @brief Clears the audio and frame state
+ *
+ * @param c Pointer to instance structure
+ */
+static void     noise_reduction_reset_state(NOISE_REDUCTION * c) {
+
+    for (int i=0;i<NOISE_REDUCTION_RING_SIZE;i++) {
+        c->in_ring[i] = 0.0;
+        c->out_ring[i] = 0.0;
+    }
+    for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+        c->gain[k] = 1.0;
+        c->clean_power[k] = 0.0;
+    }
+
+    c->in_write = 0;
+    c->out_read = 0;
+    c->block_in_hop = 0;
+
+    // Start with a (silent) frame already scheduled
+    c->stage = 0;
+    c->frame_start = (c->in_write - NOISE_REDUCTION_FFT_SIZE) & NOISE_REDUCTION_RING_MASK;
+    c->ola_start = (c->out_read + NOISE_REDUCTION_HOP_SIZE) & NOISE_REDUCTION_RING_MASK;
+}
+
+/**
+ * @brief Runs the next stage of the current frame
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     noise_reduction_run_stage(NOISE_REDUCTION * c) {
+
+    float * re = c->work_re;
+    float * im = c->work_im;
+
+    switch (c->stage) {
+
+        case NOISE_REDUCTION_STAGE_FORWARD: {
+            uint32_t start = c->frame_start;
+            for (int i=0;i<NOISE_REDUCTION_FFT_SIZE;i++) {
+                c->frame[i] = c->in_ring[(start + i) & NOISE_REDUCTION_RING_MASK]*c->window[i];
+            }
+            real_fft_forward(&c->fft, c->frame, re, im);
+            break;
+        }
+
+        case NOISE_REDUCTION_STAGE_MASK:
+            noise_reduction_update_mask(c);
+            break;
+
+        case NOISE_REDUCTION_STAGE_INVERSE:
+            for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+                re[k] *= c->gain[k];
+                im[k] *= c->gain[k];
+            }
+            real_fft_inverse(&c->fft, re, im, c->frame);
+            break;
+
+        case NOISE_REDUCTION_STAGE_OLA: {
+            uint32_t start = c->ola_start;
+            for (int i=0;i<NOISE_REDUCTION_FFT_SIZE;i++) {
+                c->out_ring[(start + i) & NOISE_REDUCTION_RING_MASK] += c->window[i]*c->frame[i]*NOISE_REDUCTION_OLA_GAIN;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Updates the noise profile (when learning) and the gain mask
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     noise_reduction_update_mask(NOISE_REDUCTION * c) {
+
+    float * re = c->work_re;
+    float * im = c->work_im;
+    float * power = c->frame;       // Free until the inverse FFT
+
+    for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+        power[k] = re[k]*re[k] + im[k]*im[k];
+    }
+
+    if (c->learning) {
+        for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+            c->learn_accum[k] += power[k];
+        }
+        c->learn_count++;
+        if (c->learn_count >= c->learn_frames) {
+            float scale = 1.0/c->learn_count;
+            for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+                c->noise_power[k] = c->learn_accum[k]*scale;
+            }
+            c->learning = false;
+            c->profile_valid = true;
+        }
+    }
+
+    // Pass the audio through until there is a profile to work with
+    if (!c->profile_valid) {
+        return;
+    }
+
+    // Wiener gain from the decision-directed a priori SNR.  The raw gains
+    // replace the powers and are smoothed below.
+    float floor = c->floor;
+    for (int k=0;k<NOISE_REDUCTION_BINS;k++) {
+        float noise = c->oversubtraction*c->noise_power[k] + NOISE_REDUCTION_MIN_POWER;
+        float snr_post = power[k]/noise;
+        float snr_inst = (snr_post > 1.0) ? snr_post - 1.0 : 0.0;
+        float snr_prio = NOISE_REDUCTION_DD_ALPHA*c->clean_power[k]/noise + (1.0 - NOISE_REDUCTION_DD_ALPHA)*snr_inst;
+        float g = snr_prio/(1.0 + snr_prio);
+
+        c->clean_power[k] = g*g*power[k];
+        power[k] = (g > floor) ? g : floor;
+    }
+
+    // Smooth the mask across neighbouring bins
+    c->gain[0] = 0.75*power[0] + 0.25*power[1];
+    for (int k=1;k<NOISE_REDUCTION_BINS-1;k++) {
+        c->gain[k] = 0.25*power[k-1] + 0.5*power[k] + 0.25*power[k+1];
+    }
+    c->gain[NOISE_REDUCTION_BINS-1] = 0.25*power[NOISE_REDUCTION_BINS-2] + 0.75*power[NOISE_REDUCTION_BINS-1];
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_NOISE_REDUCTION_H
+#define _AUDIO_EFFECT_NOISE_REDUCTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/real_fft.h"
+
+#define NOISE_REDUCTION_FFT_SIZE        (512)
+#define NOISE_REDUCTION_OVERLAP         (4)
+#define NOISE_REDUCTION_HOP_SIZE        (NOISE_REDUCTION_FFT_SIZE/NOISE_REDUCTION_OVERLAP)
+#define NOISE_REDUCTION_BINS            (NOISE_REDUCTION_FFT_SIZE/2+1)
+#define NOISE_REDUCTION_RING_SIZE       (1024)      // Power of 2 >= FFT_SIZE + HOP_SIZE
+
+// Input to output delay in samples
+#define NOISE_REDUCTION_LATENCY         (NOISE_REDUCTION_FFT_SIZE+NOISE_REDUCTION_HOP_SIZE)
+
+// Result enumerations
+typedef enum
+{
+    NOISE_REDUCTION_OK,
+    NOISE_REDUCTION_INVALID_INSTANCE_POINTER,
+    NOISE_REDUCTION_INVALID_BLOCK_SIZE,
+    NOISE_REDUCTION_INVALID_FLOOR,
+    NOISE_REDUCTION_INVALID_OVERSUBTRACTION
+} RESULT_NOISE_REDUCTION;
+
+// C struct with parameters and state information
+typedef struct {
+
+    bool    initialized;
+
+    float   floor_db;
+    float   floor;                      // Minimum gain of any bin (linear)
+    float   oversubtraction;            // Noise profile multiplier
+
+    float   audio_sample_rate;
+
+    // Frame scheduling.  The frame work is split into stages which are spread
+    // over the blocks of each hop.
+    uint32_t    blocks_per_hop;
+    uint32_t    block_in_hop;
+    uint32_t    stage;
+    uint32_t    frame_start;            // Start of the frame in the input ring
+    uint32_t    ola_start;              // Where the frame is added in the output ring
+
+    // Noise profile
+    bool    learning;
+    bool    profile_valid;
+    uint32_t    learn_frames;
+    uint32_t    learn_count;
+    float   learn_accum[NOISE_REDUCTION_BINS];
+    float   noise_power[NOISE_REDUCTION_BINS];
+
+    // Gain mask
+    float   gain[NOISE_REDUCTION_BINS];
+    float   clean_power[NOISE_REDUCTION_BINS];  // Previous frame, for the a priori SNR
+
+    REAL_FFT    fft;
+    float   window[NOISE_REDUCTION_FFT_SIZE];
+    float   frame[NOISE_REDUCTION_FFT_SIZE];
+    float   work_re[NOISE_REDUCTION_BINS];
+    float   work_im[NOISE_REDUCTION_BINS];
+
+    float   in_ring[NOISE_REDUCTION_RING_SIZE];
+    float   out_ring[NOISE_REDUCTION_RING_SIZE];
+    uint32_t    in_write;
+    uint32_t    out_read;
+
+} NOISE_REDUCTION;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_NOISE_REDUCTION noise_reduction_setup(NOISE_REDUCTION * c,
+                                             float floor_db,
+                                             float oversubtraction,
+                                             uint32_t audio_block_size,
+                                             float audio_sample_rate);
+
+RESULT_NOISE_REDUCTION noise_reduction_modify_floor(NOISE_REDUCTION * c,
+                                                    float floor_db_new);
+
+RESULT_NOISE_REDUCTION noise_reduction_modify_oversubtraction(NOISE_REDUCTION * c,
+                                                              float oversubtraction_new);
+
+void    noise_reduction_learn(NOISE_REDUCTION * c);
+
+void    noise_reduction_read(NOISE_REDUCTION * c,
+                             float * audio_in,
+                             float * audio_out,
+                             uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_EFFECT_NOISE_REDUCTION_H
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A phaser passes the signal through a chain of first-order allpass filters
+ * and mixes the result with the dry signal.  Each allpass stage shifts the
+ * phase of the signal by 0 to 180 degrees depending on frequency, so where
+ * the chain has shifted the phase by an odd multiple of 180 degrees the wet
+ * and dry signals cancel and a notch appears.  N stages give N/2 notches.
+ * Sweeping the break frequency of the stages with an LFO moves the notches up
+ * and down to create the familiar swooshing sound.  Feedback from the end of
+ * the chain back to its input sharpens the notches and adds resonant peaks
+ * between them.
+ *
+ * Unlike a flanger (effect_stereo_flanger.c), whose notches come from a short
+ * delay and are evenly spaced in Hz, the phaser's notches are spread out and
+ * there is no delay line.  The ALLPASS_FILTER element is a Schroeder
+ * (delay-line) allpass used for reverbs so it can't be used here; each stage
+ * is the first-order section:
+ *
+ *      y[n] = a*x[n] + x[n-1] - a*y[n-1]
+ *
+ * which only needs one state variable (transposed form).
+ *
+ * All stages share one coefficient, which is only recomputed every
+ * PHASER_CONTROL_PERIOD samples from the LFO.  The sweep is exponential so
+ * that it moves evenly in pitch.  The left and right channels use LFOs that
+ * are offset in phase for a wide stereo image.  The LFOs can either be
+ * generated by the phaser or taken from a shared LFO bank.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "effect_phaser.h"
+#include "../audio_elements/oscillators.h"
+
+// Min/max limits and other constants
+#define PHASER_RATE_HZ_MIN          (0.0)
+#define PHASER_RATE_HZ_MAX          (10.0)
+#define PHASER_DEPTH_MIN            (0.0)
+#define PHASER_DEPTH_MAX            (1.0)
+#define PHASER_FEEDBACK_MIN         (-0.95)
+#define PHASER_FEEDBACK_MAX         (0.95)
+#define PHASER_STEREO_PHASE_MIN     (0.0)
+#define PHASER_STEREO_PHASE_MAX     (0.5)
+
+#define PHASER_CONTROL_PERIOD       (16)        // Samples between coefficient updates
+#define PHASER_SWEEP_MIN_HZ         (200.0)
+#define PHASER_SWEEP_MAX_HZ         (4000.0)
+
+// Static function prototypes
+static float    phaser_coeff(PHASER * c, float lfo);
+static void     phaser_process_channel(PHASER_CHANNEL * ch,
+                                       uint32_t num_stages,
+                                       float feedback,
+                                       float * audio_in,
+                                       float * audio_out,
+                                       uint32_t audio_block_size);
+
+
+/**
+ * @brief Initializes instance of a phaser
+ *
+ * @param c Pointer to instance structure
+ * @param num_stages Number of allpass stages (4->12)
+ * @param rate_hz Rate of the LFO in Hz (0.0->10.0)
+ * @param depth Depth of the sweep (0.0->1.0)
+ * @param feedback Feedback (-0.95->0.95)
+ * @param stereo_phase Phase offset between the left and right LFOs in cycles (0.0->0.5)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_setup(PHASER * c,
+                             uint32_t num_stages,
+                             float rate_hz,
+                             float depth,
+                             float feedback,
+                             float stereo_phase,
+                             float audio_sample_rate) {
+
+    if (c == NULL) {
+        return PHASER_INVALID_INSTANCE_POINTER;
+    }
+
+    c->initialized = false;
+
+    if (num_stages < PHASER_MIN_STAGES || num_stages > PHASER_MAX_STAGES) {
+        return PHASER_INVALID_STAGES;
+    }
+    if (rate_hz < PHASER_RATE_HZ_MIN || rate_hz > PHASER_RATE_HZ_MAX) {
+        return PHASER_INVALID_RATE;
+    }
+    if (depth < PHASER_DEPTH_MIN || depth > PHASER_DEPTH_MAX) {
+        return PHASER_INVALID_DEPTH;
+    }
+    if (feedback < PHASER_FEEDBACK_MIN || feedback > PHASER_FEEDBACK_MAX) {
+        return PHASER_INVALID_FEEDBACK;
+    }
+    if (stereo_phase < PHASER_STEREO_PHASE_MIN ||
+        stereo_phase > PHASER_STEREO_PHASE_MAX) {
+        return PHASER_INVALID_STEREO_PHASE;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+    c->num_stages = num_stages;
+    c->rate_hz = rate_hz;
+    c->depth = depth;
+    c->feedback = feedback;
+    c->stereo_phase = stereo_phase;
+
+    c->lfo_t = 0.0;
+    c->inc = rate_hz/audio_sample_rate;
+    c->lfo_bank = NULL;
+    c->lfo_left = 0;
+    c->lfo_right = 0;
+
+    for (int i=0;i<PHASER_MAX_STAGES;i++) {
+        c->left.stage_state[i] = 0.0;
+        c->right.stage_state[i] = 0.0;
+    }
+    c->left.feedback_state = 0.0;
+    c->right.feedback_state = 0.0;
+    c->left.coeff = phaser_coeff(c, 0.0);
+    c->right.coeff = c->left.coeff;
+
+    // Instance was successfully initialized
+    c->initialized = true;
+    return PHASER_OK;
+
+}
+
+/**
+ * @brief Modify rate of the phaser's own LFO
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param rate_hz_new New rate in Hz (0.0->10.0)
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_modify_rate(PHASER * c,
+                                   float rate_hz_new) {
+
+    RESULT_PHASER res;
+
+    float rate_hz;
+    if (rate_hz_new < PHASER_RATE_HZ_MIN) {
+        rate_hz = PHASER_RATE_HZ_MIN;
+        res = PHASER_INVALID_RATE;
+    } else if (rate_hz_new > PHASER_RATE_HZ_MAX) {
+        rate_hz = PHASER_RATE_HZ_MAX;
+        res = PHASER_INVALID_RATE;
+    } else {
+        rate_hz = rate_hz_new;
+        res = PHASER_OK;
+    }
+
+    // Update instance parameters
+    c->rate_hz = rate_hz;
+    c->inc = rate_hz/c->audio_sample_rate;
+
+    return res;
+
+}
+
+/**
+ * @brief Modify depth of the sweep
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param depth_new New depth (0.0->1.0)
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_modify_depth(PHASER * c,
+                                    float depth_new) {
+
+    RESULT_PHASER res;
+
+    float depth;
+    if (depth_new < PHASER_DEPTH_MIN) {
+        depth = PHASER_DEPTH_MIN;
+        res = PHASER_INVALID_DEPTH;
+    } else if (depth_new > PHASER_DEPTH_MAX) {
+        depth = PHASER_DEPTH_MAX;
+        res = PHASER_INVALID_DEPTH;
+    } else {
+        depth = depth_new;
+        res = PHASER_OK;
+    }
+
+    // Update instance parameters
+    c->depth = depth;
+
+    return res;
+
+}
+
+/**
+ * @brief Modify feedback
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param feedback_new New feedback (-0.95->0.95)
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_modify_feedback(PHASER * c,
+                                       float feedback_new) {
+
+    RESULT_PHASER res;
+
+    float feedback;
+    if (feedback_new < PHASER_FEEDBACK_MIN) {
+        feedback = PHASER_FEEDBACK_MIN;
+        res = PHASER_INVALID_FEEDBACK;
+    } else if (feedback_new > PHASER_FEEDBACK_MAX) {
+        feedback = PHASER_FEEDBACK_MAX;
+        res = PHASER_INVALID_FEEDBACK;
+    } else {
+        feedback = feedback_new;
+        res = PHASER_OK;
+    }
+
+    // Update instance parameters
+    c->feedback = feedback;
+
+    return res;
+
+}
+
+/**
+ * @brief Modify phase offset between the left and right LFOs
+ *
+ * Only applies to the phaser's own LFO.  When subscribed to an LFO bank, the
+ * offset is set by how the bank's LFOs are linked.
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param stereo_phase_new New phase offset in cycles (0.0->0.5)
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_modify_stereo_phase(PHASER * c,
+                                           float stereo_phase_new) {
+
+    RESULT_PHASER res;
+
+    float stereo_phase;
+    if (stereo_phase_new < PHASER_STEREO_PHASE_MIN) {
+        stereo_phase = PHASER_STEREO_PHASE_MIN;
+        res = PHASER_INVALID_STEREO_PHASE;
+    } else if (stereo_phase_new > PHASER_STEREO_PHASE_MAX) {
+        stereo_phase = PHASER_STEREO_PHASE_MAX;
+        res = PHASER_INVALID_STEREO_PHASE;
+    } else {
+        stereo_phase = stereo_phase_new;
+        res = PHASER_OK;
+    }
+
+    // Update instance parameters
+    c->stereo_phase = stereo_phase;
+
+    return res;
+
+}
+
+/**
+ * @brief Drive the phaser from LFOs in a shared LFO bank
+ *
+ * Pass a NULL bank to go back to the phaser's own LFO.
+ *
+ * @param c Pointer to instance structure
+ * @param lfo_bank Pointer to LFO bank (or NULL)
+ * @param lfo_left Index of the LFO used for the left channel
+ * @param lfo_right Index of the LFO used for the right channel
+ * @return Phaser result (enumeration)
+ */
+RESULT_PHASER   phaser_subscribe_lfo(PHASER * c,
+                                     LFO_BANK * lfo_bank,
+                                     uint32_t lfo_left,
+                                     uint32_t lfo_right) {
+
+    if (lfo_bank != NULL &&
+        (lfo_left >= LFO_BANK_MAX_LFOS || lfo_right >= LFO_BANK_MAX_LFOS)) {
+        return PHASER_INVALID_LFO;
+    }
+
+    c->lfo_left = lfo_left;
+    c->lfo_right = lfo_right;
+    c->lfo_bank = lfo_bank;
+
+    return PHASER_OK;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out_left Pointer to floating point output buffer (left mono)
+ * @param audio_out_right Pointer to floating point output buffer (right mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    phaser_read(PHASER * c,
+                    float * audio_in,
+                    float * audio_out_left,
+                    float * audio_out_right,
+                    uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out_left[i] = audio_in[i];
+            audio_out_right[i] = audio_in[i];
+        }
+        return;
+    }
+
+    float * lfo_left = NULL, * lfo_right = NULL;
+    if (c->lfo_bank != NULL) {
+        lfo_left = lfo_bank_buffer(c->lfo_bank, c->lfo_left);
+        lfo_right = lfo_bank_buffer(c->lfo_bank, c->lfo_right);
+    }
+
+    float t = c->lfo_t;
+    float period_inc = c->inc*PHASER_CONTROL_PERIOD;
+
+    for (int start=0;start<audio_block_size;start+=PHASER_CONTROL_PERIOD) {
+
+        uint32_t n = audio_block_size - start;
+        if (n > PHASER_CONTROL_PERIOD) {
+            n = PHASER_CONTROL_PERIOD;
+        }
+
+        // Update the stage coefficients once per control period
+        if (lfo_left != NULL) {
+            c->left.coeff = phaser_coeff(c, lfo_left[start]);
+            c->right.coeff = phaser_coeff(c, lfo_right[start]);
+        }
+        else {
+            c->left.coeff = phaser_coeff(c, oscillator_sine(t));
+            c->right.coeff = phaser_coeff(c, oscillator_sine(t + c->stereo_phase));
+            t += period_inc;
+        }
+
+        phaser_process_channel(&c->left, c->num_stages, c->feedback,
+                               &audio_in[start], &audio_out_left[start], n);
+        phaser_process_channel(&c->right, c->num_stages, c->feedback,
+                               &audio_in[start], &audio_out_right[start], n);
+    }
+
+    c->lfo_t = t - floorf(t);
+
+}
+
+/**
+ * @brief Calculates the allpass coefficient for an LFO value
+ *
+ * @param c Pointer to instance structure
+ * @param lfo LFO value (-1.0->1.0)
+ * @return Allpass coefficient
+ */
+static float    phaser_coeff(PHASER * c, float lfo) {
+
+    // Exponential sweep around the geometric centre of the range
+    float pos = 0.5 + 0.5*c->depth*lfo;
+    float freq = PHASER_SWEEP_MIN_HZ*powf(PHASER_SWEEP_MAX_HZ/PHASER_SWEEP_MIN_HZ, pos);
+
+    // Stage has a 90 degree phase shift at 'freq'
+    float w = tanf(PI*freq/c->audio_sample_rate);
+    return (w - 1.0)/(w + 1.0);
+}
+
+/**
+ * @brief Runs a span of audio through the allpass cascade of one channel
+ *
+ * The state is copied into local variables so the cascade runs out of
+ * registers, and only written back at the end of the span.
+ *
+ * @param ch Pointer to channel state
+ * @param num_stages Number of allpass stages
+ * @param feedback Feedback from the last stage to the first
+ * @param audio_in Pointer to floating point audio input buffer
+ * @param audio_out Pointer to floating point output buffer
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     phaser_process_channel(PHASER_CHANNEL * ch,
+                                       uint32_t num_stages,
+                                       float feedback,
+                                       float * audio_in,
+                                       float * audio_out,
+                                       uint32_t audio_block_size) {
+
+    float z[PHASER_MAX_STAGES];
+    for (int k=0;k<num_stages;k++) {
+        z[k] = ch->stage_state[k];
+    }
+    float a = ch->coeff;
+    float fb = ch->feedback_state;
+
+    for (int i=0;i<audio_block_size;i++) {
+        float dry = audio_in[i];
+        float x = dry + feedback*fb;
+
+        for (int k=0;k<num_stages;k++) {
+            float y = a*x + z[k];
+            z[k] = x - a*y;
+            x = y;
+        }
+
+        fb = x;
+        audio_out[i] = 0.5*(dry + x);
+    }
+
+    for (int k=0;k<num_stages;k++) {
+        ch->stage_state[k] = z[k];
+    }
+    ch->feedback_state = fb;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_PHASER_H
+#define _AUDIO_EFFECT_PHASER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/lfo_bank.h"
+
+#define PHASER_MIN_STAGES       (4)
+#define PHASER_MAX_STAGES       (12)
+
+// Result enumerations
+typedef enum
+{
+    PHASER_OK,
+    PHASER_INVALID_INSTANCE_POINTER,
+    PHASER_INVALID_STAGES,
+    PHASER_INVALID_RATE,
+    PHASER_INVALID_DEPTH,
+    PHASER_INVALID_FEEDBACK,
+    PHASER_INVALID_STEREO_PHASE,
+    PHASER_INVALID_LFO
+} RESULT_PHASER;
+
+// State of one output channel
+typedef struct {
+
+    float   stage_state[PHASER_MAX_STAGES];
+    float   feedback_state;
+    float   coeff;
+
+} PHASER_CHANNEL;
+
+// C struct with parameters and state information
+typedef struct {
+
+    bool    initialized;
+
+    uint32_t    num_stages;
+    float   rate_hz;
+    float   depth;
+    float   feedback;
+    float   stereo_phase;
+
+    PHASER_CHANNEL  left;
+    PHASER_CHANNEL  right;
+
+    // Own LFO (used when not subscribed to an LFO bank)
+    float   lfo_t;
+    float   inc;
+
+    LFO_BANK    *   lfo_bank;           // Shared LFO bank (NULL = own LFO)
+    uint32_t        lfo_left;
+    uint32_t        lfo_right;
+
+    float   audio_sample_rate;
+
+} PHASER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_PHASER   phaser_setup(PHASER * c,
+                             uint32_t num_stages,
+                             float rate_hz,
+                             float depth,
+                             float feedback,
+                             float stereo_phase,
+                             float audio_sample_rate);
+
+RESULT_PHASER   phaser_modify_rate(PHASER * c,
+                                   float rate_hz_new);
+
+RESULT_PHASER   phaser_modify_depth(PHASER * c,
+                                    float depth_new);
+
+RESULT_PHASER   phaser_modify_feedback(PHASER * c,
+                                       float feedback_new);
+
+RESULT_PHASER   phaser_modify_stereo_phase(PHASER * c,
+                                           float stereo_phase_new);
+
+RESULT_PHASER   phaser_subscribe_lfo(PHASER * c,
+                                     LFO_BANK * lfo_bank,
+                                     uint32_t lfo_left,
+                                     uint32_t lfo_right);
+
+void    phaser_read(PHASER * c,
+                    float * audio_in,
+                    float * audio_out_left,
+                    float * audio_out_right,
+                    uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_EFFECT_PHASER_H
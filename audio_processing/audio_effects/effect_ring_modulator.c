@@ -8,11 +8,13 @@
  * Here's a nice write up of songs that feature a ring modulator
  * https://www.theguardian.com/music/2009/nov/09/ring-modulators
  * 
+ * The carrier is generated with a quadrature (coupled-form) oscillator so
+ * each sample costs a complex multiply rather than a sine evaluation.
+ * 
  */
 #include <stdlib.h>
 
 #include "effect_ring_modulator.h"
-#include "../audio_elements/oscillators.h"
 
 // Min/max limits and other constants
 #define RING_MOD_DEPTH_MIN      (0.0)
@@ -50,8 +52,7 @@ RESULT_RING_MOD     ring_modulator_setup(RING_MODULATOR * c,
         return RING_MOD_INVALID_DEPTH;
     }
 
-    c->t = 0;
-    c->t_inc = 1.0 / (audio_sample_rate/freq);
+    quad_osc_setup(&c->carrier, freq, audio_sample_rate);
 
     c->depth = depth;
 
@@ -91,7 +92,7 @@ RESULT_RING_MOD    ring_modulator_modify_freq(RING_MODULATOR * c,
         res = RING_MOD_OK;
     } 
     // Update instance parameters
-    c->t_inc = 1.0 / (c->audio_sample_rate/freq_new);
+    quad_osc_modify_freq(&c->carrier, freq);
 
     return res;
 
@@ -126,7 +127,7 @@ RESULT_RING_MOD    ring_modulator_modify_depth(RING_MODULATOR * c,
     } 
 
     // Update instance parameters
-    c->depth = depth_new;
+    c->depth = depth;
 
     return res;
 
@@ -154,10 +155,13 @@ void    ring_modulator_read(RING_MODULATOR * c,
         return;
     }
 
+    float carrier[MAX_AUDIO_BLOCK_SIZE];
+    quad_osc_read(&c->carrier, carrier, NULL, audio_block_size);
+
+    float dry = 1.0-c->depth;
+    float wet = c->depth;
     for (int i=0;i<audio_block_size;i++) {
-        audio_out[i] = (1.0-c->depth)*audio_in[i] + c->depth*audio_in[i]*oscillator_sine(c->t);
-        c->t += c->t_inc;
+        audio_out[i] = audio_in[i]*(dry + wet*carrier[i]);
     }
-    c->t = c->t - floor(c->t);
 
 }
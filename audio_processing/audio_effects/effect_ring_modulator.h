@@ -11,6 +11,7 @@
 
 #include "../audio_elements/biquad_filter.h"
 #include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/quadrature_oscillator.h"
 
 // Result enumerations
 typedef enum
@@ -26,8 +27,7 @@ typedef struct {
 
     bool    initialized;
 
-    float   t;
-    float   t_inc;
+    QUAD_OSC    carrier;
     float   depth;
     float   audio_sample_rate;
 
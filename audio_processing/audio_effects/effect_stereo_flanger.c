@@ -73,6 +73,9 @@ RESULT_FLANGER  flanger_setup(STEREO_FLANGER * c,
 
     c->audio_sample_rate = audio_sample_rate;
 
+    // Use our own LFOs until subscribed to an LFO bank
+    c->lfo_bank = NULL;
+
     // Instance was successfully initialized
     c->initialized = true;
     return FLANGER_OK;
@@ -183,6 +186,38 @@ RESULT_FLANGER  flanger_modify_feedback(STEREO_FLANGER * c, float feedback_new)
     return res;
 }
 
+/**
+ * @brief Drive the flanger from a shared LFO bank
+ *
+ * Once subscribed, the flanger uses the control buffers of the two LFOs in
+ * the bank rather than generating its own and flanger_modify_rate() has no
+ * effect (the rate is set in the bank).  The bank must be advanced once per
+ * block before flanger_read() is called.  Passing a NULL bank reverts to the
+ * flanger's own LFOs.
+ *
+ * @param c Pointer to instance structure
+ * @param lfo_bank Pointer to LFO bank (or NULL)
+ * @param lfo_left Index of LFO used for the left channel
+ * @param lfo_right Index of LFO used for the right channel
+ * @return flanger result (enumeration)
+ */
+RESULT_FLANGER  flanger_subscribe_lfo(STEREO_FLANGER * c,
+                                      LFO_BANK * lfo_bank,
+                                      uint32_t lfo_left,
+                                      uint32_t lfo_right) {
+
+    if (lfo_bank != NULL &&
+        (lfo_left >= LFO_BANK_MAX_LFOS || lfo_right >= LFO_BANK_MAX_LFOS)) {
+        return FLANGER_INVALID_LFO;
+    }
+
+    c->lfo_left = lfo_left;
+    c->lfo_right = lfo_right;
+    c->lfo_bank = lfo_bank;
+
+    return FLANGER_OK;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -207,18 +242,28 @@ void    flanger_read(STEREO_FLANGER * c,
         return;
     }
 
-    float lfo_left[MAX_AUDIO_BLOCK_SIZE], lfo_right[MAX_AUDIO_BLOCK_SIZE];
+    float lfo_left_buf[MAX_AUDIO_BLOCK_SIZE], lfo_right_buf[MAX_AUDIO_BLOCK_SIZE];
+    float * lfo_left, * lfo_right;
 
-    // Generate LFO signal
-    float t_l=c->lfo_t_left;
-    float t_r=c->lfo_t_right;
-    float inc=c->inc;
-    for (int i=0;i<audio_block_size;i++) {
-        lfo_left[i] = oscillator_sine(t_l+=inc);
-        lfo_right[i] = oscillator_sine(t_r+=inc);
+    if (c->lfo_bank != NULL) {
+        // Use the control buffers from the shared LFO bank
+        lfo_left = lfo_bank_buffer(c->lfo_bank, c->lfo_left);
+        lfo_right = lfo_bank_buffer(c->lfo_bank, c->lfo_right);
+    }
+    else {
+        // Generate LFO signal
+        float t_l=c->lfo_t_left;
+        float t_r=c->lfo_t_right;
+        float inc=c->inc;
+        for (int i=0;i<audio_block_size;i++) {
+            lfo_left_buf[i] = oscillator_sine(t_l+=inc);
+            lfo_right_buf[i] = oscillator_sine(t_r+=inc);
+        }
+        c->lfo_t_left = t_l - floor(t_l);
+        c->lfo_t_right = t_r - floor(t_r);
+        lfo_left = lfo_left_buf;
+        lfo_right = lfo_right_buf;
     }
-    c->lfo_t_left = t_l - floor(t_l);
-    c->lfo_t_right = t_r - floor(t_r);
 
     variable_delay_read(&c->var_del_left, 
                         audio_in, 
@@ -9,6 +9,7 @@
 
 #include "../audio_elements/variable_delay.h"
 #include "../audio_elements/oscillators.h"
+#include "../audio_elements/lfo_bank.h"
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -21,7 +22,8 @@ typedef enum
     FLANGER_INVALID_INSTANCE_POINTER,
     FLANGER_INVALID_RATE,
     FLANGER_INVALID_DEPTH,
-    FLANGER_INVALID_FEEDBACK
+    FLANGER_INVALID_FEEDBACK,
+    FLANGER_INVALID_LFO
 } RESULT_FLANGER;
 
 // C struct with parameters and state information
@@ -40,6 +42,10 @@ typedef struct {
     float           inc;
     float           audio_sample_rate;
 
+    LFO_BANK    *   lfo_bank;           // Shared LFO bank (NULL = own LFOs)
+    uint32_t        lfo_left;
+    uint32_t        lfo_right;
+
 } STEREO_FLANGER;
 
 // Wrapper allows C code to be called from C++ files
@@ -62,6 +68,11 @@ RESULT_FLANGER  flanger_modify_depth(STEREO_FLANGER * c,
 RESULT_FLANGER  flanger_modify_feedback(STEREO_FLANGER * c, 
                                         float new_feedback);
 
+RESULT_FLANGER  flanger_subscribe_lfo(STEREO_FLANGER * c,
+                                      LFO_BANK * lfo_bank,
+                                      uint32_t lfo_left,
+                                      uint32_t lfo_right);
+
 void    flanger_read(STEREO_FLANGER * c,
                      float * audio_in, 
                      float * audio_out_left, 
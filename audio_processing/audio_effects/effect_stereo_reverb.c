@@ -1,5 +1,15 @@
 /*
  * copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * This reverb is a true-stereo Schroeder/Moorer style reverb.  Each input
+ * channel first passes through its own pair of all-pass diffusers.  The
+ * diffused inputs are then cross-fed into a bank of eight low-pass comb
+ * filters per channel, followed by four series all-pass filters per channel.
+ * Finally, a width control mixes the left and right reverb outputs.
+ *
+ * The left and right channels of each stage are processed together in a
+ * single loop (see delay_read_stereo and allpass_read_stereo) so stereo
+ * processing costs little more than processing a single channel.
  */
 
 #include "effect_stereo_reverb.h"
@@ -13,6 +23,11 @@
 #define     REVERB_FEEDBACK_MAX  (1.0)
 #define     REVERB_LP_DAMP_MIN   (0.0)
 #define     REVERB_LP_DAMP_MAX   (1.0)
+#define     REVERB_WIDTH_MIN     (0.0)
+#define     REVERB_WIDTH_MAX     (1.0)
+
+// Amount of each diffused input fed into the opposite channel's comb filters
+#define     REVERB_CROSSFEED     (0.3)
 
 
 /**
@@ -43,6 +58,13 @@ RESULT_STEREO_REVERB reverb_setup(STEREO_REVERB * c ,
     uint32_t allpass_left[4] = {225, 556, 441, 341};
     uint32_t delay_lens_right[8] = {1551, 1593, 1463, 1433, 1252, 1372, 1101, 1105};
     uint32_t allpass_right[4] = {228, 546, 431, 321};
+    uint32_t diffuser_left[REVERB_DIFFUSER_ELEMENTS] = {142, 107};
+    uint32_t diffuser_right[REVERB_DIFFUSER_ELEMENTS] = {151, 113};
+
+    for (int i=0; i<REVERB_DIFFUSER_ELEMENTS; i++) {
+        allpass_setup( &c->diffusers_left[i], c->diffuser_buffers_left[i], diffuser_left[i], 0.5);
+        allpass_setup( &c->diffusers_right[i], c->diffuser_buffers_right[i], diffuser_right[i], 0.5);
+    }
 
     for (int i=0; i<REVERB_ALLPASS_ELEMENTS; i++) {
         allpass_setup( &c->allpass_outputs_left[i], c->allpass_buffers_left[i], allpass_left[i], 0.5);
@@ -58,6 +80,7 @@ RESULT_STEREO_REVERB reverb_setup(STEREO_REVERB * c ,
     c->wet_mix = wet_mix;
     c->lp_damp = lp_damp;
     c->feedback = feedback;
+    c->width = REVERB_WIDTH_MAX;
 
     // Instance was successfully initialized
     c->initialized = true;
@@ -214,17 +237,54 @@ RESULT_STEREO_REVERB reverb_change_lp_damp_coeff(STEREO_REVERB * c,
 
 }
 
+/**
+ * @brief Modify reverb stereo width
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding 
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ * 
+ * @param c Pointer to instance structure
+ * @param width_new New width value (0.0 = mono -> 1.0 = full stereo)
+ * @return Reverb result (enumerated)
+ */
+RESULT_STEREO_REVERB reverb_change_width(STEREO_REVERB * c,
+                                         float width_new) {
+
+    RESULT_STEREO_REVERB res;
+
+    float width;
+    if (width_new < REVERB_WIDTH_MIN) {
+        width = REVERB_WIDTH_MIN;
+        res = REVERB_INVALID_WIDTH;
+    } else if (width_new > REVERB_WIDTH_MAX) {
+        width = REVERB_WIDTH_MAX;
+        res = REVERB_INVALID_WIDTH;
+    } else {
+        width = width_new;
+        res = REVERB_OK;
+    }
+
+    // Update instance parameters
+    c->width = width;
+
+    return res;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  * 
  * @param c Pointer to instance structure
- * @param audio_in Pointer to floating point audio input buffer (mono)
- * @param audio_out_left Pointer to floating point output buffer (mono left)
- * @param audio_out_right Pointer to floating point output buffer (mono right)
+ * @param audio_in_left Pointer to floating point audio input buffer (left)
+ * @param audio_in_right Pointer to floating point audio input buffer (right)
+ * @param audio_out_left Pointer to floating point output buffer (left)
+ * @param audio_out_right Pointer to floating point output buffer (right)
  * @param audio_block_size The number of floating-point words to process
  */
+#pragma optimize_for_speed
 void reverb_read(STEREO_REVERB * c,
-                 float * audio_in, 
+                 float * audio_in_left,
+                 float * audio_in_right,
                  float * audio_out_left,
                  float * audio_out_right,
                  uint32_t audio_block_size) {
@@ -232,38 +292,66 @@ void reverb_read(STEREO_REVERB * c,
     // If this instance hasn't been properly initialized, pass audio through
     if (c == NULL || !c->initialized) {
         for (int i=0;i<audio_block_size;i++) {
-        	audio_out_left[i] = audio_in[i];
-        	audio_out_right[i] = audio_in[i];
+        	audio_out_left[i] = audio_in_left[i];
+        	audio_out_right[i] = audio_in_right[i];
         }
         return;
     }
 
-    int i;
-    float temp_audio1[MAX_AUDIO_BLOCK_SIZE],temp_audio2[MAX_AUDIO_BLOCK_SIZE];
-
-    clear_buffer(temp_audio1, audio_block_size);
-    for (int i=0;i<REVERB_DELAY_ELEMENTS;i++) {
-        delay_read( &c->lpcf_left[i], audio_in, temp_audio2, audio_block_size );
-        mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
+    float diffused_left[MAX_AUDIO_BLOCK_SIZE], diffused_right[MAX_AUDIO_BLOCK_SIZE];
+    float comb_in_left[MAX_AUDIO_BLOCK_SIZE], comb_in_right[MAX_AUDIO_BLOCK_SIZE];
+    float comb_out_left[MAX_AUDIO_BLOCK_SIZE], comb_out_right[MAX_AUDIO_BLOCK_SIZE];
+    float wet_left[MAX_AUDIO_BLOCK_SIZE], wet_right[MAX_AUDIO_BLOCK_SIZE];
+
+    // Diffuse each input channel
+    allpass_read_stereo(&c->diffusers_left[0], &c->diffusers_right[0],
+                        audio_in_left, audio_in_right,
+                        diffused_left, diffused_right,
+                        audio_block_size);
+    for (int i=1;i<REVERB_DIFFUSER_ELEMENTS;i++) {
+        allpass_read_stereo(&c->diffusers_left[i], &c->diffusers_right[i],
+                            diffused_left, diffused_right,
+                            diffused_left, diffused_right,
+                            audio_block_size);
     }
 
-    // run through all-pass filters
-    for (int i=0;i<REVERB_ALLPASS_ELEMENTS;i++) {
-        allpass_read(&c->allpass_outputs_left[i], temp_audio1, temp_audio1, audio_block_size);
+    // Cross-feed the diffused inputs into the comb filter banks
+    for (int i=0;i<audio_block_size;i++) {
+        comb_in_left[i] = diffused_left[i]*(1.0-REVERB_CROSSFEED) + diffused_right[i]*REVERB_CROSSFEED;
+        comb_in_right[i] = diffused_right[i]*(1.0-REVERB_CROSSFEED) + diffused_left[i]*REVERB_CROSSFEED;
+        wet_left[i] = 0.0;
+        wet_right[i] = 0.0;
     }
-    mix_2x1_gain(temp_audio1, c->wet_mix*(1.0/(2*REVERB_DELAY_ELEMENTS)), audio_in, c->dry_mix, audio_out_left, audio_block_size);
-
 
-    clear_buffer(temp_audio1, audio_block_size);
-    for (int i=0;i<REVERB_DELAY_ELEMENTS;i++) {
-        delay_read( &c->lpcf_right[i], audio_in, temp_audio2, audio_block_size );
-        mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
+    // Run the comb filters (LBCFs) for both channels
+    for (int k=0;k<REVERB_DELAY_ELEMENTS;k++) {
+        delay_read_stereo(&c->lpcf_left[k], &c->lpcf_right[k],
+                          comb_in_left, comb_in_right,
+                          comb_out_left, comb_out_right,
+                          audio_block_size);
+        for (int i=0;i<audio_block_size;i++) {
+            wet_left[i] += comb_out_left[i];
+            wet_right[i] += comb_out_right[i];
+        }
     }
 
     // run through all-pass filters
-    for (int i=0;i<REVERB_ALLPASS_ELEMENTS;i++) {
-        allpass_read(&c->allpass_outputs_right[i], temp_audio1, temp_audio1, audio_block_size);
+    for (int k=0;k<REVERB_ALLPASS_ELEMENTS;k++) {
+        allpass_read_stereo(&c->allpass_outputs_left[k], &c->allpass_outputs_right[k],
+                            wet_left, wet_right,
+                            wet_left, wet_right,
+                            audio_block_size);
+    }
+
+    // Apply width and mix with dry signal
+    float wet_direct = c->wet_mix*(0.5*c->width + 0.5)*(1.0/(2*REVERB_DELAY_ELEMENTS));
+    float wet_cross = c->wet_mix*(0.5 - 0.5*c->width)*(1.0/(2*REVERB_DELAY_ELEMENTS));
+    float dry = c->dry_mix;
+    for (int i=0;i<audio_block_size;i++) {
+        float wl = wet_left[i];
+        float wr = wet_right[i];
+        audio_out_left[i] = wl*wet_direct + wr*wet_cross + audio_in_left[i]*dry;
+        audio_out_right[i] = wr*wet_direct + wl*wet_cross + audio_in_right[i]*dry;
     }
-    mix_2x1_gain(temp_audio1, c->wet_mix*(1.0/(2*REVERB_DELAY_ELEMENTS)), audio_in, c->dry_mix, audio_out_right, audio_block_size);
 
 }
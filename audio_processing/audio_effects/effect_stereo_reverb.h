@@ -20,9 +20,11 @@
 
 #define REVERB_MAX_DELAY_SIZE   1700
 #define REVERB_MAX_ALLPASS_SIZE 556
+#define REVERB_MAX_DIFFUSER_SIZE 160
 
 #define REVERB_ALLPASS_ELEMENTS (4)
 #define REVERB_DELAY_ELEMENTS   (8)
+#define REVERB_DIFFUSER_ELEMENTS (2)
 
 // Result enumerations
 typedef enum
@@ -32,7 +34,8 @@ typedef enum
     REVERB_INVALID_WET_MIX,
     REVERB_INVALID_DRY_MIX,
     REVERB_INVALID_FEEDBACK,
-    REVERB_INVALID_LP_DAMP
+    REVERB_INVALID_LP_DAMP,
+    REVERB_INVALID_WIDTH
 } RESULT_STEREO_REVERB;
 
 
@@ -45,6 +48,13 @@ typedef struct  {
     float   lp_damp;
     float   wet_mix;
     float   dry_mix;
+    float   width;
+
+    // Input diffusers (separate for left and right inputs)
+    ALLPASS_FILTER  diffusers_left[REVERB_DIFFUSER_ELEMENTS];
+    ALLPASS_FILTER  diffusers_right[REVERB_DIFFUSER_ELEMENTS];
+    float      diffuser_buffers_left[REVERB_DIFFUSER_ELEMENTS][REVERB_MAX_DIFFUSER_SIZE];
+    float      diffuser_buffers_right[REVERB_DIFFUSER_ELEMENTS][REVERB_MAX_DIFFUSER_SIZE];
 
     ALLPASS_FILTER  allpass_outputs_left[REVERB_ALLPASS_ELEMENTS];
     ALLPASS_FILTER  allpass_outputs_right[REVERB_ALLPASS_ELEMENTS];
@@ -81,8 +91,12 @@ RESULT_STEREO_REVERB reverb_change_feedback(STEREO_REVERB * c,
 RESULT_STEREO_REVERB reverb_change_lp_damp_coeff(STEREO_REVERB * c, 
                                                  float lp_damp_new);
 
+RESULT_STEREO_REVERB reverb_change_width(STEREO_REVERB * c,
+                                         float width_new);
+
 void reverb_read(STEREO_REVERB * c,
-                 float * audio_in, 
+                 float * audio_in_left,
+                 float * audio_in_right,
                  float * audio_out_left,
                  float * audio_out_right,
                  uint32_t audio_block_size);
@@ -54,9 +54,15 @@ RESULT_TREMELO  tremelo_setup(TREMELO * c,
                                AMP_MOD_SIN,
                                audio_sample_rate);
 
+    c->depth = depth;
+    c->rate_hz = rate_hz;
+
     // Set sample rate for Hz rate calculations
     c->audio_sample_rate = audio_sample_rate;
 
+    // Use our own LFO until subscribed to an LFO bank
+    c->lfo_bank = NULL;
+
     // Set t value for oscillator
     c->lfo_t = 0.0;
     c->lfo_t_inc = rate_hz/audio_sample_rate;
@@ -139,6 +145,40 @@ RESULT_TREMELO  tremelo_modify_depth(TREMELO * c, float depth_new) {
     return res;
 }
 
+/**
+ * @brief Drive the tremelo from a shared LFO bank
+ *
+ * Once subscribed, the amplitude modulator uses the control buffer of the
+ * LFO in the bank rather than its own oscillator and tremelo_modify_rate()
+ * has no effect (the rate is set in the bank).  The bank must be advanced
+ * once per block before tremelo_read() is called.  Passing a NULL bank
+ * reverts to the tremelo's own sine LFO.
+ *
+ * @param c Pointer to instance structure
+ * @param lfo_bank Pointer to LFO bank (or NULL)
+ * @param lfo Index of LFO to use
+ *
+ * @return Tremelo result (enumeration)
+ */
+RESULT_TREMELO  tremelo_subscribe_lfo(TREMELO * c,
+                                      LFO_BANK * lfo_bank,
+                                      uint32_t lfo) {
+
+    if (lfo_bank != NULL && lfo >= LFO_BANK_MAX_LFOS) {
+        return TREMELO_INVALID_LFO;
+    }
+
+    c->lfo = lfo;
+    c->lfo_bank = lfo_bank;
+
+    amplitude_modulation_setup(&c->modulator,
+                               c->depth,
+                               c->rate_hz,
+                               (lfo_bank != NULL) ? AMP_MOD_EXT_LFO : AMP_MOD_SIN,
+                               c->audio_sample_rate);
+
+    return TREMELO_OK;
+}
 
 /**
  * @brief Apply effect/process to a block of audio data
@@ -164,7 +204,7 @@ void    tremelo_read(TREMELO * c,
     amplitude_modulation_read(&c->modulator,
                               audio_in,
                               audio_out,
-                              NULL,
+                              lfo_bank_buffer(c->lfo_bank, c->lfo),
                               audio_block_size);
 
 }
@@ -8,6 +8,7 @@
 #define _AUDIO_EFFECT_TREMELO_H
 
 #include "../audio_elements/amplitude_modulation.h"
+#include "../audio_elements/lfo_bank.h"
 
 // Result enumerations
 typedef enum
@@ -15,7 +16,8 @@ typedef enum
     TREMELO_OK,
     TREMELO_INVALID_INSTANCE_POINTER,
     TREMELO_INVALID_RATE,
-    TREMELO_INVALID_DEPTH
+    TREMELO_INVALID_DEPTH,
+    TREMELO_INVALID_LFO
 } RESULT_TREMELO;
 
 typedef struct {
@@ -31,6 +33,9 @@ typedef struct {
     float           lfo_t_inc;
     float           audio_sample_rate;
 
+    LFO_BANK    *   lfo_bank;           // Shared LFO bank (NULL = own LFO)
+    uint32_t        lfo;
+
 } TREMELO;
 
 // Wrapper allows C code to be called from C++ files
@@ -46,6 +51,10 @@ RESULT_TREMELO  tremelo_setup(TREMELO * c,
 RESULT_TREMELO    tremelo_modify_rate(TREMELO * c, float new_rate_hz);
 RESULT_TREMELO    tremelo_modify_depth(TREMELO * c, float new_depth);
 
+RESULT_TREMELO    tremelo_subscribe_lfo(TREMELO * c,
+                                        LFO_BANK * lfo_bank,
+                                        uint32_t lfo);
+
 void    tremelo_read(TREMELO * c,
                      float * audio_in,
                      float * audio_out,
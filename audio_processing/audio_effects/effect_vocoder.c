@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A channel vocoder imposes the spectral envelope of one signal (the
+ * modulator, usually a voice from a microphone) onto another (the carrier,
+ * usually a bright synth sound).  This is the classic "talking synth" /
+ * robot voice effect.
+ *
+ * Both signals are split into 16 to 32 bands by matching filterbanks with
+ * logarithmically spaced centre frequencies from 100 Hz to 8 kHz.  Each band
+ * is two cascaded band-pass biquads for steeper skirts and less leakage
+ * between bands.  An envelope follower on each modulator band sets the gain
+ * of the matching carrier band, and the carrier bands are summed to form the
+ * output.
+ *
+ * The filterbanks use the biquad bank element, which processes all bands
+ * side by side (structure of arrays) so that the compiler can run pairs of
+ * bands in SIMD.  The band envelopes are only read once per block and the
+ * band gains are ramped linearly across the block, so the per-sample cost of
+ * a band is its four biquads plus one multiply-accumulate.
+ *
+ * The mix blends the vocoded signal with the unprocessed carrier.  When the
+ * mix is 0 the filterbanks are skipped entirely.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "effect_vocoder.h"
+
+// Min/max limits and other constants
+#define VOCODER_MIN_FREQ            (100.0)
+#define VOCODER_MAX_FREQ            (8000.0)
+#define VOCODER_TIME_MS_MIN         (0.1)
+#define VOCODER_TIME_MS_MAX         (1000.0)
+#define VOCODER_MIX_MIN             (0.0)
+#define VOCODER_MIX_MAX             (1.0)
+
+// Widens each stage so the -3 dB bandwidth of the cascade matches the band spacing
+#define VOCODER_CASCADE_Q_SCALE     (0.644)
+
+// Per band makeup gain.  Brings the output back to about the level of the
+// carrier for a broadband modulator at around -15 dBFS.
+#define VOCODER_MAKEUP_GAIN         (6.0)
+
+
+/**
+ * @brief Initializes instance of a vocoder
+ *
+ * @param c Pointer to instance structure
+ * @param num_bands Number of bands (16->32)
+ * @param attack_ms Attack time of the band envelopes in ms (0.1->1000.0)
+ * @param release_ms Release time of the band envelopes in ms (0.1->1000.0)
+ * @param mix Mix of vocoded signal vs. unprocessed carrier (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Vocoder result (enumeration)
+ */
+RESULT_VOCODER vocoder_setup(VOCODER * c,
+                             uint32_t num_bands,
+                             float attack_ms,
+                             float release_ms,
+                             float mix,
+                             float audio_sample_rate) {
+
+    if (c == NULL) {
+        return VOCODER_INVALID_INSTANCE_POINTER;
+    }
+
+    c->initialized = false;
+
+    if (num_bands < VOCODER_MIN_BANDS || num_bands > VOCODER_MAX_BANDS) {
+        return VOCODER_INVALID_NUM_BANDS;
+    }
+    if (attack_ms > VOCODER_TIME_MS_MAX ||
+        attack_ms < VOCODER_TIME_MS_MIN) {
+        return VOCODER_INVALID_ATTACK;
+    }
+    if (release_ms > VOCODER_TIME_MS_MAX ||
+        release_ms < VOCODER_TIME_MS_MIN) {
+        return VOCODER_INVALID_RELEASE;
+    }
+    if (mix > VOCODER_MIX_MAX ||
+        mix < VOCODER_MIX_MIN) {
+        return VOCODER_INVALID_MIX;
+    }
+
+    c->num_bands = num_bands;
+    c->attack_ms = attack_ms;
+    c->release_ms = release_ms;
+    c->mix = mix;
+    c->audio_sample_rate = audio_sample_rate;
+
+    // Log spaced bands.  The Q makes adjacent bands cross at their -3 dB points.
+    float spacing = powf(VOCODER_MAX_FREQ/VOCODER_MIN_FREQ, 1.0/(num_bands - 1));
+    float q = VOCODER_CASCADE_Q_SCALE/(sqrtf(spacing) - 1.0/sqrtf(spacing));
+
+    for (int s=0;s<VOCODER_FILTER_STAGES;s++) {
+        biquad_bank_setup(&c->modulator_bank[s], num_bands, audio_sample_rate);
+        biquad_bank_setup(&c->carrier_bank[s], num_bands, audio_sample_rate);
+    }
+
+    float freq = VOCODER_MIN_FREQ;
+    for (int b=0;b<num_bands;b++) {
+        for (int s=0;s<VOCODER_FILTER_STAGES;s++) {
+            biquad_bank_set_section(&c->modulator_bank[s], b, BIQUAD_TYPE_BPF, freq, q, 0.0);
+            biquad_bank_set_section(&c->carrier_bank[s], b, BIQUAD_TYPE_BPF, freq, q, 0.0);
+        }
+
+        // Block rate envelope (the decimated output isn't used)
+        envelope_follower_setup(&c->envelope[b],
+                                ENV_FOLLOWER_PEAK,
+                                attack_ms,
+                                release_ms,
+                                MAX_AUDIO_BLOCK_SIZE,
+                                audio_sample_rate);
+        c->band_gain[b] = 0.0;
+
+        freq *= spacing;
+    }
+
+    // Both signals are split into narrower, quieter pieces as bands are added
+    c->makeup_gain = VOCODER_MAKEUP_GAIN*num_bands;
+
+    // Instance was successfully initialized
+    c->initialized = true;
+    return VOCODER_OK;
+
+}
+
+/**
+ * @brief Modify the release time of the band envelopes
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param release_ms_new New release time in ms (0.1->1000.0)
+ * @return Vocoder result (enumeration)
+ */
+RESULT_VOCODER vocoder_modify_release(VOCODER * c,
+                                      float release_ms_new) {
+
+    RESULT_VOCODER res;
+
+    float release_ms;
+    if (release_ms_new < VOCODER_TIME_MS_MIN) {
+        release_ms = VOCODER_TIME_MS_MIN;
+        res = VOCODER_INVALID_RELEASE;
+    } else if (release_ms_new > VOCODER_TIME_MS_MAX) {
+        release_ms = VOCODER_TIME_MS_MAX;
+        res = VOCODER_INVALID_RELEASE;
+    } else {
+        release_ms = release_ms_new;
+        res = VOCODER_OK;
+    }
+
+    // Update instance parameters
+    if (release_ms != c->release_ms) {
+        c->release_ms = release_ms;
+        for (int b=0;b<c->num_bands;b++) {
+            envelope_follower_modify_release(&c->envelope[b], release_ms);
+        }
+    }
+
+    return res;
+
+}
+
+/**
+ * @brief Modify mix of vocoded signal vs. unprocessed carrier
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param mix_new New mix (0.0->1.0)
+ * @return Vocoder result (enumeration)
+ */
+RESULT_VOCODER vocoder_modify_mix(VOCODER * c,
+                                  float mix_new) {
+
+    RESULT_VOCODER res;
+
+    float mix;
+    if (mix_new < VOCODER_MIX_MIN) {
+        mix = VOCODER_MIX_MIN;
+        res = VOCODER_INVALID_MIX;
+    } else if (mix_new > VOCODER_MIX_MAX) {
+        mix = VOCODER_MIX_MAX;
+        res = VOCODER_INVALID_MIX;
+    } else {
+        mix = mix_new;
+        res = VOCODER_OK;
+    }
+
+    // Update instance parameters
+    c->mix = mix;
+
+    return res;
+
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param modulator_in Pointer to modulator input buffer (e.g. microphone)
+ * @param carrier_in Pointer to carrier input buffer (e.g. synth)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    vocoder_read(VOCODER * c,
+                     float * modulator_in,
+                     float * carrier_in,
+                     float * audio_out,
+                     uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized or is fully dry,
+    // pass the carrier through
+    if (c == NULL || !c->initialized || c->mix == 0.0) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] = carrier_in[i];
+        }
+        return;
+    }
+
+    uint32_t num_bands = c->num_bands;
+    float * mod = c->modulator_bands;
+    float * car = c->carrier_bands;
+
+    // Split both signals into bands
+    biquad_bank_read(&c->modulator_bank[0], modulator_in, mod, audio_block_size);
+    biquad_bank_read(&c->carrier_bank[0], carrier_in, car, audio_block_size);
+    for (int s=1;s<VOCODER_FILTER_STAGES;s++) {
+        biquad_bank_read_planar(&c->modulator_bank[s], mod, mod, audio_block_size);
+        biquad_bank_read_planar(&c->carrier_bank[s], car, car, audio_block_size);
+    }
+
+    float wet[MAX_AUDIO_BLOCK_SIZE];
+    for (int i=0;i<audio_block_size;i++) {
+        wet[i] = 0.0;
+    }
+
+    // Apply the modulator envelope of each band to the carrier band
+    float ramp_scale = 1.0/audio_block_size;
+    for (int b=0;b<num_bands;b++) {
+
+        float target = envelope_follower_read(&c->envelope[b],
+                                              &mod[b*audio_block_size],
+                                              NULL,
+                                              audio_block_size);
+
+        float gain = c->band_gain[b];
+        float gain_inc = (target - gain)*ramp_scale;
+        float * band = &car[b*audio_block_size];
+
+        for (int i=0;i<audio_block_size;i++) {
+            gain += gain_inc;
+            wet[i] += gain*band[i];
+        }
+        c->band_gain[b] = target;
+    }
+
+    float dry_gain = 1.0 - c->mix;
+    float wet_gain = c->mix*c->makeup_gain;
+    for (int i=0;i<audio_block_size;i++) {
+        audio_out[i] = dry_gain*carrier_in[i] + wet_gain*wet[i];
+    }
+
+}
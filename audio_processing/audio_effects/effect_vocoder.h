@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_VOCODER_H
+#define _AUDIO_EFFECT_VOCODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/biquad_bank.h"
+#include "../audio_elements/envelope_follower.h"
+
+#define VOCODER_MIN_BANDS       (16)
+#define VOCODER_MAX_BANDS       (BIQUAD_BANK_MAX_SECTIONS)
+#define VOCODER_FILTER_STAGES   (2)     // Cascaded band-pass sections per band
+
+// Result enumerations
+typedef enum
+{
+    VOCODER_OK,
+    VOCODER_INVALID_INSTANCE_POINTER,
+    VOCODER_INVALID_NUM_BANDS,
+    VOCODER_INVALID_ATTACK,
+    VOCODER_INVALID_RELEASE,
+    VOCODER_INVALID_MIX
+} RESULT_VOCODER;
+
+// C struct with parameters and state information
+typedef struct {
+
+    bool    initialized;
+
+    uint32_t    num_bands;
+
+    // Analysis (modulator) and synthesis (carrier) filterbanks
+    BIQUAD_BANK modulator_bank[VOCODER_FILTER_STAGES];
+    BIQUAD_BANK carrier_bank[VOCODER_FILTER_STAGES];
+
+    // Envelope of each modulator band
+    ENVELOPE_FOLLOWER   envelope[VOCODER_MAX_BANDS];
+    float   band_gain[VOCODER_MAX_BANDS];
+
+    // Planar band signals (one channel per band)
+    float   modulator_bands[VOCODER_MAX_BANDS*MAX_AUDIO_BLOCK_SIZE];
+    float   carrier_bands[VOCODER_MAX_BANDS*MAX_AUDIO_BLOCK_SIZE];
+
+    float   attack_ms;
+    float   release_ms;
+    float   mix;
+    float   makeup_gain;
+    float   audio_sample_rate;
+
+} VOCODER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_VOCODER vocoder_setup(VOCODER * c,
+                             uint32_t num_bands,
+                             float attack_ms,
+                             float release_ms,
+                             float mix,
+                             float audio_sample_rate);
+
+RESULT_VOCODER vocoder_modify_release(VOCODER * c,
+                                      float release_ms_new);
+
+RESULT_VOCODER vocoder_modify_mix(VOCODER * c,
+                                  float mix_new);
+
+void    vocoder_read(VOCODER * c,
+                     float * modulator_in,
+                     float * carrier_in,
+                     float * audio_out,
+                     uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _AUDIO_EFFECT_VOCODER_H
@@ -6,11 +6,18 @@
  *
  * There is a setup function and an audio processing function which should be included
  * in the setup and audio processing functions of the audio callback (callback_audio_processing.cpp).
+ * On core 1 there is also a background function which should be called from
+ * processaudio_background_loop().
  *
  */
 
+#include <stdio.h>
+#include <math.h>
+
 #include "common/audio_system_config.h"
 #include "common/multicore_shared_memory.h"
+#include "drivers/bm_audio_flow_driver/bm_audio_flow.h"
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
 #include "audio_effects_selector.h"
 
@@ -40,8 +47,253 @@ static void effect_bypass(void) {
 
 /******************************************************************************
  * Effects running on SHARC core 1
+ *
+ * Each preset on core 1 is described as an effect graph (see
+ * audio_elements/effect_graph.c): a table of nodes, each wrapping an effect's
+ * *_read() function, and a table of edges connecting them to each other and
+ * to the input and output buffers.  Compiling a graph works out the
+ * processing order and which buffers each effect reads and writes, so effects
+ * run in place in the output buffers wherever they can.  Each preset also has
+ * a control function that reads the pots and switches.
+ *
+ * Presets are only set up when they are selected (see
+ * audio_elements/effect_presets.c).  The background loop zeroes the preset's
+ * delay lines a little at a time, then calls its setup routine, while the
+ * old preset carries on running.  The two are then crossfaded over
+ * PRESET_CROSSFADE_MS so echoes and tails die away instead of being cut off,
+ * and the old preset is released, so it starts from scratch when it's
+ * selected again.  If running both presets at once wouldn't fit in
+ * PRESET_CYCLE_BUDGET, the old one fades out and the new one fades in instead
+ * (a preset that hasn't run yet is assumed to need the whole budget).
+ *
+ * To add a preset, declare its node and edge tables and the delay lines it
+ * needs zeroed, compile the graph in its setup routine with
+ * preset_graph_setup() and add it to core1_preset_table[].  Delay lines
+ * listed there should be set up with the *_setup_cleared() functions.
  *****************************************************************************/
 
+// Scratch buffers shared by all of the preset graphs (they run one after
+// another, even while two presets are crossfading)
+#define PRESET_GRAPH_POOL_BUFFERS	(2)
+float	preset_graph_pool[PRESET_GRAPH_POOL_BUFFERS*AUDIO_BLOCK_SIZE];
+
+static float *	preset_graph_in[2] = { audio_effects_left_in, audio_effects_right_in };
+static float *	preset_graph_out[2] = { audio_effects_left_out, audio_effects_right_out };
+
+// Crossfade when switching presets and the cycles the presets may use per block
+#define PRESET_CROSSFADE_MS		(300.0)
+#define PRESET_CYCLE_BUDGET		((uint32_t)(0.8 * CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE * AUDIO_BLOCK_SIZE))
+
+/**
+ * @brief Reads the core cycle counter for the presets' cycle budget
+ */
+static uint32_t preset_cycle_counter(void) {
+	return (uint32_t)audioflow_get_cpu_cycle_counter();
+}
+
+#define PRESET_NUM_NODES(nodes)		(sizeof(nodes)/sizeof(EFFECT_GRAPH_NODE))
+#define PRESET_NUM_EDGES(edges)		(sizeof(edges)/sizeof(EFFECT_GRAPH_EDGE))
+
+/**
+ * @brief Compiles the graph for a preset
+ *
+ * If the graph is invalid it is left uninitialized and the preset falls back
+ * to bypass.
+ */
+static void preset_graph_setup(EFFECT_GRAPH * graph,
+							   const EFFECT_GRAPH_NODE * nodes,
+							   uint32_t num_nodes,
+							   const EFFECT_GRAPH_EDGE * edges,
+							   uint32_t num_edges) {
+
+	RESULT_EFFECT_GRAPH res = effect_graph_setup(graph,
+												 nodes,
+												 num_nodes,
+												 edges,
+												 num_edges,
+												 preset_graph_in,
+												 2,
+												 preset_graph_out,
+												 2,
+												 preset_graph_pool,
+												 PRESET_GRAPH_POOL_BUFFERS,
+												 AUDIO_BLOCK_SIZE);
+	if (res != EFFECT_GRAPH_OK) {
+		char message[64];
+		sprintf(message, "Effect graph for a core 1 preset failed to compile (%d)", (int)res);
+		log_event(EVENT_WARN, message);
+	}
+}
+
+/*
+ * Graph nodes.  These adapt the *_read() functions of the effects and
+ * elements to the signature used by the effect graph.
+ */
+static void node_delay(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	delay_read((DELAY_LPF *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_multitap_delay(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	multitap_delay_read((MULTITAP_DELAY *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+/**
+ * A noise gate used by more than one preset.  While switching presets two of
+ * them can run in the same block, and the gate must still only advance once
+ * per block: the first preset to read it runs it and any other gets a copy of
+ * the same output.  Every preset must feed it the same input.
+ */
+typedef struct {
+	NOISE_GATE *	gate;
+	uint32_t		block;					// Block the output below belongs to
+	bool			closed;
+	float			audio_out[AUDIO_BLOCK_SIZE];
+} SHARED_NOISE_GATE;
+
+static uint32_t core1_block_count = 0;		// Incremented at the start of every block
+
+static bool shared_noise_gate_read(SHARED_NOISE_GATE * c, float * audio_in, float * audio_out, uint32_t audio_block_size) {
+
+	if (c->block != core1_block_count) {
+		c->closed = noise_gate_read(c->gate, audio_in, c->audio_out, audio_block_size);
+		c->block = core1_block_count;
+	}
+	copy_buffer(c->audio_out, audio_out, audio_block_size);
+
+	return c->closed;
+}
+
+static void node_noise_gate(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	shared_noise_gate_read((SHARED_NOISE_GATE *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_multiband_comp(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	multiband_comp_read((MULTIBAND_COMPRESSOR *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_flanger(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	flanger_read((STEREO_FLANGER *)instance, audio_in[0], audio_out[0], audio_out[1], audio_block_size);
+}
+
+static void node_guitar_synth(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	guitar_synth_read((GUITAR_SYNTH *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_autowah(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	autowah_read((AUTOWAH *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_ring_modulator(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	ring_modulator_read((RING_MODULATOR *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_freq_shifter(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	freq_shifter_read((FREQ_SHIFTER *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_harmonizer(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	harmonizer_read((HARMONIZER *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_phaser(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	phaser_read((PHASER *)instance, audio_in[0], audio_out[0], audio_out[1], audio_block_size);
+}
+
+static void node_noise_reduction(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	noise_reduction_read((NOISE_REDUCTION *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_feedback_suppressor(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	feedback_suppressor_read((FEEDBACK_SUPPRESSOR *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+static void node_tremelo(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+	tremelo_read((TREMELO *)instance, audio_in[0], audio_out[0], audio_block_size);
+}
+
+/**
+ * A noise gate followed by a tube distortion.  The distortion is skipped
+ * entirely while the gate is closed.
+ */
+typedef struct {
+	SHARED_NOISE_GATE *	gate;
+	TUBE_DISTORTION *	distortion;
+} GATED_DISTORTION;
+
+static void node_gated_distortion(void * instance, float ** audio_in, float ** audio_out, uint32_t audio_block_size) {
+
+	GATED_DISTORTION * c = (GATED_DISTORTION *)instance;
+
+	if (shared_noise_gate_read(c->gate, audio_in[0], audio_out[0], audio_block_size)) {
+		clear_buffer(audio_out[0], audio_block_size);
+	}
+	else {
+		tube_distortion_read(c->distortion, audio_out[0], audio_out[0], audio_block_size);
+	}
+}
+
+/**
+ * Shared LFO bank for the modulated effects on core 1.  It is advanced once
+ * per block before the selected preset runs, and effects subscribe to its
+ * LFOs by index rather than generating their own.
+ *
+ * LFO 0/1 : multi-fx flanger left/right (180 degrees apart)
+ * LFO 2/3 : phaser left/right (90 degrees apart)
+ * LFO 4/5 : tremolo left/right (180 degrees apart)
+ */
+LFO_BANK lfo_bank_core1;
+#define LFO_BANK_TEMPO_BPM		(120.0)
+
+/**
+ * Shared noise gate for the guitar input on core 1.  High gain presets run the
+ * input through it first.  When it reports the gate fully closed, the preset
+ * can skip stages that would only process silence.
+ */
+NOISE_GATE noise_gate_core1;
+SHARED_NOISE_GATE noise_gate_core1_shared = { &noise_gate_core1, 0, false };
+#define NOISE_GATE_OPEN_DB		(-50.0)
+#define NOISE_GATE_CLOSE_DB		(-56.0)
+#define NOISE_GATE_HOLD_MS		(50.0)
+#define NOISE_GATE_RELEASE_MS	(60.0)
+#define NOISE_GATE_LOOKAHEAD_MS	(2.0)
+
+/**
+ * Automatic gain control on the core 1 inputs.  This runs before the selected
+ * preset so the thresholds used by the effects (distortion drive, noise gate,
+ * zero-crossing detector) see a consistent level regardless of whether the
+ * audio arrived via the ADAU1761, A2B or SPDIF.  Its state is published in the
+ * shared memory structure so the ARM core can log it.
+ */
+AUTO_GAIN_CONTROL agc_core1;
+#define AGC_TARGET_DB			(-20.0)
+#define AGC_MAX_GAIN_DB			(20.0)
+#define AGC_SLEW_DB_PER_SEC		(3.0)
+#define AGC_NOISE_FLOOR_DB		(-60.0)
+
+/**
+ * Chromatic tuner.  Audio Project Fin SW4 toggles tuner mode.  While it is on,
+ * the effects are muted (or bypassed if TUNER_MUTES_OUTPUT is 0) and the
+ * input is copied to the tuner.  All of the pitch analysis runs in
+ * audio_effects_background_core1() so the tuner adds no per-block cost beyond
+ * the copy.  The note and offset in cents are logged and published in the
+ * shared memory structure, where the ARM core shows them on the VU LEDs.
+ */
+TUNER tuner_core1;
+#define TUNER_MIN_FREQ			(40.0)
+#define TUNER_MAX_FREQ			(1400.0)
+#define TUNER_THRESHOLD			(0.9)
+#define TUNER_MUTES_OUTPUT		(1)
+#define TUNER_LOG_INTERVAL		(12)		// Readings between log messages (about 250 ms)
+static volatile bool tuner_mode = false;
+
+static bool tuner_mode_requested(void) {
+	#if SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+		return multicore_data->audioproj_fin_sw_4_state;
+	#else
+		return false;
+	#endif
+}
+
 
 /**
  * 1 - ECHO EFFECT
@@ -52,6 +304,10 @@ static void effect_bypass(void) {
  * the feedback path which is a useful function when building reverbs out of delay
  * lines.
  * 
+ * The delay lines are stored as half precision floats (see
+ * audio_elements/delay_line_storage.c), which gives twice the delay time of a
+ * float delay line in the same memory and keeps headroom for high feedback.
+ * 
  * POT/HADC0 : Modifies the amount of dampening in the delay feedback loop
  * POT/HADC1 : Modifies the lenght of the delay
  * POT/HADC2 : Modifies the amount of feedback in the delay (duration of the echoes)
@@ -66,10 +322,27 @@ static void effect_bypass(void) {
 // Declare instances and buffers
 DELAY_LPF 	integer_delay_l, integer_delay_r;
 
-// declare delay buffers in SDRAM with a max length of 32000 (2/3 of a second each
-#define INT_DELAY_LEN	(32000)
-float section("seg_sdram") integer_delay_line_l[INT_DELAY_LEN];
-float section("seg_sdram") integer_delay_line_r[INT_DELAY_LEN];
+// declare fp16 delay buffers in SDRAM with a max length of 64000 (4/3 of a second each)
+#define ECHO_DELAY_LEN	(64000)
+uint16_t section("seg_sdram") integer_delay_line_l[ECHO_DELAY_LEN];
+uint16_t section("seg_sdram") integer_delay_line_r[ECHO_DELAY_LEN];
+
+// Both delays are fed from the left input
+EFFECT_GRAPH echo_graph;
+const EFFECT_GRAPH_NODE echo_nodes[] = {
+	{ node_delay, &integer_delay_l, 1, 1, true },
+	{ node_delay, &integer_delay_r, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE echo_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 0, 1, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
+const EFFECT_PRESET_BUFFER echo_buffers[] = {
+	{ integer_delay_line_l, sizeof(integer_delay_line_l) },
+	{ integer_delay_line_r, sizeof(integer_delay_line_r) }
+};
 
 /**
  * @brief Setup routine to initialize instances of the delay line
@@ -77,44 +350,40 @@ float section("seg_sdram") integer_delay_line_r[INT_DELAY_LEN];
 static void effect_echo_setup() {
 
 	// Initialize effect instances
-	delay_setup(&integer_delay_l,
+	delay_setup_packed_cleared(&integer_delay_l,
 			integer_delay_line_l,
-			INT_DELAY_LEN,
-			INT_DELAY_LEN-1000,
+			ECHO_DELAY_LEN,
+			DELAY_STORAGE_FP16,
+			ECHO_DELAY_LEN-1000,
 			0.5,
 			0.8,
 			0.2);
-	delay_setup(&integer_delay_r,
+	delay_setup_packed_cleared(&integer_delay_r,
 			integer_delay_line_r,
-			INT_DELAY_LEN,
-			INT_DELAY_LEN-3000,
+			ECHO_DELAY_LEN,
+			DELAY_STORAGE_FP16,
+			ECHO_DELAY_LEN-3000,
 			0.5,
 			0.8,
 			0.2);
+
+	preset_graph_setup(&echo_graph,
+					   echo_nodes, PRESET_NUM_NODES(echo_nodes),
+					   echo_edges, PRESET_NUM_EDGES(echo_edges));
 }
 
 /**
- * @brief  Process audio and update some modifiable parameters via the pots
+ * @brief  Update some modifiable parameters via the pots
  */
-static void effect_echo_process() {
-
-	// Apply effect
-	delay_read(&integer_delay_l,
-				audio_effects_left_in,
-			   audio_effects_left_out,
-			   AUDIO_BLOCK_SIZE);
-	delay_read(&integer_delay_r,
-			   audio_effects_left_in,
-			   audio_effects_right_out,
-			   AUDIO_BLOCK_SIZE);
+static void effect_echo_control() {
 
 	// Use pot (HADC0) to modify the dampening factor in feeedback path of delay
 	delay_modify_dampening(&integer_delay_l, multicore_data->audioproj_fin_pot_hadc0*0.3+0.1);
 	delay_modify_dampening(&integer_delay_r, multicore_data->audioproj_fin_pot_hadc0*0.3+0.1);
 
 	// Use pot (HADC1) to modify the lenght of the delay
-	delay_modify_length( &integer_delay_l,     INT_DELAY_LEN/2 + multicore_data->audioproj_fin_pot_hadc1*INT_DELAY_LEN/2);
-	delay_modify_length( &integer_delay_r,     INT_DELAY_LEN/2 + multicore_data->audioproj_fin_pot_hadc1*INT_DELAY_LEN/2);
+	delay_modify_length( &integer_delay_l,     ECHO_DELAY_LEN/4 + multicore_data->audioproj_fin_pot_hadc1*ECHO_DELAY_LEN*3/4);
+	delay_modify_length( &integer_delay_r,     ECHO_DELAY_LEN/4 + multicore_data->audioproj_fin_pot_hadc1*ECHO_DELAY_LEN*3/4);
 	
 	// Use pot (HADC2) to modify the feedback value
 	delay_modify_feedback( &integer_delay_l,   multicore_data->audioproj_fin_pot_hadc2);
@@ -136,6 +405,10 @@ static void effect_echo_process() {
  * This implementation uses the integer_delay_multitap audio element and is configured
  * to utilize three taps.   
  * 
+ * The delay lines are stored as 16-bit fixed point samples (see
+ * audio_elements/delay_line_storage.c), which halves their memory footprint
+ * and SDRAM bandwidth.
+ * 
  * POT/HADC0 : nothing
  * POT/HADC1 : nothing
  * POT/HADC2 : nothing
@@ -149,52 +422,57 @@ static void effect_echo_process() {
 // Declare instances and buffers
 MULTITAP_DELAY 	integer_mt_delay_l, integer_mt_delay_r;
 #define INT_DELAY_LEN	(32000)
-float section("seg_sdram") integer_mt_delay_line_l[INT_DELAY_LEN];		// Delay line in SDRAM
-float section("seg_sdram") integer_mt_delay_line_r[INT_DELAY_LEN];		// Delay line in SDRAM
+int16_t section("seg_sdram") integer_mt_delay_line_l[INT_DELAY_LEN];		// Delay line in SDRAM
+int16_t section("seg_sdram") integer_mt_delay_line_r[INT_DELAY_LEN];		// Delay line in SDRAM
 
 uint32_t tap_offsets_l[3] = {10000,20000,28000};
 uint32_t tap_offsets_r[3] = {8000,22000,29000};
 float 	 tap_gains_l[3] = {0.3, 0.4, 0.2};
 float 	 tap_gains_r[3] = {0.4, 0.3, 0.2};
 
+EFFECT_GRAPH multitap_delay_graph;
+const EFFECT_GRAPH_NODE multitap_delay_nodes[] = {
+	{ node_multitap_delay, &integer_mt_delay_l, 1, 1, true },
+	{ node_multitap_delay, &integer_mt_delay_r, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE multitap_delay_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 0, 1, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
+const EFFECT_PRESET_BUFFER multitap_delay_buffers[] = {
+	{ integer_mt_delay_line_l, sizeof(integer_mt_delay_line_l) },
+	{ integer_mt_delay_line_r, sizeof(integer_mt_delay_line_r) }
+};
+
 /**
  * @brief Setup routine to initialize instances of the multi-tap delay line
  */
 static void effect_multitap_delay_setup() {
 
 	// Initialize effect instance
-	multitap_delay_setup(&integer_mt_delay_l,
+	multitap_delay_setup_packed_cleared(&integer_mt_delay_l,
 			integer_mt_delay_line_l,
 			INT_DELAY_LEN,
+			DELAY_STORAGE_INT16,
 			3,
 			tap_offsets_l,
 			tap_gains_l,
 			0.8);
 
-	multitap_delay_setup(&integer_mt_delay_r,
+	multitap_delay_setup_packed_cleared(&integer_mt_delay_r,
 			integer_mt_delay_line_r,
 			INT_DELAY_LEN,
+			DELAY_STORAGE_INT16,
 			3,
 			tap_offsets_r,
 			tap_gains_r,
 			0.8);
-}
-
-/**
- * @brief  Process audio and update some modifiable parameters via the pots
- */
-static void effect_multitap_delay_process() {
-
-	// Apply effect
-	multitap_delay_read(&integer_mt_delay_l,
-						audio_effects_left_in,
-						audio_effects_left_out,
-						AUDIO_BLOCK_SIZE);
 
-	multitap_delay_read(&integer_mt_delay_r,
-						audio_effects_left_in,
-						audio_effects_right_out,
-						AUDIO_BLOCK_SIZE);
+	preset_graph_setup(&multitap_delay_graph,
+					   multitap_delay_nodes, PRESET_NUM_NODES(multitap_delay_nodes),
+					   multitap_delay_edges, PRESET_NUM_EDGES(multitap_delay_edges));
 }
 
 /**
@@ -206,6 +484,9 @@ static void effect_multitap_delay_process() {
  * This implementation uses the integer_delay_multitap audio element and is configured
  * to utilize three taps.   
  * 
+ * The input passes through the shared noise gate first and the distortion is
+ * skipped entirely while the gate is closed.
+ * 
  * POT/HADC0 : distortion output gain
  * POT/HADC1 : distortion drive (prior to clipping)
  * POT/HADC2 : tone of output
@@ -220,6 +501,18 @@ static void effect_multitap_delay_process() {
  * 
  */
 TUBE_DISTORTION	tube_dist;
+GATED_DISTORTION gated_tube_dist = { &noise_gate_core1_shared, &tube_dist };
+
+// Mono, so the left output is copied to the right
+EFFECT_GRAPH tube_distortion_graph;
+const EFFECT_GRAPH_NODE tube_distortion_nodes[] = {
+	{ node_gated_distortion, &gated_tube_dist, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE tube_distortion_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
 
 /**
  * @brief Setup routine to initialize instance of the tube distortion simulator
@@ -232,23 +525,18 @@ static void effect_tube_distortion_setup(void) {
 						  multicore_data->audioproj_fin_pot_hadc0 * 1.0,
 						  multicore_data->audioproj_fin_pot_hadc2,
 						  AUDIO_SAMPLE_RATE);
+
+	// The input is gated so the distortion doesn't amplify pickup noise
+	preset_graph_setup(&tube_distortion_graph,
+					   tube_distortion_nodes, PRESET_NUM_NODES(tube_distortion_nodes),
+					   tube_distortion_edges, PRESET_NUM_EDGES(tube_distortion_edges));
 }
 
 /**
- * @briend Process audio and update some modifiable parameters via the pots
+ * @brief Update some modifiable parameters via the pots
  */
-static void effect_tube_distortion_process(void) {
-	tube_distortion_read(&tube_dist,
-						 audio_effects_left_in,
-						 audio_effects_left_out,
-						 AUDIO_BLOCK_SIZE);
+static void effect_tube_distortion_control(void) {
 
-	// Make stereo
-	for (int i=0;i<AUDIO_BLOCK_SIZE;i++) {
-		audio_effects_right_out[i] = audio_effects_left_out[i];
-	}
-
-	
 	// Use pot (HADC0) to modify the output gain of the distortion
 	tube_distortion_modify_gain( &tube_dist,   multicore_data->audioproj_fin_pot_hadc2 * 0.5);
 
@@ -269,24 +557,46 @@ static void effect_tube_distortion_process(void) {
  * A multiband compressor applies compression (dynamics processing) to 
  * different frequency bands of the original signal.  This enables different
  * compression parameters to be used on different bands of the signal.  This
- * implmentation uses just two bands.  The bands are split using a low-pass
- * filter and a high-pass filter with the same cutoff frequency.  The cutoff 
- * frequency is modifiable and one of the parameters.
+ * implementation uses four bands split with a Linkwitz-Riley crossover at
+ * 150Hz, 800Hz and 4kHz.  The crossover itself sums back flat, but the
+ * default band gains in effect_multiband_compressor.c lift the low band by
+ * 1.4x and the compressors add 2x make-up gain, so the effect is louder and
+ * bass heavier than bypass even before the compressors start working.
+ * 
+ * The threshold and ratio pots set all four bands at once.  Each band applies
+ * its own offset to the threshold and scale to the ratio so the low end is
+ * compressed harder than the top.
  * 
  * In general, compressors are used to increase the perceived sustain of an 
  * instrument and work very well in particular with acoustic guitars.
  * 
- * POT/HADC0 : the cross-over frequency (Hz) ranging from 100-600Hz
- * POT/HADC1 : the compressor threshold
+ * POT/HADC0 : the compressor threshold (0 -> -50 dB)
+ * POT/HADC1 : the compressor ratio (1:1 -> 20:1)
  * POT/HADC2 : the output gain of the compressor
  * 
  * Some fun things to try:
  *  - There are several additional parameters that can be modified in the 
  *    setup routine in effect_multiband_compressor.c.  Try playing around
  *    with different settings.    
+ *  - Try 3 or 5 bands, or use multiband_comp_change_band_thresh() to set
+ *    the bands individually
  * 
  */
 MULTIBAND_COMPRESSOR multiband_comp_l, multiband_comp_r;
+#define MULTIBAND_COMP_NUM_BANDS	(4)
+const float multiband_comp_xover_freqs[MULTIBAND_COMP_NUM_BANDS-1] = { 150.0, 800.0, 4000.0 };
+
+EFFECT_GRAPH multiband_comp_graph;
+const EFFECT_GRAPH_NODE multiband_comp_nodes[] = {
+	{ node_multiband_comp, &multiband_comp_l, 1, 1, true },
+	{ node_multiband_comp, &multiband_comp_r, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE multiband_comp_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 1, 1, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
 
 /**
  * @brief Setup routine to initialize instances of the multiband compressor
@@ -295,39 +605,34 @@ static void effect_multiband_compressor_setup(void) {
 
 	// Initialize effect instances for left and right channels
 	multiband_comp_setup(&multiband_comp_l,
-						 200.0,	
+						 MULTIBAND_COMP_NUM_BANDS,
+						 multiband_comp_xover_freqs,
 					 	 -40.0,
 						 AUDIO_SAMPLE_RATE);
 
 	multiband_comp_setup(&multiband_comp_r,
-						 200.0,
+						 MULTIBAND_COMP_NUM_BANDS,
+						 multiband_comp_xover_freqs,
 					 	 -40.0,
 						 AUDIO_SAMPLE_RATE);
 
+	preset_graph_setup(&multiband_comp_graph,
+					   multiband_comp_nodes, PRESET_NUM_NODES(multiband_comp_nodes),
+					   multiband_comp_edges, PRESET_NUM_EDGES(multiband_comp_edges));
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Update some modifiable parameters via the pots
  */
-static void effect_multiband_compressor_process(void) {
-
-	multiband_comp_read(&multiband_comp_l,
-			            audio_effects_left_in,
-			            audio_effects_left_out,
-			            AUDIO_BLOCK_SIZE);
+static void effect_multiband_compressor_control(void) {
 
-	multiband_comp_read(&multiband_comp_r,
-			            audio_effects_right_in,
-			            audio_effects_right_out,
-			            AUDIO_BLOCK_SIZE);
+	// Use pot (HADC0) to set compressor threshold (dB)
+	multiband_comp_change_thresh(&multiband_comp_l, -50.0*multicore_data->audioproj_fin_pot_hadc0);
+	multiband_comp_change_thresh(&multiband_comp_r, -50.0*multicore_data->audioproj_fin_pot_hadc0);
 
-	// Use pot (HADC0) set the cross-over frequency in Hz
-	multiband_comp_change_xover(&multiband_comp_l, 100.0+600.0*multicore_data->audioproj_fin_pot_hadc0);
-	multiband_comp_change_xover(&multiband_comp_r, 100.0+600.0*multicore_data->audioproj_fin_pot_hadc0);
-
-	// Use pot (HADC1) to set compressor threshold (dB)
-	multiband_comp_change_thresh(&multiband_comp_l, -50.0*multicore_data->audioproj_fin_pot_hadc1);
-	multiband_comp_change_thresh(&multiband_comp_r, -50.0*multicore_data->audioproj_fin_pot_hadc1);
+	// Use pot (HADC1) to set compressor ratio
+	multiband_comp_change_ratio(&multiband_comp_l, 1.0+19.0*multicore_data->audioproj_fin_pot_hadc1);
+	multiband_comp_change_ratio(&multiband_comp_r, 1.0+19.0*multicore_data->audioproj_fin_pot_hadc1);
 
 	// Use pot (HADC2) to modify the output gain of the compressors
 	multiband_comp_change_gain(&multiband_comp_l, 4.0*multicore_data->audioproj_fin_pot_hadc2);
@@ -357,6 +662,16 @@ static void effect_multiband_compressor_process(void) {
 
 STEREO_FLANGER flanger;
 
+EFFECT_GRAPH flanger_graph;
+const EFFECT_GRAPH_NODE flanger_nodes[] = {
+	{ node_flanger, &flanger, 1, 2, false }
+};
+const EFFECT_GRAPH_EDGE flanger_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 1, EFFECT_GRAPH_OUT, 1 }
+};
+
 /**
  * @brief Setup routine to initialize instance of the stereo flanger
  */
@@ -365,19 +680,15 @@ static void effect_flanger_setup(void) {
 	// Initialize effect instance
 	flanger_setup(&flanger, 0.5, 0.5, 0.5, AUDIO_SAMPLE_RATE);
 
+	preset_graph_setup(&flanger_graph,
+					   flanger_nodes, PRESET_NUM_NODES(flanger_nodes),
+					   flanger_edges, PRESET_NUM_EDGES(flanger_edges));
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Update some modifiable parameters via the pots
  */
-static void effect_flanger_process(void) {
-
-	// Apply effect
-	flanger_read(&flanger,
-				 audio_effects_left_in,
-				 audio_effects_left_out,
-				 audio_effects_right_out,
-				 AUDIO_BLOCK_SIZE);
+static void effect_flanger_control(void) {
 
 	// Use pot (HADC0) to set the flanger rate in Hz
 	flanger_modify_rate(&flanger, 2.0 * multicore_data->audioproj_fin_pot_hadc0);
@@ -396,8 +707,8 @@ static void effect_flanger_process(void) {
  * 6 - GUITAR SYNTH
  * 
  * The guitar synth effect attempts to determine which note has been played
- * by examining the periodicity of the waveform using the zero_crossing_detector
- * audio element.  Based on the detected frequency, it then generates tones using 
+ * by examining the periodicity of the waveform using the pitch_detector
+ * audio element (the zero_crossing_detector can be selected instead).  Based on the detected frequency, it then generates tones using 
  * the simple_synth audio element.
  * 
  * POT/HADC0 : clean guitar mix
@@ -413,6 +724,19 @@ static void effect_flanger_process(void) {
  */
 GUITAR_SYNTH guitar_synth;
 
+// The input is gated so noise between notes doesn't retrigger the synth
+EFFECT_GRAPH guitar_synth_graph;
+const EFFECT_GRAPH_NODE guitar_synth_nodes[] = {
+	{ node_noise_gate, &noise_gate_core1_shared, 1, 1, true },
+	{ node_guitar_synth, &guitar_synth, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE guitar_synth_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, 1, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
 /**
  * @brief Setup routine to initialize instance of the guitar synth
  */
@@ -424,20 +748,18 @@ static void effect_guitar_synth_setup(void) {
 				   	   0.5,
 				       AUDIO_SAMPLE_RATE);
 
+	// Use the NSDF pitch detector rather than zero-crossing period tracking
+	guitar_synth_select_detector(&guitar_synth, GUITAR_SYNTH_DETECT_NSDF);
+
+	preset_graph_setup(&guitar_synth_graph,
+					   guitar_synth_nodes, PRESET_NUM_NODES(guitar_synth_nodes),
+					   guitar_synth_edges, PRESET_NUM_EDGES(guitar_synth_edges));
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Update some modifiable parameters via the pots
  */
-static void effect_guitar_synth_process(void) {
-
-	// Apply effect
-	guitar_synth_read(&guitar_synth,
-					  audio_effects_left_in,
-					  audio_effects_left_out,
-					  AUDIO_BLOCK_SIZE);
-
-	copy_buffer(audio_effects_left_out, audio_effects_right_out, AUDIO_BLOCK_SIZE);
+static void effect_guitar_synth_control(void) {
 
 	// Use pot (HADC0) to set the clean mix
 	guitar_synth_modify_clean_mix(&guitar_synth, multicore_data->audioproj_fin_pot_hadc0);
@@ -468,6 +790,16 @@ static void effect_guitar_synth_process(void) {
  */
 AUTOWAH autowah;
 
+EFFECT_GRAPH autowah_graph;
+const EFFECT_GRAPH_NODE autowah_nodes[] = {
+	{ node_autowah, &autowah, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE autowah_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
 /**
  * @brief Setup routine to initialize instance of the autowah
  */
@@ -479,20 +811,15 @@ static void effect_autowah_setup(void) {
 				  multicore_data->audioproj_fin_pot_hadc1,
 				  AUDIO_SAMPLE_RATE);
 
+	preset_graph_setup(&autowah_graph,
+					   autowah_nodes, PRESET_NUM_NODES(autowah_nodes),
+					   autowah_edges, PRESET_NUM_EDGES(autowah_edges));
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Update some modifiable parameters via the pots
  */
-static void effect_autowah_process(void) {
-
-	// Apply effect
-	autowah_read(&autowah,
-				  audio_effects_left_in,
-				  audio_effects_left_out,
-				  AUDIO_BLOCK_SIZE);
-
-	copy_buffer(audio_effects_left_out, audio_effects_right_out, AUDIO_BLOCK_SIZE);
+static void effect_autowah_control(void) {
 
 	// Use pot (HADC0) to set the depth (i.e. frequency range of sweep)
 	autowah_modify_depth(&autowah, multicore_data->audioproj_fin_pot_hadc0);
@@ -527,7 +854,29 @@ DELAY_LPF delay_l_fx1, delay_r_fx1;
 #define FX_DELAY_LEN	(32000)
 float section("seg_sdram") delay_line_l_fx1[INT_DELAY_LEN];		// Delay line in SDRAM
 float section("seg_sdram") delay_line_r_fx1[INT_DELAY_LEN];		// Delay line in SDRAM
-
+GATED_DISTORTION gated_tube_dist_fx1 = { &noise_gate_core1_shared, &tube_dist_fx1 };
+
+// The flanger and delays still run when the gate is closed so their tails
+// ring out.  The delays run in place in the output buffers.
+EFFECT_GRAPH multifx_1_graph;
+const EFFECT_GRAPH_NODE multifx_1_nodes[] = {
+	{ node_gated_distortion, &gated_tube_dist_fx1, 1, 1, true },
+	{ node_flanger, &flanger_fx1, 1, 2, false },
+	{ node_delay, &delay_l_fx1, 1, 1, true },
+	{ node_delay, &delay_r_fx1, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE multifx_1_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, 1, 0 },
+	{ 1, 0, 2, 0 },
+	{ 1, 1, 3, 0 },
+	{ 2, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 3, 0, EFFECT_GRAPH_OUT, 1 }
+};
+const EFFECT_PRESET_BUFFER multifx_1_buffers[] = {
+	{ delay_line_l_fx1, sizeof(delay_line_l_fx1) },
+	{ delay_line_r_fx1, sizeof(delay_line_r_fx1) }
+};
 
 /**
  * @brief Setup routine to initialize instances for the multli-effects example
@@ -538,20 +887,25 @@ static void multifx_1_test_setup(void) {
 	// Initialize effect instance
 	flanger_setup(&flanger_fx1, 0.3, 0.2, -0.35, AUDIO_SAMPLE_RATE);
 
+	// Drive the flanger from a pair of linked LFOs in the shared bank
+	lfo_bank_configure(&lfo_bank_core1, 0, LFO_BANK_SIN, 0.2, 0.0);
+	lfo_bank_link(&lfo_bank_core1, 1, LFO_BANK_SIN, 0, 0.5);
+	flanger_subscribe_lfo(&flanger_fx1, &lfo_bank_core1, 0, 1);
+
 	tube_distortion_setup(&tube_dist_fx1,
 						  multicore_data->audioproj_fin_pot_hadc1 * 128.0,
 						  0.20,
 						  0.9,
 						  AUDIO_SAMPLE_RATE);
 
-	delay_setup(&delay_l_fx1,
+	delay_setup_cleared(&delay_l_fx1,
 				delay_line_l_fx1,
 				FX_DELAY_LEN,
 				FX_DELAY_LEN-1000,
 				0.3,
 				0.6,
 				0.2);
-	delay_setup(&delay_r_fx1,
+	delay_setup_cleared(&delay_r_fx1,
 				delay_line_r_fx1,
 				FX_DELAY_LEN,
 				FX_DELAY_LEN,
@@ -559,41 +913,15 @@ static void multifx_1_test_setup(void) {
 				0.6,
 				0.2);
 
-
+	preset_graph_setup(&multifx_1_graph,
+					   multifx_1_nodes, PRESET_NUM_NODES(multifx_1_nodes),
+					   multifx_1_edges, PRESET_NUM_EDGES(multifx_1_edges));
 }
 
 /**
- * @brief: Process audio and update some modifiable parameters via the pots
+ * @brief: Update some modifiable parameters via the pots
  */
-static void multifx_1_test_process(void) {
-
-	// Apply effects
-	float temp_1[AUDIO_BLOCK_SIZE],  temp_2[AUDIO_BLOCK_SIZE];
-
-	// Apply distortion
-	tube_distortion_read(&tube_dist_fx1,
-						 audio_effects_left_in,
-						 temp_1,
-						 AUDIO_BLOCK_SIZE);
-
-	// Apply tremelo
-	flanger_read(&flanger_fx1,
-				 temp_1,
-				 audio_effects_left_out,
-				 audio_effects_right_out,
-				 AUDIO_BLOCK_SIZE);
-
-	// Apply delay / echo
-	delay_read(&delay_l_fx1,
-			   audio_effects_left_out,
-			   audio_effects_left_out,
-			   AUDIO_BLOCK_SIZE);
-
-	delay_read(&delay_r_fx1,
-			   audio_effects_right_out,
-			   audio_effects_right_out,
-			   AUDIO_BLOCK_SIZE);
-
+static void multifx_1_test_control(void) {
 
 	// Use pot (HADC0) to modify the flanger depth
 	flanger_modify_depth(&flanger_fx1, multicore_data->audioproj_fin_pot_hadc0);
@@ -629,6 +957,16 @@ static void multifx_1_test_process(void) {
  */
 RING_MODULATOR ring_mod;
 
+EFFECT_GRAPH ringmod_graph;
+const EFFECT_GRAPH_NODE ringmod_nodes[] = {
+	{ node_ring_modulator, &ring_mod, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE ringmod_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
 /**
  * @brief Setup routine to initialize instance of the ring modulator
  */
@@ -640,20 +978,15 @@ static void effect_ringmod_setup(void) {
 						 0.5,
 						 AUDIO_SAMPLE_RATE);
 
+	preset_graph_setup(&ringmod_graph,
+					   ringmod_nodes, PRESET_NUM_NODES(ringmod_nodes),
+					   ringmod_edges, PRESET_NUM_EDGES(ringmod_edges));
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Update some modifiable parameters via the pots
  */
-static void effect_ringmod_process(void) {
-
-	// Apply effect
-	ring_modulator_read(&ring_mod,
-					    audio_effects_left_in,
-					    audio_effects_left_out,
-					    AUDIO_BLOCK_SIZE);
-
-	copy_buffer(audio_effects_left_out, audio_effects_right_out, AUDIO_BLOCK_SIZE);
+static void effect_ringmod_control(void) {
 
 	// Use pot (HADC0) to set the modulation frequency
 	ring_modulator_modify_freq(&ring_mod, 50.0+300.0*multicore_data->audioproj_fin_pot_hadc0);
@@ -665,7 +998,508 @@ static void effect_ringmod_process(void) {
 }
 
 
+/**
+ * 10 - FREQUENCY SHIFTER
+ * 
+ * A frequency shifter moves every frequency in the signal by the same number
+ * of Hz.  Small shifts (a few Hz) create a slow, swirling phaser-like sound
+ * while larger shifts produce inharmonic, metallic tones.  Unlike the ring
+ * modulator, only a single sideband is produced.
+ * 
+ * The left output is shifted up and the right output is shifted down by the
+ * same amount, which gives a wide stereo image.
+ * 
+ * POT/HADC0 : frequency shift (0->500.0 Hz)
+ * POT/HADC1 : mix
+ * POT/HADC2 : nothing
+ * 
+ * Some fun things to try:
+ *  - Set the shift to 1-2 Hz for a barber pole phaser sound
+ *
+ */
+FREQ_SHIFTER freq_shifter_up, freq_shifter_down;
+
+EFFECT_GRAPH freq_shifter_graph;
+const EFFECT_GRAPH_NODE freq_shifter_nodes[] = {
+	{ node_freq_shifter, &freq_shifter_up, 1, 1, true },
+	{ node_freq_shifter, &freq_shifter_down, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE freq_shifter_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 0, 1, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
+/**
+ * @brief Setup routine to initialize instances of the frequency shifter
+ */
+static void effect_freq_shifter_setup(void) {
+
+	// Initialize effect instances
+	freq_shifter_setup(&freq_shifter_up, 5.0, 0.5, AUDIO_SAMPLE_RATE);
+	freq_shifter_setup(&freq_shifter_down, -5.0, 0.5, AUDIO_SAMPLE_RATE);
+
+	preset_graph_setup(&freq_shifter_graph,
+					   freq_shifter_nodes, PRESET_NUM_NODES(freq_shifter_nodes),
+					   freq_shifter_edges, PRESET_NUM_EDGES(freq_shifter_edges));
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_freq_shifter_control(void) {
+
+	// Use pot (HADC0) to set the frequency shift
+	freq_shifter_modify_shift(&freq_shifter_up, 500.0*multicore_data->audioproj_fin_pot_hadc0);
+	freq_shifter_modify_shift(&freq_shifter_down, -500.0*multicore_data->audioproj_fin_pot_hadc0);
+
+	// Use pot (HADC1) to set the mix of the effect
+	freq_shifter_modify_mix(&freq_shifter_up, multicore_data->audioproj_fin_pot_hadc1);
+	freq_shifter_modify_mix(&freq_shifter_down, multicore_data->audioproj_fin_pot_hadc1);
+
+}
+
+
+/**
+ * 11 - HARMONIZER
+ *
+ * A harmonizer adds pitch shifted copies of the input at musical intervals.
+ * This preset adds a voice a third above and a voice a fifth above, and the
+ * interval of the first voice can be changed with a pot.
+ *
+ * Two algorithms are available.  The granular shifter has very little
+ * latency (~15 ms) which makes it easy to play along with.  The phase vocoder
+ * is smoother on chords but adds ~21 ms of latency to the whole output.
+ *
+ * POT/HADC0 : mix
+ * POT/HADC1 : interval of the first voice (-12->+12 semitones)
+ * POT/HADC2 : algorithm (granular below half way, phase vocoder above)
+ *
+ * Some fun things to try:
+ *  - Set the first voice to -12 for an octave down "bass" voice
+ *  - Compare the two algorithms while playing chords
+ *
+ */
+#define HARMONIZER_NUM_VOICES	(2)
+#define HARMONIZER_PRESET		(11)
+#define HARMONIZER_MODE_HYST	(0.05)	// Keeps a pot near half way from flipping the algorithm
+
+HARMONIZER harmonizer;
+
+EFFECT_GRAPH harmonizer_graph;
+const EFFECT_GRAPH_NODE harmonizer_nodes[] = {
+	{ node_harmonizer, &harmonizer, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE harmonizer_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
+/**
+ * @brief Setup routine to initialize instance of the harmonizer
+ */
+static void effect_harmonizer_setup(void) {
+
+	const float intervals[HARMONIZER_NUM_VOICES] = {4.0, 7.0};
+
+	// Initialize effect instance
+	harmonizer_setup(&harmonizer,
+					 HARMONIZER_MODE_GRANULAR,
+					 HARMONIZER_NUM_VOICES,
+					 intervals,
+					 0.5,
+					 AUDIO_SAMPLE_RATE);
+
+	preset_graph_setup(&harmonizer_graph,
+					   harmonizer_nodes, PRESET_NUM_NODES(harmonizer_nodes),
+					   harmonizer_edges, PRESET_NUM_EDGES(harmonizer_edges));
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_harmonizer_control(void) {
+
+	// Use pot (HADC2) to select the algorithm.  The switch itself is done in
+	// audio_effects_background_core1() as it clears the new mode's state.
+	float algorithm = multicore_data->audioproj_fin_pot_hadc2;
+	if (harmonizer.mode_requested == HARMONIZER_MODE_GRANULAR) {
+		if (algorithm > 0.5 + HARMONIZER_MODE_HYST) {
+			harmonizer_modify_mode(&harmonizer, HARMONIZER_MODE_PHASE_VOCODER);
+		}
+	}
+	else if (algorithm < 0.5 - HARMONIZER_MODE_HYST) {
+		harmonizer_modify_mode(&harmonizer, HARMONIZER_MODE_GRANULAR);
+	}
+
+	// Use pot (HADC0) to set the mix of the effect
+	harmonizer_modify_mix(&harmonizer, multicore_data->audioproj_fin_pot_hadc0);
+
+	// Use pot (HADC1) to set the interval of the first voice in whole semitones
+	harmonizer_modify_interval(&harmonizer, 0, roundf(-12.0 + 24.0*multicore_data->audioproj_fin_pot_hadc1));
+
+}
+
+
+/**
+ * 12 - PHASER
+ *
+ * A phaser sweeps a set of notches up and down the spectrum by running the
+ * signal through a chain of allpass filters and mixing it with the dry
+ * signal.  It's a subtler, more "liquid" sound than the flanger.
+ *
+ * This preset uses 8 stages (4 notches) and the left and right channels
+ * sweep 90 degrees apart.
+ *
+ * POT/HADC0 : rate (0.05->4.0 Hz)
+ * POT/HADC1 : feedback (0->0.9)
+ * POT/HADC2 : depth
+ *
+ * Some fun things to try:
+ *  - Try 4 stages for a classic "Phase 90" style sound or 12 for a deep sweep
+ *  - Use negative feedback for a hollower sound
+ *
+ */
+#define PHASER_STAGES		(8)
+
+PHASER phaser;
+
+EFFECT_GRAPH phaser_graph;
+const EFFECT_GRAPH_NODE phaser_nodes[] = {
+	{ node_phaser, &phaser, 1, 2, false }
+};
+const EFFECT_GRAPH_EDGE phaser_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 1, EFFECT_GRAPH_OUT, 1 }
+};
+
+/**
+ * @brief Setup routine to initialize instance of the phaser
+ */
+static void effect_phaser_setup(void) {
+
+	// Initialize effect instance
+	phaser_setup(&phaser,
+				 PHASER_STAGES,
+				 0.5,		// Rate (Hz)
+				 0.8,		// Depth
+				 0.5,		// Feedback
+				 0.25,		// Stereo phase (cycles)
+				 AUDIO_SAMPLE_RATE);
+
+	// Drive the phaser from a pair of linked LFOs in the shared bank
+	lfo_bank_configure(&lfo_bank_core1, 2, LFO_BANK_SIN, 0.5, 0.0);
+	lfo_bank_link(&lfo_bank_core1, 3, LFO_BANK_SIN, 2, 0.25);
+	phaser_subscribe_lfo(&phaser, &lfo_bank_core1, 2, 3);
+
+	preset_graph_setup(&phaser_graph,
+					   phaser_nodes, PRESET_NUM_NODES(phaser_nodes),
+					   phaser_edges, PRESET_NUM_EDGES(phaser_edges));
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_phaser_control(void) {
+
+	// Use pot (HADC0) to set the rate of the LFOs
+	lfo_bank_modify_rate(&lfo_bank_core1, 2, 0.05 + 3.95*multicore_data->audioproj_fin_pot_hadc0);
+
+	// Use pot (HADC1) to set the feedback
+	phaser_modify_feedback(&phaser, 0.9*multicore_data->audioproj_fin_pot_hadc1);
+
+	// Use pot (HADC2) to set the depth
+	phaser_modify_depth(&phaser, multicore_data->audioproj_fin_pot_hadc2);
+
+}
+
+
+/**
+ * 13 - NOISE REDUCTION
+ *
+ * Spectral noise reduction for removing steady hum and hiss, e.g. from long
+ * microphone cables or noisy pickups.  Press SW3 on the Audio Project Fin
+ * while only the noise is present (stop playing) and the effect will learn
+ * a noise profile over the next second.  Until the first profile is learned
+ * the audio passes straight through.
+ *
+ * The audio is delayed by NOISE_REDUCTION_LATENCY samples (about 13 ms).
+ *
+ * SW3       : learn the noise profile
+ * POT/HADC0 : largest attenuation (0->-40 dB)
+ * POT/HADC1 : oversubtraction (0.5->4.0); higher values remove more noise
+ *             but start to eat into quiet playing
+ *
+ * Some fun things to try:
+ *  - Turn the attenuation right up and listen for "musical noise" as the
+ *    floor disappears
+ *
+ */
+NOISE_REDUCTION noise_reduction;
+
+EFFECT_GRAPH noise_reduction_graph;
+const EFFECT_GRAPH_NODE noise_reduction_nodes[] = {
+	{ node_noise_reduction, &noise_reduction, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE noise_reduction_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
+/**
+ * @brief Setup routine to initialize instance of the noise reduction effect
+ */
+static void effect_noise_reduction_setup(void) {
+
+	// Initialize effect instance
+	noise_reduction_setup(&noise_reduction,
+						  -20.0,	// Floor (dB)
+						  1.0,		// Oversubtraction
+						  AUDIO_BLOCK_SIZE,
+						  AUDIO_SAMPLE_RATE);
+
+	preset_graph_setup(&noise_reduction_graph,
+					   noise_reduction_nodes, PRESET_NUM_NODES(noise_reduction_nodes),
+					   noise_reduction_edges, PRESET_NUM_EDGES(noise_reduction_edges));
+}
+
+/**
+ * @brief Update some modifiable parameters via the switches and pots
+ */
+static void effect_noise_reduction_control(void) {
+
+	// Use the SW3 push button to learn a new noise profile
+	#if SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+		if (multicore_data->audioproj_fin_sw_3_core1_pressed) {
+			multicore_data->audioproj_fin_sw_3_core1_pressed = false;
+			noise_reduction_learn(&noise_reduction);
+		}
+	#endif
+
+	// Use pot (HADC0) to set the largest attenuation
+	noise_reduction_modify_floor(&noise_reduction, -40.0*multicore_data->audioproj_fin_pot_hadc0);
+
+	// Use pot (HADC1) to set the oversubtraction
+	noise_reduction_modify_oversubtraction(&noise_reduction, 0.5 + 3.5*multicore_data->audioproj_fin_pot_hadc1);
+
+}
+
+
+/**
+ * 14 - FEEDBACK SUPPRESSOR
+ *
+ * Automatically notches out acoustic feedback (howling) from a microphone.
+ * The input is analyzed in the background loop and when a steady pure tone
+ * is found, a narrow notch is placed on it.  Notches are deepened if the
+ * feedback continues and are slowly released once it stops.  Each new notch
+ * is reported through the event logger.
+ *
+ * SW3 : remove all notches
+ *
+ * Some fun things to try:
+ *  - Turn a microphone up until it howls and listen to the notches settle in
+ *
+ */
+#define FEEDBACK_SUPPRESSOR_NOTCHES		(12)
+#define FEEDBACK_SUPPRESSOR_PRESET		(14)
+
+FEEDBACK_SUPPRESSOR feedback_suppressor;
+
+// The analysis is done in audio_effects_background_core1() so there is
+// nothing to control per block
+EFFECT_GRAPH feedback_suppressor_graph;
+const EFFECT_GRAPH_NODE feedback_suppressor_nodes[] = {
+	{ node_feedback_suppressor, &feedback_suppressor, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE feedback_suppressor_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
+/**
+ * @brief Setup routine to initialize instance of the feedback suppressor
+ */
+static void effect_feedback_suppressor_setup(void) {
+
+	// Initialize effect instance
+	feedback_suppressor_setup(&feedback_suppressor,
+							  FEEDBACK_SUPPRESSOR_NOTCHES,
+							  -18.0,	// Deepest notch (dB)
+							  1.0,		// Release (dB/sec)
+							  AUDIO_SAMPLE_RATE);
+
+	preset_graph_setup(&feedback_suppressor_graph,
+					   feedback_suppressor_nodes, PRESET_NUM_NODES(feedback_suppressor_nodes),
+					   feedback_suppressor_edges, PRESET_NUM_EDGES(feedback_suppressor_edges));
+}
+
+/**
+ * @brief Background work for the feedback suppressor
+ */
+static void effect_feedback_suppressor_background(void) {
+
+	static uint32_t detections = 0;
+
+	// Use the SW3 push button to remove all notches
+	#if SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+		if (multicore_data->effects_preset == FEEDBACK_SUPPRESSOR_PRESET &&
+			multicore_data->audioproj_fin_sw_3_core1_pressed) {
+			multicore_data->audioproj_fin_sw_3_core1_pressed = false;
+			feedback_suppressor_reset(&feedback_suppressor);
+			log_event(EVENT_INFO, "Feedback suppressor: notches cleared");
+		}
+	#endif
+
+	feedback_suppressor_process(&feedback_suppressor);
+
+	if (feedback_suppressor.detections != detections) {
+		char message[64];
+		detections = feedback_suppressor.detections;
+		sprintf(message, "Feedback suppressor: feedback at %.1f Hz, %u notches",
+				feedback_suppressor.last_detection_freq,
+				(unsigned int)feedback_suppressor.num_active);
+		log_event(EVENT_INFO, message);
+	}
+}
+
+
+/**
+ * 15 - TREMOLO
+ *
+ * A tremolo modulates the volume of the signal with an LFO.  The left and
+ * right channels are modulated 180 degrees apart so the sound also moves
+ * from side to side.
+ *
+ * Both tremolos are driven from the shared LFO bank.  With the square
+ * waveform each edge is ramped over one block (about 0.7ms), which keeps
+ * the "chop" from clicking.
+ *
+ * POT/HADC0 : rate (1.0->12.0 Hz)
+ * POT/HADC1 : depth
+ * POT/HADC2 : waveform (sine in the lower half, square in the upper half)
+ *
+ * Some fun things to try:
+ *  - Sync the LFOs to the tempo with lfo_bank_configure_synced()
+ *  - Subscribe both channels to the same LFO for a mono tremolo
+ *
+ */
+#define TREMELO_LFO_LEFT		(4)
+#define TREMELO_LFO_RIGHT		(5)
+
+TREMELO tremelo_l, tremelo_r;
+
+EFFECT_GRAPH tremelo_graph;
+const EFFECT_GRAPH_NODE tremelo_nodes[] = {
+	{ node_tremelo, &tremelo_l, 1, 1, true },
+	{ node_tremelo, &tremelo_r, 1, 1, true }
+};
+const EFFECT_GRAPH_EDGE tremelo_edges[] = {
+	{ EFFECT_GRAPH_IN, 0, 0, 0 },
+	{ EFFECT_GRAPH_IN, 0, 1, 0 },
+	{ 0, 0, EFFECT_GRAPH_OUT, 0 },
+	{ 1, 0, EFFECT_GRAPH_OUT, 1 }
+};
+
+static LFO_BANK_WAVEFORM tremelo_waveform;
+
+/**
+ * @brief Changes the waveform of the tremolo LFOs
+ *
+ * The phase is kept, and so is the value each LFO's next block ramps from,
+ * so the gain glides to the new waveform over one block rather than jumping.
+ */
+static void tremelo_set_waveform(LFO_BANK_WAVEFORM waveform, float rate_hz) {
+
+	LFO_BANK_LFO * left = &lfo_bank_core1.lfos[TREMELO_LFO_LEFT];
+	LFO_BANK_LFO * right = &lfo_bank_core1.lfos[TREMELO_LFO_RIGHT];
+	float value_left = left->value;
+	float value_right = right->value;
+
+	lfo_bank_configure(&lfo_bank_core1, TREMELO_LFO_LEFT, waveform, rate_hz, left->t);
+	lfo_bank_link(&lfo_bank_core1, TREMELO_LFO_RIGHT, waveform, TREMELO_LFO_LEFT, 0.5);
+	left->value = value_left;
+	right->value = value_right;
+
+	tremelo_waveform = waveform;
+}
+
+/**
+ * @brief Setup routine to initialize instances of the tremolo
+ */
+static void effect_tremelo_setup(void) {
+
+	// Initialize effect instances
+	tremelo_setup(&tremelo_l, 0.7, 5.0, AUDIO_SAMPLE_RATE);
+	tremelo_setup(&tremelo_r, 0.7, 5.0, AUDIO_SAMPLE_RATE);
+
+	// Drive the tremolos from a pair of linked LFOs in the shared bank
+	lfo_bank_configure(&lfo_bank_core1, TREMELO_LFO_LEFT, LFO_BANK_SIN, 5.0, 0.0);
+	lfo_bank_link(&lfo_bank_core1, TREMELO_LFO_RIGHT, LFO_BANK_SIN, TREMELO_LFO_LEFT, 0.5);
+	tremelo_waveform = LFO_BANK_SIN;
+	tremelo_subscribe_lfo(&tremelo_l, &lfo_bank_core1, TREMELO_LFO_LEFT);
+	tremelo_subscribe_lfo(&tremelo_r, &lfo_bank_core1, TREMELO_LFO_RIGHT);
+
+	preset_graph_setup(&tremelo_graph,
+					   tremelo_nodes, PRESET_NUM_NODES(tremelo_nodes),
+					   tremelo_edges, PRESET_NUM_EDGES(tremelo_edges));
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_tremelo_control(void) {
+
+	// Use pot (HADC0) to set the rate of the LFOs
+	float rate_hz = 1.0 + 11.0*multicore_data->audioproj_fin_pot_hadc0;
+	lfo_bank_modify_rate(&lfo_bank_core1, TREMELO_LFO_LEFT, rate_hz);
+
+	// Use pot (HADC1) to set the depth
+	tremelo_modify_depth(&tremelo_l, multicore_data->audioproj_fin_pot_hadc1);
+	tremelo_modify_depth(&tremelo_r, multicore_data->audioproj_fin_pot_hadc1);
+
+	// Use pot (HADC2) to pick the waveform
+	LFO_BANK_WAVEFORM waveform = (multicore_data->audioproj_fin_pot_hadc2 < 0.5) ? LFO_BANK_SIN : LFO_BANK_SQR;
+	if (waveform != tremelo_waveform) {
+		tremelo_set_waveform(waveform, rate_hz);
+	}
+}
+
 
+/**
+ * The core 1 presets, indexed by multicore_data->effects_preset.  Preset 0
+ * (and any preset whose graph didn't compile) bypasses the effects.  The
+ * control function runs before the graph in each block.
+ */
+#define PRESET_BUFFERS(buffers)		buffers, (sizeof(buffers)/sizeof(EFFECT_PRESET_BUFFER))
+
+static const EFFECT_PRESET core1_preset_table[] = {
+	{ NULL,									NULL,									NULL,						NULL, 0 },
+	{ effect_echo_setup,					effect_echo_control,					&echo_graph,				PRESET_BUFFERS(echo_buffers) },
+	{ effect_multitap_delay_setup,			NULL,									&multitap_delay_graph,		PRESET_BUFFERS(multitap_delay_buffers) },
+	{ effect_tube_distortion_setup,			effect_tube_distortion_control,			&tube_distortion_graph,		NULL, 0 },
+	{ effect_multiband_compressor_setup,	effect_multiband_compressor_control,	&multiband_comp_graph,		NULL, 0 },
+	{ effect_flanger_setup,					effect_flanger_control,					&flanger_graph,				NULL, 0 },
+	{ effect_guitar_synth_setup,			effect_guitar_synth_control,			&guitar_synth_graph,		NULL, 0 },
+	{ effect_autowah_setup,					effect_autowah_control,					&autowah_graph,				NULL, 0 },
+	{ multifx_1_test_setup,					multifx_1_test_control,					&multifx_1_graph,			PRESET_BUFFERS(multifx_1_buffers) },
+	{ effect_ringmod_setup,					effect_ringmod_control,					&ringmod_graph,				NULL, 0 },
+	{ effect_freq_shifter_setup,			effect_freq_shifter_control,			&freq_shifter_graph,		NULL, 0 },
+	{ effect_harmonizer_setup,				effect_harmonizer_control,				&harmonizer_graph,			NULL, 0 },
+	{ effect_phaser_setup,					effect_phaser_control,					&phaser_graph,				NULL, 0 },
+	{ effect_noise_reduction_setup,			effect_noise_reduction_control,			&noise_reduction_graph,		NULL, 0 },
+	{ effect_feedback_suppressor_setup,		NULL,									&feedback_suppressor_graph,	NULL, 0 },
+	{ effect_tremelo_setup,					effect_tremelo_control,					&tremelo_graph,				NULL, 0 }
+};
+#define CORE1_TOTAL_PRESETS		(sizeof(core1_preset_table)/sizeof(EFFECT_PRESET))
+
+// Lifecycle of the presets
+EFFECT_PRESETS core1_presets;
+#define PRESET_CLEAR_PER_PASS	(4096)		// Delay line words zeroed per background pass
 
 
 /**
@@ -673,15 +1507,39 @@ static void effect_ringmod_process(void) {
  */
 void	audio_effects_setup_core1(void) {
 
-	effect_echo_setup();	
-	effect_multitap_delay_setup();
-	effect_multiband_compressor_setup();
-	effect_tube_distortion_setup();
-	effect_flanger_setup();
-	effect_guitar_synth_setup();
-	effect_autowah_setup();
-	multifx_1_test_setup();
-	effect_ringmod_setup();
+	lfo_bank_setup(&lfo_bank_core1, LFO_BANK_TEMPO_BPM, AUDIO_SAMPLE_RATE);
+	agc_setup(&agc_core1,
+			  AGC_LINKED,
+			  AGC_TARGET_DB,
+			  AGC_MAX_GAIN_DB,
+			  AGC_SLEW_DB_PER_SEC,
+			  AGC_NOISE_FLOOR_DB,
+			  AUDIO_SAMPLE_RATE);
+	noise_gate_setup(&noise_gate_core1,
+					 NOISE_GATE_OPEN_DB,
+					 NOISE_GATE_CLOSE_DB,
+					 NOISE_GATE_HOLD_MS,
+					 NOISE_GATE_RELEASE_MS,
+					 NOISE_GATE_LOOKAHEAD_MS,
+					 AUDIO_SAMPLE_RATE);
+
+	// The presets themselves are set up when they're first selected
+	effect_presets_setup(&core1_presets,
+						 core1_preset_table,
+						 CORE1_TOTAL_PRESETS,
+						 preset_graph_in,
+						 preset_graph_out,
+						 2,
+						 PRESET_CLEAR_PER_PASS);
+	effect_presets_modify_crossfade(&core1_presets,
+									(uint32_t)(PRESET_CROSSFADE_MS * 0.001 * AUDIO_SAMPLE_RATE));
+	effect_presets_modify_cycle_budget(&core1_presets,
+									   preset_cycle_counter,
+									   PRESET_CYCLE_BUDGET);
+
+	tuner_setup(&tuner_core1, TUNER_MIN_FREQ, TUNER_MAX_FREQ, TUNER_THRESHOLD, AUDIO_SAMPLE_RATE);
+	multicore_data->tuner_active = false;
+	multicore_data->tuner_locked = false;
 
 }
 
@@ -696,24 +1554,139 @@ void	audio_effects_process_audio_core1(void) {
 	 * On core 1, we'll apply various audio effects and on core 2, we'll do just reverb
 	 */
 
-	static int32_t	core_1_effect_preset = 0;
-	uint32_t core_1_total_presets = 10;
-
-	switch (multicore_data->effects_preset) {
-		case 1: effect_echo_process(); break;
-		case 2: effect_multitap_delay_process(); break;
-		case 3: effect_tube_distortion_process(); break;
-		case 4: effect_multiband_compressor_process(); break;
-		case 5: effect_flanger_process(); break;
-		case 6: effect_guitar_synth_process(); break;
-		case 7: effect_autowah_process(); break;
-		case 8: multifx_1_test_process(); break;
-		case 9: effect_ringmod_process(); break;
-
-		default: effect_bypass(); break;
+	// In tuner mode, feed the raw input to the tuner instead of running the effects
+	bool tuner_requested = tuner_mode_requested();
+	if (tuner_requested != tuner_mode) {
+		if (tuner_requested) {
+			tuner_reset(&tuner_core1);
+		}
+		tuner_mode = tuner_requested;
+		multicore_data->tuner_active = tuner_requested;
+	}
+	if (tuner_mode) {
+		tuner_push(&tuner_core1, audio_effects_left_in, AUDIO_BLOCK_SIZE);
+		#if TUNER_MUTES_OUTPUT
+			clear_buffer(audio_effects_left_out, AUDIO_BLOCK_SIZE);
+			clear_buffer(audio_effects_right_out, AUDIO_BLOCK_SIZE);
+		#else
+			effect_bypass();
+		#endif
+		return;
+	}
+
+	// Bring the inputs to a consistent level and publish the AGC state
+	agc_read(&agc_core1,
+			 audio_effects_left_in,
+			 audio_effects_right_in,
+			 audio_effects_left_in,
+			 audio_effects_right_in,
+			 AUDIO_BLOCK_SIZE);
+
+	multicore_data->agc_level_db_left = agc_core1.level_db[0];
+	multicore_data->agc_level_db_right = agc_core1.level_db[1];
+	multicore_data->agc_gain_db_left = agc_core1.gain_db[0];
+	multicore_data->agc_gain_db_right = agc_core1.gain_db[1];
+	multicore_data->agc_frozen = agc_core1.frozen[0] && agc_core1.frozen[1];
+
+	// Advance the shared LFOs and noise gate once for this block
+	lfo_bank_advance(&lfo_bank_core1, AUDIO_BLOCK_SIZE);
+	core1_block_count++;
+
+	// Run the active preset (crossfading while switching), or bypass
+	effect_presets_read(&core1_presets, AUDIO_BLOCK_SIZE);
+
+}
+
+
+
+
+/**
+ * @brief Runs the tuner analysis while tuner mode is on
+ */
+static void tuner_background(void) {
+
+	static uint32_t log_count = 0;
+	static int32_t log_note = -1;
+	static float log_cents = 0.0;
+
+	if (!tuner_mode || !tuner_process(&tuner_core1)) {
+		return;
 	}
 
+	// Publish the reading for the ARM core (VU LEDs)
+	multicore_data->tuner_locked = tuner_core1.locked;
+	multicore_data->tuner_note = tuner_core1.note;
+	multicore_data->tuner_cents = tuner_core1.cents;
+	multicore_data->tuner_sequence++;
 
+	// Log the reading when it changes, at most every TUNER_LOG_INTERVAL readings
+	if (++log_count < TUNER_LOG_INTERVAL || !tuner_core1.locked) {
+		return;
+	}
+	if (tuner_core1.note != log_note || fabsf(tuner_core1.cents - log_cents) >= 1.0) {
+		char message[64];
+		log_count = 0;
+		log_note = tuner_core1.note;
+		log_cents = tuner_core1.cents;
+		sprintf(message, "Tuner: %s %+.1f cents (%.2f Hz)",
+				tuner_note_name(tuner_core1.note),
+				tuner_core1.cents,
+				tuner_core1.frequency);
+		log_event(EVENT_INFO, message);
+	}
+}
+
+/**
+ * @brief Switches to the selected preset, setting it up a little at a time
+ */
+static void presets_background(void) {
+
+	static int32_t logged_preset = EFFECT_PRESETS_NONE;
+	static uint32_t logged_passes = 0;
+	static uint32_t logged_shortened = 0;
+
+	effect_presets_select(&core1_presets, multicore_data->effects_preset);
+	effect_presets_process(&core1_presets);
+
+	// Warn when a crossfade had to be cut short to stay within the budget
+	if (core1_presets.crossfades_shortened != logged_shortened) {
+		char message[64];
+		logged_shortened = core1_presets.crossfades_shortened;
+		sprintf(message, "Preset crossfade cut short (%u cycles in one block)",
+				(unsigned int)core1_presets.switch_cycles_peak);
+		log_event(EVENT_WARN, message);
+	}
+
+	// Log each preset as it starts running
+	if (core1_presets.active != logged_preset) {
+		logged_preset = core1_presets.active;
+		if (logged_preset != EFFECT_PRESETS_NONE) {
+			char message[64];
+			sprintf(message, "Preset %d active (%u passes zeroing delay lines)",
+					(int)logged_preset,
+					(unsigned int)(core1_presets.clear_passes - logged_passes));
+			log_event(EVENT_INFO, message);
+		}
+		logged_passes = core1_presets.clear_passes;
+	}
+}
+
+/**
+ * This routine should be called from the background loop in SHARC core 1.  It
+ * sets up the selected preset and runs the analysis for the effects that do
+ * their heavy lifting outside the audio callback.
+ */
+void	audio_effects_background_core1(void) {
+
+	presets_background();
+
+	if (core1_presets.active == FEEDBACK_SUPPRESSOR_PRESET) {
+		effect_feedback_suppressor_background();
+	}
+	if (core1_presets.active == HARMONIZER_PRESET) {
+		harmonizer_process(&harmonizer);
+	}
+	tuner_background();
 }
 
 
@@ -726,12 +1699,34 @@ void	audio_effects_process_audio_core1(void) {
  * conventions so the input and output buffers use the same names.  This makes
  * it easy to move effects from core 1 to core 2 and visa versa.
  *
+ * Changing the reverb preset crossfades over REVERB_CROSSFADE_MS.  Between
+ * two reverb presets the feedback and damping glide to their new values;
+ * to and from preset 0 (bypass) the dry and reverb outputs are crossfaded,
+ * and the reverb keeps running until it has faded out so its tail isn't cut
+ * off.
+ *
  *****************************************************************************/
 
 
 // Instances
 STEREO_REVERB reverb_stereo;
 COMPRESSOR	limiter_l, limiter_r;
+EARLY_REFLECTIONS early_reflections;
+
+// Delay line for the early reflections (long enough for the hall geometry)
+#define EARLY_REFLECTIONS_LEN	(8192)
+float section("seg_sdram") early_reflections_line[EARLY_REFLECTIONS_LEN];
+
+// Reverb presets (preset 0 bypasses the reverb)
+static const float reverb_feedback[] = { 0.0, 0.9, 0.8, 0.95, 0.8, 0.9, 0.95, 0.7, 0.9, 0.97 };
+static const float reverb_dampening[] = { 0.0, 0.1, 0.2, 0.2, 0.3, 0.3, 0.3, 0.4, 0.4, 0.4 };
+#define REVERB_TOTAL_PRESETS	(sizeof(reverb_feedback)/sizeof(float))
+
+// Crossfade between reverb presets
+CROSSFADE reverb_crossfade;
+#define REVERB_CROSSFADE_MS		(300.0)
+static uint32_t reverb_preset_from = 0;
+static uint32_t reverb_preset_to = 0;
 
 /**
  * @brief  Set up routines for any effects running on core 2
@@ -742,9 +1737,23 @@ void	audio_effects_setup_core2(void) {
 	compressor_setup(&limiter_l, -6.0, 1000.0, 5, 5, 1.0, AUDIO_SAMPLE_RATE );
 	compressor_setup(&limiter_r, -6.0, 1000.0, 5, 5, 1.0, AUDIO_SAMPLE_RATE );
 
+	// Early reflections ahead of the reverb tail
+	early_reflections_setup(&early_reflections,
+							early_reflections_line,
+							EARLY_REFLECTIONS_LEN,
+							EARLY_REFLECTIONS_ROOM_MEDIUM,
+							32,
+							0.3,
+							AUDIO_SAMPLE_RATE);
+
 	// Stereo reverb
 	reverb_setup( &reverb_stereo,  0.3, 1.0, 0.92, 0.2);
 
+	// Dry and reverb outputs are correlated (the reverb includes the dry signal)
+	crossfade_setup(&reverb_crossfade,
+					CROSSFADE_LINEAR,
+					(uint32_t)(REVERB_CROSSFADE_MS * 0.001 * AUDIO_SAMPLE_RATE));
+
 }
 
 
@@ -754,27 +1763,70 @@ void	audio_effects_setup_core2(void) {
  */
 void	audio_effects_process_audio_core2(void) {
 
-	float reverb_feedback[10] = { 0.0, 0.9, 0.8, 0.95, 0.8, 0.9, 0.95, 0.7, 0.9, 0.97 };
-	float reverb_dampening[10] = { 0.0, 0.1, 0.2, 0.2, 0.3, 0.3, 0.3, 0.4, 0.4, 0.4 };
+	// Start crossfading to a new preset (a change made during a crossfade
+	// waits until it has finished)
+	uint32_t preset = multicore_data->reverb_preset;
+	if (preset >= REVERB_TOTAL_PRESETS) {
+		preset = 0;
+	}
+	if (preset != reverb_preset_to && !crossfade_active(&reverb_crossfade)) {
+		reverb_preset_from = reverb_preset_to;
+		reverb_preset_to = preset;
+		crossfade_start(&reverb_crossfade);
+	}
 
-	reverb_change_feedback( &reverb_stereo, reverb_feedback[multicore_data->reverb_preset]);
-	reverb_change_lp_damp_coeff(&reverb_stereo, reverb_dampening[multicore_data->reverb_preset]);
+	bool fading = crossfade_active(&reverb_crossfade);
+	bool wet_from = (reverb_preset_from != 0);
+	bool wet_to = (reverb_preset_to != 0);
 
-	if (multicore_data->reverb_preset == 0) {
+	// The reverb runs while either preset in the crossfade uses it
+	if (!wet_to && !(fading && wet_from)) {
 		effect_bypass();
 	} else {
 
+		// Glide the feedback and damping from the old preset to the new one
+		uint32_t from = wet_from ? reverb_preset_from : reverb_preset_to;
+		uint32_t to = wet_to ? reverb_preset_to : reverb_preset_from;
+		float pos = crossfade_position(&reverb_crossfade);
+		reverb_change_feedback(&reverb_stereo,
+							   reverb_feedback[from] + (reverb_feedback[to] - reverb_feedback[from]) * pos);
+		reverb_change_lp_damp_coeff(&reverb_stereo,
+									reverb_dampening[from] + (reverb_dampening[to] - reverb_dampening[from]) * pos);
+
 		// Apply limiter at -6dB to avoid clipping from earlier stage effects
 		compressor_read(&limiter_l, audio_effects_left_out, audio_effects_left_out, AUDIO_BLOCK_SIZE);
 		compressor_read(&limiter_r, audio_effects_left_out, audio_effects_left_out, AUDIO_BLOCK_SIZE);
 
-		// Apply stereo reverb effect
+		// Add early reflections to the stereo input
+		float er_left[AUDIO_BLOCK_SIZE], er_right[AUDIO_BLOCK_SIZE];
+		early_reflections_read_stereo(&early_reflections,
+									  audio_effects_left_in,
+									  audio_effects_right_in,
+									  er_left,
+									  er_right,
+									  AUDIO_BLOCK_SIZE);
+
+		// Apply true-stereo reverb effect
 		reverb_read(&reverb_stereo,
-					audio_effects_left_in,
+					er_left,
+					er_right,
 					audio_effects_left_out,
 					audio_effects_right_out,
 					AUDIO_BLOCK_SIZE);
 
+		// Crossfade to or from the dry input (between two reverb presets the
+		// old and new signals are the same and this just moves the fade on)
+		if (fading) {
+			float * dry[2] = { audio_effects_left_in, audio_effects_right_in };
+			float * wet[2] = { audio_effects_left_out, audio_effects_right_out };
+			crossfade_read(&reverb_crossfade,
+						   wet_from ? wet : dry,
+						   wet_to ? wet : dry,
+						   wet,
+						   2,
+						   AUDIO_BLOCK_SIZE);
+		}
+
 	}
 
 }
@@ -17,13 +17,29 @@
 
 #include "audio_processing/audio_elements/allpass_filter.h"
 #include "audio_processing/audio_elements/amplitude_modulation.h"
+#include "audio_processing/audio_elements/automatic_gain_control.h"
 #include "audio_processing/audio_elements/biquad_filter.h"
+#include "audio_processing/audio_elements/chorus_ensemble.h"
 #include "audio_processing/audio_elements/clickless_volume_ctrl.h"
 #include "audio_processing/audio_elements/compressor.h"
+#include "audio_processing/audio_elements/crossfade.h"
+#include "audio_processing/audio_elements/delay_line_storage.h"
+#include "audio_processing/audio_elements/early_reflections.h"
+#include "audio_processing/audio_elements/effect_graph.h"
+#include "audio_processing/audio_elements/effect_presets.h"
+#include "audio_processing/audio_elements/envelope_follower.h"
+#include "audio_processing/audio_elements/feedback_suppressor.h"
 #include "audio_processing/audio_elements/integer_delay_lpf.h"
 #include "audio_processing/audio_elements/integer_delay_multitap.h"
+#include "audio_processing/audio_elements/lfo_bank.h"
+#include "audio_processing/audio_elements/linkwitz_riley_crossover.h"
+#include "audio_processing/audio_elements/modulated_delay_multitap.h"
+#include "audio_processing/audio_elements/noise_gate.h"
 #include "audio_processing/audio_elements/oscillators.h"
+#include "audio_processing/audio_elements/pitch_detector.h"
+#include "audio_processing/audio_elements/quadrature_oscillator.h"
 #include "audio_processing/audio_elements/simple_synth.h"
+#include "audio_processing/audio_elements/tuner.h"
 #include "audio_processing/audio_elements/variable_delay.h"
 #include "audio_processing/audio_elements/zero_crossing_detector.h"
 
@@ -36,6 +52,10 @@
 #include "audio_processing/audio_effects/effect_multiband_compressor.h"
 #include "audio_processing/audio_effects/effect_tremelo.h"
 #include "audio_processing/audio_effects/effect_ring_modulator.h"
+#include "audio_processing/audio_effects/effect_frequency_shifter.h"
+#include "audio_processing/audio_effects/effect_harmonizer.h"
+#include "audio_processing/audio_effects/effect_phaser.h"
+#include "audio_processing/audio_effects/effect_noise_reduction.h"
 
 // Audio buffers to pass audio to and from the effects
 extern float	audio_effects_left_in[];
@@ -54,6 +74,8 @@ void 	audio_effects_setup_core2();
 void 	audio_effects_process_audio_core1();
 void 	audio_effects_process_audio_core2();
 
+void 	audio_effects_background_core1();
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,7 @@ RESULT_ALLPASS_FILTER   allpass_setup(ALLPASS_FILTER * c,
     // Set delay line
     c->delay_line = delay_buffer;
     c->delay_line_size = delay_buffer_size;
+    c->length = delay_buffer_size;
     c->index = 0;
 
     // Set gain parameter
@@ -100,3 +101,67 @@ void    allpass_read(ALLPASS_FILTER * c,
 
     c->index = indx;
 }
+
+/**
+ * @brief Apply a pair of all-pass filters (e.g. left and right) to a block of
+ * audio data
+ *
+ * Both filters are processed in the same loop so the two independent
+ * channels can be interleaved by the compiler.
+ *
+ * @param c_left Pointer to instance structure of first filter
+ * @param c_right Pointer to instance structure of second filter
+ * @param audio_in_left Pointer to floating point audio input buffer (first filter)
+ * @param audio_in_right Pointer to floating point audio input buffer (second filter)
+ * @param audio_out_left Pointer to floating point output buffer (first filter)
+ * @param audio_out_right Pointer to floating point output buffer (second filter)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    allpass_read_stereo(ALLPASS_FILTER * c_left,
+                            ALLPASS_FILTER * c_right,
+                            float * audio_in_left,
+                            float * audio_in_right,
+                            float * audio_out_left,
+                            float * audio_out_right,
+                            uint32_t audio_block_size) {
+
+    // Fall back to processing each filter separately if either isn't set up
+    if (c_left == NULL || !c_left->initialized ||
+        c_right == NULL || !c_right->initialized) {
+        allpass_read(c_left, audio_in_left, audio_out_left, audio_block_size);
+        allpass_read(c_right, audio_in_right, audio_out_right, audio_block_size);
+        return;
+    }
+
+    float   * buffer_l = c_left->delay_line;
+    float   * buffer_r = c_right->delay_line;
+    int     indx_l = c_left->index;
+    int     indx_r = c_right->index;
+    int     len_l = c_left->length;
+    int     len_r = c_right->length;
+    float   gain_l = c_left->gain;
+    float   gain_r = c_right->gain;
+    float   in_l, in_r, out_l, out_r;
+
+    for (int i=0;i<audio_block_size;i++)
+    {
+        in_l = audio_in_left[i];
+        in_r = audio_in_right[i];
+
+        out_l = -in_l*gain_l + buffer_l[indx_l];
+        out_r = -in_r*gain_r + buffer_r[indx_r];
+        buffer_l[indx_l] = in_l+(buffer_l[indx_l]*gain_l);
+        buffer_r[indx_r] = in_r+(buffer_r[indx_r]*gain_r);
+        audio_out_left[i] = out_l;
+        audio_out_right[i] = out_r;
+
+        indx_l++;
+        if (indx_l>=len_l) indx_l = 0;
+        indx_r++;
+        if (indx_r>=len_r) indx_r = 0;
+    }
+
+    c_left->index = indx_l;
+    c_right->index = indx_r;
+}
@@ -48,6 +48,14 @@ void    allpass_read(ALLPASS_FILTER * C,
                      float * audio_out,
                      uint32_t audio_block_size);
 
+void    allpass_read_stereo(ALLPASS_FILTER * c_left,
+                            ALLPASS_FILTER * c_right,
+                            float * audio_in_left,
+                            float * audio_in_right,
+                            float * audio_out_left,
+                            float * audio_out_right,
+                            uint32_t audio_block_size);
+
 
 // Wrapper allows C code to be called from C++ files
 #if __cplusplus
@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * Automatic gain control (AGC) brings an input to a consistent level.  Input
+ * levels from the ADAU1761, A2B and SPDIF inputs vary widely while the
+ * thresholds used by the effects (the distortion clip level, the noise gate,
+ * the zero-crossing detector's minimum amplitude) assume a fixed level.
+ * Running the inputs through an AGC first keeps those thresholds meaningful.
+ *
+ * How it works:
+ *
+ *  - A slow RMS detector (an envelope follower in log mode with a few
+ *    hundred milliseconds of averaging) measures the level of each channel.
+ *  - Every AGC_CONTROL_PERIOD samples, the gain needed to bring that level to
+ *    the target is calculated and limited to +/- max_gain_db.
+ *  - The gain moves towards this value no faster than the slew limit (in
+ *    dB/second) so the AGC adjusts gently rather than pumping like a
+ *    compressor.
+ *  - When the level drops below the noise floor (e.g. the guitarist stops
+ *    playing), the gain is frozen so the AGC doesn't slowly turn up the hiss.
+ *  - The gain is ramped linearly at audio rate between control updates.
+ *
+ * In AGC_LINKED mode both channels receive the same gain, driven by the louder
+ * channel, which preserves the stereo image.  In AGC_PER_CHANNEL mode the two
+ * channels are treated as independent (e.g. two different instruments).
+ *
+ * The right channel pointers may be NULL to process a single (mono) channel.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "automatic_gain_control.h"
+
+// Min/max limits and other constants
+#define AGC_TARGET_MIN              (-60.0)
+#define AGC_TARGET_MAX              (0.0)
+#define AGC_MAX_GAIN_MIN            (0.0)
+#define AGC_MAX_GAIN_MAX            (40.0)
+#define AGC_SLEW_MIN                (0.1)       // dB / second
+#define AGC_SLEW_MAX                (60.0)      // dB / second
+#define AGC_NOISE_FLOOR_MIN         (-120.0)
+#define AGC_NOISE_FLOOR_MAX         (-20.0)
+
+#define AGC_CONTROL_PERIOD          (16)        // Samples per gain update
+#define AGC_AVERAGING_MS            (300.0)     // RMS detector time constant
+
+// Static function prototypes
+static void     agc_update_gain(AUTO_GAIN_CONTROL * c,
+                                uint32_t channel,
+                                float level_db);
+static void     agc_apply_gain(float * audio_in,
+                               float * audio_out,
+                               float gain_start,
+                               float gain_end,
+                               uint32_t len);
+
+
+/**
+ * @brief Initializes instance of an automatic gain control
+ *
+ * @param c Pointer to instance structure
+ * @param mode Linked or per-channel gain (see enumeration)
+ * @param target_db Target RMS level (-60.0->0.0 dB)
+ * @param max_gain_db Maximum boost or cut applied (0.0->40.0 dB)
+ * @param slew_db_per_sec Maximum rate of gain change (0.1->60.0 dB/s)
+ * @param noise_floor_db Level below which the gain is frozen (-120.0->-20.0 dB)
+ * @param audio_sample_rate The system audio sample rate
+ * @return AGC result (enumeration)
+ */
+RESULT_AGC  agc_setup(AUTO_GAIN_CONTROL * c,
+                      AGC_MODE mode,
+                      float target_db,
+                      float max_gain_db,
+                      float slew_db_per_sec,
+                      float noise_floor_db,
+                      float audio_sample_rate) {
+
+    if (c == NULL) {
+        return AGC_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (target_db < AGC_TARGET_MIN || target_db > AGC_TARGET_MAX) {
+        return AGC_INVALID_TARGET;
+    }
+
+    if (max_gain_db < AGC_MAX_GAIN_MIN || max_gain_db > AGC_MAX_GAIN_MAX) {
+        return AGC_INVALID_MAX_GAIN;
+    }
+
+    if (slew_db_per_sec < AGC_SLEW_MIN || slew_db_per_sec > AGC_SLEW_MAX) {
+        return AGC_INVALID_SLEW;
+    }
+
+    if (noise_floor_db < AGC_NOISE_FLOOR_MIN ||
+        noise_floor_db > AGC_NOISE_FLOOR_MAX) {
+        return AGC_INVALID_NOISE_FLOOR;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->mode = mode;
+    c->target_db = target_db;
+    c->max_gain_db = max_gain_db;
+    c->slew_db_per_sec = slew_db_per_sec;
+    c->slew_db = slew_db_per_sec*AGC_CONTROL_PERIOD/audio_sample_rate;
+    c->noise_floor_db = noise_floor_db;
+
+    for (int ch=0;ch<2;ch++) {
+        envelope_follower_setup(&c->detector[ch],
+                                ENV_FOLLOWER_LOG,
+                                AGC_AVERAGING_MS,
+                                AGC_AVERAGING_MS,
+                                AGC_CONTROL_PERIOD,
+                                audio_sample_rate);
+
+        // Start at unity gain, frozen until signal arrives
+        c->level_db[ch] = noise_floor_db;
+        c->gain_db[ch] = 0.0;
+        c->gain[ch] = 1.0;
+        c->frozen[ch] = true;
+    }
+
+    c->initialized = true;
+    return AGC_OK;
+}
+
+/**
+ * @brief Switch between linked and per-channel operation
+ *
+ * When switching to linked mode the right channel picks up the left
+ * channel's gain so the two don't drift apart.
+ *
+ * @param c Pointer to instance structure
+ * @param mode_new New mode (see enumeration)
+ */
+void    agc_modify_mode(AUTO_GAIN_CONTROL * c,
+                        AGC_MODE mode_new) {
+
+    if (mode_new == AGC_LINKED && c->mode != AGC_LINKED) {
+        c->gain_db[1] = c->gain_db[0];
+        c->gain[1] = c->gain[0];
+    }
+    c->mode = mode_new;
+}
+
+/**
+ * @brief Modify the target level
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param target_db_new Updated target RMS level (-60.0->0.0 dB)
+ * @return AGC result (enumeration)
+ */
+RESULT_AGC  agc_modify_target(AUTO_GAIN_CONTROL * c,
+                              float target_db_new) {
+
+    RESULT_AGC res;
+
+    float target_db;
+    if (target_db_new > AGC_TARGET_MAX) {
+        target_db = AGC_TARGET_MAX;
+        res = AGC_INVALID_TARGET;
+    }
+    else if (target_db_new < AGC_TARGET_MIN) {
+        target_db = AGC_TARGET_MIN;
+        res = AGC_INVALID_TARGET;
+    }
+    else {
+        target_db = target_db_new;
+        res = AGC_OK;
+    }
+
+    c->target_db = target_db;
+
+    return res;
+}
+
+/**
+ * @brief Modify the maximum boost / cut
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param max_gain_db_new Updated maximum gain (0.0->40.0 dB)
+ * @return AGC result (enumeration)
+ */
+RESULT_AGC  agc_modify_max_gain(AUTO_GAIN_CONTROL * c,
+                                float max_gain_db_new) {
+
+    RESULT_AGC res;
+
+    float max_gain_db;
+    if (max_gain_db_new > AGC_MAX_GAIN_MAX) {
+        max_gain_db = AGC_MAX_GAIN_MAX;
+        res = AGC_INVALID_MAX_GAIN;
+    }
+    else if (max_gain_db_new < AGC_MAX_GAIN_MIN) {
+        max_gain_db = AGC_MAX_GAIN_MIN;
+        res = AGC_INVALID_MAX_GAIN;
+    }
+    else {
+        max_gain_db = max_gain_db_new;
+        res = AGC_OK;
+    }
+
+    c->max_gain_db = max_gain_db;
+
+    return res;
+}
+
+/**
+ * @brief Modify the slew limit (maximum rate of gain change)
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param slew_db_per_sec_new Updated slew limit (0.1->60.0 dB/s)
+ * @return AGC result (enumeration)
+ */
+RESULT_AGC  agc_modify_slew(AUTO_GAIN_CONTROL * c,
+                            float slew_db_per_sec_new) {
+
+    RESULT_AGC res;
+
+    float slew_db_per_sec;
+    if (slew_db_per_sec_new > AGC_SLEW_MAX) {
+        slew_db_per_sec = AGC_SLEW_MAX;
+        res = AGC_INVALID_SLEW;
+    }
+    else if (slew_db_per_sec_new < AGC_SLEW_MIN) {
+        slew_db_per_sec = AGC_SLEW_MIN;
+        res = AGC_INVALID_SLEW;
+    }
+    else {
+        slew_db_per_sec = slew_db_per_sec_new;
+        res = AGC_OK;
+    }
+
+    c->slew_db_per_sec = slew_db_per_sec;
+    c->slew_db = slew_db_per_sec*AGC_CONTROL_PERIOD/c->audio_sample_rate;
+
+    return res;
+}
+
+/**
+ * @brief Modify the noise floor below which the gain is frozen
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param noise_floor_db_new Updated noise floor (-120.0->-20.0 dB)
+ * @return AGC result (enumeration)
+ */
+RESULT_AGC  agc_modify_noise_floor(AUTO_GAIN_CONTROL * c,
+                                   float noise_floor_db_new) {
+
+    RESULT_AGC res;
+
+    float noise_floor_db;
+    if (noise_floor_db_new > AGC_NOISE_FLOOR_MAX) {
+        noise_floor_db = AGC_NOISE_FLOOR_MAX;
+        res = AGC_INVALID_NOISE_FLOOR;
+    }
+    else if (noise_floor_db_new < AGC_NOISE_FLOOR_MIN) {
+        noise_floor_db = AGC_NOISE_FLOOR_MIN;
+        res = AGC_INVALID_NOISE_FLOOR;
+    }
+    else {
+        noise_floor_db = noise_floor_db_new;
+        res = AGC_OK;
+    }
+
+    c->noise_floor_db = noise_floor_db;
+
+    return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * The audio can be processed in place (audio_in == audio_out).  Pass NULL for
+ * the right channel pointers to process a single channel.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in_left Pointer to floating point audio input buffer (left)
+ * @param audio_in_right Pointer to floating point audio input buffer (right or NULL)
+ * @param audio_out_left Pointer to floating point output buffer (left)
+ * @param audio_out_right Pointer to floating point output buffer (right or NULL)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    agc_read(AUTO_GAIN_CONTROL * c,
+                 float * audio_in_left,
+                 float * audio_in_right,
+                 float * audio_out_left,
+                 float * audio_out_right,
+                 uint32_t audio_block_size) {
+
+    bool stereo = (audio_in_right != NULL && audio_out_right != NULL);
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out_left[i] = audio_in_left[i];
+        }
+        if (stereo) {
+            for (int i=0;i<audio_block_size;i++) {
+                audio_out_right[i] = audio_in_right[i];
+            }
+        }
+        return;
+    }
+
+    float level_db[2][MAX_AUDIO_BLOCK_SIZE/AGC_CONTROL_PERIOD+1];
+    float level_end[2];
+    uint32_t num_levels = audio_block_size/AGC_CONTROL_PERIOD;
+
+    // Measure the level of each channel
+    level_end[0] = envelope_follower_read(&c->detector[0],
+                                          audio_in_left,
+                                          level_db[0],
+                                          audio_block_size);
+    if (stereo) {
+        level_end[1] = envelope_follower_read(&c->detector[1],
+                                              audio_in_right,
+                                              level_db[1],
+                                              audio_block_size);
+    }
+
+    bool linked = (c->mode == AGC_LINKED);
+
+    uint32_t k = 0;
+    for (int i=0;i<audio_block_size;i+=AGC_CONTROL_PERIOD) {
+
+        uint32_t len = audio_block_size - i;
+        if (len > AGC_CONTROL_PERIOD) {
+            len = AGC_CONTROL_PERIOD;
+        }
+
+        float level_l = (k < num_levels) ? level_db[0][k] : level_end[0];
+        float level_r = level_l;
+        if (stereo) {
+            level_r = (k < num_levels) ? level_db[1][k] : level_end[1];
+        }
+        k++;
+
+        float gain_l = c->gain[0];
+        float gain_r = c->gain[1];
+
+        if (linked || !stereo) {
+            // Both channels follow the louder one
+            agc_update_gain(c, 0, (level_l > level_r) ? level_l : level_r);
+            c->level_db[1] = level_r;
+            c->gain_db[1] = c->gain_db[0];
+            c->gain[1] = c->gain[0];
+            c->frozen[1] = c->frozen[0];
+            c->level_db[0] = level_l;
+        }
+        else {
+            agc_update_gain(c, 0, level_l);
+            agc_update_gain(c, 1, level_r);
+        }
+
+        // Ramp the gain across this control period
+        agc_apply_gain(audio_in_left + i, audio_out_left + i,
+                       gain_l, c->gain[0], len);
+        if (stereo) {
+            agc_apply_gain(audio_in_right + i, audio_out_right + i,
+                           gain_r, c->gain[1], len);
+        }
+    }
+}
+
+/**
+ * @brief Moves the gain of a channel towards the target (one control period)
+ *
+ * @param c Pointer to instance structure
+ * @param channel Channel to update (0 = left, 1 = right)
+ * @param level_db Measured level of the channel
+ */
+static void     agc_update_gain(AUTO_GAIN_CONTROL * c,
+                                uint32_t channel,
+                                float level_db) {
+
+    c->level_db[channel] = level_db;
+
+    // Hold the current gain while there is no signal
+    if (level_db < c->noise_floor_db) {
+        c->frozen[channel] = true;
+        return;
+    }
+    c->frozen[channel] = false;
+
+    float desired_db = c->target_db - level_db;
+    if (desired_db > c->max_gain_db) {
+        desired_db = c->max_gain_db;
+    }
+    else if (desired_db < -c->max_gain_db) {
+        desired_db = -c->max_gain_db;
+    }
+
+    // Slew limit
+    float step = desired_db - c->gain_db[channel];
+    if (step > c->slew_db) {
+        step = c->slew_db;
+    }
+    else if (step < -c->slew_db) {
+        step = -c->slew_db;
+    }
+
+    if (step != 0.0) {
+        c->gain_db[channel] += step;
+        c->gain[channel] = powf(10.0, c->gain_db[channel]/20.0);
+    }
+}
+
+/**
+ * @brief Applies a linear gain ramp to a short section of audio
+ *
+ * @param audio_in Pointer to input audio
+ * @param audio_out Pointer to output audio
+ * @param gain_start Gain before the first sample
+ * @param gain_end Gain at the last sample
+ * @param len Number of samples
+ */
+static void     agc_apply_gain(float * audio_in,
+                               float * audio_out,
+                               float gain_start,
+                               float gain_end,
+                               uint32_t len) {
+
+    float gain = gain_start;
+    float gain_step = (gain_end - gain_start)/(float) len;
+    for (int i=0;i<len;i++) {
+        gain += gain_step;
+        audio_out[i] = audio_in[i]*gain;
+    }
+}
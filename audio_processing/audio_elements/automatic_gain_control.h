@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUTOMATIC_GAIN_CONTROL_H
+#define _AUTOMATIC_GAIN_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "envelope_follower.h"
+
+// Result enumerations
+typedef enum
+{
+    AGC_OK,
+    AGC_INVALID_INSTANCE_POINTER,
+    AGC_INVALID_TARGET,
+    AGC_INVALID_MAX_GAIN,
+    AGC_INVALID_SLEW,
+    AGC_INVALID_NOISE_FLOOR
+} RESULT_AGC;
+
+// Channel linking modes
+typedef enum
+{
+    AGC_LINKED,             // Same gain on both channels (driven by the louder)
+    AGC_PER_CHANNEL         // Each channel has its own gain
+} AGC_MODE;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    AGC_MODE    mode;
+
+    float   target_db;          // Target RMS level
+    float   max_gain_db;        // Gain is limited to +/- this value
+    float   slew_db;            // Maximum gain change per control period
+    float   slew_db_per_sec;
+    float   noise_floor_db;     // Gain is frozen below this level
+
+    ENVELOPE_FOLLOWER   detector[2];
+
+    float   level_db[2];        // Last measured level
+    float   gain_db[2];         // Current gain in dB
+    float   gain[2];            // Current (linear) gain
+    bool    frozen[2];          // Level is below the noise floor
+
+    float   audio_sample_rate;
+
+} AUTO_GAIN_CONTROL;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_AGC  agc_setup(AUTO_GAIN_CONTROL * c,
+                      AGC_MODE mode,
+                      float target_db,
+                      float max_gain_db,
+                      float slew_db_per_sec,
+                      float noise_floor_db,
+                      float audio_sample_rate);
+
+void        agc_modify_mode(AUTO_GAIN_CONTROL * c,
+                            AGC_MODE mode_new);
+
+RESULT_AGC  agc_modify_target(AUTO_GAIN_CONTROL * c,
+                              float target_db_new);
+
+RESULT_AGC  agc_modify_max_gain(AUTO_GAIN_CONTROL * c,
+                                float max_gain_db_new);
+
+RESULT_AGC  agc_modify_slew(AUTO_GAIN_CONTROL * c,
+                            float slew_db_per_sec_new);
+
+RESULT_AGC  agc_modify_noise_floor(AUTO_GAIN_CONTROL * c,
+                                   float noise_floor_db_new);
+
+void        agc_read(AUTO_GAIN_CONTROL * c,
+                     float * audio_in_left,
+                     float * audio_in_right,
+                     float * audio_out_left,
+                     float * audio_out_right,
+                     uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _AUTOMATIC_GAIN_CONTROL_H
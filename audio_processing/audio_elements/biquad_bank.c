@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A bank of independent biquad sections that are processed together, for
+ * filterbanks such as a channel vocoder or a graphic analyzer.
+ *
+ * Running N separate BIQUAD_FILTER instances costs a function call and a pass
+ * over the block per section, and each section's recursion is serial so it
+ * can't use both of the SHARC's SIMD processing elements.  Here the
+ * coefficients and state of every section are stored as separate arrays
+ * (structure of arrays) and the inner loop runs across the sections for each
+ * sample.  The sections don't depend on each other, so that loop has no
+ * loop-carried dependency and the compiler can run two sections at a time in
+ * SIMD.  Sections use the transposed direct form II structure.
+ *
+ * Three processing modes are provided:
+ *
+ *  - biquad_bank_read() runs every section on the same mono input (a
+ *    parallel filterbank) and writes one output channel per section.
+ *  - biquad_bank_read_planar() runs each section on its own channel, which
+ *    is used to cascade a second bank after the first for steeper filters.
+ *  - biquad_bank_read_cascade() runs the sections in series on one channel
+ *    (e.g. a set of notches).  Each section's recursion is serial, so here
+ *    the sections are run one after another over the whole block, which
+ *    keeps a section's coefficients and state in registers for the block.
+ *    Sections that are pass-through are skipped, so a bank can be set up
+ *    with room for more sections than are in use at any one time.
+ *
+ * Multichannel buffers are planar: channel s occupies
+ * buffer[s*audio_block_size ... (s+1)*audio_block_size-1].
+ *
+ * Coefficients come from the same cookbook formulas as the biquad filter
+ * element (filter_generate_coeffs()) and are normalized here.  Changing a
+ * section's coefficients takes effect immediately (no smoothing).
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "biquad_bank.h"
+
+// Min/max limits and other constants
+#define BIQUAD_BANK_MIN_FREQ    (10.0)
+#define BIQUAD_BANK_MIN_Q       (0.01)
+#define BIQUAD_BANK_MAX_Q       (100.0)
+
+
+/**
+ * @brief Initializes instance of a biquad bank
+ *
+ * All sections start as pass-through (b0 = 1) until biquad_bank_set_section()
+ * is called for them.
+ *
+ * @param c Pointer to instance structure
+ * @param num_sections Number of sections (1->BIQUAD_BANK_MAX_SECTIONS)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Biquad bank result (enumeration)
+ */
+RESULT_BIQUAD_BANK biquad_bank_setup(BIQUAD_BANK * c,
+                                     uint32_t num_sections,
+                                     float audio_sample_rate) {
+
+    if (c == NULL) {
+        return BIQUAD_BANK_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (num_sections < 1 || num_sections > BIQUAD_BANK_MAX_SECTIONS) {
+        return BIQUAD_BANK_INVALID_NUM_SECTIONS;
+    }
+
+    c->num_sections = num_sections;
+    c->audio_sample_rate = audio_sample_rate;
+
+    for (int s=0;s<BIQUAD_BANK_MAX_SECTIONS;s++) {
+        c->b0[s] = 1.0;
+        c->b1[s] = 0.0;
+        c->b2[s] = 0.0;
+        c->a1[s] = 0.0;
+        c->a2[s] = 0.0;
+    }
+    biquad_bank_reset(c);
+
+    c->initialized = true;
+    return BIQUAD_BANK_OK;
+}
+
+/**
+ * @brief Sets the response of one section
+ *
+ * @param c Pointer to instance structure
+ * @param section Section to set (0->num_sections-1)
+ * @param type Type of filter (see BIQUAD_FILTER_TYPE)
+ * @param freq Cutoff/center frequency in Hz (10.0->Nyquist)
+ * @param q Q factor (0.01->100.0)
+ * @param gain_db Gain in dB (peaking and shelving types only)
+ * @return Biquad bank result (enumeration)
+ */
+RESULT_BIQUAD_BANK biquad_bank_set_section(BIQUAD_BANK * c,
+                                           uint32_t section,
+                                           BIQUAD_FILTER_TYPE type,
+                                           float freq,
+                                           float q,
+                                           float gain_db) {
+
+    if (c == NULL || !c->initialized) {
+        return BIQUAD_BANK_INVALID_INSTANCE_POINTER;
+    }
+    if (section >= c->num_sections) {
+        return BIQUAD_BANK_INVALID_SECTION;
+    }
+    if (freq < BIQUAD_BANK_MIN_FREQ || freq >= 0.5*c->audio_sample_rate) {
+        return BIQUAD_BANK_INVALID_FREQ;
+    }
+    if (q < BIQUAD_BANK_MIN_Q || q > BIQUAD_BANK_MAX_Q) {
+        return BIQUAD_BANK_INVALID_Q;
+    }
+
+    // b0, b1, b2, a0, a1, a2
+    float coeffs[6];
+    filter_generate_coeffs(type, freq, q, gain_db, c->audio_sample_rate, coeffs);
+
+    float a0_inv = 1.0/coeffs[3];
+    c->b0[section] = coeffs[0]*a0_inv;
+    c->b1[section] = coeffs[1]*a0_inv;
+    c->b2[section] = coeffs[2]*a0_inv;
+    c->a1[section] = coeffs[4]*a0_inv;
+    c->a2[section] = coeffs[5]*a0_inv;
+
+    return BIQUAD_BANK_OK;
+}
+
+/**
+ * @brief Clears the state of every section
+ *
+ * @param c Pointer to instance structure
+ */
+void    biquad_bank_reset(BIQUAD_BANK * c) {
+
+    for (int s=0;s<BIQUAD_BANK_MAX_SECTIONS;s++) {
+        c->z1[s] = 0.0;
+        c->z2[s] = 0.0;
+    }
+}
+
+/**
+ * @brief Runs every section on the same mono input
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to planar output buffer (num_sections channels)
+ * @param audio_block_size The number of floating-point words per channel
+ */
+#pragma optimize_for_speed
+void    biquad_bank_read(BIQUAD_BANK * c,
+                         float * audio_in,
+                         float * audio_out,
+                         uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t num_sections = c->num_sections;
+    float * b0 = c->b0;
+    float * b1 = c->b1;
+    float * b2 = c->b2;
+    float * a1 = c->a1;
+    float * a2 = c->a2;
+    float * z1 = c->z1;
+    float * z2 = c->z2;
+
+    for (int i=0;i<audio_block_size;i++) {
+        float x = audio_in[i];
+        float * out = &audio_out[i];
+
+        // No dependency between sections, so this loop can run in SIMD
+        #pragma SIMD_for
+        for (int s=0;s<num_sections;s++) {
+            float y = b0[s]*x + z1[s];
+            z1[s] = b1[s]*x - a1[s]*y + z2[s];
+            z2[s] = b2[s]*x - a2[s]*y;
+            out[s*audio_block_size] = y;
+        }
+    }
+}
+
+/**
+ * @brief Runs each section on its own channel of a planar buffer
+ *
+ * Processing can be done in place.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to planar input buffer (num_sections channels)
+ * @param audio_out Pointer to planar output buffer (num_sections channels)
+ * @param audio_block_size The number of floating-point words per channel
+ */
+#pragma optimize_for_speed
+void    biquad_bank_read_planar(BIQUAD_BANK * c,
+                                float * audio_in,
+                                float * audio_out,
+                                uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t num_sections = c->num_sections;
+    float * b0 = c->b0;
+    float * b1 = c->b1;
+    float * b2 = c->b2;
+    float * a1 = c->a1;
+    float * a2 = c->a2;
+    float * z1 = c->z1;
+    float * z2 = c->z2;
+
+    for (int i=0;i<audio_block_size;i++) {
+        float * in = &audio_in[i];
+        float * out = &audio_out[i];
+
+        // No dependency between sections, so this loop can run in SIMD
+        #pragma SIMD_for
+        for (int s=0;s<num_sections;s++) {
+            float x = in[s*audio_block_size];
+            float y = b0[s]*x + z1[s];
+            z1[s] = b1[s]*x - a1[s]*y + z2[s];
+            z2[s] = b2[s]*x - a2[s]*y;
+            out[s*audio_block_size] = y;
+        }
+    }
+}
+
+/**
+ * @brief Runs the sections in series on a mono channel
+ *
+ * Pass-through sections (b0 = 1, all other coefficients 0) are skipped.
+ * Processing can be done in place.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    biquad_bank_read_cascade(BIQUAD_BANK * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    if (audio_out != audio_in) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] = audio_in[i];
+        }
+    }
+
+    for (int s=0;s<c->num_sections;s++) {
+        float b0 = c->b0[s];
+        float b1 = c->b1[s];
+        float b2 = c->b2[s];
+        float a1 = c->a1[s];
+        float a2 = c->a2[s];
+
+        if (b0 == 1.0 && b1 == 0.0 && b2 == 0.0 && a1 == 0.0 && a2 == 0.0) {
+            continue;
+        }
+
+        float z1 = c->z1[s];
+        float z2 = c->z2[s];
+        for (int i=0;i<audio_block_size;i++) {
+            float x = audio_out[i];
+            float y = b0*x + z1;
+            z1 = b1*x - a1*y + z2;
+            z2 = b2*x - a2*y;
+            audio_out[i] = y;
+        }
+        c->z1[s] = z1;
+        c->z2[s] = z2;
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _BIQUAD_BANK_H
+#define _BIQUAD_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "biquad_filter.h"
+
+#define BIQUAD_BANK_MAX_SECTIONS    (32)
+
+// Result enumerations
+typedef enum
+{
+    BIQUAD_BANK_OK,
+    BIQUAD_BANK_INVALID_INSTANCE_POINTER,
+    BIQUAD_BANK_INVALID_NUM_SECTIONS,
+    BIQUAD_BANK_INVALID_SECTION,
+    BIQUAD_BANK_INVALID_FREQ,
+    BIQUAD_BANK_INVALID_Q
+} RESULT_BIQUAD_BANK;
+
+/*
+ * C struct with parameters and state information.  Coefficients and state are
+ * stored as one array per term (structure of arrays) so the sections can be
+ * processed side by side.
+ */
+typedef struct  {
+
+    bool    initialized;
+
+    uint32_t    num_sections;
+
+    // Normalized coefficients (a0 = 1)
+    float   b0[BIQUAD_BANK_MAX_SECTIONS];
+    float   b1[BIQUAD_BANK_MAX_SECTIONS];
+    float   b2[BIQUAD_BANK_MAX_SECTIONS];
+    float   a1[BIQUAD_BANK_MAX_SECTIONS];
+    float   a2[BIQUAD_BANK_MAX_SECTIONS];
+
+    // Transposed direct form II state
+    float   z1[BIQUAD_BANK_MAX_SECTIONS];
+    float   z2[BIQUAD_BANK_MAX_SECTIONS];
+
+    float   audio_sample_rate;
+
+} BIQUAD_BANK;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_BIQUAD_BANK biquad_bank_setup(BIQUAD_BANK * c,
+                                     uint32_t num_sections,
+                                     float audio_sample_rate);
+
+RESULT_BIQUAD_BANK biquad_bank_set_section(BIQUAD_BANK * c,
+                                           uint32_t section,
+                                           BIQUAD_FILTER_TYPE type,
+                                           float freq,
+                                           float q,
+                                           float gain_db);
+
+void    biquad_bank_reset(BIQUAD_BANK * c);
+
+void    biquad_bank_read(BIQUAD_BANK * c,
+                         float * audio_in,
+                         float * audio_out,
+                         uint32_t audio_block_size);
+
+void    biquad_bank_read_planar(BIQUAD_BANK * c,
+                                float * audio_in,
+                                float * audio_out,
+                                uint32_t audio_block_size);
+
+void    biquad_bank_read_cascade(BIQUAD_BANK * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _BIQUAD_BANK_H
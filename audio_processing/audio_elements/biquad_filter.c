@@ -26,12 +26,6 @@
 
 
 // Static function prototypes
-static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
-                                            float freq,
-                                            float q,
-                                            float gain_db,
-                                            float audio_sample_rate,
-                                            float * result );
 static RESULT_BIQUAD convert_coeffs(float * coeffs_ab,
                                     float * sos_coeffs,
                                     float * scaling_factor);
@@ -268,12 +262,12 @@ void    filter_read(BIQUAD_FILTER * c,
  * @param result Pointer to floating-point buffer where coefficients will be stored
  * @return Result enum - see .h file for details
  */
-static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
-                                            float freq,
-                                            float q,
-                                            float gain_db,
-                                            float audio_sample_rate,
-                                            float * result ) {
+RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
+                                     float freq,
+                                     float q,
+                                     float gain_db,
+                                     float audio_sample_rate,
+                                     float * result ) {
 
 
 
@@ -104,6 +104,14 @@ void    filter_read(BIQUAD_FILTER * c,
                     float * audio_out,
                     uint32_t audio_block_size);
 
+// Un-normalized coefficients in the order b0, b1, b2, a0, a1, a2
+RESULT_BIQUAD   filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
+                                       float freq,
+                                       float q,
+                                       float gain_db,
+                                       float audio_sample_rate,
+                                       float * result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A chorus / ensemble is built from several copies of the input signal, each
+ * delayed by a slowly modulated amount and mixed back with the original.
+ *
+ * The stereo flanger uses a separate variable delay (and buffer and LFO) for
+ * each voice.  This element instead writes the input once into a single
+ * shared delay line and reads it back with up to eight modulated read heads.
+ * All read heads are driven by one phase accumulator; each voice simply adds
+ * a fixed phase offset (voice / num_voices) to it.  The LFO is only evaluated
+ * once per voice per block and the delay of each read head is ramped linearly
+ * across the block, so a full ensemble costs little more than one flanger
+ * voice.
+ *
+ * The voices are spread evenly across the stereo field (see spread
+ * parameter) to produce a wide stereo output from a mono input.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "chorus_ensemble.h"
+#include "audio_utilities.h"
+#include "oscillators.h"
+
+// Min/max limits and other constants
+#define CHORUS_DELAY_MS_MIN     (7.0)
+#define CHORUS_DELAY_MS_MAX     (20.0)
+#define CHORUS_DEPTH_MIN        (0.0)
+#define CHORUS_DEPTH_MAX        (1.0)
+#define CHORUS_DEPTH_MS_MAX     (5.0)
+#define CHORUS_RATE_HZ_MIN      (0.01)
+#define CHORUS_RATE_HZ_MAX      (10.0)
+#define CHORUS_SPREAD_MIN       (0.0)
+#define CHORUS_SPREAD_MAX       (1.0)
+#define CHORUS_MIX_MIN          (0.0)
+#define CHORUS_MIX_MAX          (1.0)
+
+// Static function prototypes
+static void chorus_update_voice_gains(CHORUS * c);
+
+
+/**
+ * @brief Initializes instance of a chorus / ensemble
+ *
+ * @param c Pointer to instance structure
+ * @param num_voices Number of modulated read heads (1->8)
+ * @param delay_ms Center delay of each read head in milliseconds (7.0->20.0)
+ * @param depth Depth of modulation (0.0->1.0)
+ * @param rate_hz Rate of modulation in Hz (0.01->10.0)
+ * @param spread Stereo spread of the voices (0.0->1.0)
+ * @param mix Wet/dry mix (0.0 = dry only, 1.0 = wet only)
+ * @param audio_sample_rate The system audio sample rate
+ * @return chorus result (enumeration)
+ */
+RESULT_CHORUS   chorus_setup(CHORUS * c,
+                             uint32_t num_voices,
+                             float delay_ms,
+                             float depth,
+                             float rate_hz,
+                             float spread,
+                             float mix,
+                             float audio_sample_rate) {
+
+    if (c == NULL) {
+        return CHORUS_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (num_voices < 1 ||
+        num_voices > CHORUS_MAX_VOICES) {
+        return CHORUS_INVALID_VOICES;
+    }
+    if (delay_ms < CHORUS_DELAY_MS_MIN ||
+        delay_ms > CHORUS_DELAY_MS_MAX) {
+        return CHORUS_INVALID_DELAY;
+    }
+    if (depth < CHORUS_DEPTH_MIN ||
+        depth > CHORUS_DEPTH_MAX) {
+        return CHORUS_INVALID_DEPTH;
+    }
+    if (rate_hz < CHORUS_RATE_HZ_MIN ||
+        rate_hz > CHORUS_RATE_HZ_MAX) {
+        return CHORUS_INVALID_RATE;
+    }
+    if (spread < CHORUS_SPREAD_MIN ||
+        spread > CHORUS_SPREAD_MAX) {
+        return CHORUS_INVALID_SPREAD;
+    }
+    if (mix < CHORUS_MIX_MIN ||
+        mix > CHORUS_MIX_MAX) {
+        return CHORUS_INVALID_MIX;
+    }
+
+    // Make sure the longest read head (plus one block) fits in the delay line
+    if ((delay_ms + CHORUS_DEPTH_MS_MAX) * 0.001 * audio_sample_rate
+            + MAX_AUDIO_BLOCK_SIZE + 2 > CHORUS_DELAY_LINE_LEN) {
+        return CHORUS_INVALID_DELAY;
+    }
+
+    // Save parameters
+    c->num_voices = num_voices;
+    c->delay_samples = delay_ms * 0.001 * audio_sample_rate;
+    c->depth_samples = depth * CHORUS_DEPTH_MS_MAX * 0.001 * audio_sample_rate;
+    c->rate_hz = rate_hz;
+    c->spread = spread;
+    c->mix = mix;
+
+    c->audio_sample_rate = audio_sample_rate;
+    c->lfo_t = 0.0;
+    c->lfo_inc = rate_hz/audio_sample_rate;
+
+    chorus_update_voice_gains(c);
+
+    // Start each read head where the LFO currently places it
+    for (int v=0;v<num_voices;v++) {
+        float phase = (float) v / (float) num_voices;
+        c->voice_delay_last[v] = c->delay_samples + c->depth_samples*oscillator_sine(phase);
+    }
+
+    // clear delay line
+    for (int i=0;i<CHORUS_DELAY_LINE_LEN+1;i++) {
+        c->delay_line[i] = 0.0;
+    }
+    c->delay_index = 0;
+
+    c->initialized = true;
+    return CHORUS_OK;
+}
+
+/**
+ * @brief Modify chorus modulation depth
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_depth Updated depth parameter (0.0->1.0)
+ * @return chorus result (enumeration)
+ */
+RESULT_CHORUS   chorus_modify_depth(CHORUS * c, float depth_new) {
+
+    RESULT_CHORUS res;
+
+    float depth;
+    if (depth_new > CHORUS_DEPTH_MAX) {
+        depth = CHORUS_DEPTH_MAX;
+        res = CHORUS_INVALID_DEPTH;
+    }
+    else if (depth_new < CHORUS_DEPTH_MIN) {
+        depth = CHORUS_DEPTH_MIN;
+        res = CHORUS_INVALID_DEPTH;
+    }
+    else {
+        depth = depth_new;
+        res = CHORUS_OK;
+    }
+
+    c->depth_samples = depth * CHORUS_DEPTH_MS_MAX * 0.001 * c->audio_sample_rate;
+
+    return res;
+}
+
+/**
+ * @brief Modify chorus modulation rate
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_rate_hz Updated rate parameter in Hz (0.01->10.0)
+ * @return chorus result (enumeration)
+ */
+RESULT_CHORUS   chorus_modify_rate(CHORUS * c, float rate_hz_new) {
+
+    RESULT_CHORUS res;
+
+    float rate_hz;
+    if (rate_hz_new > CHORUS_RATE_HZ_MAX) {
+        rate_hz = CHORUS_RATE_HZ_MAX;
+        res = CHORUS_INVALID_RATE;
+    }
+    else if (rate_hz_new < CHORUS_RATE_HZ_MIN) {
+        rate_hz = CHORUS_RATE_HZ_MIN;
+        res = CHORUS_INVALID_RATE;
+    }
+    else {
+        rate_hz = rate_hz_new;
+        res = CHORUS_OK;
+    }
+
+    c->rate_hz = rate_hz;
+    c->lfo_inc = rate_hz/c->audio_sample_rate;
+
+    return res;
+}
+
+/**
+ * @brief Modify stereo spread of the chorus voices
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_spread Updated spread parameter (0.0->1.0)
+ * @return chorus result (enumeration)
+ */
+RESULT_CHORUS   chorus_modify_spread(CHORUS * c, float spread_new) {
+
+    RESULT_CHORUS res;
+
+    float spread;
+    if (spread_new > CHORUS_SPREAD_MAX) {
+        spread = CHORUS_SPREAD_MAX;
+        res = CHORUS_INVALID_SPREAD;
+    }
+    else if (spread_new < CHORUS_SPREAD_MIN) {
+        spread = CHORUS_SPREAD_MIN;
+        res = CHORUS_INVALID_SPREAD;
+    }
+    else {
+        spread = spread_new;
+        res = CHORUS_OK;
+    }
+
+    c->spread = spread;
+    chorus_update_voice_gains(c);
+
+    return res;
+}
+
+/**
+ * @brief Modify chorus wet/dry mix
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_mix Updated mix parameter (0.0->1.0)
+ * @return chorus result (enumeration)
+ */
+RESULT_CHORUS   chorus_modify_mix(CHORUS * c, float mix_new) {
+
+    RESULT_CHORUS res;
+
+    float mix;
+    if (mix_new > CHORUS_MIX_MAX) {
+        mix = CHORUS_MIX_MAX;
+        res = CHORUS_INVALID_MIX;
+    }
+    else if (mix_new < CHORUS_MIX_MIN) {
+        mix = CHORUS_MIX_MIN;
+        res = CHORUS_INVALID_MIX;
+    }
+    else {
+        mix = mix_new;
+        res = CHORUS_OK;
+    }
+
+    c->mix = mix;
+    chorus_update_voice_gains(c);
+
+    return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * The input and output buffers may be the same buffers (in place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out_left Pointer to floating point output buffer (left)
+ * @param audio_out_right Pointer to floating point output buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    chorus_read(CHORUS * c,
+                    float * audio_in,
+                    float * audio_out_left,
+                    float * audio_out_right,
+                    uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out_left[i] = audio_in[i];
+            audio_out_right[i] = audio_in[i];
+        }
+        return;
+    }
+
+    float   lfo_end[CHORUS_MAX_VOICES];
+    float   voice_span[MAX_AUDIO_BLOCK_SIZE];
+    float   wet_left[MAX_AUDIO_BLOCK_SIZE], wet_right[MAX_AUDIO_BLOCK_SIZE];
+
+    float   * delay_line = c->delay_line;
+    uint32_t start_indx = c->delay_index;
+    uint32_t delay_indx = start_indx;
+    float   len_f = (float) CHORUS_DELAY_LINE_LEN;
+    float   inv_block_size = 1.0/(float) audio_block_size;
+    int     num_voices = c->num_voices;
+
+    // Write the block into the shared delay line first.  The shortest read
+    // head is always several samples long so the interpolator never touches
+    // a sample that hasn't been written yet.
+    for (int i=0;i<audio_block_size;i++) {
+        delay_line[delay_indx] = audio_in[i];
+        if (delay_indx == 0) {
+            delay_line[CHORUS_DELAY_LINE_LEN] = audio_in[i];
+        }
+        delay_indx++;
+        if (delay_indx >= CHORUS_DELAY_LINE_LEN) {
+            delay_indx = 0;
+        }
+    }
+
+    // Advance the shared phase accumulator and evaluate the LFO once per voice
+    float t = c->lfo_t + c->lfo_inc*(float) audio_block_size;
+    t = t - floor(t);
+    float phase_step = 1.0/(float) num_voices;
+    for (int v=0;v<num_voices;v++) {
+        lfo_end[v] = oscillator_sine(t + phase_step*(float) v);
+    }
+    c->lfo_t = t;
+
+    clear_buffer(wet_left, audio_block_size);
+    clear_buffer(wet_right, audio_block_size);
+
+    // Read each voice across the full block with a linear delay ramp
+    for (int v=0;v<num_voices;v++) {
+
+        float delay_end = c->delay_samples + c->depth_samples*lfo_end[v];
+        float read_inc = 1.0 - (delay_end - c->voice_delay_last[v])*inv_block_size;
+
+        float read_pos = (float) start_indx - c->voice_delay_last[v];
+        if (read_pos < 0.0) {
+            read_pos += len_f;
+        }
+
+        for (int i=0;i<audio_block_size;i++) {
+            uint32_t indx = (uint32_t) read_pos;
+            float delta = read_pos - (float) indx;
+            voice_span[i] = delay_line[indx] + delta*(delay_line[indx+1] - delay_line[indx]);
+            read_pos += read_inc;
+            if (read_pos >= len_f) {
+                read_pos -= len_f;
+            } else if (read_pos < 0.0) {
+                // A large jump in delay or depth makes read_inc negative
+                read_pos += len_f;
+            }
+        }
+
+        float gain_l = c->voice_gain_left[v];
+        float gain_r = c->voice_gain_right[v];
+        for (int i=0;i<audio_block_size;i++) {
+            wet_left[i] += voice_span[i]*gain_l;
+            wet_right[i] += voice_span[i]*gain_r;
+        }
+
+        c->voice_delay_last[v] = delay_end;
+    }
+
+    // Mix dry and wet signals
+    float dry = 1.0 - c->mix;
+    for (int i=0;i<audio_block_size;i++) {
+        float original = audio_in[i];
+        audio_out_left[i] = original*dry + wet_left[i];
+        audio_out_right[i] = original*dry + wet_right[i];
+    }
+
+    // Save state back to C struct
+    c->delay_index = delay_indx;
+}
+
+/**
+ * @brief Spread the voices evenly across the stereo field (equal-power pan)
+ *
+ * The wet mix and a 1/sqrt(num_voices) normalization are folded into the
+ * per-voice gains.
+ *
+ * @param c Pointer to instance structure
+ */
+static void chorus_update_voice_gains(CHORUS * c) {
+
+    float norm = c->mix / sqrtf((float) c->num_voices);
+
+    for (int v=0;v<c->num_voices;v++) {
+        float pan = 0.0;
+        if (c->num_voices > 1) {
+            pan = c->spread * (2.0*(float) v / (float) (c->num_voices-1) - 1.0);
+        }
+        float pan_angle = (pan + 1.0) * 0.25 * PI;
+        c->voice_gain_left[v] = norm * cosf(pan_angle);
+        c->voice_gain_right[v] = norm * sinf(pan_angle);
+    }
+}
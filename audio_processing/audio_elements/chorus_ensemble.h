@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CHORUS_ENSEMBLE_H
+#define _CHORUS_ENSEMBLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define CHORUS_MAX_VOICES           (8)
+
+// Shared delay line length (plus one guard sample used by the interpolator)
+#define CHORUS_DELAY_LINE_LEN       (2048)
+
+// Result enumerations
+typedef enum
+{
+    CHORUS_OK,
+    CHORUS_INVALID_INSTANCE_POINTER,
+    CHORUS_INVALID_VOICES,
+    CHORUS_INVALID_DELAY,
+    CHORUS_INVALID_DEPTH,
+    CHORUS_INVALID_RATE,
+    CHORUS_INVALID_SPREAD,
+    CHORUS_INVALID_MIX
+} RESULT_CHORUS;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool        initialized;
+
+    uint32_t    num_voices;
+    float       delay_samples;      // center delay of each read head
+    float       depth_samples;      // modulation depth of each read head
+    float       rate_hz;
+    float       spread;
+    float       mix;
+
+    float       voice_gain_left[CHORUS_MAX_VOICES];
+    float       voice_gain_right[CHORUS_MAX_VOICES];
+    float       voice_delay_last[CHORUS_MAX_VOICES];
+
+    float       lfo_t;              // single phase accumulator for all voices
+    float       lfo_inc;
+
+    float       audio_sample_rate;
+
+    float       delay_line[CHORUS_DELAY_LINE_LEN+1];
+    uint32_t    delay_index;
+
+} CHORUS;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_CHORUS   chorus_setup(CHORUS * c,
+                             uint32_t num_voices,
+                             float delay_ms,
+                             float depth,
+                             float rate_hz,
+                             float spread,
+                             float mix,
+                             float audio_sample_rate);
+
+RESULT_CHORUS   chorus_modify_depth(CHORUS * c,
+                                    float new_depth);
+RESULT_CHORUS   chorus_modify_rate(CHORUS * c,
+                                   float new_rate_hz);
+RESULT_CHORUS   chorus_modify_spread(CHORUS * c,
+                                     float new_spread);
+RESULT_CHORUS   chorus_modify_mix(CHORUS * c,
+                                  float new_mix);
+
+void    chorus_read(CHORUS * c,
+                    float * audio_in,
+                    float * audio_out_left,
+                    float * audio_out_right,
+                    uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _CHORUS_ENSEMBLE_H
@@ -9,6 +9,13 @@
  * used for, and their parameters:
  * https://www.uaudio.com/blog/audio-compression-basics/
  * 
+ * The signal level is measured with an RMS envelope follower and the gain
+ * computer (threshold, ratio, attack and release) runs at a control rate of
+ * one update every COMPRESSOR_CONTROL_PERIOD samples.  The gain is ramped
+ * linearly between control updates so there is no zipper noise, and the
+ * log / exp conversions are only done once per control period rather than
+ * for every sample.
+ * 
  */
 #include "compressor.h"
 #include "audio_elements_common.h"
@@ -27,12 +34,14 @@
 #define     COMPRESSOR_MAX_RELEASE_MS   (1000.0)
 #define     COMPRESSOR_MIN_GAIN         (0)
 #define     COMPRESSOR_MAX_GAIN         (10.0)
+#define     COMPRESSOR_CONTROL_PERIOD   (8)         // Samples per gain update
+#define     COMPRESSOR_RMS_TIME_MS      (1.6)       // RMS detector time constant
+#define     COMPRESSOR_DB_TO_LOG2       (0.16609640474)
 
 // Static function prototypes
 static float log2f(float x);
 static float calculate_threshold_coeff(float threshold_db);
 static float calculate_ratio_coeff(float ratio);
-static LP_COEFF calculate_rms_coeffs(float rms_fc, float fs);
 static LP_COEFF calculate_lp_coeffs(float timeconstant_ms, float fs);
 
 
@@ -87,7 +96,7 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c,
         return COMPRESSOR_INVALID_ATTACK;
     }
     c->attack_ms = attack_ms;
-    c->attack_coeff = calculate_lp_coeffs(attack_ms, audio_sample_rate);
+    c->attack_coeff = calculate_lp_coeffs(attack_ms, audio_sample_rate/COMPRESSOR_CONTROL_PERIOD);
 
     // Set compressor release time
     if (release_ms > COMPRESSOR_MAX_RELEASE_MS ||
@@ -95,10 +104,15 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c,
         return COMPRESSOR_INVALID_RELEASE;
     }
     c->release_ms = release_ms;
-    c->release_coeff = calculate_lp_coeffs(release_ms, audio_sample_rate);
+    c->release_coeff = calculate_lp_coeffs(release_ms, audio_sample_rate/COMPRESSOR_CONTROL_PERIOD);
 
-    // Set RMS coefficient for 100ms
-    c->rms_coeff = calculate_rms_coeffs( 100.0, audio_sample_rate);
+    // Set up RMS level detector (level reported in dB)
+    envelope_follower_setup(&c->detector,
+                            ENV_FOLLOWER_LOG,
+                            COMPRESSOR_RMS_TIME_MS,
+                            COMPRESSOR_RMS_TIME_MS,
+                            COMPRESSOR_CONTROL_PERIOD,
+                            audio_sample_rate);
 
     // Set output gain
     if (output_gain > COMPRESSOR_MAX_GAIN ||
@@ -111,8 +125,8 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c,
     c->audio_sample_rate = audio_sample_rate;
 
     // Initialize state variables
-    c->x2_last = 0.0;
     c->x_ar_last = 0.0;
+    c->vca_last = 1.0;
 
     // Instance was successfully initialized
     c->initialized = true;
@@ -255,7 +269,7 @@ RESULT_COMPRESSOR   compressor_modify_attack(COMPRESSOR * c,
 
     // Update parameters
     c->attack_ms = attack_ms;
-    c->attack_coeff = calculate_lp_coeffs(attack_ms, c->audio_sample_rate);
+    c->attack_coeff = calculate_lp_coeffs(attack_ms, c->audio_sample_rate/COMPRESSOR_CONTROL_PERIOD);
 
     return res;
 
@@ -302,7 +316,7 @@ RESULT_COMPRESSOR   compressor_modify_release(COMPRESSOR * c,
 
     // Update parameters
     c->release_ms = release_ms;
-    c->release_coeff = calculate_lp_coeffs(release_ms, c->audio_sample_rate);
+    c->release_coeff = calculate_lp_coeffs(release_ms, c->audio_sample_rate/COMPRESSOR_CONTROL_PERIOD);
 
     return res;
 
@@ -368,22 +382,24 @@ void    compressor_read(COMPRESSOR * c,
         return;
     }
 
-    float x2_last = c->x2_last;
     float x_ar_last = c->x_ar_last;
+    float vca_last = c->vca_last;
+    float inv_period = 1.0/(float) COMPRESSOR_CONTROL_PERIOD;
 
-    float rms_ff = c->rms_coeff.ff;
-    float rms_fb = c->rms_coeff.fb;
+    for (int i=0;i<audio_block_size;i+=COMPRESSOR_CONTROL_PERIOD) {
 
-    for (int i=0;i<audio_block_size;i++) {
-        float x = audio_in[i];
+        uint32_t len = audio_block_size - i;
+        if (len > COMPRESSOR_CONTROL_PERIOD) {
+            len = COMPRESSOR_CONTROL_PERIOD;
+        }
 
-        // Calculate current signal RMS
-        float x2 = x*x;
-        float x2_lpf = rms_ff*x2 + rms_fb*x2_last;
-        x2_last = x2;
-        float x_rms = 0.5*log2f(x2_lpf);
+        // Measure RMS level over this control period (log2 of linear RMS)
+        float x_rms = COMPRESSOR_DB_TO_LOG2*envelope_follower_read(&c->detector,
+                                                                   &audio_in[i],
+                                                                   NULL,
+                                                                   len);
 
-        // Calculate and apply vca
+        // Calculate vca gain
         float x_thresh = c->threshold_coeff - x_rms;
         if (x_thresh > 0.0) {
             x_thresh = 0.0;
@@ -403,13 +419,20 @@ void    compressor_read(COMPRESSOR * c,
 
         float vca_coeff = powf(2.0, x_ar);
 
-        audio_out[i] = x * vca_coeff * c->output_gain;
-
+        // Ramp the gain across the control period and apply it
+        float vca = vca_last;
+        float vca_step = (vca_coeff - vca_last)*inv_period;
+        float gain = c->output_gain;
+        for (int j=0;j<len;j++) {
+            vca += vca_step;
+            audio_out[i+j] = audio_in[i+j] * vca * gain;
+        }
+        vca_last = vca;
     }
 
     // Save state variables for next time through
-    c->x2_last = x2_last;
     c->x_ar_last = x_ar_last;
+    c->vca_last = vca_last;
 
 }
 
@@ -444,23 +467,6 @@ static float calculate_ratio_coeff(float ratio) {
     return 1.0 - 1.0/ratio;
 }
 
-/**
- * @brief Calculates the RMS LPF coefficient
- * 
- * @param rms_fc RMS constant
- * @param fs Audio sample rate
- * 
- * @return Coefficient
- */
-static LP_COEFF calculate_rms_coeffs(float rms_fc, float fs) {
-    LP_COEFF coeffs;
-
-    coeffs.fb = expf(-PI2*rms_fc/fs);
-    coeffs.ff = 1.0 - coeffs.fb;
-
-    return coeffs;
-}
-
 /**
  * @brief Calculates attack / release coefficent
  * 
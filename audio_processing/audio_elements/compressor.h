@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "envelope_follower.h"
+
 // Result enumerations
 typedef enum
 {
@@ -49,13 +51,12 @@ typedef struct  {
     float   release_ms;
     float   release_ms_last;
 
-    LP_COEFF    rms_coeff;
+    ENVELOPE_FOLLOWER   detector;
     LP_COEFF    attack_coeff;
     LP_COEFF    release_coeff;
 
-    float   cur_rms;
-
-    float   x2_last, x_ar_last;
+    float   x_ar_last;
+    float   vca_last;
     float   audio_sample_rate;
 
 } COMPRESSOR;
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A crossfade between two multichannel signals, e.g. the outputs of the old
+ * and the new effect chain when switching presets.  While a crossfade is
+ * running, crossfade_read() mixes the two signals with gains that ramp from
+ * all old to all new over the crossfade length; once it has finished the new
+ * signal is passed straight through.
+ *
+ * The gain curves are either linear (the gains add up to one, which suits
+ * correlated signals such as dry and wet versions of the same input) or
+ * equal power (the squared gains add up to one, which suits unrelated
+ * signals).  The equal power gains are a quarter cycle of a cosine and sine,
+ * computed once per block and then rotated sample by sample.
+ *
+ * The gains move by the same amount every sample, so the output is
+ * continuous across block boundaries and at both ends of the crossfade.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "crossfade.h"
+
+// Min/max limits and other constants
+#define CROSSFADE_MAX_LENGTH    (1 << 20)           // About 20 seconds at 48 kHz
+
+
+/**
+ * @brief Initializes instance of a crossfade
+ *
+ * @param c Pointer to instance structure
+ * @param shape Shape of the gain curves (linear or equal power)
+ * @param length Length of a crossfade in samples (0 switches immediately)
+ * @return Crossfade result (enumeration)
+ */
+RESULT_CROSSFADE    crossfade_setup(CROSSFADE * c,
+                                    CROSSFADE_SHAPE shape,
+                                    uint32_t length) {
+
+    if (c == NULL) {
+        return CROSSFADE_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (length > CROSSFADE_MAX_LENGTH) {
+        return CROSSFADE_INVALID_LENGTH;
+    }
+
+    c->shape = shape;
+    c->length = length;
+
+    c->remaining = 0;
+    c->position = 1.0;
+    c->step = 0.0;
+
+    c->initialized = true;
+    return CROSSFADE_OK;
+}
+
+/**
+ * @brief Changes the length of the following crossfades
+ *
+ * A crossfade that is already running keeps its length.
+ *
+ * @param c Pointer to instance structure
+ * @param length Length of a crossfade in samples (0 switches immediately)
+ * @return Crossfade result (enumeration)
+ */
+RESULT_CROSSFADE    crossfade_modify_length(CROSSFADE * c,
+                                            uint32_t length) {
+
+    if (c == NULL) {
+        return CROSSFADE_INVALID_INSTANCE_POINTER;
+    }
+    if (length > CROSSFADE_MAX_LENGTH) {
+        return CROSSFADE_INVALID_LENGTH;
+    }
+
+    c->length = length;
+    return CROSSFADE_OK;
+}
+
+/**
+ * @brief Starts a crossfade from the old signal to the new one
+ *
+ * @param c Pointer to instance structure
+ */
+void    crossfade_start(CROSSFADE * c) {
+
+    if (c->length == 0) {
+        c->remaining = 0;
+        c->position = 1.0;
+        return;
+    }
+
+    c->remaining = c->length;
+    c->position = 0.0;
+    c->step = 1.0 / (float)c->length;
+}
+
+/**
+ * @brief Makes the current crossfade finish within max_remaining samples
+ *
+ * The gains carry on from where they are, just with a steeper ramp, so the
+ * output stays continuous.
+ *
+ * @param c Pointer to instance structure
+ * @param max_remaining Maximum number of samples left (at least 1)
+ */
+void    crossfade_shorten(CROSSFADE * c,
+                          uint32_t max_remaining) {
+
+    if (max_remaining < 1) {
+        max_remaining = 1;
+    }
+    if (c->remaining > max_remaining) {
+        c->remaining = max_remaining;
+        c->step = (1.0 - c->position) / (float)max_remaining;
+    }
+}
+
+/**
+ * @brief Checks whether a crossfade is running
+ *
+ * @param c Pointer to instance structure
+ * @return true until the crossfade has finished
+ */
+bool    crossfade_active(CROSSFADE * c) {
+    return (c->remaining > 0);
+}
+
+/**
+ * @brief Returns how far the crossfade has got
+ *
+ * @param c Pointer to instance structure
+ * @return 0.0 (all old) to 1.0 (all new)
+ */
+float   crossfade_position(CROSSFADE * c) {
+    return c->position;
+}
+
+/**
+ * @brief Mixes a block of the old and new signals
+ *
+ * The output buffers may be the same as either set of input buffers.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_old Pointers to the old signal (one per channel)
+ * @param audio_new Pointers to the new signal (one per channel)
+ * @param audio_out Pointers to the output buffers (one per channel)
+ * @param num_channels Number of channels (1->CROSSFADE_MAX_CHANNELS)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    crossfade_read(CROSSFADE * c,
+                       float ** audio_old,
+                       float ** audio_new,
+                       float ** audio_out,
+                       uint32_t num_channels,
+                       uint32_t audio_block_size) {
+
+    uint32_t fade_len = (c->remaining < audio_block_size) ? c->remaining : audio_block_size;
+
+    if (fade_len > 0) {
+
+        // Gains for the first sample of the block and the rotation per sample
+        float pos = c->position + c->step;
+        float step = c->step;
+        float rot_cos = 0.0, rot_sin = 0.0, start_cos = 0.0, start_sin = 0.0;
+        if (c->shape == CROSSFADE_EQUAL_POWER) {
+            rot_cos = cosf(step * (float)(PI / 2.0));
+            rot_sin = sinf(step * (float)(PI / 2.0));
+            start_cos = cosf(pos * (float)(PI / 2.0));
+            start_sin = sinf(pos * (float)(PI / 2.0));
+        }
+
+        for (int ch=0;ch<num_channels;ch++) {
+            float * old_in = audio_old[ch];
+            float * new_in = audio_new[ch];
+            float * out = audio_out[ch];
+
+            if (c->shape == CROSSFADE_EQUAL_POWER) {
+                float gain_old = start_cos;
+                float gain_new = start_sin;
+                for (int i=0;i<fade_len;i++) {
+                    out[i] = old_in[i] * gain_old + new_in[i] * gain_new;
+
+                    float g = gain_old * rot_cos - gain_new * rot_sin;
+                    gain_new = gain_new * rot_cos + gain_old * rot_sin;
+                    gain_old = g;
+                }
+            }
+            else {
+                float gain_new = pos;
+                for (int i=0;i<fade_len;i++) {
+                    out[i] = old_in[i] + (new_in[i] - old_in[i]) * gain_new;
+                    gain_new += step;
+                }
+            }
+        }
+
+        c->remaining -= fade_len;
+        c->position = (c->remaining == 0) ? 1.0 : c->position + step * (float)fade_len;
+    }
+
+    // Rest of the block is all new
+    if (fade_len < audio_block_size) {
+        for (int ch=0;ch<num_channels;ch++) {
+            if (audio_out[ch] != audio_new[ch]) {
+                float * new_in = audio_new[ch];
+                float * out = audio_out[ch];
+                for (int i=fade_len;i<audio_block_size;i++) {
+                    out[i] = new_in[i];
+                }
+            }
+        }
+    }
+}
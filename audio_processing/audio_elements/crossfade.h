@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CROSSFADE_H
+#define _CROSSFADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define CROSSFADE_MAX_CHANNELS  (2)
+
+// Result enumerations
+typedef enum
+{
+    CROSSFADE_OK,
+    CROSSFADE_INVALID_INSTANCE_POINTER,
+    CROSSFADE_INVALID_LENGTH
+} RESULT_CROSSFADE;
+
+// Shape of the gain curves
+typedef enum
+{
+    CROSSFADE_LINEAR,                   // Constant amplitude, for correlated signals (e.g. dry vs. wet)
+    CROSSFADE_EQUAL_POWER               // Constant power, for unrelated signals (e.g. two effect chains)
+} CROSSFADE_SHAPE;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    CROSSFADE_SHAPE shape;
+    uint32_t    length;                 // Samples per crossfade
+
+    // Current crossfade
+    uint32_t    remaining;              // Samples left (0 when finished)
+    float       position;               // 0.0 (all old) to 1.0 (all new)
+    float       step;                   // Change in position per sample
+
+} CROSSFADE;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_CROSSFADE    crossfade_setup(CROSSFADE * c,
+                                    CROSSFADE_SHAPE shape,
+                                    uint32_t length);
+
+RESULT_CROSSFADE    crossfade_modify_length(CROSSFADE * c,
+                                            uint32_t length);
+
+void    crossfade_start(CROSSFADE * c);
+
+void    crossfade_shorten(CROSSFADE * c,
+                          uint32_t max_remaining);
+
+bool    crossfade_active(CROSSFADE * c);
+
+float   crossfade_position(CROSSFADE * c);
+
+void    crossfade_read(CROSSFADE * c,
+                       float ** audio_old,
+                       float ** audio_new,
+                       float ** audio_out,
+                       uint32_t num_channels,
+                       uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _CROSSFADE_H
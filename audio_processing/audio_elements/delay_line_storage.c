@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * Long delay lines live in external SDRAM and a 32000 sample float delay line
+ * costs 128 KB.  These routines allow delay elements to keep their delay line
+ * in a 16-bit format instead, halving the memory footprint and the SDRAM
+ * bandwidth (or doubling the available delay time).
+ *
+ * Two 16-bit formats are supported:
+ *
+ *  - DELAY_STORAGE_INT16: 16-bit fixed point.  Best resolution (~96 dB SNR)
+ *    for signals within +/-1.0 but saturates anything louder.
+ *  - DELAY_STORAGE_FP16: IEEE half precision float.  ~66 dB SNR relative to
+ *    the signal level but with lots of headroom, which suits delays with
+ *    high feedback.  Values below the smallest normal half (~6e-5) are
+ *    flushed to zero.
+ *
+ * Samples are converted a block at a time with simple loops that the compiler
+ * can vectorize.  The read and write routines take care of wrapping around the
+ * end of the circular delay line.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "delay_line_storage.h"
+
+// Scaling constants for the 16-bit fixed point format
+#define DELAY_STORAGE_INT16_SCALE       (32767.0)
+#define DELAY_STORAGE_INT16_INV_SCALE   (1.0/32767.0)
+
+// Largest finite half precision value (65504.0)
+#define DELAY_STORAGE_FP16_MAX          (0x7BFF)
+
+// Allows the bit patterns of floats to be manipulated
+typedef union {
+    float       f;
+    uint32_t    u;
+} FLOAT_BITS;
+
+/**
+ * @brief Converts a 32-bit float to a half precision float
+ *
+ * Rounds to nearest, saturates to the largest finite value and flushes
+ * denormals to zero.
+ *
+ * @param x Floating point value
+ * @return Half precision bit pattern
+ */
+static inline uint16_t float_to_fp16(float x) {
+
+    FLOAT_BITS v;
+    v.f = x;
+
+    uint32_t sign = (v.u >> 16) & 0x8000;
+    int32_t exponent = (int32_t) ((v.u >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = v.u & 0x7FFFFF;
+
+    if (exponent <= 0) {
+        return (uint16_t) sign;
+    }
+    if (exponent >= 31) {
+        return (uint16_t) (sign | DELAY_STORAGE_FP16_MAX);
+    }
+
+    // Round to nearest (a carry into the exponent is valid)
+    uint32_t h = ((uint32_t) exponent << 10) | (mantissa >> 13);
+    h += (mantissa >> 12) & 1;
+    if (h > DELAY_STORAGE_FP16_MAX) {
+        h = DELAY_STORAGE_FP16_MAX;
+    }
+
+    return (uint16_t) (sign | h);
+}
+
+/**
+ * @brief Converts a half precision float to a 32-bit float
+ *
+ * @param h Half precision bit pattern
+ * @return Floating point value
+ */
+static inline float fp16_to_float(uint16_t h) {
+
+    FLOAT_BITS v;
+
+    uint32_t sign = ((uint32_t) h & 0x8000) << 16;
+    uint32_t exponent = ((uint32_t) h >> 10) & 0x1F;
+    uint32_t mantissa = (uint32_t) h & 0x3FF;
+
+    if (exponent == 0) {
+        v.u = sign;
+    } else {
+        v.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    return v.f;
+}
+
+/**
+ * @brief Converts a 32-bit float to 16-bit fixed point with saturation
+ *
+ * @param x Floating point value
+ * @return 16-bit fixed point value
+ */
+static inline int16_t float_to_int16(float x) {
+
+    float scaled = x * DELAY_STORAGE_INT16_SCALE;
+    if (scaled > DELAY_STORAGE_INT16_SCALE) {
+        scaled = DELAY_STORAGE_INT16_SCALE;
+    } else if (scaled < -DELAY_STORAGE_INT16_SCALE) {
+        scaled = -DELAY_STORAGE_INT16_SCALE;
+    }
+
+    return (int16_t) lrintf(scaled);
+}
+
+/**
+ * @brief Returns the number of bytes used to store one sample in a format
+ *
+ * @param format Storage format
+ * @return Bytes per sample
+ */
+uint32_t    delay_storage_bytes_per_sample(DELAY_STORAGE_FORMAT format) {
+
+    if (format == DELAY_STORAGE_FLOAT) {
+        return sizeof(float);
+    }
+    return sizeof(int16_t);
+}
+
+/**
+ * @brief Zeros a delay line
+ *
+ * @param delay_line Pointer to delay line
+ * @param format Storage format of delay line
+ * @param delay_line_size Size of delay line in samples
+ */
+void    delay_storage_clear(void * delay_line,
+                            DELAY_STORAGE_FORMAT format,
+                            uint32_t delay_line_size) {
+
+    if (format == DELAY_STORAGE_FLOAT) {
+        float * line = (float *) delay_line;
+        for (int i=0;i<delay_line_size;i++) {
+            line[i] = 0.0;
+        }
+    } else {
+        // Zero is all bits clear in both 16-bit formats
+        int16_t * line = (int16_t *) delay_line;
+        for (int i=0;i<delay_line_size;i++) {
+            line[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Converts a contiguous block of floats into a storage format
+ *
+ * @param input Pointer to floating point samples
+ * @param output Pointer to packed samples
+ * @param format Storage format
+ * @param num_samples Number of samples to convert
+ */
+#pragma optimize_for_speed
+void    delay_storage_pack(float * input,
+                           void * output,
+                           DELAY_STORAGE_FORMAT format,
+                           uint32_t num_samples) {
+
+    switch (format) {
+        case DELAY_STORAGE_INT16: {
+            int16_t * out = (int16_t *) output;
+            for (int i=0;i<num_samples;i++) {
+                out[i] = float_to_int16(input[i]);
+            }
+            break;
+        }
+        case DELAY_STORAGE_FP16: {
+            uint16_t * out = (uint16_t *) output;
+            for (int i=0;i<num_samples;i++) {
+                out[i] = float_to_fp16(input[i]);
+            }
+            break;
+        }
+        default: {
+            float * out = (float *) output;
+            for (int i=0;i<num_samples;i++) {
+                out[i] = input[i];
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Converts a contiguous block of packed samples back to floats
+ *
+ * @param input Pointer to packed samples
+ * @param output Pointer to floating point samples
+ * @param format Storage format
+ * @param num_samples Number of samples to convert
+ */
+#pragma optimize_for_speed
+void    delay_storage_unpack(void * input,
+                             float * output,
+                             DELAY_STORAGE_FORMAT format,
+                             uint32_t num_samples) {
+
+    switch (format) {
+        case DELAY_STORAGE_INT16: {
+            int16_t * in = (int16_t *) input;
+            for (int i=0;i<num_samples;i++) {
+                output[i] = (float) in[i] * DELAY_STORAGE_INT16_INV_SCALE;
+            }
+            break;
+        }
+        case DELAY_STORAGE_FP16: {
+            uint16_t * in = (uint16_t *) input;
+            for (int i=0;i<num_samples;i++) {
+                output[i] = fp16_to_float(in[i]);
+            }
+            break;
+        }
+        default: {
+            float * in = (float *) input;
+            for (int i=0;i<num_samples;i++) {
+                output[i] = in[i];
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Writes a block of samples into a circular delay line
+ *
+ * @param delay_line Pointer to delay line
+ * @param format Storage format of delay line
+ * @param delay_line_size Size of delay line in samples
+ * @param index Position in the delay line of the first sample
+ * @param input Pointer to floating point samples
+ * @param num_samples Number of samples to write
+ */
+void    delay_storage_write(void * delay_line,
+                            DELAY_STORAGE_FORMAT format,
+                            uint32_t delay_line_size,
+                            uint32_t index,
+                            float * input,
+                            uint32_t num_samples) {
+
+    uint32_t bytes = delay_storage_bytes_per_sample(format);
+
+    // Split the block in two if it wraps around the end of the delay line
+    uint32_t first = delay_line_size - index;
+    if (first > num_samples) {
+        first = num_samples;
+    }
+
+    delay_storage_pack(input, (char *) delay_line + index*bytes, format, first);
+    if (first < num_samples) {
+        delay_storage_pack(input + first, delay_line, format, num_samples - first);
+    }
+}
+
+/**
+ * @brief Reads a block of samples out of a circular delay line
+ *
+ * @param delay_line Pointer to delay line
+ * @param format Storage format of delay line
+ * @param delay_line_size Size of delay line in samples
+ * @param index Position in the delay line of the first sample
+ * @param output Pointer to floating point samples
+ * @param num_samples Number of samples to read
+ */
+void    delay_storage_read(void * delay_line,
+                           DELAY_STORAGE_FORMAT format,
+                           uint32_t delay_line_size,
+                           uint32_t index,
+                           float * output,
+                           uint32_t num_samples) {
+
+    uint32_t bytes = delay_storage_bytes_per_sample(format);
+
+    // Split the block in two if it wraps around the end of the delay line
+    uint32_t first = delay_line_size - index;
+    if (first > num_samples) {
+        first = num_samples;
+    }
+
+    delay_storage_unpack((char *) delay_line + index*bytes, output, format, first);
+    if (first < num_samples) {
+        delay_storage_unpack(delay_line, output + first, format, num_samples - first);
+    }
+}
+
+/**
+ * @brief Reads a single sample out of a delay line
+ *
+ * @param delay_line Pointer to delay line
+ * @param format Storage format of delay line
+ * @param index Position in the delay line
+ * @return Floating point sample
+ */
+float   delay_storage_read_sample(void * delay_line,
+                                  DELAY_STORAGE_FORMAT format,
+                                  uint32_t index) {
+
+    switch (format) {
+        case DELAY_STORAGE_INT16:
+            return (float) ((int16_t *) delay_line)[index] * DELAY_STORAGE_INT16_INV_SCALE;
+        case DELAY_STORAGE_FP16:
+            return fp16_to_float(((uint16_t *) delay_line)[index]);
+        default:
+            return ((float *) delay_line)[index];
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _DELAY_LINE_STORAGE_H
+#define _DELAY_LINE_STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Sample formats that a delay line can be stored in
+typedef enum
+{
+    DELAY_STORAGE_FLOAT,        // 32-bit float (default)
+    DELAY_STORAGE_INT16,        // 16-bit fixed point, saturates at +/-1.0
+    DELAY_STORAGE_FP16          // IEEE 754 half precision float
+} DELAY_STORAGE_FORMAT;
+
+
+#if __cplusplus
+extern "C" {
+#endif
+
+uint32_t    delay_storage_bytes_per_sample(DELAY_STORAGE_FORMAT format);
+
+void    delay_storage_clear(void * delay_line,
+                            DELAY_STORAGE_FORMAT format,
+                            uint32_t delay_line_size);
+
+void    delay_storage_pack(float * input,
+                           void * output,
+                           DELAY_STORAGE_FORMAT format,
+                           uint32_t num_samples);
+
+void    delay_storage_unpack(void * input,
+                             float * output,
+                             DELAY_STORAGE_FORMAT format,
+                             uint32_t num_samples);
+
+void    delay_storage_write(void * delay_line,
+                            DELAY_STORAGE_FORMAT format,
+                            uint32_t delay_line_size,
+                            uint32_t index,
+                            float * input,
+                            uint32_t num_samples);
+
+void    delay_storage_read(void * delay_line,
+                           DELAY_STORAGE_FORMAT format,
+                           uint32_t delay_line_size,
+                           uint32_t index,
+                           float * output,
+                           uint32_t num_samples);
+
+float   delay_storage_read_sample(void * delay_line,
+                                  DELAY_STORAGE_FORMAT format,
+                                  uint32_t index);
+
+#if __cplusplus
+}
+#endif
+
+
+#endif  // _DELAY_LINE_STORAGE_H
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * Early reflections are the first distinct echoes from the walls, floor and
+ * ceiling of a room.  They arrive within the first ~100ms and give the ear
+ * most of its sense of room size and source position.  The stereo reverb
+ * (effect_stereo_reverb.c) only models the diffuse tail, so this element is
+ * intended to run ahead of it.
+ *
+ * The element is a sparse FIR: one shared delay line and a list of
+ * (delay, gain) tap pairs for each output channel.  The cost is proportional
+ * to the number of taps; each tap reads a contiguous block from the delay line.
+ *
+ * The tap tables below were generated offline with the image-source method
+ * for a rectangular (shoebox) room.  The source and a pair of spaced
+ * microphones (30cm apart) are placed in the room, and images up to
+ * 6th order are computed.  Each reflection's gain is
+ * (wall reflection)^order * (direct distance / image distance), and its delay
+ * is taken relative to the direct sound (which is passed through dry).
+ * Coincident images are merged, and the first 64 arrivals are kept, sorted
+ * by arrival time.  At setup the first num_reflections entries are
+ * converted to samples and normalized to unit energy.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "early_reflections.h"
+
+// Min/max limits and other constants
+#define EARLY_REFLECTIONS_LEVEL_MIN     (0.0)
+#define EARLY_REFLECTIONS_LEVEL_MAX     (1.0)
+
+/*
+ * Precomputed reflection tables ({delay in ms, gain})
+ *
+ * Positions are (x, y, z) in meters from one corner of the room.  The left
+ * and right microphones are 15cm either side of the listed point along y
+ * (left at +y).  The source and microphones are kept off each other's
+ * mirror image across the room, which would make pairs of images arrive
+ * together and sum to more than the first reflection.
+ *
+ * Small room  : 5.0 x 4.0 x 2.7m, wall reflection 0.85,
+ *               source (3.6, 2.5, 1.4), microphones (1.5, 1.7, 1.2)
+ * Medium room : 10.0 x 7.5 x 3.5m, wall reflection 0.80,
+ *               source (7.0, 4.6, 1.6), microphones (2.6, 3.4, 1.4)
+ * Hall        : 24.0 x 16.0 x 9.0m, wall reflection 0.75,
+ *               source (5.2, 8.6, 1.8), microphones (17.3, 7.4, 1.6)
+ *
+ * Along each axis of length L, a source at s has images at 2nL + s (|2n|
+ * reflections) and 2nL - s (|2n - 1| reflections).  An image's order is
+ * the total reflections across the three axes, and images of order 1 to 6
+ * are kept.  With the speed of sound at 343 m/s:
+ *
+ *   delay_ms = 1000 * (image distance - direct distance) / 343
+ *   gain     = (wall reflection)^order * direct distance / image distance
+ *
+ * So no reflection is louder than the first one, and the gain of each
+ * order falls off with the length of its path.
+ */
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_small_left[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  3.491, 0.5511}, {  3.943, 0.5271}, {  5.855, 0.4451}, {  7.659, 0.3881},
+    {  7.987, 0.3793}, {  7.993, 0.3223}, {  8.308, 0.3154}, {  8.565, 0.3647},
+    {  9.558, 0.2907}, {  9.842, 0.2856}, {  9.847, 0.2856}, { 10.024, 0.2825},
+    { 10.127, 0.2807}, { 10.361, 0.2768}, { 10.632, 0.2724}, { 11.104, 0.2651},
+    { 11.388, 0.2609}, { 11.858, 0.2542}, { 12.676, 0.2433}, { 12.924, 0.2042},
+    { 13.072, 0.2026}, { 13.116, 0.2378}, { 13.159, 0.2017}, { 13.358, 0.1997},
+    { 13.588, 0.1974}, { 13.992, 0.1935}, { 14.116, 0.1923}, { 14.257, 0.1910},
+    { 14.339, 0.1902}, { 14.481, 0.1889}, { 14.526, 0.1885}, { 14.744, 0.1866},
+    { 14.884, 0.1854}, { 15.126, 0.1833}, { 15.341, 0.1815}, { 15.728, 0.1783},
+    { 15.858, 0.2086}, { 16.682, 0.2011}, { 16.956, 0.1436}, { 17.104, 0.1679},
+    { 17.299, 0.1665}, { 17.316, 0.1414}, { 17.728, 0.1390}, { 17.753, 0.1634},
+    { 17.886, 0.1625}, { 17.952, 0.1377}, { 18.074, 0.1613}, { 18.077, 0.1370},
+    { 18.298, 0.1358}, { 18.315, 0.1597}, { 18.694, 0.1337}, { 18.943, 0.1557},
+    { 19.030, 0.1319}, { 19.325, 0.1534}, { 19.522, 0.1791}, { 19.653, 0.1515},
+    { 19.864, 0.1503}, { 19.922, 0.1275}, { 20.044, 0.1269}, { 20.217, 0.1260},
+    { 20.411, 0.1251}, { 20.439, 0.1250}, { 20.518, 0.1246}, { 20.581, 0.1243}
+};
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_small_right[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  3.385, 0.5660}, {  3.828, 0.5422}, {  6.310, 0.4392}, {  6.568, 0.4306},
+    {  7.818, 0.3937}, {  8.340, 0.3231}, {  8.391, 0.3788}, {  8.564, 0.3183},
+    {  8.641, 0.3167}, {  8.861, 0.3123}, {  9.663, 0.2970}, {  9.838, 0.2939},
+    {  9.940, 0.2921}, { 10.173, 0.2881}, { 10.442, 0.2835}, { 10.910, 0.2760},
+    { 11.614, 0.2654}, { 11.798, 0.2628}, { 12.071, 0.2590}, { 12.251, 0.2565},
+    { 13.108, 0.2086}, { 13.253, 0.2071}, { 13.279, 0.2069}, { 13.338, 0.2063},
+    { 13.423, 0.2054}, { 13.507, 0.2045}, { 13.532, 0.2043}, { 13.699, 0.2026},
+    { 13.757, 0.2020}, { 13.922, 0.2004}, { 14.151, 0.1982}, { 14.269, 0.1971},
+    { 14.313, 0.1967}, { 14.670, 0.1934}, { 14.709, 0.2271}, { 15.125, 0.1894},
+    { 15.510, 0.1861}, { 16.002, 0.1821}, { 16.202, 0.1805}, { 16.460, 0.2100},
+    { 17.057, 0.1479}, { 17.199, 0.1470}, { 17.411, 0.1458}, { 17.527, 0.1707},
+    { 17.552, 0.1449}, { 17.660, 0.1697}, { 17.816, 0.1434}, { 17.847, 0.1684},
+    { 17.954, 0.1426}, { 18.088, 0.1668}, { 18.160, 0.1414}, { 18.293, 0.1654},
+    { 18.296, 0.1406}, { 18.630, 0.1632}, { 19.012, 0.1608}, { 19.144, 0.1600},
+    { 19.408, 0.1346}, { 19.519, 0.1341}, { 19.583, 0.1337}, { 19.731, 0.1330},
+    { 19.904, 0.1321}, { 19.978, 0.1318}, { 20.063, 0.1818}, { 20.098, 0.1312}
+};
+
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_medium_left[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  2.624, 0.6674}, {  4.404, 0.5999}, { 10.542, 0.4448}, { 10.610, 0.3548},
+    { 11.589, 0.3408}, { 12.095, 0.3340}, { 13.245, 0.3195}, { 13.808, 0.3910},
+    { 14.960, 0.3750}, { 15.183, 0.2977}, { 16.212, 0.2872}, { 16.281, 0.2866},
+    { 17.274, 0.2772}, { 17.279, 0.3465}, { 17.725, 0.2186}, { 18.485, 0.2133},
+    { 18.504, 0.2665}, { 18.798, 0.2112}, { 19.429, 0.2589}, { 20.298, 0.2018},
+    { 21.001, 0.1976}, { 21.187, 0.2457}, { 21.234, 0.1963}, { 21.475, 0.1949},
+    { 21.918, 0.1925}, { 22.277, 0.1905}, { 23.106, 0.1862}, { 23.110, 0.2327},
+    { 23.155, 0.1859}, { 23.518, 0.2301}, { 23.804, 0.1827}, { 24.144, 0.1810},
+    { 24.394, 0.1438}, { 24.541, 0.1791}, { 24.933, 0.1772}, { 25.321, 0.1755},
+    { 25.325, 0.2193}, { 26.301, 0.1711}, { 26.488, 0.1362}, { 26.537, 0.1361},
+    { 26.697, 0.1355}, { 27.047, 0.1679}, { 27.083, 0.1342}, { 27.329, 0.1334},
+    { 28.166, 0.1307}, { 28.524, 0.1296}, { 28.723, 0.1290}, { 28.737, 0.1289},
+    { 28.974, 0.1282}, { 29.090, 0.1279}, { 29.139, 0.1277}, { 29.449, 0.1981},
+    { 29.474, 0.1267}, { 30.123, 0.1248}, { 30.248, 0.1244}, { 30.332, 0.1553},
+    { 30.669, 0.1233}, { 31.010, 0.1529}, { 31.039, 0.1222}, { 31.878, 0.0960},
+    { 32.387, 0.1853}, { 33.214, 0.1456}, { 33.362, 0.0929}, { 33.512, 0.0926}
+};
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_medium_right[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  2.586, 0.6708}, {  4.347, 0.6044}, { 10.508, 0.3591}, { 11.052, 0.4389},
+    { 11.483, 0.3450}, { 12.561, 0.3307}, { 12.812, 0.4094}, { 13.682, 0.3170},
+    { 14.225, 0.3108}, { 14.839, 0.3801}, { 15.280, 0.2994}, { 16.155, 0.2905},
+    { 17.144, 0.2811}, { 17.150, 0.3514}, { 18.067, 0.2183}, { 18.371, 0.2703},
+    { 18.663, 0.2143}, { 18.814, 0.2133}, { 19.293, 0.2627}, { 19.453, 0.2091},
+    { 20.169, 0.2047}, { 21.093, 0.1992}, { 21.333, 0.1978}, { 21.472, 0.2463},
+    { 21.775, 0.1953}, { 22.547, 0.1911}, { 22.728, 0.2377}, { 23.009, 0.1887},
+    { 23.364, 0.1869}, { 23.369, 0.2336}, { 23.656, 0.1854}, { 23.766, 0.1849},
+    { 24.389, 0.1818}, { 24.558, 0.1810}, { 24.562, 0.2262}, { 24.636, 0.1445},
+    { 25.168, 0.1782}, { 25.552, 0.1764}, { 25.791, 0.1403}, { 26.307, 0.1730},
+    { 26.705, 0.1371}, { 26.912, 0.1364}, { 27.175, 0.1355}, { 27.294, 0.1351},
+    { 27.802, 0.1334}, { 28.004, 0.1328}, { 28.365, 0.1316}, { 28.375, 0.1316},
+    { 28.386, 0.2056}, { 28.816, 0.1302}, { 28.931, 0.1299}, { 28.981, 0.1297},
+    { 29.286, 0.1610}, { 29.316, 0.1287}, { 29.420, 0.1284}, { 29.971, 0.1268},
+    { 29.977, 0.1584}, { 30.089, 0.1264}, { 30.878, 0.1242}, { 32.043, 0.0968},
+    { 32.224, 0.1883}, { 32.843, 0.1189}, { 33.014, 0.0948}, { 33.050, 0.1479}
+};
+
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_hall_left[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  1.356, 0.7223}, { 19.954, 0.4797}, { 22.725, 0.4568}, { 23.422, 0.4514},
+    { 23.561, 0.3378}, { 24.249, 0.3339}, { 27.410, 0.3171}, { 28.377, 0.3123},
+    { 30.257, 0.4044}, { 30.999, 0.2999}, { 36.324, 0.2083}, { 36.639, 0.2765},
+    { 37.203, 0.2743}, { 38.995, 0.3570}, { 39.650, 0.2654}, { 42.515, 0.1917},
+    { 42.843, 0.2546}, { 43.036, 0.1904}, { 43.296, 0.1898}, { 43.813, 0.1886},
+    { 44.827, 0.2483}, { 45.334, 0.2467}, { 45.435, 0.1848}, { 45.938, 0.1836},
+    { 48.285, 0.1785}, { 49.013, 0.1770}, { 49.864, 0.1314}, { 50.308, 0.2324},
+    { 50.341, 0.1307}, { 52.123, 0.2276}, { 52.588, 0.2264}, { 52.680, 0.1696},
+    { 53.142, 0.1687}, { 55.167, 0.1237}, { 55.302, 0.1647}, { 55.416, 0.1645},
+    { 55.865, 0.1637}, { 55.974, 0.1635}, { 60.145, 0.1173}, { 60.571, 0.1167},
+    { 60.783, 0.1165}, { 61.206, 0.1160}, { 61.471, 0.2056}, { 61.689, 0.1154},
+    { 61.921, 0.1535}, { 61.975, 0.1534}, { 62.340, 0.1528}, { 66.011, 0.1473},
+    { 66.227, 0.0827}, { 66.348, 0.1101}, { 66.628, 0.0824}, { 66.748, 0.1097},
+    { 66.947, 0.1095}, { 67.198, 0.1941}, { 67.345, 0.1090}, { 67.674, 0.1449},
+    { 69.297, 0.1902}, { 69.763, 0.1420}, { 70.408, 0.1412}, { 72.080, 0.0782},
+    { 72.459, 0.0779}, { 74.493, 0.1020}, { 74.802, 0.1017}, { 75.048, 0.1014}
+};
+static const EARLY_REFLECTION_TABLE_ENTRY er_room_hall_right[EARLY_REFLECTIONS_MAX_TAPS] = {
+    {  1.353, 0.7225}, { 19.923, 0.4804}, { 22.639, 0.4580}, { 23.336, 0.4525},
+    { 23.475, 0.3386}, { 24.162, 0.3347}, { 27.373, 0.3176}, { 28.339, 0.3128},
+    { 30.218, 0.4051}, { 30.958, 0.3005}, { 36.281, 0.2086}, { 36.552, 0.2771},
+    { 37.117, 0.2750}, { 38.950, 0.3576}, { 39.605, 0.2659}, { 42.428, 0.1922},
+    { 42.796, 0.2550}, { 42.950, 0.1909}, { 43.210, 0.1903}, { 43.726, 0.1890},
+    { 44.741, 0.2489}, { 45.248, 0.2473}, { 45.349, 0.1852}, { 45.852, 0.1841},
+    { 48.235, 0.1789}, { 48.963, 0.1773}, { 49.778, 0.1317}, { 50.255, 0.1310},
+    { 50.257, 0.2329}, { 52.036, 0.2281}, { 52.501, 0.2269}, { 52.594, 0.1700},
+    { 53.056, 0.1691}, { 55.115, 0.1240}, { 55.250, 0.1650}, { 55.330, 0.1649},
+    { 55.778, 0.1641}, { 55.922, 0.1638}, { 60.058, 0.1175}, { 60.484, 0.1170},
+    { 60.571, 0.2079}, { 60.697, 0.1168}, { 61.079, 0.1551}, { 61.120, 0.1163},
+    { 61.634, 0.1156}, { 61.835, 0.1539}, { 62.253, 0.1532}, { 65.955, 0.1476},
+    { 66.141, 0.0829}, { 66.261, 0.1104}, { 66.542, 0.0826}, { 66.661, 0.1099},
+    { 66.861, 0.1097}, { 67.259, 0.1093}, { 67.933, 0.1931}, { 68.405, 0.1441},
+    { 69.240, 0.1907}, { 69.577, 0.1425}, { 69.706, 0.1424}, { 71.993, 0.0784},
+    { 72.372, 0.0781}, { 73.690, 0.1029}, { 74.249, 0.1023}, { 74.743, 0.1019}
+};
+
+static const EARLY_REFLECTION_TABLE_ENTRY * er_room_tables_left[EARLY_REFLECTIONS_NUM_ROOMS] = {
+    er_room_small_left, er_room_medium_left, er_room_hall_left
+};
+static const EARLY_REFLECTION_TABLE_ENTRY * er_room_tables_right[EARLY_REFLECTIONS_NUM_ROOMS] = {
+    er_room_small_right, er_room_medium_right, er_room_hall_right
+};
+
+// Static function prototypes
+static RESULT_EARLY_REFLECTIONS early_reflections_load_taps(EARLY_REFLECTIONS * c,
+                                                            const EARLY_REFLECTION_TABLE_ENTRY * table,
+                                                            EARLY_REFLECTION_TAP * taps);
+static void early_reflections_accumulate(EARLY_REFLECTIONS * c,
+                                         EARLY_REFLECTION_TAP * taps,
+                                         uint32_t write_index,
+                                         float * audio_out,
+                                         uint32_t audio_block_size);
+
+
+/**
+ * @brief Initializes instance of an early reflections generator
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to delay line
+ * @param delay_line_size Length of delay line in floating point words
+ * @param room Room geometry to use (see enumeration)
+ * @param num_reflections Number of reflections per channel (1->64)
+ * @param level Level of reflections mixed with the dry signal (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Early reflections result (enumeration)
+ */
+RESULT_EARLY_REFLECTIONS    early_reflections_setup(EARLY_REFLECTIONS * c,
+                                                    float * delay_line,
+                                                    uint32_t delay_line_size,
+                                                    EARLY_REFLECTIONS_ROOM room,
+                                                    uint32_t num_reflections,
+                                                    float level,
+                                                    float audio_sample_rate) {
+
+    if (c == NULL) {
+        return EARLY_REFLECTIONS_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (delay_line == NULL) {
+        return EARLY_REFLECTIONS_INVALID_DELAY_LINE_POINTER;
+    }
+
+    if (room >= EARLY_REFLECTIONS_NUM_ROOMS) {
+        return EARLY_REFLECTIONS_INVALID_ROOM;
+    }
+
+    if (num_reflections < 1 ||
+        num_reflections > EARLY_REFLECTIONS_MAX_TAPS) {
+        return EARLY_REFLECTIONS_TOO_MANY_TAPS;
+    }
+
+    if (level < EARLY_REFLECTIONS_LEVEL_MIN ||
+        level > EARLY_REFLECTIONS_LEVEL_MAX) {
+        return EARLY_REFLECTIONS_INVALID_LEVEL;
+    }
+
+    // Set parameters
+    c->delay_line = delay_line;
+    c->delay_line_size = delay_line_size;
+    c->num_taps = num_reflections;
+    c->level = level;
+    c->audio_sample_rate = audio_sample_rate;
+
+    RESULT_EARLY_REFLECTIONS res;
+    res = early_reflections_load_taps(c, er_room_tables_left[room], c->taps_left);
+    if (res != EARLY_REFLECTIONS_OK) {
+        return res;
+    }
+    res = early_reflections_load_taps(c, er_room_tables_right[room], c->taps_right);
+    if (res != EARLY_REFLECTIONS_OK) {
+        return res;
+    }
+
+    // Zero delay line
+    for (int i=0;i<delay_line_size;i++) {
+        delay_line[i] = 0.0;
+    }
+    c->write_index = 0;
+
+    c->initialized = true;
+    return EARLY_REFLECTIONS_OK;
+}
+
+/**
+ * @brief Modify level of the early reflections
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param level_new Updated level (0.0->1.0)
+ * @return Early reflections result (enumeration)
+ */
+RESULT_EARLY_REFLECTIONS    early_reflections_modify_level(EARLY_REFLECTIONS * c,
+                                                           float level_new) {
+
+    RESULT_EARLY_REFLECTIONS res;
+
+    float level;
+    if (level_new > EARLY_REFLECTIONS_LEVEL_MAX) {
+        level = EARLY_REFLECTIONS_LEVEL_MAX;
+        res = EARLY_REFLECTIONS_INVALID_LEVEL;
+    }
+    else if (level_new < EARLY_REFLECTIONS_LEVEL_MIN) {
+        level = EARLY_REFLECTIONS_LEVEL_MIN;
+        res = EARLY_REFLECTIONS_INVALID_LEVEL;
+    }
+    else {
+        level = level_new;
+        res = EARLY_REFLECTIONS_OK;
+    }
+
+    c->level = level;
+
+    return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * The outputs contain the dry signal plus the early reflections.  The input
+ * and output buffers may be the same buffers (in place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out_left Pointer to floating point output buffer (left)
+ * @param audio_out_right Pointer to floating point output buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+void    early_reflections_read(EARLY_REFLECTIONS * c,
+                               float * audio_in,
+                               float * audio_out_left,
+                               float * audio_out_right,
+                               uint32_t audio_block_size) {
+
+    early_reflections_read_stereo(c,
+                                  audio_in,
+                                  audio_in,
+                                  audio_out_left,
+                                  audio_out_right,
+                                  audio_block_size);
+}
+
+/**
+ * @brief Apply effect/process to a block of stereo audio data
+ *
+ * The reflections are generated from the mono sum of the inputs and are
+ * added to each (dry) input channel, preserving the stereo image of the
+ * input.  The input and output buffers may be the same buffers (in place
+ * processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in_left Pointer to floating point audio input buffer (left)
+ * @param audio_in_right Pointer to floating point audio input buffer (right)
+ * @param audio_out_left Pointer to floating point output buffer (left)
+ * @param audio_out_right Pointer to floating point output buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    early_reflections_read_stereo(EARLY_REFLECTIONS * c,
+                                      float * audio_in_left,
+                                      float * audio_in_right,
+                                      float * audio_out_left,
+                                      float * audio_out_right,
+                                      uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out_left[i] = audio_in_left[i];
+            audio_out_right[i] = audio_in_right[i];
+        }
+        return;
+    }
+
+    float   er_left[MAX_AUDIO_BLOCK_SIZE], er_right[MAX_AUDIO_BLOCK_SIZE];
+
+    float   * delay_line = c->delay_line;
+    uint32_t len = c->delay_line_size;
+    uint32_t start_indx = c->write_index;
+    uint32_t indx = start_indx;
+
+    // Write the block into the delay line first (taps are at least one sample)
+    for (int i=0;i<audio_block_size;i++) {
+        delay_line[indx] = 0.5*(audio_in_left[i] + audio_in_right[i]);
+        indx++;
+        if (indx >= len) {
+            indx = 0;
+        }
+    }
+
+    for (int i=0;i<audio_block_size;i++) {
+        er_left[i] = 0.0;
+        er_right[i] = 0.0;
+    }
+
+    early_reflections_accumulate(c, c->taps_left, start_indx, er_left, audio_block_size);
+    early_reflections_accumulate(c, c->taps_right, start_indx, er_right, audio_block_size);
+
+    // Mix reflections with dry signal
+    float level = c->level;
+    for (int i=0;i<audio_block_size;i++) {
+        audio_out_left[i] = audio_in_left[i] + er_left[i]*level;
+        audio_out_right[i] = audio_in_right[i] + er_right[i]*level;
+    }
+
+    // Store index back into instance struct
+    c->write_index = indx;
+}
+
+/**
+ * @brief Converts a reflection table into taps for the current sample rate
+ *
+ * Tap gains are normalized so that the reflections have unit energy
+ * regardless of how many of them are used.
+ *
+ * @param c Pointer to instance structure
+ * @param table Pointer to precomputed reflection table
+ * @param taps Pointer to the instance's taps for one channel
+ * @return Early reflections result (enumeration)
+ */
+static RESULT_EARLY_REFLECTIONS early_reflections_load_taps(EARLY_REFLECTIONS * c,
+                                                            const EARLY_REFLECTION_TABLE_ENTRY * table,
+                                                            EARLY_REFLECTION_TAP * taps) {
+
+    float energy = 0.0;
+
+    for (int tap=0;tap<c->num_taps;tap++) {
+        uint32_t delay = (uint32_t) (table[tap].delay_ms * 0.001 * c->audio_sample_rate + 0.5);
+        if (delay < 1) {
+            delay = 1;
+        }
+        if (delay + MAX_AUDIO_BLOCK_SIZE > c->delay_line_size) {
+            return EARLY_REFLECTIONS_TAP_EXCEEDS_DELAY_LINE_LEN;
+        }
+        taps[tap].delay = delay;
+        taps[tap].gain = table[tap].gain;
+        energy += table[tap].gain * table[tap].gain;
+    }
+
+    float norm = 1.0 / sqrtf(energy);
+    for (int tap=0;tap<c->num_taps;tap++) {
+        taps[tap].gain *= norm;
+    }
+
+    return EARLY_REFLECTIONS_OK;
+}
+
+/**
+ * @brief Accumulates the taps of one channel into an output buffer
+ *
+ * Each tap reads a contiguous block from the delay line, split in two where
+ * it wraps around the end of the delay line.
+ *
+ * @param c Pointer to instance structure
+ * @param taps Pointer to the taps for one channel
+ * @param write_index Delay line position of the first sample in this block
+ * @param audio_out Pointer to floating point output buffer
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void early_reflections_accumulate(EARLY_REFLECTIONS * c,
+                                         EARLY_REFLECTION_TAP * taps,
+                                         uint32_t write_index,
+                                         float * audio_out,
+                                         uint32_t audio_block_size) {
+
+    float   * delay_line = c->delay_line;
+    int32_t len = c->delay_line_size;
+
+    for (int tap=0;tap<c->num_taps;tap++) {
+        int32_t read_indx = (int32_t) write_index - (int32_t) taps[tap].delay;
+        if (read_indx < 0) {
+            read_indx += len;
+        }
+        float gain = taps[tap].gain;
+
+        uint32_t first = len - read_indx;
+        if (first > audio_block_size) {
+            first = audio_block_size;
+        }
+
+        float * src = &delay_line[read_indx];
+        for (int i=0;i<first;i++) {
+            audio_out[i] += src[i]*gain;
+        }
+        for (int i=first;i<audio_block_size;i++) {
+            audio_out[i] += delay_line[i-first]*gain;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _EARLY_REFLECTIONS_H
+#define _EARLY_REFLECTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define EARLY_REFLECTIONS_MAX_TAPS      (64)
+
+// Result enumerations
+typedef enum
+{
+    EARLY_REFLECTIONS_OK,
+    EARLY_REFLECTIONS_INVALID_INSTANCE_POINTER,
+    EARLY_REFLECTIONS_INVALID_DELAY_LINE_POINTER,
+    EARLY_REFLECTIONS_INVALID_ROOM,
+    EARLY_REFLECTIONS_TOO_MANY_TAPS,
+    EARLY_REFLECTIONS_TAP_EXCEEDS_DELAY_LINE_LEN,
+    EARLY_REFLECTIONS_INVALID_LEVEL
+} RESULT_EARLY_REFLECTIONS;
+
+// Precomputed room geometries
+typedef enum
+{
+    EARLY_REFLECTIONS_ROOM_SMALL,
+    EARLY_REFLECTIONS_ROOM_MEDIUM,
+    EARLY_REFLECTIONS_ROOM_HALL,
+    EARLY_REFLECTIONS_NUM_ROOMS
+} EARLY_REFLECTIONS_ROOM;
+
+// Entry in a precomputed reflection table
+typedef struct {
+    float   delay_ms;       // Arrival time relative to the direct sound
+    float   gain;           // Gain relative to the direct sound
+} EARLY_REFLECTION_TABLE_ENTRY;
+
+// A single tap of the sparse FIR
+typedef struct {
+    uint32_t    delay;      // In samples
+    float       gain;
+} EARLY_REFLECTION_TAP;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool        initialized;
+
+    float    *  delay_line;
+    uint32_t    delay_line_size;
+    uint32_t    write_index;
+
+    EARLY_REFLECTION_TAP    taps_left[EARLY_REFLECTIONS_MAX_TAPS];
+    EARLY_REFLECTION_TAP    taps_right[EARLY_REFLECTIONS_MAX_TAPS];
+    uint32_t    num_taps;
+
+    float       level;
+    float       audio_sample_rate;
+
+} EARLY_REFLECTIONS;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_EARLY_REFLECTIONS    early_reflections_setup(EARLY_REFLECTIONS * c,
+                                                    float * delay_line,
+                                                    uint32_t delay_line_size,
+                                                    EARLY_REFLECTIONS_ROOM room,
+                                                    uint32_t num_reflections,
+                                                    float level,
+                                                    float audio_sample_rate);
+
+RESULT_EARLY_REFLECTIONS    early_reflections_modify_level(EARLY_REFLECTIONS * c,
+                                                           float new_level);
+
+void    early_reflections_read(EARLY_REFLECTIONS * c,
+                               float * audio_in,
+                               float * audio_out_left,
+                               float * audio_out_right,
+                               uint32_t audio_block_size);
+
+void    early_reflections_read_stereo(EARLY_REFLECTIONS * c,
+                                      float * audio_in_left,
+                                      float * audio_in_right,
+                                      float * audio_out_left,
+                                      float * audio_out_right,
+                                      uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _EARLY_REFLECTIONS_H
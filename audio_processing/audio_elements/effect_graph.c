@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * An effect graph runs a set of effects and elements that are connected as a
+ * directed acyclic graph, so a chain can be described as data rather than as
+ * a hand written sequence of *_read() calls and buffer copies.
+ *
+ * A graph is described by two tables:
+ *
+ *  - Nodes: a function that processes one block (usually a thin wrapper
+ *    around an existing *_read() function), its instance, its number of
+ *    input and output ports and whether it can process in place.
+ *  - Edges: each connects a node output (or one of the graph's inputs,
+ *    EFFECT_GRAPH_IN) to a node input (or one of the graph's outputs,
+ *    EFFECT_GRAPH_OUT).  An output can feed any number of inputs but each
+ *    input takes exactly one edge; mixing is done by a node.
+ *
+ * effect_graph_setup() compiles the tables once:
+ *
+ *  1. The nodes are sorted so that every node runs after the nodes that feed
+ *     it (nodes already in order keep their order).  Cycles are rejected.
+ *  2. Each signal (node output) is given a buffer.  A node that can process
+ *     in place writes over its input when nothing else still needs it.
+ *     Chains of in-place nodes that end at a graph output are traced
+ *     backwards so the whole chain runs in the output buffer itself.
+ *     Everything else comes from a pool of scratch buffers, which are
+ *     reused as soon as the signal in them is no longer needed.
+ *  3. A copy is only added when a graph output can't be written directly,
+ *     e.g. a mono signal feeding both the left and right outputs.
+ *
+ * effect_graph_read() then just calls the nodes in order with their buffers
+ * and makes any copies.  The graph's inputs are never written, and its
+ * outputs must be separate buffers from its inputs.
+ *
+ * The buffer pool is scratch memory that is only used during
+ * effect_graph_read(), so graphs that don't run at the same time (e.g.
+ * presets) can share one pool.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "effect_graph.h"
+
+// Min/max limits and other constants
+#define EFFECT_GRAPH_NUM_SIGNALS    (EFFECT_GRAPH_MAX_NODES*EFFECT_GRAPH_MAX_PORTS + EFFECT_GRAPH_MAX_IO)
+#define EFFECT_GRAPH_NONE           (-1)
+
+// Signal numbers: node outputs first, then the graph inputs
+#define SIGNAL_NODE(n, p)           ((n)*EFFECT_GRAPH_MAX_PORTS + (p))
+#define SIGNAL_GRAPH_IN(k)          (EFFECT_GRAPH_MAX_NODES*EFFECT_GRAPH_MAX_PORTS + (k))
+#define SIGNAL_IS_GRAPH_IN(s)       ((s) >= EFFECT_GRAPH_MAX_NODES*EFFECT_GRAPH_MAX_PORTS)
+
+// Buffer numbers: pool buffers first, then the graph outputs and inputs
+#define BUFFER_GRAPH_OUT(k)         (EFFECT_GRAPH_MAX_BUFFERS + (k))
+#define BUFFER_GRAPH_IN(k)          (EFFECT_GRAPH_MAX_BUFFERS + EFFECT_GRAPH_MAX_IO + (k))
+#define BUFFER_IS_POOL(b)           ((b) >= 0 && (b) < EFFECT_GRAPH_MAX_BUFFERS)
+
+// Working state of the compile step
+typedef struct {
+
+    int16_t input_signal[EFFECT_GRAPH_MAX_NODES][EFFECT_GRAPH_MAX_PORTS];
+    int16_t output_signal[EFFECT_GRAPH_MAX_IO];     // Signal feeding each graph output
+
+    uint8_t order[EFFECT_GRAPH_MAX_NODES];          // Node at each step
+    uint8_t step_of[EFFECT_GRAPH_MAX_NODES];        // Step of each node
+
+    uint8_t num_consumers[EFFECT_GRAPH_NUM_SIGNALS];    // Node inputs fed by each signal
+    bool    feeds_output[EFFECT_GRAPH_NUM_SIGNALS];
+    int16_t last_use[EFFECT_GRAPH_NUM_SIGNALS];         // Last step that reads each signal
+    int16_t preferred[EFFECT_GRAPH_NUM_SIGNALS];        // Graph output to build the signal in
+    int16_t buffer[EFFECT_GRAPH_NUM_SIGNALS];
+
+    bool    busy[EFFECT_GRAPH_MAX_BUFFERS];
+
+} EFFECT_GRAPH_COMPILER;
+
+// Static function prototypes
+static RESULT_EFFECT_GRAPH  effect_graph_connect(EFFECT_GRAPH_COMPILER * w,
+                                                 const EFFECT_GRAPH_NODE * nodes,
+                                                 uint32_t num_nodes,
+                                                 const EFFECT_GRAPH_EDGE * edges,
+                                                 uint32_t num_edges,
+                                                 uint32_t num_graph_in,
+                                                 uint32_t num_graph_out);
+static RESULT_EFFECT_GRAPH  effect_graph_sort(EFFECT_GRAPH_COMPILER * w,
+                                              const EFFECT_GRAPH_NODE * nodes,
+                                              uint32_t num_nodes);
+static void     effect_graph_trace_outputs(EFFECT_GRAPH_COMPILER * w,
+                                           const EFFECT_GRAPH_NODE * nodes,
+                                           uint32_t num_graph_out);
+static RESULT_EFFECT_GRAPH  effect_graph_assign_buffers(EFFECT_GRAPH * c,
+                                                        EFFECT_GRAPH_COMPILER * w,
+                                                        const EFFECT_GRAPH_NODE * nodes,
+                                                        uint32_t num_nodes,
+                                                        uint32_t num_pool_buffers);
+
+
+/**
+ * @brief Compiles a graph of effects
+ *
+ * @param c Pointer to instance structure
+ * @param nodes Pointer to the node table (must stay valid while the graph is in use)
+ * @param num_nodes Number of nodes (1->EFFECT_GRAPH_MAX_NODES)
+ * @param edges Pointer to the edge table
+ * @param num_edges Number of edges (1->EFFECT_GRAPH_MAX_EDGES)
+ * @param graph_in Pointers to the graph's input buffers (read only)
+ * @param num_graph_in Number of graph inputs (0->EFFECT_GRAPH_MAX_IO)
+ * @param graph_out Pointers to the graph's output buffers
+ * @param num_graph_out Number of graph outputs (1->EFFECT_GRAPH_MAX_IO)
+ * @param buffer_pool Scratch buffers, num_pool_buffers*audio_block_size words
+ * @param num_pool_buffers Number of scratch buffers (0->EFFECT_GRAPH_MAX_BUFFERS)
+ * @param audio_block_size The number of floating-point words per buffer
+ * @return Effect graph result (enumeration)
+ */
+RESULT_EFFECT_GRAPH effect_graph_setup(EFFECT_GRAPH * c,
+                                       const EFFECT_GRAPH_NODE * nodes,
+                                       uint32_t num_nodes,
+                                       const EFFECT_GRAPH_EDGE * edges,
+                                       uint32_t num_edges,
+                                       float ** graph_in,
+                                       uint32_t num_graph_in,
+                                       float ** graph_out,
+                                       uint32_t num_graph_out,
+                                       float * buffer_pool,
+                                       uint32_t num_pool_buffers,
+                                       uint32_t audio_block_size) {
+
+    if (c == NULL) {
+        return EFFECT_GRAPH_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (nodes == NULL || edges == NULL ||
+        num_nodes < 1 || num_nodes > EFFECT_GRAPH_MAX_NODES ||
+        num_edges < 1 || num_edges > EFFECT_GRAPH_MAX_EDGES ||
+        num_graph_in > EFFECT_GRAPH_MAX_IO ||
+        num_graph_out < 1 || num_graph_out > EFFECT_GRAPH_MAX_IO ||
+        num_pool_buffers > EFFECT_GRAPH_MAX_BUFFERS ||
+        (num_pool_buffers > 0 && buffer_pool == NULL)) {
+        return EFFECT_GRAPH_INVALID_SIZE;
+    }
+
+    for (int n=0;n<num_nodes;n++) {
+        if (nodes[n].read == NULL ||
+            nodes[n].num_inputs > EFFECT_GRAPH_MAX_PORTS ||
+            nodes[n].num_outputs > EFFECT_GRAPH_MAX_PORTS) {
+            return EFFECT_GRAPH_INVALID_NODE;
+        }
+    }
+
+    EFFECT_GRAPH_COMPILER w;
+    RESULT_EFFECT_GRAPH res;
+
+    res = effect_graph_connect(&w, nodes, num_nodes, edges, num_edges, num_graph_in, num_graph_out);
+    if (res != EFFECT_GRAPH_OK) {
+        return res;
+    }
+    res = effect_graph_sort(&w, nodes, num_nodes);
+    if (res != EFFECT_GRAPH_OK) {
+        return res;
+    }
+    effect_graph_trace_outputs(&w, nodes, num_graph_out);
+    res = effect_graph_assign_buffers(c, &w, nodes, num_nodes, num_pool_buffers);
+    if (res != EFFECT_GRAPH_OK) {
+        return res;
+    }
+
+    // Resolve buffer numbers to pointers
+    float * buffers[EFFECT_GRAPH_MAX_BUFFERS + 2*EFFECT_GRAPH_MAX_IO];
+    for (int b=0;b<num_pool_buffers;b++) {
+        buffers[b] = &buffer_pool[b*audio_block_size];
+    }
+    for (int k=0;k<num_graph_out;k++) {
+        buffers[BUFFER_GRAPH_OUT(k)] = graph_out[k];
+    }
+    for (int k=0;k<num_graph_in;k++) {
+        buffers[BUFFER_GRAPH_IN(k)] = graph_in[k];
+    }
+
+    c->num_steps = num_nodes;
+    for (int i=0;i<num_nodes;i++) {
+        uint32_t n = w.order[i];
+        EFFECT_GRAPH_STEP * step = &c->steps[i];
+        step->node = &nodes[n];
+        for (int p=0;p<EFFECT_GRAPH_MAX_PORTS;p++) {
+            step->audio_in[p] = (p < nodes[n].num_inputs) ? buffers[w.buffer[w.input_signal[n][p]]] : NULL;
+            step->audio_out[p] = (p < nodes[n].num_outputs) ? buffers[w.buffer[SIGNAL_NODE(n, p)]] : NULL;
+        }
+    }
+
+    // Copy any graph outputs that weren't written directly
+    c->num_copies = 0;
+    for (int k=0;k<num_graph_out;k++) {
+        int16_t b = w.buffer[w.output_signal[k]];
+        if (b != BUFFER_GRAPH_OUT(k)) {
+            c->copy_src[c->num_copies] = buffers[b];
+            c->copy_dst[c->num_copies] = graph_out[k];
+            c->num_copies++;
+        }
+    }
+
+    c->initialized = true;
+    return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Processes a block of audio through the graph
+ *
+ * @param c Pointer to instance structure
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    effect_graph_read(EFFECT_GRAPH * c,
+                          uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    for (int i=0;i<c->num_steps;i++) {
+        EFFECT_GRAPH_STEP * step = &c->steps[i];
+        step->node->read(step->node->instance,
+                         step->audio_in,
+                         step->audio_out,
+                         audio_block_size);
+    }
+
+    for (int k=0;k<c->num_copies;k++) {
+        float * src = c->copy_src[k];
+        float * dst = c->copy_dst[k];
+        for (int i=0;i<audio_block_size;i++) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+/**
+ * @brief Reads the edge table into the signal feeding each input
+ *
+ * @param w Pointer to compiler state
+ * @param nodes Pointer to the node table
+ * @param num_nodes Number of nodes
+ * @param edges Pointer to the edge table
+ * @param num_edges Number of edges
+ * @param num_graph_in Number of graph inputs
+ * @param num_graph_out Number of graph outputs
+ * @return Effect graph result (enumeration)
+ */
+static RESULT_EFFECT_GRAPH  effect_graph_connect(EFFECT_GRAPH_COMPILER * w,
+                                                 const EFFECT_GRAPH_NODE * nodes,
+                                                 uint32_t num_nodes,
+                                                 const EFFECT_GRAPH_EDGE * edges,
+                                                 uint32_t num_edges,
+                                                 uint32_t num_graph_in,
+                                                 uint32_t num_graph_out) {
+
+    for (int n=0;n<EFFECT_GRAPH_MAX_NODES;n++) {
+        for (int p=0;p<EFFECT_GRAPH_MAX_PORTS;p++) {
+            w->input_signal[n][p] = EFFECT_GRAPH_NONE;
+        }
+    }
+    for (int k=0;k<EFFECT_GRAPH_MAX_IO;k++) {
+        w->output_signal[k] = EFFECT_GRAPH_NONE;
+    }
+    for (int s=0;s<EFFECT_GRAPH_NUM_SIGNALS;s++) {
+        w->num_consumers[s] = 0;
+        w->feeds_output[s] = false;
+    }
+
+    for (int e=0;e<num_edges;e++) {
+        const EFFECT_GRAPH_EDGE * edge = &edges[e];
+
+        // Source
+        int16_t signal;
+        if (edge->src_node == EFFECT_GRAPH_IN) {
+            if (edge->src_port >= num_graph_in) {
+                return EFFECT_GRAPH_INVALID_EDGE;
+            }
+            signal = SIGNAL_GRAPH_IN(edge->src_port);
+        }
+        else {
+            if (edge->src_node >= num_nodes ||
+                edge->src_port >= nodes[edge->src_node].num_outputs) {
+                return EFFECT_GRAPH_INVALID_EDGE;
+            }
+            signal = SIGNAL_NODE(edge->src_node, edge->src_port);
+        }
+
+        // Destination, which may only be connected once
+        if (edge->dst_node == EFFECT_GRAPH_OUT) {
+            if (edge->dst_port >= num_graph_out ||
+                w->output_signal[edge->dst_port] != EFFECT_GRAPH_NONE) {
+                return EFFECT_GRAPH_INVALID_EDGE;
+            }
+            w->output_signal[edge->dst_port] = signal;
+            w->feeds_output[signal] = true;
+        }
+        else {
+            if (edge->dst_node >= num_nodes ||
+                edge->dst_port >= nodes[edge->dst_node].num_inputs ||
+                w->input_signal[edge->dst_node][edge->dst_port] != EFFECT_GRAPH_NONE) {
+                return EFFECT_GRAPH_INVALID_EDGE;
+            }
+            w->input_signal[edge->dst_node][edge->dst_port] = signal;
+            w->num_consumers[signal]++;
+        }
+    }
+
+    for (int n=0;n<num_nodes;n++) {
+        for (int p=0;p<nodes[n].num_inputs;p++) {
+            if (w->input_signal[n][p] == EFFECT_GRAPH_NONE) {
+                return EFFECT_GRAPH_UNCONNECTED_INPUT;
+            }
+        }
+    }
+    for (int k=0;k<num_graph_out;k++) {
+        if (w->output_signal[k] == EFFECT_GRAPH_NONE) {
+            return EFFECT_GRAPH_UNCONNECTED_INPUT;
+        }
+    }
+
+    return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Orders the nodes so each one runs after the nodes that feed it
+ *
+ * At each step the lowest numbered node whose inputs are all ready runs
+ * next, so a table that is already in order is left as it is.
+ *
+ * @param w Pointer to compiler state
+ * @param nodes Pointer to the node table
+ * @param num_nodes Number of nodes
+ * @return Effect graph result (enumeration)
+ */
+static RESULT_EFFECT_GRAPH  effect_graph_sort(EFFECT_GRAPH_COMPILER * w,
+                                              const EFFECT_GRAPH_NODE * nodes,
+                                              uint32_t num_nodes) {
+
+    bool done[EFFECT_GRAPH_MAX_NODES];
+    for (int n=0;n<num_nodes;n++) {
+        done[n] = false;
+    }
+
+    for (int i=0;i<num_nodes;i++) {
+
+        int next = EFFECT_GRAPH_NONE;
+        for (int n=0;n<num_nodes && next == EFFECT_GRAPH_NONE;n++) {
+            if (done[n]) {
+                continue;
+            }
+            bool ready = true;
+            for (int p=0;p<nodes[n].num_inputs;p++) {
+                int16_t s = w->input_signal[n][p];
+                if (!SIGNAL_IS_GRAPH_IN(s) && !done[s/EFFECT_GRAPH_MAX_PORTS]) {
+                    ready = false;
+                }
+            }
+            if (ready) {
+                next = n;
+            }
+        }
+
+        // Nodes are left but none can run, so they feed each other
+        if (next == EFFECT_GRAPH_NONE) {
+            return EFFECT_GRAPH_CYCLE;
+        }
+
+        done[next] = true;
+        w->order[i] = next;
+        w->step_of[next] = i;
+    }
+
+    // The last step that needs each signal.  Signals that feed a graph output
+    // are needed until the end.
+    for (int s=0;s<EFFECT_GRAPH_NUM_SIGNALS;s++) {
+        w->last_use[s] = w->feeds_output[s] ? num_nodes : EFFECT_GRAPH_NONE;
+    }
+    for (int n=0;n<num_nodes;n++) {
+        for (int p=0;p<nodes[n].num_inputs;p++) {
+            int16_t s = w->input_signal[n][p];
+            if (w->last_use[s] < w->step_of[n]) {
+                w->last_use[s] = w->step_of[n];
+            }
+        }
+    }
+
+    return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Traces chains of in-place nodes back from each graph output
+ *
+ * Every signal in such a chain is built in the output buffer, so the chain
+ * runs entirely in place and no copy is needed at the end.
+ *
+ * @param w Pointer to compiler state
+ * @param nodes Pointer to the node table
+ * @param num_graph_out Number of graph outputs
+ */
+static void     effect_graph_trace_outputs(EFFECT_GRAPH_COMPILER * w,
+                                           const EFFECT_GRAPH_NODE * nodes,
+                                           uint32_t num_graph_out) {
+
+    for (int s=0;s<EFFECT_GRAPH_NUM_SIGNALS;s++) {
+        w->preferred[s] = EFFECT_GRAPH_NONE;
+    }
+
+    for (int k=0;k<num_graph_out;k++) {
+
+        // A graph input or a signal already going to another output is copied
+        int16_t s = w->output_signal[k];
+        if (SIGNAL_IS_GRAPH_IN(s) || w->preferred[s] != EFFECT_GRAPH_NONE) {
+            continue;
+        }
+        w->preferred[s] = k;
+
+        // Walk back while the node can write over an input that only it reads
+        while (true) {
+            uint32_t n = s/EFFECT_GRAPH_MAX_PORTS;
+            uint32_t p = s%EFFECT_GRAPH_MAX_PORTS;
+            if (!nodes[n].in_place || p >= nodes[n].num_inputs) {
+                break;
+            }
+            int16_t t = w->input_signal[n][p];
+            if (SIGNAL_IS_GRAPH_IN(t) ||
+                w->num_consumers[t] != 1 ||
+                w->feeds_output[t]) {
+                break;
+            }
+            w->preferred[t] = k;
+            s = t;
+        }
+    }
+}
+
+/**
+ * @brief Gives every signal a buffer
+ *
+ * @param c Pointer to instance structure
+ * @param w Pointer to compiler state
+ * @param nodes Pointer to the node table
+ * @param num_nodes Number of nodes
+ * @param num_pool_buffers Number of scratch buffers
+ * @return Effect graph result (enumeration)
+ */
+static RESULT_EFFECT_GRAPH  effect_graph_assign_buffers(EFFECT_GRAPH * c,
+                                                        EFFECT_GRAPH_COMPILER * w,
+                                                        const EFFECT_GRAPH_NODE * nodes,
+                                                        uint32_t num_nodes,
+                                                        uint32_t num_pool_buffers) {
+
+    for (int s=0;s<EFFECT_GRAPH_NUM_SIGNALS;s++) {
+        w->buffer[s] = EFFECT_GRAPH_NONE;
+    }
+    for (int k=0;k<EFFECT_GRAPH_MAX_IO;k++) {
+        w->buffer[SIGNAL_GRAPH_IN(k)] = BUFFER_GRAPH_IN(k);
+    }
+    for (int b=0;b<EFFECT_GRAPH_MAX_BUFFERS;b++) {
+        w->busy[b] = false;
+    }
+
+    c->buffers_used = 0;
+    c->outputs_in_place = 0;
+    uint32_t in_use = 0;
+
+    for (int i=0;i<num_nodes;i++) {
+        uint32_t n = w->order[i];
+        const EFFECT_GRAPH_NODE * node = &nodes[n];
+        bool reused[EFFECT_GRAPH_MAX_PORTS] = { false };
+
+        for (int p=0;p<node->num_outputs;p++) {
+            int16_t s = SIGNAL_NODE(n, p);
+
+            // Part of a chain that is built in a graph output
+            if (w->preferred[s] != EFFECT_GRAPH_NONE) {
+                w->buffer[s] = BUFFER_GRAPH_OUT(w->preferred[s]);
+                if (p < node->num_inputs &&
+                    w->buffer[w->input_signal[n][p]] == w->buffer[s]) {
+                    c->outputs_in_place++;
+                }
+                continue;
+            }
+
+            // Write over the input on the same port if nothing else needs it
+            if (node->in_place && p < node->num_inputs) {
+                int16_t t = w->input_signal[n][p];
+                bool shared = false;
+                for (int q=0;q<node->num_inputs;q++) {
+                    if (q != p && w->input_signal[n][q] == t) {
+                        shared = true;
+                    }
+                }
+                if (!shared &&
+                    w->last_use[t] == i &&
+                    BUFFER_IS_POOL(w->buffer[t])) {
+                    w->buffer[s] = w->buffer[t];
+                    reused[p] = true;
+                    c->outputs_in_place++;
+                    continue;
+                }
+            }
+
+            // Otherwise take a free scratch buffer
+            int b = 0;
+            while (b < num_pool_buffers && w->busy[b]) {
+                b++;
+            }
+            if (b >= num_pool_buffers) {
+                return EFFECT_GRAPH_OUT_OF_BUFFERS;
+            }
+            w->busy[b] = true;
+            w->buffer[s] = b;
+            in_use++;
+            if (in_use > c->buffers_used) {
+                c->buffers_used = in_use;
+            }
+        }
+
+        // Release inputs that aren't needed any more
+        for (int p=0;p<node->num_inputs;p++) {
+            int16_t t = w->input_signal[n][p];
+            int16_t b = w->buffer[t];
+            if (w->last_use[t] == i && BUFFER_IS_POOL(b) && !reused[p] && w->busy[b]) {
+                w->busy[b] = false;
+                in_use--;
+            }
+        }
+
+        // Outputs that nothing reads are scratch for this step only
+        for (int p=0;p<node->num_outputs;p++) {
+            int16_t s = SIGNAL_NODE(n, p);
+            int16_t b = w->buffer[s];
+            if (w->num_consumers[s] == 0 && !w->feeds_output[s] && BUFFER_IS_POOL(b) && w->busy[b]) {
+                w->busy[b] = false;
+                in_use--;
+            }
+        }
+    }
+
+    return EFFECT_GRAPH_OK;
+}
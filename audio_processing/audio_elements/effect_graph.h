@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _EFFECT_GRAPH_H
+#define _EFFECT_GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define EFFECT_GRAPH_MAX_NODES      (16)
+#define EFFECT_GRAPH_MAX_EDGES      (32)
+#define EFFECT_GRAPH_MAX_PORTS      (2)         // Inputs or outputs of one node
+#define EFFECT_GRAPH_MAX_IO         (2)         // Inputs or outputs of the whole graph
+#define EFFECT_GRAPH_MAX_BUFFERS    (8)         // Largest buffer pool
+
+// Node numbers of the graph's own inputs and outputs, for use in edges
+#define EFFECT_GRAPH_IN             (0xFE)
+#define EFFECT_GRAPH_OUT            (0xFF)
+
+// Result enumerations
+typedef enum
+{
+    EFFECT_GRAPH_OK,
+    EFFECT_GRAPH_INVALID_INSTANCE_POINTER,
+    EFFECT_GRAPH_INVALID_SIZE,              // Too many nodes, edges, inputs, outputs or buffers
+    EFFECT_GRAPH_INVALID_NODE,
+    EFFECT_GRAPH_INVALID_EDGE,
+    EFFECT_GRAPH_UNCONNECTED_INPUT,         // A node input or graph output has no edge
+    EFFECT_GRAPH_CYCLE,
+    EFFECT_GRAPH_OUT_OF_BUFFERS
+} RESULT_EFFECT_GRAPH;
+
+/*
+ * Every node is processed by a function of this type.  Most wrap an
+ * existing *_read() function, e.g.
+ *
+ *  static void node_delay(void * instance, float ** in, float ** out, uint32_t n) {
+ *      delay_read((DELAY_LPF *) instance, in[0], out[0], n);
+ *  }
+ */
+typedef void    (*EFFECT_GRAPH_READ)(void * instance,
+                                     float ** audio_in,
+                                     float ** audio_out,
+                                     uint32_t audio_block_size);
+
+// A node (effect or element) in the graph
+typedef struct {
+
+    EFFECT_GRAPH_READ   read;
+    void *  instance;
+    uint8_t num_inputs;
+    uint8_t num_outputs;
+    bool    in_place;                   // Output n may be the same buffer as input n
+
+} EFFECT_GRAPH_NODE;
+
+// A connection from a node output to a node input
+typedef struct {
+
+    uint8_t src_node;                   // Node number or EFFECT_GRAPH_IN
+    uint8_t src_port;
+    uint8_t dst_node;                   // Node number or EFFECT_GRAPH_OUT
+    uint8_t dst_port;
+
+} EFFECT_GRAPH_EDGE;
+
+// One node call in the compiled graph, with its buffers resolved
+typedef struct {
+
+    const EFFECT_GRAPH_NODE * node;
+    float * audio_in[EFFECT_GRAPH_MAX_PORTS];
+    float * audio_out[EFFECT_GRAPH_MAX_PORTS];
+
+} EFFECT_GRAPH_STEP;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    // Compiled graph
+    EFFECT_GRAPH_STEP   steps[EFFECT_GRAPH_MAX_NODES];
+    uint32_t    num_steps;
+
+    // Copies to the graph outputs that couldn't be avoided
+    float * copy_src[EFFECT_GRAPH_MAX_IO];
+    float * copy_dst[EFFECT_GRAPH_MAX_IO];
+    uint32_t    num_copies;
+
+    // Statistics from the compile step
+    uint32_t    buffers_used;           // Largest number of pool buffers in use at once
+    uint32_t    outputs_in_place;       // Node outputs written over their input
+
+} EFFECT_GRAPH;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_EFFECT_GRAPH effect_graph_setup(EFFECT_GRAPH * c,
+                                       const EFFECT_GRAPH_NODE * nodes,
+                                       uint32_t num_nodes,
+                                       const EFFECT_GRAPH_EDGE * edges,
+                                       uint32_t num_edges,
+                                       float ** graph_in,
+                                       uint32_t num_graph_in,
+                                       float ** graph_out,
+                                       uint32_t num_graph_out,
+                                       float * buffer_pool,
+                                       uint32_t num_pool_buffers,
+                                       uint32_t audio_block_size);
+
+void    effect_graph_read(EFFECT_GRAPH * c,
+                          uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _EFFECT_GRAPH_H
@@ -0,0 +1,717 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * Manages a set of effect presets (see effect_graph.c) so that a preset is
+ * only set up when it is selected, rather than setting up every preset at
+ * boot.  Each preset goes through a simple lifecycle:
+ *
+ *  - instantiate : its delay lines are zeroed and then its setup function is
+ *                  called, which sets up the instances and compiles the graph
+ *  - activate    : it starts running in the audio callback
+ *  - deactivate  : it stops running but keeps its state
+ *  - release     : its state is discarded, so the next time it's selected it
+ *                  starts again from scratch
+ *
+ * Long delay lines in SDRAM take a while to zero, so the zeroing is spread
+ * over several calls to effect_presets_process() from the background loop,
+ * clear_per_pass 32-bit words at a time.  The setup functions should then use the
+ * *_setup_cleared() variants of the delay elements so the lines aren't
+ * zeroed a second time.  Nothing is set up in the audio callback, so
+ * switching presets never stalls the audio.
+ *
+ * Normally the application just calls effect_presets_select() with the
+ * selected preset and effect_presets_process() from the background loop.
+ * When the selection changes, the preset that's running carries on while the
+ * new one is instantiated.  Once it's ready the background loop hands the
+ * switch over to the audio callback, which takes it at the start of the next
+ * block:
+ *
+ *  - Crossfade : both presets run and their outputs are crossfaded over
+ *                effect_presets_modify_crossfade() samples, so the old
+ *                preset's echoes and tails die away under the new one rather
+ *                than being cut off.  The crossfade is linear because both
+ *                outputs carry the same dry signal.
+ *  - Fade out/in : the old preset fades out over one block and the new one
+ *                fades in over the next.  This is used when the crossfade
+ *                length is 0 or when both presets together wouldn't fit in
+ *                the cycle budget.  It never runs more than one preset per
+ *                block but there's a short dip in the output.
+ *
+ * Once the audio callback has finished with the old preset the background
+ * loop releases it.  Only one switch is in progress at a time; a selection
+ * made meanwhile is picked up when it has finished.  Bypass (no preset) takes
+ * part in switches like any other preset, so turning the effects off fades
+ * the tails out too.
+ *
+ * Cycle budget: effect_presets_modify_cycle_budget() supplies a function that
+ * reads the core cycle counter and the number of cycles available per block.
+ * The cycles each preset takes are measured as it runs and the peak is kept.
+ * A crossfade is refused in favour of fade out/in when the peaks of the two
+ * presets add up to more than the budget.  A preset that has never run has no
+ * peak yet, so it is assumed to need the whole budget: it can crossfade with
+ * bypass, but from another preset it fades out and in the first time.  As a
+ * last resort, if a crossfading block still goes over budget the crossfade is
+ * finished within that block and the new preset runs on its own from then on.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "audio_utilities.h"
+#include "effect_presets.h"
+
+// Static function prototypes
+static bool     effect_presets_valid(EFFECT_PRESETS * c,
+                                     uint32_t preset);
+static bool     effect_presets_switching(EFFECT_PRESETS * c);
+static uint32_t effect_presets_cycles(EFFECT_PRESETS * c,
+                                      int32_t preset);
+static void     effect_presets_switch(EFFECT_PRESETS * c,
+                                      int32_t preset,
+                                      bool release);
+static void     effect_presets_start_clearing(EFFECT_PRESETS * c,
+                                              int32_t preset);
+static void     effect_presets_run(EFFECT_PRESETS * c,
+                                   int32_t preset,
+                                   uint32_t audio_block_size);
+static void     effect_presets_ramp(EFFECT_PRESETS * c,
+                                    bool fade_in,
+                                    uint32_t audio_block_size);
+
+
+/**
+ * @brief Initializes the preset manager.  No presets are set up yet.
+ *
+ * All of the presets' graphs must use the same input and output buffers.
+ *
+ * @param c Pointer to instance structure
+ * @param presets Pointer to the preset table (must stay valid)
+ * @param num_presets Number of presets (1->EFFECT_PRESETS_MAX_PRESETS)
+ * @param audio_in Pointers to the input buffers of the graphs
+ * @param audio_out Pointers to the output buffers of the graphs
+ * @param num_channels Number of input and output buffers (1->EFFECT_PRESETS_MAX_CHANNELS)
+ * @param clear_per_pass Number of words to zero per background pass
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_setup(EFFECT_PRESETS * c,
+                                             const EFFECT_PRESET * presets,
+                                             uint32_t num_presets,
+                                             float ** audio_in,
+                                             float ** audio_out,
+                                             uint32_t num_channels,
+                                             uint32_t clear_per_pass) {
+
+    if (c == NULL) {
+        return EFFECT_PRESETS_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (presets == NULL ||
+        num_presets < 1 ||
+        num_presets > EFFECT_PRESETS_MAX_PRESETS) {
+        return EFFECT_PRESETS_INVALID_NUM_PRESETS;
+    }
+    if (audio_in == NULL ||
+        audio_out == NULL ||
+        num_channels < 1 ||
+        num_channels > EFFECT_PRESETS_MAX_CHANNELS) {
+        return EFFECT_PRESETS_INVALID_CHANNELS;
+    }
+
+    c->presets = presets;
+    c->num_presets = num_presets;
+    c->clear_per_pass = (clear_per_pass < 1) ? 1 : clear_per_pass;
+
+    for (int i=0;i<num_channels;i++) {
+        c->audio_in[i] = audio_in[i];
+        c->audio_out[i] = audio_out[i];
+    }
+    c->num_channels = num_channels;
+
+    c->cycle_counter = NULL;
+    c->cycle_budget = 0;
+
+    for (int i=0;i<num_presets;i++) {
+        c->state[i] = EFFECT_PRESET_RELEASED;
+        c->cycles_peak[i] = 0;
+    }
+
+    c->clearing = EFFECT_PRESETS_NONE;
+    c->clear_buffer = 0;
+    c->clear_offset = 0;
+
+    c->requested = EFFECT_PRESETS_NONE;
+    c->active = EFFECT_PRESETS_NONE;
+
+    c->pending = EFFECT_PRESETS_NO_CHANGE;
+    c->pending_switch = EFFECT_PRESETS_SWITCH_NONE;
+    c->retiring = EFFECT_PRESETS_NONE;
+    c->retiring_release = false;
+
+    // Fade out/in until a crossfade length is set.  The presets' outputs all
+    // carry the same dry signal, so they're correlated and fade linearly.
+    c->switching = EFFECT_PRESETS_SWITCH_NONE;
+    c->fading = EFFECT_PRESETS_NONE;
+    crossfade_setup(&c->crossfade, CROSSFADE_LINEAR, 0);
+
+    c->instantiations = 0;
+    c->clear_passes = 0;
+    c->crossfades = 0;
+    c->crossfades_refused = 0;
+    c->crossfades_shortened = 0;
+    c->switch_cycles_peak = 0;
+
+    c->initialized = true;
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Sets the length of the crossfade when switching presets
+ *
+ * @param c Pointer to instance structure
+ * @param crossfade_samples Crossfade length in samples (0 fades out and in instead)
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_modify_crossfade(EFFECT_PRESETS * c,
+                                                        uint32_t crossfade_samples) {
+
+    if (c == NULL || !c->initialized) {
+        return EFFECT_PRESETS_INVALID_INSTANCE_POINTER;
+    }
+
+    if (crossfade_modify_length(&c->crossfade, crossfade_samples) != CROSSFADE_OK) {
+        return EFFECT_PRESETS_INVALID_CROSSFADE;
+    }
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Sets the cycle budget for effect_presets_read()
+ *
+ * @param c Pointer to instance structure
+ * @param cycle_counter Function returning the core cycle counter (NULL for no checks)
+ * @param cycle_budget Cycles available per block
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_modify_cycle_budget(EFFECT_PRESETS * c,
+                                                           uint32_t (*cycle_counter)(void),
+                                                           uint32_t cycle_budget) {
+
+    if (c == NULL || !c->initialized) {
+        return EFFECT_PRESETS_INVALID_INSTANCE_POINTER;
+    }
+
+    c->cycle_budget = cycle_budget;
+    c->cycle_counter = cycle_counter;
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Starts setting up a preset
+ *
+ * The work is done by effect_presets_process().  The preset is ready to be
+ * activated once its state is EFFECT_PRESET_READY.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_instantiate(EFFECT_PRESETS * c,
+                                                   uint32_t preset) {
+
+    if (!effect_presets_valid(c, preset)) {
+        return EFFECT_PRESETS_INVALID_PRESET;
+    }
+
+    if (c->state[preset] == EFFECT_PRESET_RELEASED) {
+        c->state[preset] = EFFECT_PRESET_CLEARING;
+        if (c->clearing == EFFECT_PRESETS_NONE) {
+            effect_presets_start_clearing(c, preset);
+        }
+    }
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Makes a preset the one that runs in the audio callback
+ *
+ * The preset that was running is switched out and deactivated.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_activate(EFFECT_PRESETS * c,
+                                                uint32_t preset) {
+
+    if (!effect_presets_valid(c, preset)) {
+        return EFFECT_PRESETS_INVALID_PRESET;
+    }
+
+    if (c->state[preset] == EFFECT_PRESET_ACTIVE) {
+        return EFFECT_PRESETS_OK;
+    }
+    if (c->state[preset] != EFFECT_PRESET_READY) {
+        return EFFECT_PRESETS_NOT_INSTANTIATED;
+    }
+    if (effect_presets_switching(c)) {
+        return EFFECT_PRESETS_SWITCHING;
+    }
+
+    effect_presets_switch(c, preset, false);
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Stops a preset running in the audio callback.  Its state is kept.
+ *
+ * The preset fades out and its state becomes EFFECT_PRESET_READY once it has.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_deactivate(EFFECT_PRESETS * c,
+                                                  uint32_t preset) {
+
+    if (!effect_presets_valid(c, preset)) {
+        return EFFECT_PRESETS_INVALID_PRESET;
+    }
+
+    if (c->state[preset] == EFFECT_PRESET_ACTIVE) {
+        if (effect_presets_switching(c)) {
+            return EFFECT_PRESETS_SWITCHING;
+        }
+        effect_presets_switch(c, EFFECT_PRESETS_NONE, false);
+    }
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Discards a preset's state
+ *
+ * A preset that is running fades out first and is released once it has.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ * @return Effect presets result (enumeration)
+ */
+RESULT_EFFECT_PRESETS   effect_presets_release(EFFECT_PRESETS * c,
+                                               uint32_t preset) {
+
+    if (!effect_presets_valid(c, preset)) {
+        return EFFECT_PRESETS_INVALID_PRESET;
+    }
+
+    if (c->state[preset] == EFFECT_PRESET_FADING_OUT) {
+        c->retiring_release = true;
+        return EFFECT_PRESETS_OK;
+    }
+    if (c->state[preset] == EFFECT_PRESET_ACTIVE) {
+        if (effect_presets_switching(c)) {
+            return EFFECT_PRESETS_SWITCHING;
+        }
+        effect_presets_switch(c, EFFECT_PRESETS_NONE, true);
+        return EFFECT_PRESETS_OK;
+    }
+
+    if (c->clearing == (int32_t)preset) {
+        c->clearing = EFFECT_PRESETS_NONE;
+    }
+    c->state[preset] = EFFECT_PRESET_RELEASED;
+
+    return EFFECT_PRESETS_OK;
+}
+
+/**
+ * @brief Selects the preset that should be running
+ *
+ * Out of range presets and presets without a graph select bypass.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ */
+void    effect_presets_select(EFFECT_PRESETS * c,
+                              uint32_t preset) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    c->requested = effect_presets_valid(c, preset) ? (int32_t)preset : EFFECT_PRESETS_NONE;
+}
+
+/**
+ * @brief Background work: switches to the selected preset and zeroes the
+ * delay lines of presets being instantiated
+ *
+ * This should be called from the background loop.  Each call zeroes at most
+ * clear_per_pass words, and a preset's setup function is called on a pass of
+ * its own.
+ *
+ * @param c Pointer to instance structure
+ * @return true if there was any work to do
+ */
+bool    effect_presets_process(EFFECT_PRESETS * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    bool busy = false;
+
+    // Tear down the old preset once the audio callback has switched away from it
+    if (c->retiring != EFFECT_PRESETS_NONE &&
+        c->pending == EFFECT_PRESETS_NO_CHANGE &&
+        c->switching == EFFECT_PRESETS_SWITCH_NONE) {
+        c->state[c->retiring] = c->retiring_release ? EFFECT_PRESET_RELEASED : EFFECT_PRESET_READY;
+        c->retiring = EFFECT_PRESETS_NONE;
+        busy = true;
+    }
+
+    // Switch presets
+    int32_t requested = c->requested;
+    if (requested != c->active && !effect_presets_switching(c)) {
+
+        // Don't finish instantiating presets that are no longer wanted
+        for (int i=0;i<c->num_presets;i++) {
+            if (i != requested && c->state[i] == EFFECT_PRESET_CLEARING) {
+                effect_presets_release(c, i);
+            }
+        }
+
+        // The running preset carries on until the new one is ready
+        if (requested == EFFECT_PRESETS_NONE || c->state[requested] == EFFECT_PRESET_READY) {
+            effect_presets_switch(c, requested, true);
+        }
+        else {
+            effect_presets_instantiate(c, requested);
+        }
+        busy = true;
+    }
+
+    // Pick up the next preset waiting to be instantiated
+    if (c->clearing == EFFECT_PRESETS_NONE) {
+        for (int i=0;i<c->num_presets;i++) {
+            if (c->state[i] == EFFECT_PRESET_CLEARING) {
+                effect_presets_start_clearing(c, i);
+                break;
+            }
+        }
+    }
+    if (c->clearing == EFFECT_PRESETS_NONE) {
+        return busy;
+    }
+
+    // Zero the next part of its buffers.  All zero bits is zero in every
+    // storage format, so the buffers are cleared as bytes whatever their type.
+    const EFFECT_PRESET * p = &c->presets[c->clearing];
+    uint32_t pass_bytes = c->clear_per_pass*sizeof(float);
+    uint32_t remaining = pass_bytes;
+    while (remaining > 0 && c->clear_buffer < p->num_buffers) {
+        const EFFECT_PRESET_BUFFER * b = &p->buffers[c->clear_buffer];
+        uint32_t n = b->bytes - c->clear_offset;
+        if (n > remaining) {
+            n = remaining;
+        }
+        memset((char *) b->buffer + c->clear_offset, 0, n);
+        remaining -= n;
+        c->clear_offset += n;
+        if (c->clear_offset >= b->bytes) {
+            c->clear_buffer++;
+            c->clear_offset = 0;
+        }
+    }
+
+    // Once a pass finds nothing left to zero, set the preset up.  If it's the
+    // one selected, the next pass switches to it.
+    if (remaining == pass_bytes) {
+        if (p->setup != NULL) {
+            p->setup();
+        }
+        c->state[c->clearing] = EFFECT_PRESET_READY;
+        c->clearing = EFFECT_PRESETS_NONE;
+        c->instantiations++;
+    }
+    else {
+        c->clear_passes++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Runs the active preset on a block of audio
+ *
+ * The preset's control function is called first and then its graph.  With no
+ * preset active the input is copied to the output.  While switching presets,
+ * the old and new presets are crossfaded or faded out and in.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    effect_presets_read(EFFECT_PRESETS * c,
+                            uint32_t audio_block_size) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    // Take over a switch handed over by effect_presets_process()
+    int32_t pending = c->pending;
+    if (pending != EFFECT_PRESETS_NO_CHANGE) {
+        c->fading = c->active;
+        c->active = pending;
+        c->switching = c->pending_switch;
+        if (c->switching == EFFECT_PRESETS_SWITCH_CROSSFADE) {
+            crossfade_start(&c->crossfade);
+        }
+        c->pending = EFFECT_PRESETS_NO_CHANGE;
+    }
+
+    if (c->switching == EFFECT_PRESETS_SWITCH_NONE) {
+        effect_presets_run(c, c->active, audio_block_size);
+        return;
+    }
+
+    uint32_t cycles_start = (c->cycle_counter != NULL) ? c->cycle_counter() : 0;
+
+    switch (c->switching) {
+
+        case EFFECT_PRESETS_SWITCH_CROSSFADE: {
+
+            // Old preset into the fade buffers, new preset into the outputs
+            float * fade_buffer[EFFECT_PRESETS_MAX_CHANNELS];
+            effect_presets_run(c, c->fading, audio_block_size);
+            for (int ch=0;ch<c->num_channels;ch++) {
+                fade_buffer[ch] = c->fade_buffer[ch];
+                copy_buffer(c->audio_out[ch], fade_buffer[ch], audio_block_size);
+            }
+            effect_presets_run(c, c->active, audio_block_size);
+
+            // If running both went over budget, finish the crossfade in this block
+            if (c->cycle_counter != NULL &&
+                c->cycle_budget > 0 &&
+                c->cycle_counter() - cycles_start > c->cycle_budget) {
+                if (c->crossfade.remaining > audio_block_size) {
+                    crossfade_shorten(&c->crossfade, audio_block_size);
+                    c->crossfades_shortened++;
+                }
+            }
+
+            crossfade_read(&c->crossfade,
+                           fade_buffer,
+                           c->audio_out,
+                           c->audio_out,
+                           c->num_channels,
+                           audio_block_size);
+
+            if (!crossfade_active(&c->crossfade)) {
+                c->switching = EFFECT_PRESETS_SWITCH_NONE;
+            }
+            break;
+        }
+
+        case EFFECT_PRESETS_SWITCH_FADE_OUT:
+            effect_presets_run(c, c->fading, audio_block_size);
+            effect_presets_ramp(c, false, audio_block_size);
+            c->switching = EFFECT_PRESETS_SWITCH_FADE_IN;
+            break;
+
+        case EFFECT_PRESETS_SWITCH_FADE_IN:
+        default:
+            effect_presets_run(c, c->active, audio_block_size);
+            effect_presets_ramp(c, true, audio_block_size);
+            c->switching = EFFECT_PRESETS_SWITCH_NONE;
+            break;
+    }
+
+    if (c->cycle_counter != NULL) {
+        uint32_t cycles = c->cycle_counter() - cycles_start;
+        if (cycles > c->switch_cycles_peak) {
+            c->switch_cycles_peak = cycles;
+        }
+    }
+}
+
+/**
+ * @brief Checks a preset number is in range and has a graph
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ * @return true if valid
+ */
+static bool     effect_presets_valid(EFFECT_PRESETS * c,
+                                     uint32_t preset) {
+
+    return (c != NULL &&
+            c->initialized &&
+            preset < c->num_presets &&
+            c->presets[preset].graph != NULL);
+}
+
+/**
+ * @brief Checks whether a switch is still in progress
+ *
+ * @param c Pointer to instance structure
+ * @return true until the old preset of the last switch has been torn down
+ */
+static bool     effect_presets_switching(EFFECT_PRESETS * c) {
+
+    return (c->pending != EFFECT_PRESETS_NO_CHANGE ||
+            c->switching != EFFECT_PRESETS_SWITCH_NONE ||
+            c->retiring != EFFECT_PRESETS_NONE);
+}
+
+/**
+ * @brief Estimates the cycles one block of a preset takes
+ *
+ * This is the measured peak, or the whole budget if the preset hasn't run yet.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number or EFFECT_PRESETS_NONE
+ * @return Cycles per block
+ */
+static uint32_t effect_presets_cycles(EFFECT_PRESETS * c,
+                                      int32_t preset) {
+
+    // Bypass (or a preset whose graph failed to compile)
+    if (preset == EFFECT_PRESETS_NONE || !c->presets[preset].graph->initialized) {
+        return 0;
+    }
+
+    if (c->cycles_peak[preset] == 0) {
+        return c->cycle_budget;
+    }
+    return c->cycles_peak[preset];
+}
+
+/**
+ * @brief Hands a switch to another preset over to the audio callback
+ *
+ * The preset must be ready (or EFFECT_PRESETS_NONE for bypass).  Crossfades
+ * unless the crossfade length is 0 or the estimated cycles of the two presets
+ * add up to more than the budget, in which case it fades out and in.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset to switch to
+ * @param release Release the old preset afterwards rather than keeping its state
+ */
+static void     effect_presets_switch(EFFECT_PRESETS * c,
+                                      int32_t preset,
+                                      bool release) {
+
+    int32_t old = c->active;
+
+    EFFECT_PRESETS_SWITCH how = EFFECT_PRESETS_SWITCH_CROSSFADE;
+    if (c->crossfade.length == 0) {
+        how = EFFECT_PRESETS_SWITCH_FADE_OUT;
+    }
+    else if (c->cycle_counter != NULL && c->cycle_budget > 0) {
+        uint32_t cycles = effect_presets_cycles(c, old) + effect_presets_cycles(c, preset);
+        if (cycles > c->cycle_budget) {
+            how = EFFECT_PRESETS_SWITCH_FADE_OUT;
+            c->crossfades_refused++;
+        }
+    }
+    if (how == EFFECT_PRESETS_SWITCH_CROSSFADE) {
+        c->crossfades++;
+    }
+
+    if (old != EFFECT_PRESETS_NONE) {
+        c->state[old] = EFFECT_PRESET_FADING_OUT;
+    }
+    if (preset != EFFECT_PRESETS_NONE) {
+        c->state[preset] = EFFECT_PRESET_ACTIVE;
+    }
+    c->retiring = old;
+    c->retiring_release = release;
+
+    // The audio callback can take the switch as soon as pending is written
+    c->pending_switch = how;
+    c->pending = preset;
+}
+
+/**
+ * @brief Starts zeroing the buffers of a preset
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number
+ */
+static void     effect_presets_start_clearing(EFFECT_PRESETS * c,
+                                              int32_t preset) {
+
+    c->clearing = preset;
+    c->clear_buffer = 0;
+    c->clear_offset = 0;
+}
+
+/**
+ * @brief Runs one preset (or bypass) into the output buffers and keeps track
+ * of its peak cycles
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset number or EFFECT_PRESETS_NONE
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     effect_presets_run(EFFECT_PRESETS * c,
+                                   int32_t preset,
+                                   uint32_t audio_block_size) {
+
+    const EFFECT_PRESET * p = (preset != EFFECT_PRESETS_NONE) ? &c->presets[preset] : NULL;
+
+    // Bypass (or a preset whose graph failed to compile)
+    if (p == NULL || !p->graph->initialized) {
+        for (int ch=0;ch<c->num_channels;ch++) {
+            copy_buffer(c->audio_in[ch], c->audio_out[ch], audio_block_size);
+        }
+        return;
+    }
+
+    uint32_t cycles_start = (c->cycle_counter != NULL) ? c->cycle_counter() : 0;
+
+    if (p->control != NULL) {
+        p->control();
+    }
+    effect_graph_read(p->graph, audio_block_size);
+
+    if (c->cycle_counter != NULL) {
+        uint32_t cycles = c->cycle_counter() - cycles_start;
+        if (cycles > c->cycles_peak[preset]) {
+            c->cycles_peak[preset] = cycles;
+        }
+    }
+}
+
+/**
+ * @brief Fades the output buffers out (1 -> 0) or in (0 -> 1) over one block
+ *
+ * @param c Pointer to instance structure
+ * @param fade_in true to fade in, false to fade out
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     effect_presets_ramp(EFFECT_PRESETS * c,
+                                    bool fade_in,
+                                    uint32_t audio_block_size) {
+
+    float step = 1.0 / (float)audio_block_size;
+
+    for (int ch=0;ch<c->num_channels;ch++) {
+        float * out = c->audio_out[ch];
+        float gain = fade_in ? step : 1.0 - step;
+        float delta = fade_in ? step : -step;
+        for (int i=0;i<audio_block_size;i++) {
+            out[i] *= gain;
+            gain += delta;
+        }
+    }
+}
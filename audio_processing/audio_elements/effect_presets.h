@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _EFFECT_PRESETS_H
+#define _EFFECT_PRESETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "effect_graph.h"
+#include "crossfade.h"
+
+#define EFFECT_PRESETS_MAX_PRESETS  (16)
+#define EFFECT_PRESETS_MAX_CHANNELS (CROSSFADE_MAX_CHANNELS)
+#define EFFECT_PRESETS_NONE         (-1)        // Bypass
+#define EFFECT_PRESETS_NO_CHANGE    (-2)
+
+// Result enumerations
+typedef enum
+{
+    EFFECT_PRESETS_OK,
+    EFFECT_PRESETS_INVALID_INSTANCE_POINTER,
+    EFFECT_PRESETS_INVALID_NUM_PRESETS,
+    EFFECT_PRESETS_INVALID_PRESET,
+    EFFECT_PRESETS_INVALID_CHANNELS,
+    EFFECT_PRESETS_INVALID_CROSSFADE,
+    EFFECT_PRESETS_NOT_INSTANTIATED,        // Preset can't be activated until it has been set up
+    EFFECT_PRESETS_SWITCHING                // Another switch hasn't finished yet
+} RESULT_EFFECT_PRESETS;
+
+// Lifecycle of a preset
+typedef enum
+{
+    EFFECT_PRESET_RELEASED,                 // Not set up (or its state has been discarded)
+    EFFECT_PRESET_CLEARING,                 // Delay lines are being zeroed in the background
+    EFFECT_PRESET_READY,                    // Set up but not running
+    EFFECT_PRESET_ACTIVE,                   // Running in the audio callback
+    EFFECT_PRESET_FADING_OUT                // Still running while the next preset fades in
+} EFFECT_PRESET_STATE;
+
+// How the audio callback moves from one preset to the next
+typedef enum
+{
+    EFFECT_PRESETS_SWITCH_NONE,             // Not switching
+    EFFECT_PRESETS_SWITCH_CROSSFADE,        // Both presets run while their outputs are crossfaded
+    EFFECT_PRESETS_SWITCH_FADE_OUT,         // Old preset fades out for one block...
+    EFFECT_PRESETS_SWITCH_FADE_IN           // ...then the new one fades in for one block
+} EFFECT_PRESETS_SWITCH;
+
+// A delay line (or other buffer) that must be zeroed before the preset is set up.
+// Any type of buffer can be listed (float, packed int16/fp16 etc.) as it's
+// zeroed a byte at a time.
+typedef struct {
+
+    void *  buffer;
+    uint32_t    bytes;                  // e.g. sizeof() the array
+
+} EFFECT_PRESET_BUFFER;
+
+// Description of a preset
+typedef struct {
+
+    void    (*setup)(void);             // Sets up the instances and compiles the graph
+    void    (*control)(void);           // Reads the pots/switches before each block (may be NULL)
+    EFFECT_GRAPH *  graph;              // NULL for a bypass preset
+    const EFFECT_PRESET_BUFFER *    buffers;
+    uint32_t    num_buffers;
+
+} EFFECT_PRESET;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    const EFFECT_PRESET *   presets;
+    uint32_t    num_presets;
+    uint32_t    clear_per_pass;         // Words zeroed per call to effect_presets_process()
+
+    // Input and output buffers shared by all of the presets' graphs
+    float *     audio_in[EFFECT_PRESETS_MAX_CHANNELS];
+    float *     audio_out[EFFECT_PRESETS_MAX_CHANNELS];
+    uint32_t    num_channels;
+
+    // Cycle budget for effect_presets_read() (no checks if cycle_counter is NULL)
+    uint32_t    (*cycle_counter)(void);
+    uint32_t    cycle_budget;
+    uint32_t    cycles_peak[EFFECT_PRESETS_MAX_PRESETS];    // Most cycles one block of each preset has taken
+
+    EFFECT_PRESET_STATE state[EFFECT_PRESETS_MAX_PRESETS];
+
+    // Preset whose buffers are being zeroed and how far it has got
+    int32_t     clearing;
+    uint32_t    clear_buffer;
+    uint32_t    clear_offset;           // Bytes
+
+    int32_t     requested;              // Preset selected with effect_presets_select()
+    volatile int32_t    active;         // Preset run by effect_presets_read()
+
+    // Switch handed over to the audio callback (written by the background loop)
+    volatile int32_t    pending;        // EFFECT_PRESETS_NO_CHANGE when there's nothing to take
+    volatile EFFECT_PRESETS_SWITCH  pending_switch;
+    int32_t     retiring;               // Preset to deactivate once the switch has finished
+    bool        retiring_release;       // ...and release as well
+
+    // Switch in progress in the audio callback
+    volatile EFFECT_PRESETS_SWITCH  switching;
+    volatile int32_t    fading;         // Preset being switched away from
+    CROSSFADE   crossfade;
+    float       fade_buffer[EFFECT_PRESETS_MAX_CHANNELS][MAX_AUDIO_BLOCK_SIZE];
+
+    // Statistics
+    uint32_t    instantiations;         // Presets set up since effect_presets_setup()
+    uint32_t    clear_passes;           // Background passes spent zeroing buffers
+    uint32_t    crossfades;             // Switches that crossfaded
+    uint32_t    crossfades_refused;     // Switches that faded out and in because both wouldn't fit
+    volatile uint32_t   crossfades_shortened;   // Crossfades cut short after a block went over budget
+    volatile uint32_t   switch_cycles_peak;     // Most cycles a block has taken while switching
+
+} EFFECT_PRESETS;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_EFFECT_PRESETS   effect_presets_setup(EFFECT_PRESETS * c,
+                                             const EFFECT_PRESET * presets,
+                                             uint32_t num_presets,
+                                             float ** audio_in,
+                                             float ** audio_out,
+                                             uint32_t num_channels,
+                                             uint32_t clear_per_pass);
+
+RESULT_EFFECT_PRESETS   effect_presets_modify_crossfade(EFFECT_PRESETS * c,
+                                                        uint32_t crossfade_samples);
+
+RESULT_EFFECT_PRESETS   effect_presets_modify_cycle_budget(EFFECT_PRESETS * c,
+                                                           uint32_t (*cycle_counter)(void),
+                                                           uint32_t cycle_budget);
+
+RESULT_EFFECT_PRESETS   effect_presets_instantiate(EFFECT_PRESETS * c,
+                                                   uint32_t preset);
+
+RESULT_EFFECT_PRESETS   effect_presets_activate(EFFECT_PRESETS * c,
+                                                uint32_t preset);
+
+RESULT_EFFECT_PRESETS   effect_presets_deactivate(EFFECT_PRESETS * c,
+                                                  uint32_t preset);
+
+RESULT_EFFECT_PRESETS   effect_presets_release(EFFECT_PRESETS * c,
+                                               uint32_t preset);
+
+void    effect_presets_select(EFFECT_PRESETS * c,
+                              uint32_t preset);
+
+bool    effect_presets_process(EFFECT_PRESETS * c);
+
+void    effect_presets_read(EFFECT_PRESETS * c,
+                            uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _EFFECT_PRESETS_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * An envelope follower tracks the amplitude of a signal.  It is the detector
+ * used by dynamics processors (compressors, gates), envelope filters such as
+ * an autowah, and note detection.
+ *
+ * Three modes are supported:
+ *
+ *  - ENV_FOLLOWER_PEAK: follows |x|.  Use an attack time of 0 for a classic
+ *    peak follower that jumps to each new peak and then decays.
+ *  - ENV_FOLLOWER_RMS: follows x^2 and reports the square root (RMS).
+ *  - ENV_FOLLOWER_LOG: follows x^2 and reports the RMS level in dB, which is
+ *    what a compressor's gain computer works with.
+ *
+ * Each mode uses a one-pole smoother with separate attack (rising) and
+ * release (falling) time constants.  The time constant is the time taken to
+ * cover ~63% of a step.
+ *
+ * The envelope is processed a block at a time.  In RMS / log modes the
+ * smoothing runs on x^2 so the square root / log is only taken when a value
+ * is reported.  Values are reported once every 'decimation' samples into
+ * an optional control-rate buffer, and envelope_follower_read() returns the
+ * envelope at the end of the block.  For example, with a block of 32 samples
+ * and a decimation of 8, four control values are written per block and only
+ * four square roots are computed.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "envelope_follower.h"
+
+// Min/max limits and other constants
+#define ENV_FOLLOWER_TIME_MS_MIN        (0.0)
+#define ENV_FOLLOWER_TIME_MS_MAX        (10000.0)
+#define ENV_FOLLOWER_DECIMATION_MAX     (MAX_AUDIO_BLOCK_SIZE)
+#define ENV_FOLLOWER_LOG_FLOOR_DB       (-120.0)
+#define ENV_FOLLOWER_LOG_FLOOR          (1e-12)     // Power at floor (x^2)
+
+// Static function prototypes
+static float    envelope_follower_coeff(float time_ms, float fs);
+static float    envelope_follower_convert(ENV_FOLLOWER_MODE mode, float env);
+
+
+/**
+ * @brief Initializes instance of an envelope follower
+ *
+ * @param c Pointer to instance structure
+ * @param mode Detector mode (see enumeration)
+ * @param attack_ms Attack time constant in ms (0.0->10000.0, 0 = instant)
+ * @param release_ms Release time constant in ms (0.0->10000.0, 0 = instant)
+ * @param decimation Number of samples per control-rate output value (1->128)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Envelope follower result (enumeration)
+ */
+RESULT_ENV_FOLLOWER envelope_follower_setup(ENVELOPE_FOLLOWER * c,
+                                            ENV_FOLLOWER_MODE mode,
+                                            float attack_ms,
+                                            float release_ms,
+                                            uint32_t decimation,
+                                            float audio_sample_rate) {
+
+    if (c == NULL) {
+        return ENV_FOLLOWER_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (mode != ENV_FOLLOWER_PEAK &&
+        mode != ENV_FOLLOWER_RMS &&
+        mode != ENV_FOLLOWER_LOG) {
+        return ENV_FOLLOWER_INVALID_MODE;
+    }
+
+    if (attack_ms < ENV_FOLLOWER_TIME_MS_MIN ||
+        attack_ms > ENV_FOLLOWER_TIME_MS_MAX) {
+        return ENV_FOLLOWER_INVALID_ATTACK;
+    }
+
+    if (release_ms < ENV_FOLLOWER_TIME_MS_MIN ||
+        release_ms > ENV_FOLLOWER_TIME_MS_MAX) {
+        return ENV_FOLLOWER_INVALID_RELEASE;
+    }
+
+    if (decimation < 1 || decimation > ENV_FOLLOWER_DECIMATION_MAX) {
+        return ENV_FOLLOWER_INVALID_DECIMATION;
+    }
+
+    c->mode = mode;
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->attack_ms = attack_ms;
+    c->attack_coeff = envelope_follower_coeff(attack_ms, audio_sample_rate);
+    c->release_ms = release_ms;
+    c->release_coeff = envelope_follower_coeff(release_ms, audio_sample_rate);
+
+    c->decimation = decimation;
+    c->decimation_counter = 0;
+
+    c->env = 0.0;
+
+    c->initialized = true;
+    return ENV_FOLLOWER_OK;
+}
+
+/**
+ * @brief Modify the attack time
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_attack_ms Updated attack time constant in ms (0.0->10000.0)
+ * @return Envelope follower result (enumeration)
+ */
+RESULT_ENV_FOLLOWER envelope_follower_modify_attack(ENVELOPE_FOLLOWER * c,
+                                                    float attack_ms_new) {
+
+    RESULT_ENV_FOLLOWER res;
+
+    float attack_ms;
+    if (attack_ms_new > ENV_FOLLOWER_TIME_MS_MAX) {
+        attack_ms = ENV_FOLLOWER_TIME_MS_MAX;
+        res = ENV_FOLLOWER_INVALID_ATTACK;
+    }
+    else if (attack_ms_new < ENV_FOLLOWER_TIME_MS_MIN) {
+        attack_ms = ENV_FOLLOWER_TIME_MS_MIN;
+        res = ENV_FOLLOWER_INVALID_ATTACK;
+    }
+    else {
+        attack_ms = attack_ms_new;
+        res = ENV_FOLLOWER_OK;
+    }
+
+    // Only recalculate the coefficient when the value changes
+    if (attack_ms != c->attack_ms) {
+        c->attack_ms = attack_ms;
+        c->attack_coeff = envelope_follower_coeff(attack_ms, c->audio_sample_rate);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Modify the release time
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_release_ms Updated release time constant in ms (0.0->10000.0)
+ * @return Envelope follower result (enumeration)
+ */
+RESULT_ENV_FOLLOWER envelope_follower_modify_release(ENVELOPE_FOLLOWER * c,
+                                                     float release_ms_new) {
+
+    RESULT_ENV_FOLLOWER res;
+
+    float release_ms;
+    if (release_ms_new > ENV_FOLLOWER_TIME_MS_MAX) {
+        release_ms = ENV_FOLLOWER_TIME_MS_MAX;
+        res = ENV_FOLLOWER_INVALID_RELEASE;
+    }
+    else if (release_ms_new < ENV_FOLLOWER_TIME_MS_MIN) {
+        release_ms = ENV_FOLLOWER_TIME_MS_MIN;
+        res = ENV_FOLLOWER_INVALID_RELEASE;
+    }
+    else {
+        release_ms = release_ms_new;
+        res = ENV_FOLLOWER_OK;
+    }
+
+    // Only recalculate the coefficient when the value changes
+    if (release_ms != c->release_ms) {
+        c->release_ms = release_ms;
+        c->release_coeff = envelope_follower_coeff(release_ms, c->audio_sample_rate);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Follows the envelope of a block of audio
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param env_out Pointer to control-rate output buffer (or NULL).  One value
+ *                is written every 'decimation' samples.
+ * @param audio_block_size The number of floating-point words to process
+ * @return Envelope at the end of the block (in the units of the mode)
+ */
+#pragma optimize_for_speed
+float   envelope_follower_read(ENVELOPE_FOLLOWER * c,
+                               float * audio_in,
+                               float * env_out,
+                               uint32_t audio_block_size) {
+
+    if (c == NULL || !c->initialized) {
+        return 0.0;
+    }
+
+    float env = c->env;
+    float att = c->attack_coeff;
+    float rel = c->release_coeff;
+    uint32_t counter = c->decimation_counter;
+    uint32_t decimation = c->decimation;
+    uint32_t num_out = 0;
+
+    bool squared = (c->mode != ENV_FOLLOWER_PEAK);
+
+    for (int i=0;i<audio_block_size;i++) {
+
+        float x = audio_in[i];
+        x = squared ? x*x : fabsf(x);
+
+        float coeff = (x > env) ? att : rel;
+        env += coeff*(x - env);
+
+        if (++counter >= decimation) {
+            counter = 0;
+            if (env_out != NULL) {
+                env_out[num_out++] = env;
+            }
+        }
+    }
+
+    c->env = env;
+    c->decimation_counter = counter;
+
+    // Only convert the decimated values
+    if (squared) {
+        for (int i=0;i<num_out;i++) {
+            env_out[i] = envelope_follower_convert(c->mode, env_out[i]);
+        }
+    }
+
+    return envelope_follower_convert(c->mode, env);
+}
+
+/**
+ * @brief Returns the current envelope
+ *
+ * @param c Pointer to instance structure
+ * @return Current envelope (in the units of the mode)
+ */
+float   envelope_follower_value(ENVELOPE_FOLLOWER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return 0.0;
+    }
+    return envelope_follower_convert(c->mode, c->env);
+}
+
+/**
+ * @brief Calculates a one-pole smoothing coefficient from a time constant
+ *
+ * @param time_ms Time constant in ms (0 = no smoothing)
+ * @param fs Audio sample rate
+ * @return Coefficient
+ */
+static float    envelope_follower_coeff(float time_ms, float fs) {
+
+    if (time_ms <= 0.0) {
+        return 1.0;
+    }
+    return 1.0 - expf(-1.0/(1e-3*time_ms*fs));
+}
+
+/**
+ * @brief Converts the internal envelope state to the units of a mode
+ *
+ * @param mode Detector mode
+ * @param env Internal envelope state
+ * @return Envelope value
+ */
+static float    envelope_follower_convert(ENV_FOLLOWER_MODE mode, float env) {
+
+    switch (mode) {
+        case ENV_FOLLOWER_RMS:
+            return sqrtf(env);
+        case ENV_FOLLOWER_LOG:
+            if (env < ENV_FOLLOWER_LOG_FLOOR) {
+                return ENV_FOLLOWER_LOG_FLOOR_DB;
+            }
+            return 10.0*log10f(env);
+        default:
+            return env;
+    }
+}
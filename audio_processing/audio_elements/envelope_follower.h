@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _ENVELOPE_FOLLOWER_H
+#define _ENVELOPE_FOLLOWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum
+{
+    ENV_FOLLOWER_OK,
+    ENV_FOLLOWER_INVALID_INSTANCE_POINTER,
+    ENV_FOLLOWER_INVALID_MODE,
+    ENV_FOLLOWER_INVALID_ATTACK,
+    ENV_FOLLOWER_INVALID_RELEASE,
+    ENV_FOLLOWER_INVALID_DECIMATION
+} RESULT_ENV_FOLLOWER;
+
+// Detector modes
+typedef enum
+{
+    ENV_FOLLOWER_PEAK,      // Peak amplitude (linear)
+    ENV_FOLLOWER_RMS,       // RMS amplitude (linear)
+    ENV_FOLLOWER_LOG        // RMS amplitude in dB
+} ENV_FOLLOWER_MODE;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    ENV_FOLLOWER_MODE   mode;
+
+    float   attack_ms;
+    float   release_ms;
+    float   attack_coeff;
+    float   release_coeff;
+
+    uint32_t    decimation;
+    uint32_t    decimation_counter;
+
+    float   env;            // |x| for peak mode, x^2 for RMS / log modes
+
+    float   audio_sample_rate;
+
+} ENVELOPE_FOLLOWER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_ENV_FOLLOWER envelope_follower_setup(ENVELOPE_FOLLOWER * c,
+                                            ENV_FOLLOWER_MODE mode,
+                                            float attack_ms,
+                                            float release_ms,
+                                            uint32_t decimation,
+                                            float audio_sample_rate);
+
+RESULT_ENV_FOLLOWER envelope_follower_modify_attack(ENVELOPE_FOLLOWER * c,
+                                                    float new_attack_ms);
+
+RESULT_ENV_FOLLOWER envelope_follower_modify_release(ENVELOPE_FOLLOWER * c,
+                                                     float new_release_ms);
+
+float   envelope_follower_read(ENVELOPE_FOLLOWER * c,
+                               float * audio_in,
+                               float * env_out,
+                               uint32_t audio_block_size);
+
+float   envelope_follower_value(ENVELOPE_FOLLOWER * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _ENVELOPE_FOLLOWER_H
@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * An adaptive acoustic feedback suppressor.  It watches the input for the
+ * stable narrowband peaks that build up when a microphone starts to howl and
+ * places a narrow notch on each one.
+ *
+ * The work is split between the audio callback and the background loop:
+ *
+ *  - feedback_suppressor_read() is called from the audio callback.  It copies
+ *    the input into a ring buffer for analysis and runs the notches as one
+ *    cascaded biquad bank (see biquad_bank_read_cascade()).  Unused notches
+ *    are pass-through and are skipped.
+ *  - feedback_suppressor_process() is called from the background loop.  Each
+ *    time FEEDBACK_SUPPRESSOR_HOP_SIZE new samples are available it decimates
+ *    the latest frame by 2 (half-band FIR), takes a Hann windowed FFT and
+ *    looks for feedback.  New notch coefficients are handed back to the
+ *    callback, which picks them up at the start of its next block.
+ *
+ * A peak is treated as feedback when it:
+ *
+ *  - is above FEEDBACK_SUPPRESSOR_MIN_LEVEL_DB,
+ *  - stands at least FEEDBACK_SUPPRESSOR_PNPR_DB above the bins either side
+ *    of it (peak to neighbour ratio), i.e. it is a pure tone, and
+ *  - stays within a FEEDBACK_SUPPRESSOR_MAX_DRIFT bin range for
+ *    FEEDBACK_SUPPRESSOR_DETECT_MS.
+ *
+ * Sustained notes in the music can pass these tests too, which is why the
+ * notches are narrow (Q of FEEDBACK_SUPPRESSOR_Q).  The detection time is the
+ * trade-off between reacting quickly and notching the music.
+ *
+ * A new notch starts at FEEDBACK_SUPPRESSOR_INITIAL_DEPTH_DB.  If the peak is
+ * still there after another detection period, the notch is deepened in
+ * FEEDBACK_SUPPRESSOR_DEEPEN_DB steps down to max_depth_db.  Once the peak has
+ * gone, the notch is held for FEEDBACK_SUPPRESSOR_HOLD_MS and then released
+ * slowly (release_db_per_sec) until it is removed.  When every notch is in
+ * use, the shallowest one is moved to the new frequency.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "feedback_suppressor.h"
+
+// Min/max limits and other constants
+#define FEEDBACK_SUPPRESSOR_DEPTH_MIN       (-40.0)
+#define FEEDBACK_SUPPRESSOR_DEPTH_MAX       (-3.0)
+#define FEEDBACK_SUPPRESSOR_RELEASE_MIN     (0.1)
+#define FEEDBACK_SUPPRESSOR_RELEASE_MAX     (20.0)
+#define FEEDBACK_SUPPRESSOR_RING_MASK       (FEEDBACK_SUPPRESSOR_RING_SIZE-1)
+
+#define FEEDBACK_SUPPRESSOR_MIN_FREQ        (80.0)
+#define FEEDBACK_SUPPRESSOR_MAX_FREQ        (10000.0)
+#define FEEDBACK_SUPPRESSOR_MIN_LEVEL_DB    (-50.0)     // dBFS (sine)
+#define FEEDBACK_SUPPRESSOR_PNPR_DB         (15.0)
+#define FEEDBACK_SUPPRESSOR_NEIGHBOUR_MIN   (3)         // Neighbour bins are 3->5 bins either side
+#define FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX   (5)
+#define FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME (3)
+#define FEEDBACK_SUPPRESSOR_MAX_DRIFT       (0.5)       // Range of bins a peak may cover while it's watched
+#define FEEDBACK_SUPPRESSOR_MAX_MISSED      (2)         // Frames a peak may drop out
+#define FEEDBACK_SUPPRESSOR_DETECT_MS       (200.0)
+
+#define FEEDBACK_SUPPRESSOR_Q               (30.0)
+#define FEEDBACK_SUPPRESSOR_INITIAL_DEPTH_DB (-6.0)
+#define FEEDBACK_SUPPRESSOR_DEEPEN_DB       (3.0)
+#define FEEDBACK_SUPPRESSOR_REMOVE_DB       (-0.5)      // Notches shallower than this are removed
+#define FEEDBACK_SUPPRESSOR_HOLD_MS         (2000.0)
+#define FEEDBACK_SUPPRESSOR_MATCH_RATIO     (1.0/60.0)  // Same notch if within this fraction of its frequency
+
+// Half-band decimation filter (every other tap is zero).  Kaiser windowed
+// (beta 6.0); at 48 kHz it is flat to 0.01 dB up to 10 kHz and rejects
+// everything above 14 kHz by at least 62 dB, so nothing that folds back into
+// the search range can get above FEEDBACK_SUPPRESSOR_MIN_LEVEL_DB.
+#define FEEDBACK_SUPPRESSOR_HB_TAPS         (47)
+static const float feedback_suppressor_hb[FEEDBACK_SUPPRESSOR_HB_TAPS] = {
+    -0.000205849, 0.0, 0.000712440, 0.0,
+    -0.001664417, 0.0, 0.003262198, 0.0,
+    -0.005758129, 0.0, 0.009484547, 0.0,
+    -0.014925504, 0.0, 0.022902101, 0.0,
+    -0.035097158, 0.0, 0.055861473, 0.0,
+    -0.101261770, 0.0, 0.316679666, 0.500020805,
+    0.316679666, 0.0, -0.101261770, 0.0,
+    0.055861473, 0.0, -0.035097158, 0.0,
+    0.022902101, 0.0, -0.014925504, 0.0,
+    0.009484547, 0.0, -0.005758129, 0.0,
+    0.003262198, 0.0, -0.001664417, 0.0,
+    0.000712440, 0.0, -0.000205849
+};
+
+// Static function prototypes
+static void     feedback_suppressor_find_peaks(FEEDBACK_SUPPRESSOR * c,
+                                               float * peak_bins,
+                                               uint32_t * num_peaks);
+static void     feedback_suppressor_track(FEEDBACK_SUPPRESSOR * c,
+                                          float * peak_bins,
+                                          uint32_t num_peaks);
+static void     feedback_suppressor_deploy(FEEDBACK_SUPPRESSOR * c,
+                                           float freq);
+static void     feedback_suppressor_release(FEEDBACK_SUPPRESSOR * c);
+static void     feedback_suppressor_publish(FEEDBACK_SUPPRESSOR * c);
+
+
+/**
+ * @brief Initializes instance of a feedback suppressor
+ *
+ * @param c Pointer to instance structure
+ * @param num_notches Number of notches available (1->FEEDBACK_SUPPRESSOR_MAX_NOTCHES)
+ * @param max_depth_db Deepest notch in dB (-40.0->-3.0)
+ * @param release_db_per_sec Release rate once the feedback has gone (0.1->20.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Feedback suppressor result (enumeration)
+ */
+RESULT_FEEDBACK_SUPPRESSOR  feedback_suppressor_setup(FEEDBACK_SUPPRESSOR * c,
+                                                      uint32_t num_notches,
+                                                      float max_depth_db,
+                                                      float release_db_per_sec,
+                                                      float audio_sample_rate) {
+
+    if (c == NULL) {
+        return FEEDBACK_SUPPRESSOR_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (num_notches < 1 || num_notches > FEEDBACK_SUPPRESSOR_MAX_NOTCHES) {
+        return FEEDBACK_SUPPRESSOR_INVALID_NUM_NOTCHES;
+    }
+    if (max_depth_db < FEEDBACK_SUPPRESSOR_DEPTH_MIN || max_depth_db > FEEDBACK_SUPPRESSOR_DEPTH_MAX) {
+        return FEEDBACK_SUPPRESSOR_INVALID_DEPTH;
+    }
+    if (release_db_per_sec < FEEDBACK_SUPPRESSOR_RELEASE_MIN || release_db_per_sec > FEEDBACK_SUPPRESSOR_RELEASE_MAX) {
+        return FEEDBACK_SUPPRESSOR_INVALID_RELEASE;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+    c->num_notches = num_notches;
+    c->max_depth_db = max_depth_db;
+
+    // Timing is in analysis frames
+    float frame_ms = 1000.0*FEEDBACK_SUPPRESSOR_HOP_SIZE/audio_sample_rate;
+    c->release_db_per_frame = release_db_per_sec*frame_ms*0.001;
+    c->hold_frames = (uint32_t)(FEEDBACK_SUPPRESSOR_HOLD_MS/frame_ms);
+    c->detect_frames = (uint32_t)(FEEDBACK_SUPPRESSOR_DETECT_MS/frame_ms + 0.5);
+    if (c->detect_frames < 2) {
+        c->detect_frames = 2;
+    }
+
+    // Search range, leaving room for the neighbour bins
+    float bin_hz = audio_sample_rate/(FEEDBACK_SUPPRESSOR_DECIMATION*FEEDBACK_SUPPRESSOR_FFT_SIZE);
+    c->min_bin = (uint32_t)(FEEDBACK_SUPPRESSOR_MIN_FREQ/bin_hz);
+    c->max_bin = (uint32_t)(FEEDBACK_SUPPRESSOR_MAX_FREQ/bin_hz);
+    if (c->min_bin < FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX + 1) {
+        c->min_bin = FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX + 1;
+    }
+    if (c->max_bin > FEEDBACK_SUPPRESSOR_BINS - FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX - 2) {
+        c->max_bin = FEEDBACK_SUPPRESSOR_BINS - FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX - 2;
+    }
+
+    // Periodic Hann window
+    for (int i=0;i<FEEDBACK_SUPPRESSOR_FFT_SIZE;i++) {
+        c->window[i] = 0.5 - 0.5*cosf(PI2*i/FEEDBACK_SUPPRESSOR_FFT_SIZE);
+    }
+    real_fft_setup(&c->fft, FEEDBACK_SUPPRESSOR_FFT_SIZE);
+
+    // All notches start as pass-through
+    biquad_bank_setup(&c->notches, num_notches, audio_sample_rate);
+    c->coeffs_pending = false;
+
+    for (int i=0;i<FEEDBACK_SUPPRESSOR_RING_SIZE;i++) {
+        c->ring[i] = 0.0;
+    }
+    c->write_count = 0;
+    c->next_frame_end = FEEDBACK_SUPPRESSOR_FRAME_SIZE;
+    c->frames_dropped = 0;
+    c->detections = 0;
+    c->last_detection_freq = 0.0;
+
+    c->initialized = true;
+    feedback_suppressor_reset(c);
+
+    return FEEDBACK_SUPPRESSOR_OK;
+}
+
+/**
+ * @brief Removes all notches and forgets any peaks being watched
+ *
+ * Call this from the background loop.  The notches are removed at the start
+ * of the next audio block.
+ *
+ * @param c Pointer to instance structure
+ */
+void    feedback_suppressor_reset(FEEDBACK_SUPPRESSOR * c) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    for (int i=0;i<FEEDBACK_SUPPRESSOR_MAX_CANDIDATES;i++) {
+        c->candidates[i].active = false;
+    }
+    for (int n=0;n<FEEDBACK_SUPPRESSOR_MAX_NOTCHES;n++) {
+        c->notch[n].active = false;
+        c->notch[n].freq = 0.0;
+        c->notch[n].depth_db = 0.0;
+        c->notch[n].hold_frames = 0;
+    }
+    c->num_active = 0;
+
+    c->coeffs_dirty = true;
+    feedback_suppressor_publish(c);
+}
+
+/**
+ * @brief Runs the notches on a block of audio and queues it for analysis
+ *
+ * Called from the audio callback.  Processing can be done in place.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    feedback_suppressor_read(FEEDBACK_SUPPRESSOR * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    // Pick up new coefficients from the background loop.  A notch that was
+    // pass-through has stale state (it was skipped), so clear it.
+    if (c->coeffs_pending) {
+        BIQUAD_BANK * bank = &c->notches;
+        for (int s=0;s<c->num_notches;s++) {
+            if (bank->a1[s] == 0.0 && bank->a2[s] == 0.0) {
+                bank->z1[s] = 0.0;
+                bank->z2[s] = 0.0;
+            }
+            bank->b0[s] = c->pending_b0[s];
+            bank->b1[s] = c->pending_b1[s];
+            bank->b2[s] = c->pending_b2[s];
+            bank->a1[s] = c->pending_a1[s];
+            bank->a2[s] = c->pending_a2[s];
+        }
+        c->coeffs_pending = false;
+    }
+
+    // Queue the input for analysis
+    uint32_t pos = c->write_count;
+    for (int i=0;i<audio_block_size;i++) {
+        c->ring[(pos + i) & FEEDBACK_SUPPRESSOR_RING_MASK] = audio_in[i];
+    }
+    c->write_count = pos + audio_block_size;
+
+    biquad_bank_read_cascade(&c->notches, audio_in, audio_out, audio_block_size);
+}
+
+/**
+ * @brief Analyzes the next frame of audio if one is ready and updates the notches
+ *
+ * Call this from the background loop.  At most one frame is analyzed per call.
+ *
+ * @param c Pointer to instance structure
+ * @return true if a notch was added, deepened or removed
+ */
+#pragma optimize_for_speed
+bool    feedback_suppressor_process(FEEDBACK_SUPPRESSOR * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    // Retry a coefficient update that the callback hadn't picked up yet
+    feedback_suppressor_publish(c);
+
+    uint32_t written = c->write_count;
+    if ((int32_t)(written - c->next_frame_end) < 0) {
+        return false;
+    }
+
+    // If we've fallen behind, jump to the latest frame
+    if (written - c->next_frame_end > FEEDBACK_SUPPRESSOR_RING_SIZE - FEEDBACK_SUPPRESSOR_FRAME_SIZE - FEEDBACK_SUPPRESSOR_HB_TAPS) {
+        c->frames_dropped++;
+        c->next_frame_end = written;
+    }
+    uint32_t start = c->next_frame_end - FEEDBACK_SUPPRESSOR_FRAME_SIZE - FEEDBACK_SUPPRESSOR_HB_TAPS + 1;
+    c->next_frame_end += FEEDBACK_SUPPRESSOR_HOP_SIZE;
+
+    // Decimate and window
+    for (int m=0;m<FEEDBACK_SUPPRESSOR_FFT_SIZE;m++) {
+        uint32_t pos = start + m*FEEDBACK_SUPPRESSOR_DECIMATION;
+        float sum = 0.0;
+        for (int j=0;j<FEEDBACK_SUPPRESSOR_HB_TAPS;j++) {
+            sum += feedback_suppressor_hb[j]*c->ring[(pos + j) & FEEDBACK_SUPPRESSOR_RING_MASK];
+        }
+        c->frame[m] = sum*c->window[m];
+    }
+
+    real_fft_forward(&c->fft, c->frame, c->work_re, c->work_im);
+
+    // Level in dB relative to a full scale sine (the Hann window has a
+    // coherent gain of 0.5)
+    float scale = 4.0/FEEDBACK_SUPPRESSOR_FFT_SIZE;
+    scale = scale*scale;
+    for (int k=0;k<FEEDBACK_SUPPRESSOR_BINS;k++) {
+        float power = c->work_re[k]*c->work_re[k] + c->work_im[k]*c->work_im[k];
+        c->spectrum_db[k] = 10.0*log10f(power*scale + 1.0e-20);
+    }
+
+    float peak_bins[FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME];
+    uint32_t num_peaks;
+    feedback_suppressor_find_peaks(c, peak_bins, &num_peaks);
+    feedback_suppressor_track(c, peak_bins, num_peaks);
+    feedback_suppressor_release(c);
+
+    bool changed = c->coeffs_dirty;
+    feedback_suppressor_publish(c);
+
+    return changed;
+}
+
+/**
+ * @brief Finds the strongest narrowband peaks in the current spectrum
+ *
+ * @param c Pointer to instance structure
+ * @param peak_bins Interpolated bins of the peaks found (strongest first)
+ * @param num_peaks Number of peaks found
+ */
+static void     feedback_suppressor_find_peaks(FEEDBACK_SUPPRESSOR * c,
+                                               float * peak_bins,
+                                               uint32_t * num_peaks) {
+
+    float * db = c->spectrum_db;
+    float peak_db[FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME];
+    uint32_t found = 0;
+
+    for (int k=c->min_bin;k<=c->max_bin;k++) {
+
+        float level = db[k];
+        if (level < FEEDBACK_SUPPRESSOR_MIN_LEVEL_DB ||
+            level <= db[k-1] ||
+            level < db[k+1]) {
+            continue;
+        }
+
+        // Compare with the bins just outside the window's main lobe
+        float neighbours = 0.0;
+        for (int n=FEEDBACK_SUPPRESSOR_NEIGHBOUR_MIN;n<=FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX;n++) {
+            neighbours += powf(10.0, 0.1*db[k-n]) + powf(10.0, 0.1*db[k+n]);
+        }
+        neighbours *= 0.5/(FEEDBACK_SUPPRESSOR_NEIGHBOUR_MAX - FEEDBACK_SUPPRESSOR_NEIGHBOUR_MIN + 1);
+        if (level - 10.0*log10f(neighbours + 1.0e-20) < FEEDBACK_SUPPRESSOR_PNPR_DB) {
+            continue;
+        }
+
+        // Parabola through the peak (in dB) for the fractional bin
+        float a = db[k-1];
+        float b = db[k];
+        float d = db[k+1];
+        float denom = a - 2.0*b + d;
+        float offset = (denom < 0.0) ? 0.5*(a - d)/denom : 0.0;
+
+        // Keep the strongest peaks, sorted
+        int slot = found;
+        while (slot > 0 && peak_db[slot-1] < level) {
+            if (slot < FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME) {
+                peak_db[slot] = peak_db[slot-1];
+                peak_bins[slot] = peak_bins[slot-1];
+            }
+            slot--;
+        }
+        if (slot < FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME) {
+            peak_db[slot] = level;
+            peak_bins[slot] = k + offset;
+            if (found < FEEDBACK_SUPPRESSOR_PEAKS_PER_FRAME) {
+                found++;
+            }
+        }
+    }
+
+    *num_peaks = found;
+}
+
+/**
+ * @brief Follows peaks from frame to frame and reports the ones that persist
+ *
+ * @param c Pointer to instance structure
+ * @param peak_bins Interpolated bins of the peaks in this frame
+ * @param num_peaks Number of peaks in this frame
+ */
+static void     feedback_suppressor_track(FEEDBACK_SUPPRESSOR * c,
+                                          float * peak_bins,
+                                          uint32_t num_peaks) {
+
+    bool seen[FEEDBACK_SUPPRESSOR_MAX_CANDIDATES];
+    for (int i=0;i<FEEDBACK_SUPPRESSOR_MAX_CANDIDATES;i++) {
+        seen[i] = false;
+    }
+
+    for (int p=0;p<num_peaks;p++) {
+        float bin = peak_bins[p];
+
+        // Match to a peak we're already watching
+        int match = -1;
+        int free_slot = -1;
+        for (int i=0;i<FEEDBACK_SUPPRESSOR_MAX_CANDIDATES;i++) {
+            FEEDBACK_SUPPRESSOR_CANDIDATE * cand = &c->candidates[i];
+            if (!cand->active) {
+                if (free_slot < 0) {
+                    free_slot = i;
+                }
+            }
+            else if (!seen[i] && fabsf(cand->bin - bin) < 1.0) {
+                match = i;
+                break;
+            }
+        }
+
+        if (match < 0) {
+            if (free_slot >= 0) {
+                FEEDBACK_SUPPRESSOR_CANDIDATE * cand = &c->candidates[free_slot];
+                cand->active = true;
+                cand->bin = bin;
+                cand->bin_min = bin;
+                cand->bin_max = bin;
+                cand->frames = 1;
+                cand->missed = 0;
+                seen[free_slot] = true;
+            }
+            continue;
+        }
+
+        // A peak that wanders isn't feedback.  The drift is the whole range
+        // the peak has covered rather than the move from the last frame, so
+        // notes a semitone apart can't be bridged by the frame in between.
+        FEEDBACK_SUPPRESSOR_CANDIDATE * cand = &c->candidates[match];
+        if (bin < cand->bin_min) {
+            cand->bin_min = bin;
+        }
+        if (bin > cand->bin_max) {
+            cand->bin_max = bin;
+        }
+        if (cand->bin_max - cand->bin_min > FEEDBACK_SUPPRESSOR_MAX_DRIFT) {
+            cand->bin_min = bin;
+            cand->bin_max = bin;
+            cand->frames = 1;
+        }
+        else {
+            cand->frames++;
+        }
+        cand->bin = bin;
+        cand->missed = 0;
+        seen[match] = true;
+
+        if (cand->frames >= c->detect_frames) {
+            float bin_hz = c->audio_sample_rate/(FEEDBACK_SUPPRESSOR_DECIMATION*FEEDBACK_SUPPRESSOR_FFT_SIZE);
+            feedback_suppressor_deploy(c, bin*bin_hz);
+
+            // Deepen the notch if the peak is still there after another detection period
+            cand->frames = 0;
+        }
+    }
+
+    // Forget peaks that have gone
+    for (int i=0;i<FEEDBACK_SUPPRESSOR_MAX_CANDIDATES;i++) {
+        FEEDBACK_SUPPRESSOR_CANDIDATE * cand = &c->candidates[i];
+        if (cand->active && !seen[i]) {
+            cand->missed++;
+            if (cand->missed > FEEDBACK_SUPPRESSOR_MAX_MISSED) {
+                cand->active = false;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Places a notch on a feedback frequency, or deepens the one already there
+ *
+ * @param c Pointer to instance structure
+ * @param freq Feedback frequency in Hz
+ */
+static void     feedback_suppressor_deploy(FEEDBACK_SUPPRESSOR * c,
+                                           float freq) {
+
+    float bin_hz = c->audio_sample_rate/(FEEDBACK_SUPPRESSOR_DECIMATION*FEEDBACK_SUPPRESSOR_FFT_SIZE);
+    float tolerance = freq*FEEDBACK_SUPPRESSOR_MATCH_RATIO;
+    if (tolerance < bin_hz) {
+        tolerance = bin_hz;
+    }
+
+    c->detections++;
+    c->last_detection_freq = freq;
+    c->coeffs_dirty = true;
+
+    // Already notched, so go deeper
+    for (int n=0;n<c->num_notches;n++) {
+        FEEDBACK_SUPPRESSOR_NOTCH * notch = &c->notch[n];
+        if (notch->active && fabsf(notch->freq - freq) < tolerance) {
+            notch->freq += 0.5*(freq - notch->freq);
+            notch->depth_db -= FEEDBACK_SUPPRESSOR_DEEPEN_DB;
+            if (notch->depth_db < c->max_depth_db) {
+                notch->depth_db = c->max_depth_db;
+            }
+            notch->hold_frames = c->hold_frames;
+            return;
+        }
+    }
+
+    // Use a free notch, otherwise move the shallowest one
+    int slot = -1;
+    for (int n=0;n<c->num_notches;n++) {
+        if (!c->notch[n].active) {
+            slot = n;
+            break;
+        }
+    }
+    if (slot < 0) {
+        slot = 0;
+        for (int n=1;n<c->num_notches;n++) {
+            if (c->notch[n].depth_db > c->notch[slot].depth_db) {
+                slot = n;
+            }
+        }
+    }
+    else {
+        c->num_active++;
+    }
+
+    FEEDBACK_SUPPRESSOR_NOTCH * notch = &c->notch[slot];
+    notch->active = true;
+    notch->freq = freq;
+    notch->depth_db = FEEDBACK_SUPPRESSOR_INITIAL_DEPTH_DB;
+    if (notch->depth_db < c->max_depth_db) {
+        notch->depth_db = c->max_depth_db;
+    }
+    notch->hold_frames = c->hold_frames;
+}
+
+/**
+ * @brief Holds and then slowly releases notches once the feedback has gone
+ *
+ * @param c Pointer to instance structure
+ */
+static void     feedback_suppressor_release(FEEDBACK_SUPPRESSOR * c) {
+
+    for (int n=0;n<c->num_notches;n++) {
+        FEEDBACK_SUPPRESSOR_NOTCH * notch = &c->notch[n];
+        if (!notch->active) {
+            continue;
+        }
+        if (notch->hold_frames > 0) {
+            notch->hold_frames--;
+            continue;
+        }
+
+        notch->depth_db += c->release_db_per_frame;
+        if (notch->depth_db > FEEDBACK_SUPPRESSOR_REMOVE_DB) {
+            notch->active = false;
+            notch->depth_db = 0.0;
+            c->num_active--;
+        }
+        c->coeffs_dirty = true;
+    }
+}
+
+/**
+ * @brief Hands new notch coefficients to the audio callback
+ *
+ * If the callback hasn't picked up the previous set yet, this is left for
+ * the next call.
+ *
+ * @param c Pointer to instance structure
+ */
+static void     feedback_suppressor_publish(FEEDBACK_SUPPRESSOR * c) {
+
+    if (!c->coeffs_dirty || c->coeffs_pending) {
+        return;
+    }
+
+    for (int n=0;n<c->num_notches;n++) {
+        FEEDBACK_SUPPRESSOR_NOTCH * notch = &c->notch[n];
+        if (!notch->active) {
+            c->pending_b0[n] = 1.0;
+            c->pending_b1[n] = 0.0;
+            c->pending_b2[n] = 0.0;
+            c->pending_a1[n] = 0.0;
+            c->pending_a2[n] = 0.0;
+            continue;
+        }
+
+        // b0, b1, b2, a0, a1, a2
+        float coeffs[6];
+        filter_generate_coeffs(BIQUAD_TYPE_PEAKING,
+                               notch->freq,
+                               FEEDBACK_SUPPRESSOR_Q,
+                               notch->depth_db,
+                               c->audio_sample_rate,
+                               coeffs);
+
+        float a0_inv = 1.0/coeffs[3];
+        c->pending_b0[n] = coeffs[0]*a0_inv;
+        c->pending_b1[n] = coeffs[1]*a0_inv;
+        c->pending_b2[n] = coeffs[2]*a0_inv;
+        c->pending_a1[n] = coeffs[4]*a0_inv;
+        c->pending_a2[n] = coeffs[5]*a0_inv;
+    }
+
+    c->coeffs_dirty = false;
+    c->coeffs_pending = true;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _FEEDBACK_SUPPRESSOR_H
+#define _FEEDBACK_SUPPRESSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "biquad_bank.h"
+#include "real_fft.h"
+
+#define FEEDBACK_SUPPRESSOR_MAX_NOTCHES     (12)
+#define FEEDBACK_SUPPRESSOR_MAX_CANDIDATES  (8)
+
+#define FEEDBACK_SUPPRESSOR_FRAME_SIZE      (2048)      // Analysis frame (full rate samples)
+#define FEEDBACK_SUPPRESSOR_HOP_SIZE        (1024)      // Samples between analyses
+#define FEEDBACK_SUPPRESSOR_RING_SIZE       (4096)      // Power of 2 >= FRAME_SIZE + HOP_SIZE + half-band taps
+#define FEEDBACK_SUPPRESSOR_DECIMATION      (2)
+#define FEEDBACK_SUPPRESSOR_FFT_SIZE        (FEEDBACK_SUPPRESSOR_FRAME_SIZE/FEEDBACK_SUPPRESSOR_DECIMATION)
+#define FEEDBACK_SUPPRESSOR_BINS            (FEEDBACK_SUPPRESSOR_FFT_SIZE/2+1)
+
+// Result enumerations
+typedef enum
+{
+    FEEDBACK_SUPPRESSOR_OK,
+    FEEDBACK_SUPPRESSOR_INVALID_INSTANCE_POINTER,
+    FEEDBACK_SUPPRESSOR_INVALID_NUM_NOTCHES,
+    FEEDBACK_SUPPRESSOR_INVALID_DEPTH,
+    FEEDBACK_SUPPRESSOR_INVALID_RELEASE
+} RESULT_FEEDBACK_SUPPRESSOR;
+
+// A narrowband peak that is being watched
+typedef struct {
+
+    bool    active;
+    float   bin;                        // Interpolated bin of the peak
+    float   bin_min;                    // Range of bins the peak has covered
+    float   bin_max;
+    uint32_t    frames;                 // Consecutive frames the peak has been seen
+    uint32_t    missed;                 // Consecutive frames the peak has been missing
+
+} FEEDBACK_SUPPRESSOR_CANDIDATE;
+
+// A deployed notch
+typedef struct {
+
+    bool    active;
+    float   freq;                       // Hz
+    float   depth_db;                   // Gain at the center (negative)
+    uint32_t    hold_frames;            // Frames left before the release starts
+
+} FEEDBACK_SUPPRESSOR_NOTCH;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    uint32_t    num_notches;
+    float   max_depth_db;
+    float   release_db_per_frame;
+    uint32_t    hold_frames;
+    uint32_t    detect_frames;          // Frames a peak must persist to count as feedback
+    uint32_t    min_bin;
+    uint32_t    max_bin;
+
+    // The notch cascade (audio callback)
+    BIQUAD_BANK notches;
+
+    // New coefficients, written by the background loop and picked up by the
+    // audio callback at the start of the next block
+    float   pending_b0[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    float   pending_b1[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    float   pending_b2[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    float   pending_a1[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    float   pending_a2[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    volatile bool   coeffs_pending;
+    bool    coeffs_dirty;
+
+    // Sample ring written by the audio callback
+    float   ring[FEEDBACK_SUPPRESSOR_RING_SIZE];
+    volatile uint32_t   write_count;
+    uint32_t    next_frame_end;
+    uint32_t    frames_dropped;
+
+    // Work buffers for the background analysis
+    REAL_FFT    fft;
+    float   window[FEEDBACK_SUPPRESSOR_FFT_SIZE];
+    float   frame[FEEDBACK_SUPPRESSOR_FFT_SIZE];
+    float   work_re[FEEDBACK_SUPPRESSOR_BINS];
+    float   work_im[FEEDBACK_SUPPRESSOR_BINS];
+    float   spectrum_db[FEEDBACK_SUPPRESSOR_BINS];
+
+    FEEDBACK_SUPPRESSOR_CANDIDATE   candidates[FEEDBACK_SUPPRESSOR_MAX_CANDIDATES];
+
+    // Results
+    FEEDBACK_SUPPRESSOR_NOTCH   notch[FEEDBACK_SUPPRESSOR_MAX_NOTCHES];
+    uint32_t    num_active;             // Notches currently deployed
+    uint32_t    detections;             // Total feedback detections since setup
+    float   last_detection_freq;        // Hz
+
+    float   audio_sample_rate;
+
+} FEEDBACK_SUPPRESSOR;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_FEEDBACK_SUPPRESSOR  feedback_suppressor_setup(FEEDBACK_SUPPRESSOR * c,
+                                                      uint32_t num_notches,
+                                                      float max_depth_db,
+                                                      float release_db_per_sec,
+                                                      float audio_sample_rate);
+
+void    feedback_suppressor_reset(FEEDBACK_SUPPRESSOR * c);
+
+void    feedback_suppressor_read(FEEDBACK_SUPPRESSOR * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size);
+
+bool    feedback_suppressor_process(FEEDBACK_SUPPRESSOR * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _FEEDBACK_SUPPRESSOR_H
@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <math.h>
 
 #include "integer_delay_lpf.h"
 
@@ -17,6 +18,33 @@
 #define DELAY_MAX_ACOEFF        (0.999)
 
 #define DELAY_LPF_LENGTH_TRANS_STEPS    (16000)
+#define DELAY_MIN_CROSSFADE_LEN         (32)
+#define DELAY_MAX_CROSSFADE_LEN         (48000)
+
+// Static function prototypes
+static RESULT_DELAY delay_init(DELAY_LPF * c,
+                               void * delay_buffer,
+                               uint32_t delay_buffer_size,
+                               DELAY_STORAGE_FORMAT storage_format,
+                               uint32_t delay_initial_length,
+                               float feedback,
+                               float feedthrough,
+                               float a_coeff,
+                               bool clear_delay_line);
+static void     delay_start_crossfade(DELAY_LPF * c);
+static void     delay_advance_crossfade(DELAY_LPF * c, uint32_t num_samples);
+static uint32_t delay_read_crossfade(DELAY_LPF * c,
+                                     float * audio_in,
+                                     float * audio_out,
+                                     uint32_t audio_block_size);
+static void     delay_read_glide(DELAY_LPF * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size);
+static void     delay_read_packed(DELAY_LPF * c,
+                                  float * audio_in,
+                                  float * audio_out,
+                                  uint32_t audio_block_size);
 
 
 /**
@@ -38,8 +66,155 @@ RESULT_DELAY    delay_setup(DELAY_LPF * c,
                             float feedback,
                             float feedthrough,
                             float a_coeff) {
-    
-    
+
+    return delay_setup_packed(c,
+                              delay_buffer,
+                              delay_buffer_size,
+                              DELAY_STORAGE_FLOAT,
+                              delay_initial_length,
+                              feedback,
+                              feedthrough,
+                              a_coeff);
+}
+
+/**
+ * @brief Initializes instance of a digital delay effect with a delay line
+ * stored in the specified sample format
+ *
+ * Delay lines stored as 16-bit samples (see delay_line_storage.c) use half
+ * the memory of a float delay line.  They are processed a block at a time, so
+ * the delay length must be at least MAX_AUDIO_BLOCK_SIZE samples.
+ *
+ * @param c Pointer to instance structure
+ * @param delay_buffer Pointer to delay line buffer
+ * @param delay_buffer_size Size of delay line buffer in samples
+ * @param storage_format Sample format of the delay line buffer
+ * @param delay_initial_length Initial length of delay (location of read pointer)
+ * @param feedback Amount of feedback (-1.0->1.0)
+ * @param feedthrough Amount of feedthrough (-1.0->1.0)
+ * @param a_coeff Dampening coefficent - set to 0.0 for no dampening
+ * @return Delay result (enumeration)
+ */
+RESULT_DELAY    delay_setup_packed(DELAY_LPF * c,
+                                   void * delay_buffer,
+                                   uint32_t delay_buffer_size,
+                                   DELAY_STORAGE_FORMAT storage_format,
+                                   uint32_t delay_initial_length,
+                                   float feedback,
+                                   float feedthrough,
+                                   float a_coeff) {
+
+    return delay_init(c,
+                      delay_buffer,
+                      delay_buffer_size,
+                      storage_format,
+                      delay_initial_length,
+                      feedback,
+                      feedthrough,
+                      a_coeff,
+                      true);
+}
+
+/**
+ * @brief Initializes instance of a digital delay effect with a delay line
+ * that has already been cleared
+ *
+ * This is the same as delay_setup() except that the delay line isn't zeroed,
+ * which takes a while for long delay lines in SDRAM.  The caller is
+ * responsible for zeroing it first, e.g. a little at a time in the
+ * background loop (see effect_presets.c).
+ *
+ * @param c Pointer to instance structure
+ * @param delay_buffer Pointer to delay line buffer (already zeroed)
+ * @param delay_buffer_size Size of delay line buffer in floating point words
+ * @param delay_initial_length Initial length of delay (location of read pointer)
+ * @param feedback Amount of feedback (-1.0->1.0)
+ * @param feedthrough Amount of feedthrough (-1.0->1.0)
+ * @param a_coeff Dampening coefficent - set to 0.0 for no dampening
+ * @return Delay result (enumeration)
+ */
+RESULT_DELAY    delay_setup_cleared(DELAY_LPF * c,
+                                    float * delay_buffer,
+                                    uint32_t delay_buffer_size,
+                                    uint32_t delay_initial_length,
+                                    float feedback,
+                                    float feedthrough,
+                                    float a_coeff) {
+
+    return delay_init(c,
+                      delay_buffer,
+                      delay_buffer_size,
+                      DELAY_STORAGE_FLOAT,
+                      delay_initial_length,
+                      feedback,
+                      feedthrough,
+                      a_coeff,
+                      false);
+}
+
+/**
+ * @brief Initializes instance of a digital delay effect with a packed delay
+ * line that has already been cleared
+ *
+ * This is the same as delay_setup_packed() except that the delay line isn't
+ * zeroed (see delay_setup_cleared()).  All of the storage formats are zero
+ * when every bit is zero, so a packed delay line can be zeroed as
+ * delay_buffer_size*delay_storage_bytes_per_sample()/4 float words.
+ *
+ * @param c Pointer to instance structure
+ * @param delay_buffer Pointer to delay line buffer (already zeroed)
+ * @param delay_buffer_size Size of delay line buffer in samples
+ * @param storage_format Sample format of the delay line buffer
+ * @param delay_initial_length Initial length of delay (location of read pointer)
+ * @param feedback Amount of feedback (-1.0->1.0)
+ * @param feedthrough Amount of feedthrough (-1.0->1.0)
+ * @param a_coeff Dampening coefficent - set to 0.0 for no dampening
+ * @return Delay result (enumeration)
+ */
+RESULT_DELAY    delay_setup_packed_cleared(DELAY_LPF * c,
+                                           void * delay_buffer,
+                                           uint32_t delay_buffer_size,
+                                           DELAY_STORAGE_FORMAT storage_format,
+                                           uint32_t delay_initial_length,
+                                           float feedback,
+                                           float feedthrough,
+                                           float a_coeff) {
+
+    return delay_init(c,
+                      delay_buffer,
+                      delay_buffer_size,
+                      storage_format,
+                      delay_initial_length,
+                      feedback,
+                      feedthrough,
+                      a_coeff,
+                      false);
+}
+
+/**
+ * @brief Initializes the instance for the setup functions
+ *
+ * @param c Pointer to instance structure
+ * @param delay_buffer Pointer to delay line buffer
+ * @param delay_buffer_size Size of delay line buffer in samples
+ * @param storage_format Sample format of the delay line buffer
+ * @param delay_initial_length Initial length of delay (location of read pointer)
+ * @param feedback Amount of feedback (-1.0->1.0)
+ * @param feedthrough Amount of feedthrough (-1.0->1.0)
+ * @param a_coeff Dampening coefficent - set to 0.0 for no dampening
+ * @param clear_delay_line Zero the delay line (false if already zeroed)
+ * @return Delay result (enumeration)
+ */
+static RESULT_DELAY delay_init(DELAY_LPF * c,
+                               void * delay_buffer,
+                               uint32_t delay_buffer_size,
+                               DELAY_STORAGE_FORMAT storage_format,
+                               uint32_t delay_initial_length,
+                               float feedback,
+                               float feedthrough,
+                               float a_coeff,
+                               bool clear_delay_line) {
+
     if (c == NULL) {
         return DELAY_INVALID_INSTANCE_POINTER;
     }
@@ -49,6 +224,11 @@ RESULT_DELAY    delay_setup(DELAY_LPF * c,
     if (delay_initial_length > delay_buffer_size) {
         return DELAY_LENGTH_EXCEEDS_BUF_SIZE;
     }
+
+    if (storage_format != DELAY_STORAGE_FLOAT &&
+        delay_initial_length < MAX_AUDIO_BLOCK_SIZE) {
+        return DELAY_LENGTH_TOO_SHORT;
+    }
     
     // Check if buffer pointer is valid
     if (delay_buffer == NULL) {
@@ -58,6 +238,7 @@ RESULT_DELAY    delay_setup(DELAY_LPF * c,
     // Set delay parameters
     c->delay_line = delay_buffer;
     c->delay_line_size = delay_buffer_size;
+    c->storage_format = storage_format;
 
     if (feedback < DELAY_MIN_FEEDBACK ||
         feedback > DELAY_MAX_FEEDBACK) {
@@ -72,13 +253,19 @@ RESULT_DELAY    delay_setup(DELAY_LPF * c,
     c->feedthrough = feedthrough;
     
     // Zero delay line
-    for (int i=0;i<delay_buffer_size;i++) {
-        delay_buffer[i] = 0.0;
+    if (clear_delay_line) {
+        delay_storage_clear(delay_buffer, storage_format, delay_buffer_size);
     }
 
     c->read_tap = delay_initial_length;
     c->read_tap_f = (float) c->read_tap;
     c->target_read_tap = delay_initial_length;
+    c->read_tap_steps = 0;
+
+    // Length changes glide by default, see delay_modify_crossfade()
+    c->xfade_len = 0;
+    c->xfade_steps = 0;
+    c->xfade_tap = c->read_tap;
 
     c->write_ptr = 0;
 
@@ -147,6 +334,12 @@ RESULT_DELAY    delay_modify_dampening(DELAY_LPF * c,
 /**
  * @brief Modify delay length
  *
+ * By default the read tap glides to the new length over
+ * DELAY_LPF_LENGTH_TRANS_STEPS samples (which bends the pitch of the delayed
+ * audio).  If a crossfade length has been set with delay_modify_crossfade(),
+ * a second read head is started at the new length instead and the two heads
+ * are crossfaded.
+ *
  * If the input parameter is out of bounds, clip it to the corresponding min/max
  * and apply that value.  This function will return a flag indicating an
  * invalid input parameter was supplied but it won't disable the effect.
@@ -176,6 +369,24 @@ RESULT_DELAY    delay_modify_length(DELAY_LPF * c,
         res = DELAY_OK;
     }
 
+    // Packed delay lines are processed a block at a time
+    if (c->storage_format != DELAY_STORAGE_FLOAT &&
+        delay_length < MAX_AUDIO_BLOCK_SIZE) {
+        delay_length = MAX_AUDIO_BLOCK_SIZE;
+        res = DELAY_LENGTH_TOO_SHORT;
+    }
+
+    // Crossfade mode: start a new crossfade unless one is already running, in
+    // which case the new target is picked up at the start of the first block
+    // after it completes
+    if (c->xfade_len) {
+        c->target_read_tap = delay_length;
+        if (c->xfade_steps == 0 && delay_length != c->read_tap) {
+            delay_start_crossfade(c);
+        }
+        return res;
+    }
+
     if (delay_length_new == c->read_tap) {
         return res;
     }
@@ -260,6 +471,49 @@ RESULT_DELAY    delay_modify_feedthrough( DELAY_LPF * c, float feedthrough_new )
     return res;
 }
 
+/**
+ * @brief Modify the length of the crossfade used when the delay length changes
+ *
+ * A length of 0 disables crossfading and delay length changes glide the read
+ * tap instead.
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param crossfade_len_new Crossfade length in samples (0 or 32->48000)
+ *
+ * @return Delay result (enumeration)
+ */
+RESULT_DELAY    delay_modify_crossfade(DELAY_LPF * c, uint32_t crossfade_len_new) {
+
+    RESULT_DELAY res;
+
+    uint32_t crossfade_len;
+    if (crossfade_len_new == 0) {
+        crossfade_len = 0;
+        res = DELAY_OK;
+    }
+    else if (crossfade_len_new > DELAY_MAX_CROSSFADE_LEN) {
+        crossfade_len = DELAY_MAX_CROSSFADE_LEN;
+        res = DELAY_INVALID_CROSSFADE;
+    }
+    else if (crossfade_len_new < DELAY_MIN_CROSSFADE_LEN) {
+        crossfade_len = DELAY_MIN_CROSSFADE_LEN;
+        res = DELAY_INVALID_CROSSFADE;
+    }
+    else {
+        crossfade_len = crossfade_len_new;
+        res = DELAY_OK;
+    }
+
+    // Calculate / update parameters
+    c->xfade_len = crossfade_len;
+
+    return res;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  * 
@@ -279,8 +533,367 @@ void    delay_read(DELAY_LPF * c,
         for (int i=0;i<audio_block_size;i++) {
             audio_out[i] = audio_in[i];
         }
+        return;
+    }
+
+    // Pick up a length change made while the last crossfade was running.  This
+    // is only done at a block boundary so a block never has two crossfades.
+    if (c->xfade_len && c->xfade_steps == 0 && c->target_read_tap != c->read_tap) {
+        delay_start_crossfade(c);
+    }
+
+    // Delay lines stored in a 16-bit format are processed a block at a time
+    if (c->storage_format != DELAY_STORAGE_FLOAT) {
+        delay_read_packed(c, audio_in, audio_out, audio_block_size);
+        return;
+    }
+
+    int i = 0;
+
+    // Run the second read head while crossfading to a new delay length
+    if (c->xfade_steps) {
+        i = delay_read_crossfade(c, audio_in, audio_out, audio_block_size);
+    }
+
+    // Gliding to a new delay length is handled separately so that the
+    // steady state loops below don't need to branch each sample
+    if (c->read_tap_steps) {
+        delay_read_glide(c, audio_in+i, audio_out+i, audio_block_size-i);
+        return;
+    }
+
+    float   * buffer = c->delay_line;
+    int     len = c->delay_line_size;
+    float   feedback_amt = c->feedback;
+    float   feedthrough_amt = c->feedthrough;
+
+    // Intermediate values
+    float   out,in;
+    float   lpf_hist = c->lpf_hist;
+    float   lpf_a = c->lpf_a;
+
+    // Set initial taps
+    int     write_ptr = c->write_ptr;
+    int     read_tap = write_ptr - c->read_tap;
+    if (read_tap < 0) {
+        read_tap += len;
+    }
+
+    if (lpf_a != 0.0) {
+        // Perform delay with LPF (LBCF)
+        for (;i<audio_block_size;i++)
+        {
+            in = audio_in[i];
+            audio_out[i] = (in*feedthrough_amt) + buffer[read_tap];
+            out = in + buffer[read_tap];
+            buffer[write_ptr] = lpf_hist;
+            lpf_hist += lpf_a * (out * feedback_amt - lpf_hist);
+
+            write_ptr++;
+            if (write_ptr>=len) {
+                write_ptr = 0;
+            }
+            read_tap++;
+            if (read_tap>=len) {
+                read_tap = 0;
+            }
+        }
+        c->lpf_hist = lpf_hist;
+    } else {
+        // Perform standard delay
+        for (;i<audio_block_size;i++)
+        {
+            in = audio_in[i];
+            audio_out[i] = (in*feedthrough_amt) + buffer[read_tap];
+            out = in + buffer[read_tap];
+            buffer[write_ptr] = out * feedback_amt;
+
+            write_ptr++;
+            if (write_ptr>=len) {
+                write_ptr = 0;
+            }
+            read_tap++;
+            if (read_tap>=len) {
+                read_tap = 0;
+            }
+        }
+    }
+
+    // Store index back into instance struct
+    c->write_ptr = write_ptr;
+
+}
+
+/**
+ * @brief Apply a pair of delays (e.g. left and right) to a block of audio data
+ *
+ * When both delays are float delay lines in their steady state (no length
+ * change in progress) both are processed in the same loop so the two
+ * independent channels can be interleaved by the compiler.  Otherwise each
+ * delay is simply processed with delay_read().
+ *
+ * @param c_left Pointer to instance structure of first delay
+ * @param c_right Pointer to instance structure of second delay
+ * @param audio_in_left Pointer to floating point audio input buffer (first delay)
+ * @param audio_in_right Pointer to floating point audio input buffer (second delay)
+ * @param audio_out_left Pointer to floating point audio output buffer (first delay)
+ * @param audio_out_right Pointer to floating point audio output buffer (second delay)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    delay_read_stereo(DELAY_LPF * c_left,
+                          DELAY_LPF * c_right,
+                          float * audio_in_left,
+                          float * audio_in_right,
+                          float * audio_out_left,
+                          float * audio_out_right,
+                          uint32_t audio_block_size) {
+
+    if (c_left == NULL || !c_left->initialized ||
+        c_right == NULL || !c_right->initialized ||
+        c_left->storage_format != DELAY_STORAGE_FLOAT ||
+        c_right->storage_format != DELAY_STORAGE_FLOAT ||
+        c_left->read_tap_steps || c_right->read_tap_steps ||
+        c_left->xfade_steps || c_right->xfade_steps ||
+        (c_left->xfade_len && c_left->target_read_tap != c_left->read_tap) ||
+        (c_right->xfade_len && c_right->target_read_tap != c_right->read_tap) ||
+        (c_left->lpf_a == 0.0) != (c_right->lpf_a == 0.0)) {
+        delay_read(c_left, audio_in_left, audio_out_left, audio_block_size);
+        delay_read(c_right, audio_in_right, audio_out_right, audio_block_size);
+        return;
+    }
+
+    float   * buffer_l = c_left->delay_line;
+    float   * buffer_r = c_right->delay_line;
+    int     len_l = c_left->delay_line_size;
+    int     len_r = c_right->delay_line_size;
+    float   feedback_l = c_left->feedback;
+    float   feedback_r = c_right->feedback;
+    float   feedthrough_l = c_left->feedthrough;
+    float   feedthrough_r = c_right->feedthrough;
+    float   lpf_hist_l = c_left->lpf_hist;
+    float   lpf_hist_r = c_right->lpf_hist;
+    float   lpf_a_l = c_left->lpf_a;
+    float   lpf_a_r = c_right->lpf_a;
+    float   in_l, in_r, delayed_l, delayed_r;
+
+    // Set initial taps
+    int     write_l = c_left->write_ptr;
+    int     write_r = c_right->write_ptr;
+    int     read_l = write_l - c_left->read_tap;
+    if (read_l < 0) {
+        read_l += len_l;
+    }
+    int     read_r = write_r - c_right->read_tap;
+    if (read_r < 0) {
+        read_r += len_r;
+    }
+
+    if (lpf_a_l != 0.0) {
+        // Perform delays with LPF (LBCF)
+        for (int i=0;i<audio_block_size;i++)
+        {
+            in_l = audio_in_left[i];
+            in_r = audio_in_right[i];
+            delayed_l = buffer_l[read_l];
+            delayed_r = buffer_r[read_r];
+
+            audio_out_left[i] = in_l*feedthrough_l + delayed_l;
+            audio_out_right[i] = in_r*feedthrough_r + delayed_r;
+
+            buffer_l[write_l] = lpf_hist_l;
+            buffer_r[write_r] = lpf_hist_r;
+            lpf_hist_l += lpf_a_l * ((in_l + delayed_l) * feedback_l - lpf_hist_l);
+            lpf_hist_r += lpf_a_r * ((in_r + delayed_r) * feedback_r - lpf_hist_r);
+
+            write_l++;
+            if (write_l>=len_l) write_l = 0;
+            write_r++;
+            if (write_r>=len_r) write_r = 0;
+            read_l++;
+            if (read_l>=len_l) read_l = 0;
+            read_r++;
+            if (read_r>=len_r) read_r = 0;
+        }
+        c_left->lpf_hist = lpf_hist_l;
+        c_right->lpf_hist = lpf_hist_r;
+    } else {
+        // Perform standard delays
+        for (int i=0;i<audio_block_size;i++)
+        {
+            in_l = audio_in_left[i];
+            in_r = audio_in_right[i];
+            delayed_l = buffer_l[read_l];
+            delayed_r = buffer_r[read_r];
+
+            audio_out_left[i] = in_l*feedthrough_l + delayed_l;
+            audio_out_right[i] = in_r*feedthrough_r + delayed_r;
+
+            buffer_l[write_l] = (in_l + delayed_l) * feedback_l;
+            buffer_r[write_r] = (in_r + delayed_r) * feedback_r;
+
+            write_l++;
+            if (write_l>=len_l) write_l = 0;
+            write_r++;
+            if (write_r>=len_r) write_r = 0;
+            read_l++;
+            if (read_l>=len_l) read_l = 0;
+            read_r++;
+            if (read_r>=len_r) read_r = 0;
+        }
+    }
+
+    // Store indices back into instance structs
+    c_left->write_ptr = write_l;
+    c_right->write_ptr = write_r;
+}
+
+/**
+ * @brief Starts crossfading from the current read tap to the target read tap
+ *
+ * The gains of the two read heads follow an equal-power (cos/sin) curve which
+ * is generated by rotating a unit vector by a fixed angle each sample.
+ *
+ * @param c Pointer to instance structure
+ */
+static void     delay_start_crossfade(DELAY_LPF * c) {
+
+    float angle = (0.5*PI) / (float) c->xfade_len;
+
+    c->xfade_tap = c->read_tap;
+    c->read_tap = c->target_read_tap;
+    c->read_tap_f = (float) c->read_tap;
+    c->read_tap_steps = 0;
+
+    c->xfade_gain_old = 1.0;
+    c->xfade_gain_new = 0.0;
+    c->xfade_rot_cos = cosf(angle);
+    c->xfade_rot_sin = sinf(angle);
+
+    c->xfade_steps = c->xfade_len;
+}
+
+/**
+ * @brief Process audio while crossfading between the old and new read heads
+ *
+ * Processes samples until the end of the block or the end of the crossfade,
+ * whichever comes first.  If the delay length was changed again during the
+ * crossfade, delay_read() starts the next crossfade at the start of the
+ * following block; the rest of this block is read from the new tap alone.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ * @return The number of samples that were processed
+ */
+#pragma optimize_for_speed
+static uint32_t delay_read_crossfade(DELAY_LPF * c,
+                                     float * audio_in,
+                                     float * audio_out,
+                                     uint32_t audio_block_size) {
+
+    uint32_t num_samples = audio_block_size;
+    if (c->xfade_steps < num_samples) {
+        num_samples = c->xfade_steps;
+    }
+
+    float   * buffer = c->delay_line;
+    int     len = c->delay_line_size;
+    float   feedback_amt = c->feedback;
+    float   feedthrough_amt = c->feedthrough;
+    float   lpf_hist = c->lpf_hist;
+    float   lpf_a = c->lpf_a;
+
+    float   gain_old = c->xfade_gain_old;
+    float   gain_new = c->xfade_gain_new;
+    float   rot_cos = c->xfade_rot_cos;
+    float   rot_sin = c->xfade_rot_sin;
+    float   in, out, delayed, gain;
+
+    int     write_ptr = c->write_ptr;
+    int     read_old = write_ptr - c->xfade_tap;
+    if (read_old < 0) {
+        read_old += len;
+    }
+    int     read_new = write_ptr - c->read_tap;
+    if (read_new < 0) {
+        read_new += len;
+    }
+
+    for (int i=0;i<num_samples;i++) {
+        in = audio_in[i];
+        delayed = buffer[read_old]*gain_old + buffer[read_new]*gain_new;
+        audio_out[i] = (in*feedthrough_amt) + delayed;
+        out = in + delayed;
+        if (lpf_a != 0.0) {
+            buffer[write_ptr] = lpf_hist;
+            lpf_hist += lpf_a * (out * feedback_amt - lpf_hist);
+        } else {
+            buffer[write_ptr] = out * feedback_amt;
+        }
+
+        // Rotate gains along the equal-power curve
+        gain = gain_old*rot_cos - gain_new*rot_sin;
+        gain_new = gain_new*rot_cos + gain_old*rot_sin;
+        gain_old = gain;
+
+        write_ptr++;
+        if (write_ptr>=len) {
+            write_ptr = 0;
+        }
+        read_old++;
+        if (read_old>=len) {
+            read_old = 0;
+        }
+        read_new++;
+        if (read_new>=len) {
+            read_new = 0;
+        }
+    }
+
+    // Store state back into instance struct
+    c->write_ptr = write_ptr;
+    c->lpf_hist = lpf_hist;
+    c->xfade_gain_old = gain_old;
+    c->xfade_gain_new = gain_new;
+    delay_advance_crossfade(c, num_samples);
+
+    return num_samples;
+}
+
+/**
+ * @brief Advances the crossfade
+ *
+ * The read tap isn't changed here, even if the delay length was changed again
+ * while the crossfade was running, as the rest of the block has already been
+ * (or is about to be) read from it.
+ *
+ * @param c Pointer to instance structure
+ * @param num_samples The number of samples that were crossfaded
+ */
+static void     delay_advance_crossfade(DELAY_LPF * c, uint32_t num_samples) {
+
+    c->xfade_steps -= num_samples;
+
+    if (c->xfade_steps == 0) {
+        c->xfade_tap = c->read_tap;
     }
+}
 
+/**
+ * @brief Process audio while gliding the read tap to a new delay length
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     delay_read_glide(DELAY_LPF * c,
+                                 float * audio_in,
+                                 float * audio_out,
+                                 uint32_t audio_block_size) {
 
     int i;
 
@@ -305,9 +918,9 @@ void    delay_read(DELAY_LPF * c,
         // Perform delay with LPF (LBCF)
         for (i=0;i<audio_block_size;i++)
         {
-            
-            audio_out[i] = (audio_in[i]*c->feedthrough) + buffer[read_tap];
-            out = audio_in[i] + buffer[read_tap];
+            in = audio_in[i];
+            audio_out[i] = (in*c->feedthrough) + buffer[read_tap];
+            out = in + buffer[read_tap];
             buffer[write_ptr] = lpf_hist;
             lpf_hist += lpf_a * (out * c->feedback - lpf_hist);
 
@@ -338,9 +951,9 @@ void    delay_read(DELAY_LPF * c,
         // Perform standard delay
         for (i=0;i<audio_block_size;i++)
         {
-
-            audio_out[i] = (audio_in[i]*c->feedthrough) + buffer[read_tap];
-            out = audio_in[i] + buffer[read_tap];
+            in = audio_in[i];
+            audio_out[i] = (in*c->feedthrough) + buffer[read_tap];
+            out = in + buffer[read_tap];
 
             fb = out * c->feedback;
             buffer[write_ptr] = fb;
@@ -375,4 +988,145 @@ void    delay_read(DELAY_LPF * c,
     c->write_ptr = write_ptr;
 
 }
-    
+
+/**
+ * @brief Apply effect/process to a block of audio data using a packed delay line
+ *
+ * The delay length is always at least MAX_AUDIO_BLOCK_SIZE samples, so the
+ * delayed samples for the whole block can be read (and unpacked) before any
+ * new samples are written (and packed) back into the delay line.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void delay_read_packed(DELAY_LPF * c,
+                              float * audio_in,
+                              float * audio_out,
+                              uint32_t audio_block_size) {
+
+    float   delayed[MAX_AUDIO_BLOCK_SIZE];
+    float   write_block[MAX_AUDIO_BLOCK_SIZE];
+
+    int     len = c->delay_line_size;
+    int     write_ptr = c->write_ptr;
+    float   feedback_amt = c->feedback;
+    float   feedthrough_amt = c->feedthrough;
+    float   lpf_hist = c->lpf_hist;
+    float   lpf_a = c->lpf_a;
+    float   in, out;
+
+    if (c->read_tap_steps == 0) {
+        // Steady state: the delayed samples are contiguous
+        int read_tap = write_ptr - c->read_tap;
+        if (read_tap < 0) {
+            read_tap += len;
+        }
+        delay_storage_read(c->delay_line,
+                           c->storage_format,
+                           len,
+                           read_tap,
+                           delayed,
+                           audio_block_size);
+    } else {
+        // Delay length is changing, step the read tap each sample
+        int read_ptr = write_ptr;
+        for (int i=0;i<audio_block_size;i++) {
+            int read_tap = read_ptr - c->read_tap;
+            if (read_tap < 0) {
+                read_tap += len;
+            }
+            delayed[i] = delay_storage_read_sample(c->delay_line,
+                                                   c->storage_format,
+                                                   read_tap);
+
+            read_ptr++;
+            if (read_ptr >= len) {
+                read_ptr = 0;
+            }
+
+            if (c->read_tap_steps) {
+                c->read_tap_steps--;
+                if (c->read_tap_steps == 0) {
+                    c->read_tap = c->target_read_tap;
+                    c->read_tap_f = (float) c->read_tap;
+                }
+                else {
+                    c->read_tap_f += c->read_tap_inc;
+                    c->read_tap = (uint32_t) c->read_tap_f;
+                }
+            }
+        }
+    }
+
+    // While crossfading, both read heads are contiguous
+    if (c->xfade_steps) {
+        float       delayed_old[MAX_AUDIO_BLOCK_SIZE];
+        float       gain_old = c->xfade_gain_old;
+        float       gain_new = c->xfade_gain_new;
+        float       gain;
+        uint32_t    num_samples = audio_block_size;
+        if (c->xfade_steps < num_samples) {
+            num_samples = c->xfade_steps;
+        }
+
+        int read_old = write_ptr - c->xfade_tap;
+        if (read_old < 0) {
+            read_old += len;
+        }
+        delay_storage_read(c->delay_line,
+                           c->storage_format,
+                           len,
+                           read_old,
+                           delayed_old,
+                           num_samples);
+
+        for (int i=0;i<num_samples;i++) {
+            delayed[i] = delayed_old[i]*gain_old + delayed[i]*gain_new;
+            gain = gain_old*c->xfade_rot_cos - gain_new*c->xfade_rot_sin;
+            gain_new = gain_new*c->xfade_rot_cos + gain_old*c->xfade_rot_sin;
+            gain_old = gain;
+        }
+
+        c->xfade_gain_old = gain_old;
+        c->xfade_gain_new = gain_new;
+        delay_advance_crossfade(c, num_samples);
+    }
+
+    if (lpf_a != 0.0) {
+        // Perform delay with LPF (LBCF)
+        for (int i=0;i<audio_block_size;i++) {
+            in = audio_in[i];
+            out = in + delayed[i];
+            audio_out[i] = in*feedthrough_amt + delayed[i];
+            write_block[i] = lpf_hist;
+            lpf_hist += lpf_a * (out * feedback_amt - lpf_hist);
+        }
+        c->lpf_hist = lpf_hist;
+    } else {
+        // Perform standard delay
+        for (int i=0;i<audio_block_size;i++) {
+            in = audio_in[i];
+            out = in + delayed[i];
+            audio_out[i] = in*feedthrough_amt + delayed[i];
+            write_block[i] = out * feedback_amt;
+        }
+    }
+
+    delay_storage_write(c->delay_line,
+                        c->storage_format,
+                        len,
+                        write_ptr,
+                        write_block,
+                        audio_block_size);
+
+    write_ptr += audio_block_size;
+    if (write_ptr >= len) {
+        write_ptr -= len;
+    }
+
+    // Store index back into instance struct
+    c->write_ptr = write_ptr;
+}
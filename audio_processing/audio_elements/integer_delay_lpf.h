@@ -11,6 +11,7 @@
 #include <stdbool.h>
 
 #include "audio_elements_common.h"
+#include "delay_line_storage.h"
 
 // Result enumerations
 typedef enum
@@ -21,7 +22,9 @@ typedef enum
     DELAY_LENGTH_EXCEEDS_BUF_SIZE,
     DELAY_INVALID_FEEDBACK,
     DELAY_INVALID_FEEDTHROUGH,
-    DELAY_INVALID_DAMPENING_COEFF
+    DELAY_INVALID_DAMPENING_COEFF,
+    DELAY_LENGTH_TOO_SHORT,
+    DELAY_INVALID_CROSSFADE
 } RESULT_DELAY;
 
 // C struct with parameters and state information
@@ -29,8 +32,9 @@ typedef struct  {
 
     bool    initialized;
 
-    float    *  delay_line;
+    void     *  delay_line;
     uint32_t    delay_line_size;
+    DELAY_STORAGE_FORMAT storage_format;
     uint32_t    write_ptr;
     int32_t     read_tap;
     float       read_tap_f;
@@ -38,6 +42,15 @@ typedef struct  {
     float       read_tap_inc;
     uint32_t    read_tap_steps;
 
+    // Second read head used to crossfade between delay lengths
+    uint32_t    xfade_len;
+    uint32_t    xfade_steps;
+    int32_t     xfade_tap;
+    float       xfade_gain_old;
+    float       xfade_gain_new;
+    float       xfade_rot_cos;
+    float       xfade_rot_sin;
+
     float       feedback;
     float       feedthrough;
     float       lpf_a;
@@ -57,16 +70,51 @@ RESULT_DELAY    delay_setup(DELAY_LPF * c,
                             float feedthrough,
                             float a_coeff);
 
+RESULT_DELAY    delay_setup_packed(DELAY_LPF * c,
+                                   void * delay_buffer,
+                                   uint32_t delay_buffer_size,
+                                   DELAY_STORAGE_FORMAT storage_format,
+                                   uint32_t delay_initial_length,
+                                   float feedback,
+                                   float feedthrough,
+                                   float a_coeff);
+
+RESULT_DELAY    delay_setup_cleared(DELAY_LPF * c,
+                                    float * delay_buffer,
+                                    uint32_t delay_buffer_size,
+                                    uint32_t delay_initial_length,
+                                    float feedback,
+                                    float feedthrough,
+                                    float a_coeff);
+
+RESULT_DELAY    delay_setup_packed_cleared(DELAY_LPF * c,
+                                           void * delay_buffer,
+                                           uint32_t delay_buffer_size,
+                                           DELAY_STORAGE_FORMAT storage_format,
+                                           uint32_t delay_initial_length,
+                                           float feedback,
+                                           float feedthrough,
+                                           float a_coeff);
+
 RESULT_DELAY    delay_modify_dampening(DELAY_LPF * c, float coeff);
 RESULT_DELAY    delay_modify_length(DELAY_LPF * c, uint32_t new_delay_length);
 RESULT_DELAY    delay_modify_feedback(DELAY_LPF * c, float new_feedback);
 RESULT_DELAY    delay_modify_feedthrough(DELAY_LPF * c, float new_feedthrough);
+RESULT_DELAY    delay_modify_crossfade(DELAY_LPF * c, uint32_t new_crossfade_len);
 
 void    delay_read(DELAY_LPF * c,
                    float * input, 
                    float * output, 
                    uint32_t audio_block_size);
 
+void    delay_read_stereo(DELAY_LPF * c_left,
+                          DELAY_LPF * c_right,
+                          float * audio_in_left,
+                          float * audio_in_right,
+                          float * audio_out_left,
+                          float * audio_out_right,
+                          uint32_t audio_block_size);
+
 #if __cplusplus
 }
 #endif
@@ -13,6 +13,22 @@
 
 #include "integer_delay_multitap.h"
 
+// Static function prototypes
+static RESULT_MT_DELAY  multitap_delay_init(MULTITAP_DELAY * c,
+                                            void * delay_line,
+                                            uint32_t delay_line_size,
+                                            DELAY_STORAGE_FORMAT storage_format,
+                                            uint32_t num_taps,
+                                            uint32_t * tap_offsets,
+                                            float * tap_gains,
+                                            float feedthrough,
+                                            bool clear_delay_line);
+static uint32_t multitap_delay_max_offset(MULTITAP_DELAY * c);
+static void     multitap_delay_read_packed(MULTITAP_DELAY * c,
+                                           float * audio_in,
+                                           float * audio_out,
+                                           uint32_t audio_block_size);
+
 
 /**
  * @brief Initializes instance of a multi-tap delay
@@ -34,6 +50,150 @@ RESULT_MT_DELAY    multitap_delay_setup(MULTITAP_DELAY * c,
                                         float * tap_gains,
                                         float feedthrough) {
 
+    return multitap_delay_setup_packed(c,
+                                       delay_line,
+                                       delay_line_size,
+                                       DELAY_STORAGE_FLOAT,
+                                       num_taps,
+                                       tap_offsets,
+                                       tap_gains,
+                                       feedthrough);
+}
+
+/**
+ * @brief Initializes instance of a multi-tap delay with a delay line stored in
+ * the specified sample format
+ *
+ * Delay lines stored as 16-bit samples (see delay_line_storage.c) use half
+ * the memory of a float delay line.  They are written and read a block at a
+ * time, so tap offsets may not exceed delay_line_size-MAX_AUDIO_BLOCK_SIZE.
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to delay line
+ * @param delay_line_size Length of delay line in samples
+ * @param storage_format Sample format of the delay line
+ * @param num_taps Number of delay line taps
+ * @param tap_offsets A pointer to an array of offsets for each tap
+ * @param tap_gains A pointer to an array of gains for each tap
+ * @param feedthrough The clean mix of audio passed through
+ * @return Multitap delay result (enumeration)
+ */
+RESULT_MT_DELAY    multitap_delay_setup_packed(MULTITAP_DELAY * c,
+                                               void * delay_line,
+                                               uint32_t delay_line_size,
+                                               DELAY_STORAGE_FORMAT storage_format,
+                                               uint32_t num_taps,
+                                               uint32_t * tap_offsets,
+                                               float * tap_gains,
+                                               float feedthrough) {
+
+    return multitap_delay_init(c,
+                               delay_line,
+                               delay_line_size,
+                               storage_format,
+                               num_taps,
+                               tap_offsets,
+                               tap_gains,
+                               feedthrough,
+                               true);
+}
+
+/**
+ * @brief Initializes instance of a multi-tap delay with a delay line that has
+ * already been cleared
+ *
+ * This is the same as multitap_delay_setup() except that the delay line isn't
+ * zeroed.  The caller is responsible for zeroing it first (see
+ * effect_presets.c).
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to delay line (already zeroed)
+ * @param delay_line_size Length of delay line in samples / floating point words
+ * @param num_taps Number of delay line taps
+ * @param tap_offsets A pointer to an array of offsets for each tap
+ * @param tap_gains A pointer to an array of gains for each tap
+ * @param feedthrough The clean mix of audio passed through
+ * @return Multitap delay result (enumeration)
+ */
+RESULT_MT_DELAY    multitap_delay_setup_cleared(MULTITAP_DELAY * c,
+                                                float * delay_line,
+                                                uint32_t delay_line_size,
+                                                uint32_t num_taps,
+                                                uint32_t * tap_offsets,
+                                                float * tap_gains,
+                                                float feedthrough) {
+
+    return multitap_delay_init(c,
+                               delay_line,
+                               delay_line_size,
+                               DELAY_STORAGE_FLOAT,
+                               num_taps,
+                               tap_offsets,
+                               tap_gains,
+                               feedthrough,
+                               false);
+}
+
+/**
+ * @brief Initializes instance of a multi-tap delay with a packed delay line
+ * that has already been cleared
+ *
+ * This is the same as multitap_delay_setup_packed() except that the delay line
+ * isn't zeroed (see multitap_delay_setup_cleared()).
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to delay line (already zeroed)
+ * @param delay_line_size Length of delay line in samples
+ * @param storage_format Sample format of the delay line
+ * @param num_taps Number of delay line taps
+ * @param tap_offsets A pointer to an array of offsets for each tap
+ * @param tap_gains A pointer to an array of gains for each tap
+ * @param feedthrough The clean mix of audio passed through
+ * @return Multitap delay result (enumeration)
+ */
+RESULT_MT_DELAY    multitap_delay_setup_packed_cleared(MULTITAP_DELAY * c,
+                                                       void * delay_line,
+                                                       uint32_t delay_line_size,
+                                                       DELAY_STORAGE_FORMAT storage_format,
+                                                       uint32_t num_taps,
+                                                       uint32_t * tap_offsets,
+                                                       float * tap_gains,
+                                                       float feedthrough) {
+
+    return multitap_delay_init(c,
+                               delay_line,
+                               delay_line_size,
+                               storage_format,
+                               num_taps,
+                               tap_offsets,
+                               tap_gains,
+                               feedthrough,
+                               false);
+}
+
+/**
+ * @brief Initializes the instance for the setup functions
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to delay line
+ * @param delay_line_size Length of delay line in samples
+ * @param storage_format Sample format of the delay line
+ * @param num_taps Number of delay line taps
+ * @param tap_offsets A pointer to an array of offsets for each tap
+ * @param tap_gains A pointer to an array of gains for each tap
+ * @param feedthrough The clean mix of audio passed through
+ * @param clear_delay_line Zero the delay line (false if already zeroed)
+ * @return Multitap delay result (enumeration)
+ */
+static RESULT_MT_DELAY  multitap_delay_init(MULTITAP_DELAY * c,
+                                            void * delay_line,
+                                            uint32_t delay_line_size,
+                                            DELAY_STORAGE_FORMAT storage_format,
+                                            uint32_t num_taps,
+                                            uint32_t * tap_offsets,
+                                            float * tap_gains,
+                                            float feedthrough,
+                                            bool clear_delay_line) {
 
     if (c == NULL) {
         return MT_DELAY_INVALID_INSTANCE_POINTER;
@@ -57,11 +217,12 @@ RESULT_MT_DELAY    multitap_delay_setup(MULTITAP_DELAY * c,
     // Set delay parameters
     c->delay_line = delay_line;
     c->delay_line_size = delay_line_size;
+    c->storage_format = storage_format;
     c->feedthrough = feedthrough;
 
     c->num_taps = num_taps;
     for (int tap=0;tap<c->num_taps;tap++) {
-        if (tap_offsets[tap] > delay_line_size) {
+        if (tap_offsets[tap] > multitap_delay_max_offset(c)) {
             return MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN;
         }
         c->tap_offsets[tap] = tap_offsets[tap];
@@ -69,11 +230,9 @@ RESULT_MT_DELAY    multitap_delay_setup(MULTITAP_DELAY * c,
     }
 
     // Zero delay line
-    int i;
-    float * ptr;
-    ptr = c->delay_line;
-    for (i=0;i<delay_line_size;i++)
-        delay_line[i] = 0.0;
+    if (clear_delay_line) {
+        delay_storage_clear(delay_line, storage_format, delay_line_size);
+    }
     c->index = 0;
 
     c->initialized = true;
@@ -94,7 +253,7 @@ RESULT_MT_DELAY multitap_delay_modify_taps( MULTITAP_DELAY * c,
 
     // Copy new taps into instance struct
     for (int tap=0;tap<c->num_taps;tap++) {
-        if (new_tap_offsets[tap] > c->delay_line_size) {
+        if (new_tap_offsets[tap] > multitap_delay_max_offset(c)) {
             return MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN;
         }
         c->tap_offsets[tap] = new_tap_offsets[tap];
@@ -126,6 +285,12 @@ void    multitap_delay_read(MULTITAP_DELAY * c,
         return;
     }
 
+    // Delay lines stored in a 16-bit format are processed a block at a time
+    if (c->storage_format != DELAY_STORAGE_FLOAT) {
+        multitap_delay_read_packed(c, audio_in, audio_out, audio_block_size);
+        return;
+    }
+
     float   * delay_buffer = c->delay_line;
     uint32_t    indx = c->index;
 
@@ -152,3 +317,78 @@ void    multitap_delay_read(MULTITAP_DELAY * c,
    c->index = indx;
 }
 
+/**
+ * @brief Apply effect/process to a block of audio data using a packed delay line
+ *
+ * The input block is packed into the delay line first and each tap then
+ * unpacks a contiguous block of samples.  Tap offsets are limited (see
+ * multitap_delay_max_offset) so the oldest samples a tap needs are never
+ * overwritten by the block that was just written.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void     multitap_delay_read_packed(MULTITAP_DELAY * c,
+                                           float * audio_in,
+                                           float * audio_out,
+                                           uint32_t audio_block_size) {
+
+    float       tap_block[MAX_AUDIO_BLOCK_SIZE];
+    int32_t     len = c->delay_line_size;
+    uint32_t    indx = c->index;
+
+    delay_storage_write(c->delay_line,
+                        c->storage_format,
+                        len,
+                        indx,
+                        audio_in,
+                        audio_block_size);
+
+    for (int i=0;i<audio_block_size;i++) {
+        audio_out[i] = audio_in[i] * c->feedthrough;
+    }
+
+    for (int tap=0;tap<c->num_taps;tap++) {
+        int32_t tap_pos = (int32_t) indx - (int32_t) c->tap_offsets[tap];
+        if (tap_pos < 0) {
+            tap_pos += len;
+        }
+        delay_storage_read(c->delay_line,
+                           c->storage_format,
+                           len,
+                           tap_pos,
+                           tap_block,
+                           audio_block_size);
+
+        float gain = c->tap_gains[tap];
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] += tap_block[i]*gain;
+        }
+    }
+
+    indx += audio_block_size;
+    if (indx >= len) {
+        indx -= len;
+    }
+
+    // Store index back into instance struct
+    c->index = indx;
+}
+
+/**
+ * @brief Returns the longest tap offset supported by the delay line
+ *
+ * @param c Pointer to instance structure
+ * @return Maximum tap offset in samples
+ */
+static uint32_t multitap_delay_max_offset(MULTITAP_DELAY * c) {
+
+    if (c->storage_format == DELAY_STORAGE_FLOAT ||
+        c->delay_line_size < MAX_AUDIO_BLOCK_SIZE) {
+        return c->delay_line_size;
+    }
+    return c->delay_line_size - MAX_AUDIO_BLOCK_SIZE;
+}
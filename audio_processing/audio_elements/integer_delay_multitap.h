@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "audio_elements_common.h"
+#include "delay_line_storage.h"
 
 #define     MULTITAP_DELAY_MAX_TAPS (32)
 
@@ -28,7 +29,8 @@ typedef enum
 typedef struct  {
     bool        initialized;
 
-    float    *  delay_line;
+    void     *  delay_line;
+    DELAY_STORAGE_FORMAT storage_format;
     uint32_t    tap_offsets[MULTITAP_DELAY_MAX_TAPS];
     float       tap_gains[MULTITAP_DELAY_MAX_TAPS];
     uint32_t    delay_line_size;
@@ -50,6 +52,32 @@ RESULT_MT_DELAY    multitap_delay_setup(MULTITAP_DELAY * c,
                                         float * tap_gains,
                                         float feedthrough);
 
+RESULT_MT_DELAY    multitap_delay_setup_packed(MULTITAP_DELAY * c,
+                                               void * delay_line,
+                                               uint32_t delay_line_size,
+                                               DELAY_STORAGE_FORMAT storage_format,
+                                               uint32_t num_taps,
+                                               uint32_t * tap_offsets,
+                                               float * tap_gains,
+                                               float feedthrough);
+
+RESULT_MT_DELAY    multitap_delay_setup_cleared(MULTITAP_DELAY * c,
+                                                float * delay_line,
+                                                uint32_t delay_line_size,
+                                                uint32_t num_taps,
+                                                uint32_t * tap_offsets,
+                                                float * tap_gains,
+                                                float feedthrough);
+
+RESULT_MT_DELAY    multitap_delay_setup_packed_cleared(MULTITAP_DELAY * c,
+                                                       void * delay_line,
+                                                       uint32_t delay_line_size,
+                                                       DELAY_STORAGE_FORMAT storage_format,
+                                                       uint32_t num_taps,
+                                                       uint32_t * tap_offsets,
+                                                       float * tap_gains,
+                                                       float feedthrough);
+
 RESULT_MT_DELAY multitap_delay_modify_taps(MULTITAP_DELAY * c, uint32_t * new_tap_offsets);
 
 void    multitap_delay_read(MULTITAP_DELAY * c,
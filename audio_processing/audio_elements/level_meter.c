@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A multichannel peak / RMS level meter for signal presence and clip
+ * indicators.
+ *
+ * level_meter_read() is called from the audio callback with a planar buffer
+ * (channel n occupies buffer[n*audio_block_size ... (n+1)*audio_block_size-1]),
+ * which is how the audio frameworks store their channels.  It makes a single
+ * pass over the buffer, keeping the largest magnitude and the sum of squares
+ * of each channel.  Each inner loop is a plain reduction over one channel so
+ * the compiler can vectorize it, and the cost is a couple of cycles per sample
+ * per channel.  At the end of each metering period the results are handed to
+ * the background loop through a small ring.
+ *
+ * level_meter_process() is called from the background loop and applies the
+ * meter ballistics:
+ *
+ *  - Peak hold: the largest peak is held for hold_ms and then decays at
+ *    decay_db_per_sec.
+ *  - RMS: the mean square is smoothed with a time constant of rms_time_ms.
+ *  - Clip: a channel is flagged as clipped for one second after any sample
+ *    reaches full scale.
+ *
+ * The metering period also sets how often the results change, so it can be
+ * used to rate limit anything driven by the meter (e.g. LEDs).
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "level_meter.h"
+
+// Min/max limits and other constants
+#define LEVEL_METER_PERIOD_MS_MIN       (1.0)
+#define LEVEL_METER_PERIOD_MS_MAX       (1000.0)
+#define LEVEL_METER_HOLD_MS_MIN         (0.0)
+#define LEVEL_METER_HOLD_MS_MAX         (10000.0)
+#define LEVEL_METER_DECAY_MIN           (1.0)
+#define LEVEL_METER_DECAY_MAX           (1000.0)
+#define LEVEL_METER_RMS_TIME_MS_MIN     (10.0)
+#define LEVEL_METER_RMS_TIME_MS_MAX     (10000.0)
+#define LEVEL_METER_RING_MASK           (LEVEL_METER_RING_SIZE-1)
+
+#define LEVEL_METER_CLIP_LEVEL          (0.999)     // About -0.01 dBFS
+#define LEVEL_METER_CLIP_HOLD_MS        (1000.0)
+
+// Static function prototypes
+static float    level_meter_db(float x, float scale);
+
+
+/**
+ * @brief Initializes instance of a level meter
+ *
+ * @param c Pointer to instance structure
+ * @param num_channels Number of channels in the planar input (1->16)
+ * @param period_ms Metering period in ms (1.0->1000.0)
+ * @param hold_ms Peak hold time in ms (0.0->10000.0)
+ * @param decay_db_per_sec Peak decay rate after the hold (1.0->1000.0)
+ * @param rms_time_ms RMS time constant in ms (10.0->10000.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Level meter result (enumeration)
+ */
+RESULT_LEVEL_METER  level_meter_setup(LEVEL_METER * c,
+                                      uint32_t num_channels,
+                                      float period_ms,
+                                      float hold_ms,
+                                      float decay_db_per_sec,
+                                      float rms_time_ms,
+                                      float audio_sample_rate) {
+
+    if (c == NULL) {
+        return LEVEL_METER_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (num_channels < 1 || num_channels > LEVEL_METER_MAX_CHANNELS) {
+        return LEVEL_METER_INVALID_NUM_CHANNELS;
+    }
+    if (period_ms < LEVEL_METER_PERIOD_MS_MIN || period_ms > LEVEL_METER_PERIOD_MS_MAX) {
+        return LEVEL_METER_INVALID_PERIOD;
+    }
+    if (hold_ms < LEVEL_METER_HOLD_MS_MIN || hold_ms > LEVEL_METER_HOLD_MS_MAX) {
+        return LEVEL_METER_INVALID_HOLD;
+    }
+    if (decay_db_per_sec < LEVEL_METER_DECAY_MIN || decay_db_per_sec > LEVEL_METER_DECAY_MAX) {
+        return LEVEL_METER_INVALID_DECAY;
+    }
+    if (rms_time_ms < LEVEL_METER_RMS_TIME_MS_MIN || rms_time_ms > LEVEL_METER_RMS_TIME_MS_MAX) {
+        return LEVEL_METER_INVALID_RMS_TIME;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+    c->num_channels = num_channels;
+    c->period_samples = (uint32_t)(period_ms*0.001*audio_sample_rate);
+    if (c->period_samples < 1) {
+        c->period_samples = 1;
+    }
+
+    // Ballistics are applied once per period
+    c->hold_periods = (uint32_t)(hold_ms/period_ms);
+    c->clip_hold_periods = (uint32_t)(LEVEL_METER_CLIP_HOLD_MS/period_ms);
+    c->decay = powf(10.0, -decay_db_per_sec*period_ms*0.001/20.0);
+    c->rms_coeff = 1.0 - expf(-period_ms/rms_time_ms);
+
+    for (int ch=0;ch<LEVEL_METER_MAX_CHANNELS;ch++) {
+        c->acc_peak[ch] = 0.0;
+        c->acc_sum[ch] = 0.0;
+
+        c->hold[ch] = 0.0;
+        c->hold_count[ch] = 0;
+        c->clip_count[ch] = 0;
+        c->rms_ms[ch] = 0.0;
+
+        c->peak_db[ch] = LEVEL_METER_SILENCE_DB;
+        c->peak_hold_db[ch] = LEVEL_METER_SILENCE_DB;
+        c->rms_db[ch] = LEVEL_METER_SILENCE_DB;
+        c->clipped[ch] = false;
+    }
+    c->acc_count = 0;
+
+    c->periods_written = 0;
+    c->periods_read = 0;
+    c->periods_dropped = 0;
+
+    c->initialized = true;
+    return LEVEL_METER_OK;
+}
+
+/**
+ * @brief Measures a block of planar audio
+ *
+ * Called from the audio callback.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to planar input buffer (num_channels channels)
+ * @param audio_block_size The number of floating-point words per channel
+ */
+#pragma optimize_for_speed
+void    level_meter_read(LEVEL_METER * c,
+                         float * audio_in,
+                         uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t num_channels = c->num_channels;
+
+    for (int ch=0;ch<num_channels;ch++) {
+        float * in = &audio_in[ch*audio_block_size];
+        float peak = c->acc_peak[ch];
+        float sum = 0.0;
+
+        for (int i=0;i<audio_block_size;i++) {
+            float x = in[i];
+            float mag = fabsf(x);
+            peak = (mag > peak) ? mag : peak;
+            sum += x*x;
+        }
+
+        c->acc_peak[ch] = peak;
+        c->acc_sum[ch] += sum;
+    }
+    c->acc_count += audio_block_size;
+
+    // Hand the finished period to the background loop
+    if (c->acc_count >= c->period_samples) {
+        uint32_t written = c->periods_written;
+        uint32_t slot = written & LEVEL_METER_RING_MASK;
+        float scale = 1.0/c->acc_count;
+
+        for (int ch=0;ch<num_channels;ch++) {
+            c->period_peak[slot][ch] = c->acc_peak[ch];
+            c->period_ms[slot][ch] = c->acc_sum[ch]*scale;
+            c->acc_peak[ch] = 0.0;
+            c->acc_sum[ch] = 0.0;
+        }
+        c->acc_count = 0;
+        c->periods_written = written + 1;
+    }
+}
+
+/**
+ * @brief Applies the meter ballistics to any finished periods
+ *
+ * Call this from the background loop.
+ *
+ * @param c Pointer to instance structure
+ * @return true if the results were updated
+ */
+bool    level_meter_process(LEVEL_METER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    uint32_t written = c->periods_written;
+    if (written == c->periods_read) {
+        return false;
+    }
+
+    // Skip periods that have already been overwritten
+    if (written - c->periods_read > LEVEL_METER_RING_SIZE) {
+        c->periods_dropped += written - c->periods_read - LEVEL_METER_RING_SIZE;
+        c->periods_read = written - LEVEL_METER_RING_SIZE;
+    }
+
+    while (c->periods_read != written) {
+        uint32_t slot = c->periods_read & LEVEL_METER_RING_MASK;
+
+        for (int ch=0;ch<c->num_channels;ch++) {
+            float peak = c->period_peak[slot][ch];
+
+            // Peak hold, then decay
+            if (peak >= c->hold[ch]) {
+                c->hold[ch] = peak;
+                c->hold_count[ch] = c->hold_periods;
+            }
+            else if (c->hold_count[ch] > 0) {
+                c->hold_count[ch]--;
+            }
+            else {
+                c->hold[ch] *= c->decay;
+                if (c->hold[ch] < peak) {
+                    c->hold[ch] = peak;
+                }
+            }
+
+            if (peak >= LEVEL_METER_CLIP_LEVEL) {
+                c->clip_count[ch] = c->clip_hold_periods + 1;
+            }
+            else if (c->clip_count[ch] > 0) {
+                c->clip_count[ch]--;
+            }
+
+            c->rms_ms[ch] += c->rms_coeff*(c->period_ms[slot][ch] - c->rms_ms[ch]);
+
+            c->peak_db[ch] = level_meter_db(peak, 20.0);
+        }
+
+        c->periods_read++;
+    }
+
+    for (int ch=0;ch<c->num_channels;ch++) {
+        c->peak_hold_db[ch] = level_meter_db(c->hold[ch], 20.0);
+        c->rms_db[ch] = level_meter_db(c->rms_ms[ch], 10.0);
+        c->clipped[ch] = (c->clip_count[ch] > 0);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns the highest peak hold level of a group of channels
+ *
+ * @param c Pointer to instance structure
+ * @param first_channel First channel of the group
+ * @param num_channels Number of channels in the group
+ * @return Highest peak hold level in dBFS
+ */
+float   level_meter_max_peak_hold_db(LEVEL_METER * c,
+                                     uint32_t first_channel,
+                                     uint32_t num_channels) {
+
+    float level = LEVEL_METER_SILENCE_DB;
+    for (int ch=first_channel;ch<first_channel+num_channels && ch<c->num_channels;ch++) {
+        if (c->peak_hold_db[ch] > level) {
+            level = c->peak_hold_db[ch];
+        }
+    }
+    return level;
+}
+
+/**
+ * @brief Checks whether any channel of a group has clipped recently
+ *
+ * @param c Pointer to instance structure
+ * @param first_channel First channel of the group
+ * @param num_channels Number of channels in the group
+ * @return true if any channel in the group is flagged as clipped
+ */
+bool    level_meter_any_clipped(LEVEL_METER * c,
+                                uint32_t first_channel,
+                                uint32_t num_channels) {
+
+    for (int ch=first_channel;ch<first_channel+num_channels && ch<c->num_channels;ch++) {
+        if (c->clipped[ch]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Converts a level to dB
+ *
+ * @param x Linear level (magnitude or mean square)
+ * @param scale 20.0 for magnitudes, 10.0 for mean squares
+ * @return Level in dB (LEVEL_METER_SILENCE_DB for silence)
+ */
+static float    level_meter_db(float x, float scale) {
+
+    if (x <= 0.0) {
+        return LEVEL_METER_SILENCE_DB;
+    }
+    float db = scale*log10f(x);
+    return (db < LEVEL_METER_SILENCE_DB) ? LEVEL_METER_SILENCE_DB : db;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _LEVEL_METER_H
+#define _LEVEL_METER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define LEVEL_METER_MAX_CHANNELS    (16)
+#define LEVEL_METER_RING_SIZE       (4)         // Periods waiting for the background (power of 2)
+
+// Reported for digital silence
+#define LEVEL_METER_SILENCE_DB      (-100.0)
+
+// Result enumerations
+typedef enum
+{
+    LEVEL_METER_OK,
+    LEVEL_METER_INVALID_INSTANCE_POINTER,
+    LEVEL_METER_INVALID_NUM_CHANNELS,
+    LEVEL_METER_INVALID_PERIOD,
+    LEVEL_METER_INVALID_HOLD,
+    LEVEL_METER_INVALID_DECAY,
+    LEVEL_METER_INVALID_RMS_TIME
+} RESULT_LEVEL_METER;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    uint32_t    num_channels;
+    uint32_t    period_samples;         // Samples per metering period
+
+    // Accumulated by the audio callback
+    float       acc_peak[LEVEL_METER_MAX_CHANNELS];
+    float       acc_sum[LEVEL_METER_MAX_CHANNELS];
+    uint32_t    acc_count;
+
+    // Finished periods handed to the background loop
+    float       period_peak[LEVEL_METER_RING_SIZE][LEVEL_METER_MAX_CHANNELS];
+    float       period_ms[LEVEL_METER_RING_SIZE][LEVEL_METER_MAX_CHANNELS];
+    volatile uint32_t   periods_written;
+    uint32_t    periods_read;
+    uint32_t    periods_dropped;
+
+    // Ballistics (background loop)
+    uint32_t    hold_periods;
+    uint32_t    clip_hold_periods;
+    float       decay;                  // Peak hold multiplier per period once the hold expires
+    float       rms_coeff;
+
+    float       hold[LEVEL_METER_MAX_CHANNELS];
+    uint32_t    hold_count[LEVEL_METER_MAX_CHANNELS];
+    uint32_t    clip_count[LEVEL_METER_MAX_CHANNELS];
+    float       rms_ms[LEVEL_METER_MAX_CHANNELS];
+
+    // Results
+    float   peak_db[LEVEL_METER_MAX_CHANNELS];
+    float   peak_hold_db[LEVEL_METER_MAX_CHANNELS];
+    float   rms_db[LEVEL_METER_MAX_CHANNELS];
+    bool    clipped[LEVEL_METER_MAX_CHANNELS];
+
+    float   audio_sample_rate;
+
+} LEVEL_METER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_LEVEL_METER  level_meter_setup(LEVEL_METER * c,
+                                      uint32_t num_channels,
+                                      float period_ms,
+                                      float hold_ms,
+                                      float decay_db_per_sec,
+                                      float rms_time_ms,
+                                      float audio_sample_rate);
+
+void    level_meter_read(LEVEL_METER * c,
+                         float * audio_in,
+                         uint32_t audio_block_size);
+
+bool    level_meter_process(LEVEL_METER * c);
+
+float   level_meter_max_peak_hold_db(LEVEL_METER * c,
+                                     uint32_t first_channel,
+                                     uint32_t num_channels);
+
+bool    level_meter_any_clipped(LEVEL_METER * c,
+                                uint32_t first_channel,
+                                uint32_t num_channels);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _LEVEL_METER_H
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * An LFO bank holds a set of low frequency oscillators that can be shared
+ * by several effects.  Rather than each effect keeping its own phase and
+ * evaluating an oscillator for every sample, the bank is advanced once per
+ * audio block (lfo_bank_advance).  Each LFO's waveform is evaluated once at
+ * the end of the block and a control buffer is filled by ramping linearly
+ * from the previous value, which is plenty of resolution for LFO rates.
+ * The one exception is the jumps in the square and ramp waveforms: these are
+ * ramped across the block they fall in too, so the square is really a
+ * trapezoid with edges one block long (0.67ms for 32 samples at 48kHz) and
+ * the ramp's reset takes a block.  For modulating gain or delay this is a
+ * useful de-click rather than a loss.
+ *
+ * Effects subscribe to an LFO by index, either reading the block-rate value
+ * (lfo_bank_value) or the per-sample control buffer (lfo_bank_buffer), which
+ * can be passed to elements that accept an external modulator such as
+ * VARIABLE_DELAY (VARIABLE_DELAY_EXT_LFO) or AMPLITUDE_MODULATION
+ * (AMP_MOD_EXT_LFO).
+ *
+ * LFOs can either run at a fixed rate in Hz or be synced to the bank's tempo
+ * (in beats per cycle).  An LFO can also be linked to another LFO so it
+ * shares the other LFO's phase plus a fixed offset, e.g. the left and right
+ * LFOs of a stereo effect 180 degrees apart.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "lfo_bank.h"
+#include "oscillators.h"
+
+// Min/max limits and other constants
+#define LFO_BANK_RATE_HZ_MIN    (0.0)
+#define LFO_BANK_RATE_HZ_MAX    (20.0)
+#define LFO_BANK_BEATS_MIN      (0.0625)
+#define LFO_BANK_BEATS_MAX      (64.0)
+#define LFO_BANK_TEMPO_MIN      (20.0)
+#define LFO_BANK_TEMPO_MAX      (300.0)
+
+// Static function prototypes
+static void     lfo_bank_update_inc(LFO_BANK * c, LFO_BANK_LFO * lfo);
+static float    lfo_bank_evaluate(LFO_BANK_WAVEFORM waveform, float t);
+
+
+/**
+ * @brief Initializes instance of an LFO bank
+ *
+ * All LFOs are disabled until they are configured.
+ *
+ * @param c Pointer to instance structure
+ * @param tempo_bpm Tempo used by tempo synced LFOs (20.0->300.0 BPM)
+ * @param audio_sample_rate The system audio sample rate
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_setup(LFO_BANK * c,
+                               float tempo_bpm,
+                               float audio_sample_rate) {
+
+    if (c == NULL) {
+        return LFO_BANK_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (tempo_bpm < LFO_BANK_TEMPO_MIN ||
+        tempo_bpm > LFO_BANK_TEMPO_MAX) {
+        return LFO_BANK_INVALID_TEMPO;
+    }
+
+    c->tempo_bpm = tempo_bpm;
+    c->audio_sample_rate = audio_sample_rate;
+
+    for (int i=0;i<LFO_BANK_MAX_LFOS;i++) {
+        LFO_BANK_LFO * lfo = &c->lfos[i];
+        lfo->enabled = false;
+        lfo->master = -1;
+        lfo->value = 0.0;
+        for (int j=0;j<MAX_AUDIO_BLOCK_SIZE;j++) {
+            lfo->buffer[j] = 0.0;
+        }
+    }
+
+    c->initialized = true;
+    return LFO_BANK_OK;
+}
+
+/**
+ * @brief Configures a free running LFO
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO to configure
+ * @param waveform Waveform of the LFO (see enumeration)
+ * @param rate_hz Rate of the LFO in Hz (0.0->20.0)
+ * @param phase Initial phase of the LFO (in cycles)
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_configure(LFO_BANK * c,
+                                   uint32_t lfo,
+                                   LFO_BANK_WAVEFORM waveform,
+                                   float rate_hz,
+                                   float phase) {
+
+    if (lfo >= LFO_BANK_MAX_LFOS) {
+        return LFO_BANK_INVALID_INDEX;
+    }
+
+    if (rate_hz < LFO_BANK_RATE_HZ_MIN ||
+        rate_hz > LFO_BANK_RATE_HZ_MAX) {
+        return LFO_BANK_INVALID_RATE;
+    }
+
+    LFO_BANK_LFO * l = &c->lfos[lfo];
+    l->waveform = waveform;
+    l->master = -1;
+    l->phase_offset = 0.0;
+    l->tempo_synced = false;
+    l->rate_hz = rate_hz;
+    l->t = phase - floor(phase);
+    lfo_bank_update_inc(c, l);
+    l->value = lfo_bank_evaluate(waveform, l->t);
+    l->enabled = true;
+
+    return LFO_BANK_OK;
+}
+
+/**
+ * @brief Configures an LFO that is synced to the bank's tempo
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO to configure
+ * @param waveform Waveform of the LFO (see enumeration)
+ * @param beats_per_cycle Length of one LFO cycle in beats (0.0625->64.0)
+ * @param phase Initial phase of the LFO (in cycles)
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_configure_synced(LFO_BANK * c,
+                                          uint32_t lfo,
+                                          LFO_BANK_WAVEFORM waveform,
+                                          float beats_per_cycle,
+                                          float phase) {
+
+    if (lfo >= LFO_BANK_MAX_LFOS) {
+        return LFO_BANK_INVALID_INDEX;
+    }
+
+    if (beats_per_cycle < LFO_BANK_BEATS_MIN ||
+        beats_per_cycle > LFO_BANK_BEATS_MAX) {
+        return LFO_BANK_INVALID_BEATS;
+    }
+
+    LFO_BANK_LFO * l = &c->lfos[lfo];
+    l->waveform = waveform;
+    l->master = -1;
+    l->phase_offset = 0.0;
+    l->tempo_synced = true;
+    l->beats_per_cycle = beats_per_cycle;
+    l->t = phase - floor(phase);
+    lfo_bank_update_inc(c, l);
+    l->value = lfo_bank_evaluate(waveform, l->t);
+    l->enabled = true;
+
+    return LFO_BANK_OK;
+}
+
+/**
+ * @brief Links an LFO to another (master) LFO
+ *
+ * The linked LFO uses the master's phase plus a fixed phase offset, so the
+ * two LFOs always stay in the same phase relationship.  The master must be
+ * a free running or tempo synced LFO (not itself linked).
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO to link
+ * @param waveform Waveform of the linked LFO (see enumeration)
+ * @param master_lfo Index of the master LFO
+ * @param phase_offset Phase offset relative to the master (in cycles)
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_link(LFO_BANK * c,
+                              uint32_t lfo,
+                              LFO_BANK_WAVEFORM waveform,
+                              uint32_t master_lfo,
+                              float phase_offset) {
+
+    if (lfo >= LFO_BANK_MAX_LFOS) {
+        return LFO_BANK_INVALID_INDEX;
+    }
+
+    if (master_lfo >= LFO_BANK_MAX_LFOS ||
+        master_lfo == lfo ||
+        c->lfos[master_lfo].master >= 0) {
+        return LFO_BANK_INVALID_MASTER;
+    }
+
+    LFO_BANK_LFO * l = &c->lfos[lfo];
+    l->waveform = waveform;
+    l->master = master_lfo;
+    l->phase_offset = phase_offset - floor(phase_offset);
+    l->value = lfo_bank_evaluate(waveform, c->lfos[master_lfo].t + l->phase_offset);
+    l->enabled = true;
+
+    return LFO_BANK_OK;
+}
+
+/**
+ * @brief Modify the rate of a free running LFO
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO to modify
+ * @param new_rate_hz Updated rate in Hz (0.0->20.0)
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_modify_rate(LFO_BANK * c,
+                                     uint32_t lfo,
+                                     float rate_hz_new) {
+
+    if (lfo >= LFO_BANK_MAX_LFOS) {
+        return LFO_BANK_INVALID_INDEX;
+    }
+
+    RESULT_LFO_BANK res;
+
+    float rate_hz;
+    if (rate_hz_new > LFO_BANK_RATE_HZ_MAX) {
+        rate_hz = LFO_BANK_RATE_HZ_MAX;
+        res = LFO_BANK_INVALID_RATE;
+    }
+    else if (rate_hz_new < LFO_BANK_RATE_HZ_MIN) {
+        rate_hz = LFO_BANK_RATE_HZ_MIN;
+        res = LFO_BANK_INVALID_RATE;
+    }
+    else {
+        rate_hz = rate_hz_new;
+        res = LFO_BANK_OK;
+    }
+
+    LFO_BANK_LFO * l = &c->lfos[lfo];
+    l->tempo_synced = false;
+    l->rate_hz = rate_hz;
+    lfo_bank_update_inc(c, l);
+
+    return res;
+}
+
+/**
+ * @brief Modify the tempo used by tempo synced LFOs
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_tempo_bpm Updated tempo in BPM (20.0->300.0)
+ * @return LFO bank result (enumeration)
+ */
+RESULT_LFO_BANK lfo_bank_modify_tempo(LFO_BANK * c,
+                                      float tempo_bpm_new) {
+
+    RESULT_LFO_BANK res;
+
+    float tempo_bpm;
+    if (tempo_bpm_new > LFO_BANK_TEMPO_MAX) {
+        tempo_bpm = LFO_BANK_TEMPO_MAX;
+        res = LFO_BANK_INVALID_TEMPO;
+    }
+    else if (tempo_bpm_new < LFO_BANK_TEMPO_MIN) {
+        tempo_bpm = LFO_BANK_TEMPO_MIN;
+        res = LFO_BANK_INVALID_TEMPO;
+    }
+    else {
+        tempo_bpm = tempo_bpm_new;
+        res = LFO_BANK_OK;
+    }
+
+    c->tempo_bpm = tempo_bpm;
+    for (int i=0;i<LFO_BANK_MAX_LFOS;i++) {
+        if (c->lfos[i].tempo_synced) {
+            lfo_bank_update_inc(c, &c->lfos[i]);
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @brief Advances all LFOs by one block and generates their control buffers
+ *
+ * This should be called once per audio block before any of the subscribed
+ * effects are processed.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_block_size The number of samples in the audio block
+ */
+#pragma optimize_for_speed
+void    lfo_bank_advance(LFO_BANK * c,
+                         uint32_t audio_block_size) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    // Advance the phase of the free running / synced LFOs first
+    for (int i=0;i<LFO_BANK_MAX_LFOS;i++) {
+        LFO_BANK_LFO * lfo = &c->lfos[i];
+        if (lfo->enabled && lfo->master < 0) {
+            float t = lfo->t + lfo->inc*(float) audio_block_size;
+            lfo->t = t - floor(t);
+        }
+    }
+
+    // Evaluate each waveform once and ramp the control buffer towards it
+    float inv_block_size = 1.0/(float) audio_block_size;
+    for (int i=0;i<LFO_BANK_MAX_LFOS;i++) {
+        LFO_BANK_LFO * lfo = &c->lfos[i];
+        if (!lfo->enabled) {
+            continue;
+        }
+
+        float t = lfo->t;
+        if (lfo->master >= 0) {
+            t = c->lfos[lfo->master].t + lfo->phase_offset;
+        }
+
+        float start = lfo->value;
+        float end = lfo_bank_evaluate(lfo->waveform, t);
+        float step = (end - start)*inv_block_size;
+
+        float * buffer = lfo->buffer;
+        for (int j=0;j<audio_block_size;j++) {
+            buffer[j] = start + step*(float) (j+1);
+        }
+        lfo->value = end;
+    }
+}
+
+/**
+ * @brief Returns the block-rate value of an LFO
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO
+ * @return LFO value (-1.0->1.0) at the end of the current block
+ */
+float   lfo_bank_value(LFO_BANK * c,
+                       uint32_t lfo) {
+
+    if (c == NULL || lfo >= LFO_BANK_MAX_LFOS) {
+        return 0.0;
+    }
+    return c->lfos[lfo].value;
+}
+
+/**
+ * @brief Returns the per-sample control buffer of an LFO
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Index of the LFO
+ * @return Pointer to the LFO's control buffer (-1.0->1.0) for the current block
+ */
+float * lfo_bank_buffer(LFO_BANK * c,
+                        uint32_t lfo) {
+
+    if (c == NULL || lfo >= LFO_BANK_MAX_LFOS) {
+        return NULL;
+    }
+    return c->lfos[lfo].buffer;
+}
+
+/**
+ * @brief Recalculates the phase increment of an LFO
+ *
+ * @param c Pointer to instance structure
+ * @param lfo Pointer to the LFO
+ */
+static void     lfo_bank_update_inc(LFO_BANK * c, LFO_BANK_LFO * lfo) {
+
+    float rate_hz = lfo->rate_hz;
+    if (lfo->tempo_synced) {
+        rate_hz = (c->tempo_bpm / 60.0) / lfo->beats_per_cycle;
+    }
+    lfo->inc = rate_hz / c->audio_sample_rate;
+}
+
+/**
+ * @brief Evaluates an LFO waveform
+ *
+ * @param waveform Waveform (see enumeration)
+ * @param t Phase in cycles
+ * @return Waveform value (-1.0->1.0)
+ */
+static float    lfo_bank_evaluate(LFO_BANK_WAVEFORM waveform, float t) {
+
+    switch (waveform) {
+        case LFO_BANK_TRI:  return oscillator_triangle(t);
+        case LFO_BANK_SQR:  return oscillator_square(t);
+        case LFO_BANK_RAMP: return oscillator_ramp(t);
+        default:            return oscillator_sine(t);
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _LFO_BANK_H
+#define _LFO_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define LFO_BANK_MAX_LFOS       (16)
+
+// Result enumerations
+typedef enum
+{
+    LFO_BANK_OK,
+    LFO_BANK_INVALID_INSTANCE_POINTER,
+    LFO_BANK_INVALID_INDEX,
+    LFO_BANK_INVALID_MASTER,
+    LFO_BANK_INVALID_RATE,
+    LFO_BANK_INVALID_BEATS,
+    LFO_BANK_INVALID_TEMPO
+} RESULT_LFO_BANK;
+
+// Supported LFO waveforms
+typedef enum
+{
+    LFO_BANK_SIN,
+    LFO_BANK_TRI,
+    LFO_BANK_SQR,                       // Edges are ramped over one block (see .c file)
+    LFO_BANK_RAMP                       // Reset is ramped over one block
+} LFO_BANK_WAVEFORM;
+
+// State of a single LFO in the bank
+typedef struct {
+
+    bool        enabled;
+    LFO_BANK_WAVEFORM waveform;
+
+    int32_t     master;             // LFO this one follows (-1 = free running)
+    float       phase_offset;       // Phase offset (cycles) relative to master
+
+    bool        tempo_synced;
+    float       rate_hz;
+    float       beats_per_cycle;
+
+    float       t;
+    float       inc;
+    float       value;              // Value at the end of the current block
+    float       buffer[MAX_AUDIO_BLOCK_SIZE];
+
+} LFO_BANK_LFO;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool        initialized;
+
+    LFO_BANK_LFO    lfos[LFO_BANK_MAX_LFOS];
+
+    float       tempo_bpm;
+    float       audio_sample_rate;
+
+} LFO_BANK;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_LFO_BANK lfo_bank_setup(LFO_BANK * c,
+                               float tempo_bpm,
+                               float audio_sample_rate);
+
+RESULT_LFO_BANK lfo_bank_configure(LFO_BANK * c,
+                                   uint32_t lfo,
+                                   LFO_BANK_WAVEFORM waveform,
+                                   float rate_hz,
+                                   float phase);
+
+RESULT_LFO_BANK lfo_bank_configure_synced(LFO_BANK * c,
+                                          uint32_t lfo,
+                                          LFO_BANK_WAVEFORM waveform,
+                                          float beats_per_cycle,
+                                          float phase);
+
+RESULT_LFO_BANK lfo_bank_link(LFO_BANK * c,
+                              uint32_t lfo,
+                              LFO_BANK_WAVEFORM waveform,
+                              uint32_t master_lfo,
+                              float phase_offset);
+
+RESULT_LFO_BANK lfo_bank_modify_rate(LFO_BANK * c,
+                                     uint32_t lfo,
+                                     float new_rate_hz);
+
+RESULT_LFO_BANK lfo_bank_modify_tempo(LFO_BANK * c,
+                                      float new_tempo_bpm);
+
+void    lfo_bank_advance(LFO_BANK * c,
+                         uint32_t audio_block_size);
+
+float   lfo_bank_value(LFO_BANK * c,
+                       uint32_t lfo);
+
+float * lfo_bank_buffer(LFO_BANK * c,
+                        uint32_t lfo);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _LFO_BANK_H
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A Linkwitz-Riley crossover splits audio into 2 to 5 frequency bands that
+ * sum back to a flat magnitude response.
+ *
+ * Each crossover point uses 4th order Linkwitz-Riley filters, which are two
+ * cascaded 2nd order Butterworth (Q = 0.707) sections.  The LR4 low-pass and
+ * high-pass outputs at a crossover point are in phase and sum to a 2nd order
+ * allpass at the same frequency.
+ *
+ * The bands are split as a tree: the input is split at the lowest crossover
+ * point, the high-pass output is split again at the next crossover point and
+ * so on.  A band that was split off early hasn't been through the filters of
+ * the higher crossover points, so it would be out of phase with the other
+ * bands when they are summed.  To compensate, each band is run through the
+ * matching 2nd order allpass of every higher crossover point.  With this, the
+ * sum of all bands is an allpass of the input (flat magnitude).
+ *
+ * All bands are computed together in a single pass over the block rather
+ * than one filter pass per band.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "linkwitz_riley_crossover.h"
+
+// Min/max limits and other constants
+#define LR_CROSSOVER_FREQ_MIN       (20.0)
+#define LR_CROSSOVER_FREQ_MAX_FS    (0.45)      // Max freq as fraction of fs
+#define LR_CROSSOVER_MIN_SPACING    (1.1)       // Min ratio between points
+#define LR_CROSSOVER_Q              (0.70710678118)
+
+// Static function prototypes
+static void lr_crossover_calc_coeffs(LR_CROSSOVER * c, uint32_t index);
+
+/**
+ * @brief Runs one sample through a transposed direct form II biquad
+ *
+ * @param k Pointer to coefficients
+ * @param s Pointer to filter state
+ * @param x Input sample
+ * @return Output sample
+ */
+static inline float lr_crossover_biquad(LR_CROSSOVER_COEFFS * k,
+                                        LR_CROSSOVER_STATE * s,
+                                        float x) {
+
+    float y = k->b0*x + s->s1;
+    s->s1 = k->b1*x - k->a1*y + s->s2;
+    s->s2 = k->b2*x - k->a2*y;
+    return y;
+}
+
+
+/**
+ * @brief Initializes instance of a Linkwitz-Riley crossover
+ *
+ * @param c Pointer to instance structure
+ * @param num_bands Number of bands (2->5)
+ * @param crossover_freqs Array of num_bands-1 crossover frequencies (ascending)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Crossover result (enumeration)
+ */
+RESULT_LR_CROSSOVER lr_crossover_setup(LR_CROSSOVER * c,
+                                       uint32_t num_bands,
+                                       const float * crossover_freqs,
+                                       float audio_sample_rate) {
+
+    if (c == NULL) {
+        return LR_CROSSOVER_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (num_bands < 2 || num_bands > LR_CROSSOVER_MAX_BANDS) {
+        return LR_CROSSOVER_INVALID_NUM_BANDS;
+    }
+
+    // Crossover points must be in range and in ascending order
+    float freq_last = 0.0;
+    for (int i=0;i<num_bands-1;i++) {
+        float freq = crossover_freqs[i];
+        if (freq < LR_CROSSOVER_FREQ_MIN ||
+            freq > LR_CROSSOVER_FREQ_MAX_FS*audio_sample_rate ||
+            freq < freq_last*LR_CROSSOVER_MIN_SPACING) {
+            return LR_CROSSOVER_INVALID_FREQ;
+        }
+        freq_last = freq;
+    }
+
+    c->num_bands = num_bands;
+    c->audio_sample_rate = audio_sample_rate;
+
+    for (int i=0;i<num_bands-1;i++) {
+        c->freqs[i] = crossover_freqs[i];
+        lr_crossover_calc_coeffs(c, i);
+    }
+
+    // Clear filter state
+    for (int i=0;i<LR_CROSSOVER_MAX_SPLITS;i++) {
+        for (int j=0;j<2;j++) {
+            c->lpf_state[i][j].s1 = c->lpf_state[i][j].s2 = 0.0;
+            c->hpf_state[i][j].s1 = c->hpf_state[i][j].s2 = 0.0;
+        }
+    }
+    for (int b=0;b<LR_CROSSOVER_MAX_BANDS;b++) {
+        for (int i=0;i<LR_CROSSOVER_MAX_SPLITS;i++) {
+            c->apf_state[b][i].s1 = c->apf_state[b][i].s2 = 0.0;
+        }
+    }
+
+    c->initialized = true;
+    return LR_CROSSOVER_OK;
+}
+
+/**
+ * @brief Modify the frequency of one crossover point
+ *
+ * The frequency is kept between the neighbouring crossover points.
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param index Crossover point to modify (0->num_bands-2)
+ * @param new_freq Updated crossover frequency in Hz
+ * @return Crossover result (enumeration)
+ */
+RESULT_LR_CROSSOVER lr_crossover_modify_freq(LR_CROSSOVER * c,
+                                             uint32_t index,
+                                             float freq_new) {
+
+    if (c == NULL) {
+        return LR_CROSSOVER_INVALID_INSTANCE_POINTER;
+    }
+
+    if (index >= c->num_bands-1) {
+        return LR_CROSSOVER_INVALID_INDEX;
+    }
+
+    float freq_min = LR_CROSSOVER_FREQ_MIN;
+    float freq_max = LR_CROSSOVER_FREQ_MAX_FS*c->audio_sample_rate;
+    if (index > 0) {
+        freq_min = c->freqs[index-1]*LR_CROSSOVER_MIN_SPACING;
+    }
+    if (index < c->num_bands-2) {
+        freq_max = c->freqs[index+1]/LR_CROSSOVER_MIN_SPACING;
+    }
+
+    RESULT_LR_CROSSOVER res;
+
+    float freq;
+    if (freq_new > freq_max) {
+        freq = freq_max;
+        res = LR_CROSSOVER_INVALID_FREQ;
+    }
+    else if (freq_new < freq_min) {
+        freq = freq_min;
+        res = LR_CROSSOVER_INVALID_FREQ;
+    }
+    else {
+        freq = freq_new;
+        res = LR_CROSSOVER_OK;
+    }
+
+    if (freq != c->freqs[index]) {
+        c->freqs[index] = freq;
+        lr_crossover_calc_coeffs(c, index);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Splits a block of audio into frequency bands
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param bands_out Array of num_bands pointers to floating point output buffers
+ *                  (lowest band first)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    lr_crossover_read(LR_CROSSOVER * c,
+                          float * audio_in,
+                          float ** bands_out,
+                          uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    // in the lowest band
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            bands_out[0][i] = audio_in[i];
+        }
+        return;
+    }
+
+    uint32_t num_splits = c->num_bands-1;
+
+    for (int i=0;i<audio_block_size;i++) {
+
+        float rest = audio_in[i];
+
+        for (int s=0;s<num_splits;s++) {
+
+            // Phase compensate the bands already split off
+            for (int b=0;b<s;b++) {
+                bands_out[b][i] = lr_crossover_biquad(&c->apf[s],
+                                                      &c->apf_state[b][s],
+                                                      bands_out[b][i]);
+            }
+
+            // LR4 split of what remains
+            float low = lr_crossover_biquad(&c->lpf[s], &c->lpf_state[s][0], rest);
+            low = lr_crossover_biquad(&c->lpf[s], &c->lpf_state[s][1], low);
+
+            float high = lr_crossover_biquad(&c->hpf[s], &c->hpf_state[s][0], rest);
+            high = lr_crossover_biquad(&c->hpf[s], &c->hpf_state[s][1], high);
+
+            bands_out[s][i] = low;
+            rest = high;
+        }
+
+        bands_out[num_splits][i] = rest;
+    }
+}
+
+/**
+ * @brief Calculates the LPF, HPF and allpass coefficients of a crossover point
+ *
+ * @param c Pointer to instance structure
+ * @param index Crossover point
+ */
+static void lr_crossover_calc_coeffs(LR_CROSSOVER * c, uint32_t index) {
+
+    float w0 = PI2*c->freqs[index]/c->audio_sample_rate;
+    float cs = cosf(w0);
+    float alpha = sinf(w0)/(2.0*LR_CROSSOVER_Q);
+    float a0_recip = 1.0/(1.0 + alpha);
+
+    float a1 = -2.0*cs*a0_recip;
+    float a2 = (1.0 - alpha)*a0_recip;
+
+    LR_CROSSOVER_COEFFS * lpf = &c->lpf[index];
+    lpf->b0 = 0.5*(1.0 - cs)*a0_recip;
+    lpf->b1 = (1.0 - cs)*a0_recip;
+    lpf->b2 = lpf->b0;
+    lpf->a1 = a1;
+    lpf->a2 = a2;
+
+    LR_CROSSOVER_COEFFS * hpf = &c->hpf[index];
+    hpf->b0 = 0.5*(1.0 + cs)*a0_recip;
+    hpf->b1 = -(1.0 + cs)*a0_recip;
+    hpf->b2 = hpf->b0;
+    hpf->a1 = a1;
+    hpf->a2 = a2;
+
+    LR_CROSSOVER_COEFFS * apf = &c->apf[index];
+    apf->b0 = a2;
+    apf->b1 = a1;
+    apf->b2 = 1.0;
+    apf->a1 = a1;
+    apf->a2 = a2;
+}
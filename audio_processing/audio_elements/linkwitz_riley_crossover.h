@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _LINKWITZ_RILEY_CROSSOVER_H
+#define _LINKWITZ_RILEY_CROSSOVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define LR_CROSSOVER_MAX_BANDS      (5)
+#define LR_CROSSOVER_MAX_SPLITS     (LR_CROSSOVER_MAX_BANDS-1)
+
+// Result enumerations
+typedef enum
+{
+    LR_CROSSOVER_OK,
+    LR_CROSSOVER_INVALID_INSTANCE_POINTER,
+    LR_CROSSOVER_INVALID_NUM_BANDS,
+    LR_CROSSOVER_INVALID_INDEX,
+    LR_CROSSOVER_INVALID_FREQ
+} RESULT_LR_CROSSOVER;
+
+// Normalized biquad coefficients (a0 = 1)
+typedef struct {
+    float   b0, b1, b2;
+    float   a1, a2;
+} LR_CROSSOVER_COEFFS;
+
+// Transposed direct form II state of one biquad
+typedef struct {
+    float   s1, s2;
+} LR_CROSSOVER_STATE;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool        initialized;
+
+    uint32_t    num_bands;
+    float       freqs[LR_CROSSOVER_MAX_SPLITS];
+
+    // Coefficients for each crossover point
+    LR_CROSSOVER_COEFFS     lpf[LR_CROSSOVER_MAX_SPLITS];
+    LR_CROSSOVER_COEFFS     hpf[LR_CROSSOVER_MAX_SPLITS];
+    LR_CROSSOVER_COEFFS     apf[LR_CROSSOVER_MAX_SPLITS];
+
+    // 4th order LPF/HPF are two cascaded 2nd order sections each
+    LR_CROSSOVER_STATE      lpf_state[LR_CROSSOVER_MAX_SPLITS][2];
+    LR_CROSSOVER_STATE      hpf_state[LR_CROSSOVER_MAX_SPLITS][2];
+
+    // Phase compensation allpass for band b at crossover point s (s > b)
+    LR_CROSSOVER_STATE      apf_state[LR_CROSSOVER_MAX_BANDS][LR_CROSSOVER_MAX_SPLITS];
+
+    float       audio_sample_rate;
+
+} LR_CROSSOVER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_LR_CROSSOVER lr_crossover_setup(LR_CROSSOVER * c,
+                                       uint32_t num_bands,
+                                       const float * crossover_freqs,
+                                       float audio_sample_rate);
+
+RESULT_LR_CROSSOVER lr_crossover_modify_freq(LR_CROSSOVER * c,
+                                             uint32_t index,
+                                             float new_freq);
+
+void    lr_crossover_read(LR_CROSSOVER * c,
+                          float * audio_in,
+                          float ** bands_out,
+                          uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _LINKWITZ_RILEY_CROSSOVER_H
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A stereo loudness meter following ITU-R BS.1770 / EBU R128.  It reports
+ * momentary (400 ms), short-term (3 s) and gated integrated loudness in LUFS,
+ * and the true-peak level in dBTP.
+ *
+ * Loudness is the mean square of the K-weighted signal, summed over the
+ * channels:
+ *
+ *      L = -0.691 + 10*log10(sum of channel mean squares)
+ *
+ * K-weighting is a high shelf (+4 dB above about 1.5 kHz, modelling the head)
+ * followed by a 38 Hz high-pass.  The coefficients are calculated for the
+ * system sample rate from the analog prototypes.
+ *
+ * Like the STFT analyzer, the work is split so the audio callback does very
+ * little:
+ *
+ *  - loudness_meter_push() is called from the audio callback.  It runs the
+ *    K-weighting filters and accumulates the square-sum.  Every 100 ms it
+ *    hands the block's mean square to the background loop through a small
+ *    ring.  It also copies the raw samples into a ring for the true-peak
+ *    meter.
+ *  - loudness_meter_process() is called from processaudio_background_loop().
+ *    It keeps the last 3 s of 100 ms blocks for the momentary and short-term
+ *    loudness, and adds each 400 ms momentary block (75% overlap) to a
+ *    histogram with 0.1 LU bins.  The integrated loudness is gated from the
+ *    histogram: blocks below -70 LUFS are ignored, then blocks more than 10 LU
+ *    below the loudness of the rest.  The histogram keeps the cost and memory
+ *    fixed no matter how long the meter runs.
+ *
+ * The true-peak meter oversamples by 4 with the 48 tap polyphase interpolator
+ * described in BS.1770 and reports the largest magnitude since the last
+ * reset.
+ *
+ * If the background loop falls behind, whole blocks are dropped and counted
+ * in blocks_dropped.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "loudness_meter.h"
+
+// Min/max limits and other constants
+#define LOUDNESS_SAMPLE_RATE_MIN    (8000.0)
+#define LOUDNESS_SAMPLE_RATE_MAX    (192000.0)
+#define LOUDNESS_BLOCK_RING_MASK    (LOUDNESS_BLOCK_RING_SIZE-1)
+#define LOUDNESS_TP_RING_MASK       (LOUDNESS_TP_RING_SIZE-1)
+#define LOUDNESS_TP_PHASE_TAPS      (LOUDNESS_TP_TAPS/LOUDNESS_TP_OVERSAMPLE)
+
+#define LOUDNESS_ABSOLUTE_GATE      (-70.0)     // LUFS
+#define LOUDNESS_RELATIVE_GATE      (-10.0)     // LU
+#define LOUDNESS_BIN_WIDTH          (0.1)       // LU
+
+// Static function prototypes
+static float    loudness_from_power(float power);
+static void     loudness_add_block(LOUDNESS_METER * c, float power);
+static float    loudness_integrated(LOUDNESS_METER * c);
+static void     loudness_true_peak(LOUDNESS_METER * c);
+
+
+/**
+ * @brief Initializes instance of a loudness meter
+ *
+ * @param c Pointer to instance structure
+ * @param audio_sample_rate The system audio sample rate (8000->192000)
+ * @return Loudness meter result (enumeration)
+ */
+RESULT_LOUDNESS loudness_meter_setup(LOUDNESS_METER * c,
+                                     float audio_sample_rate) {
+
+    if (c == NULL) {
+        return LOUDNESS_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (audio_sample_rate < LOUDNESS_SAMPLE_RATE_MIN ||
+        audio_sample_rate > LOUDNESS_SAMPLE_RATE_MAX) {
+        return LOUDNESS_INVALID_SAMPLE_RATE;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+
+    // Stage 1: high shelf
+    float f0 = 1681.974450955533;
+    float q = 0.7071752369554196;
+    float k = tanf(PI*f0/audio_sample_rate);
+    float vh = powf(10.0, 3.999843853973347/20.0);
+    float vb = powf(vh, 0.4996667741545416);
+    float a0 = 1.0 + k/q + k*k;
+    c->kw_b[0][0] = (vh + vb*k/q + k*k)/a0;
+    c->kw_b[0][1] = 2.0*(k*k - vh)/a0;
+    c->kw_b[0][2] = (vh - vb*k/q + k*k)/a0;
+    c->kw_a[0][0] = 2.0*(k*k - 1.0)/a0;
+    c->kw_a[0][1] = (1.0 - k/q + k*k)/a0;
+
+    // Stage 2: high-pass
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tanf(PI*f0/audio_sample_rate);
+    a0 = 1.0 + k/q + k*k;
+    c->kw_b[1][0] = 1.0;
+    c->kw_b[1][1] = -2.0;
+    c->kw_b[1][2] = 1.0;
+    c->kw_a[1][0] = 2.0*(k*k - 1.0)/a0;
+    c->kw_a[1][1] = (1.0 - k/q + k*k)/a0;
+
+    for (int ch=0;ch<LOUDNESS_CHANNELS;ch++) {
+        for (int s=0;s<2;s++) {
+            c->kw_z1[ch][s] = 0.0;
+            c->kw_z2[ch][s] = 0.0;
+        }
+    }
+
+    c->block_length = (uint32_t)(0.1*audio_sample_rate + 0.5);
+    c->block_fill = 0;
+    c->block_sum = 0.0;
+    c->blocks_written = 0;
+    c->blocks_read = 0;
+    c->blocks_dropped = 0;
+
+    // True-peak interpolator: Hann windowed sinc at the original Nyquist,
+    // each phase normalized to unity gain at DC
+    for (int i=0;i<LOUDNESS_TP_TAPS;i++) {
+        float x = (i - 0.5*(LOUDNESS_TP_TAPS - 1))/LOUDNESS_TP_OVERSAMPLE;
+        float sinc = (x == 0.0) ? 1.0 : sinf(PI*x)/(PI*x);
+        float window = 0.5 - 0.5*cosf(PI2*(i + 1)/(LOUDNESS_TP_TAPS + 1));
+        c->tp_coeffs[i] = sinc*window;
+    }
+    for (int p=0;p<LOUDNESS_TP_OVERSAMPLE;p++) {
+        float sum = 0.0;
+        for (int j=0;j<LOUDNESS_TP_PHASE_TAPS;j++) {
+            sum += c->tp_coeffs[p + j*LOUDNESS_TP_OVERSAMPLE];
+        }
+        for (int j=0;j<LOUDNESS_TP_PHASE_TAPS;j++) {
+            c->tp_coeffs[p + j*LOUDNESS_TP_OVERSAMPLE] /= sum;
+        }
+    }
+
+    for (int ch=0;ch<LOUDNESS_CHANNELS;ch++) {
+        for (int i=0;i<LOUDNESS_TP_RING_SIZE;i++) {
+            c->tp_ring[ch][i] = 0.0;
+        }
+    }
+    c->samples_written = 0;
+    c->samples_read = 0;
+
+    // Power at the center of each histogram bin
+    for (int b=0;b<LOUDNESS_HISTOGRAM_BINS;b++) {
+        float lufs = LOUDNESS_ABSOLUTE_GATE + (b + 0.5)*LOUDNESS_BIN_WIDTH;
+        c->bin_power[b] = powf(10.0, (lufs + 0.691)/10.0);
+    }
+
+    loudness_meter_reset(c);
+
+    c->initialized = true;
+    return LOUDNESS_OK;
+}
+
+/**
+ * @brief Restarts the integrated loudness and true-peak measurements
+ *
+ * Call this from the same context as loudness_meter_process() (the
+ * background loop).
+ *
+ * @param c Pointer to instance structure
+ */
+void    loudness_meter_reset(LOUDNESS_METER * c) {
+
+    for (int i=0;i<LOUDNESS_SHORT_TERM_BLOCKS;i++) {
+        c->history[i] = 0.0;
+    }
+    c->history_pos = 0;
+    c->history_count = 0;
+
+    for (int b=0;b<LOUDNESS_HISTOGRAM_BINS;b++) {
+        c->histogram[b] = 0;
+    }
+    c->tp_max = 0.0;
+
+    c->momentary_lufs = LOUDNESS_SILENCE;
+    c->short_term_lufs = LOUDNESS_SILENCE;
+    c->integrated_lufs = LOUDNESS_SILENCE;
+    c->true_peak_dbtp = LOUDNESS_SILENCE;
+}
+
+/**
+ * @brief Adds a block of audio to the measurement
+ *
+ * Called from the audio callback.  Only the K-weighting and the square-sum
+ * are done here.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in_left Pointer to floating point audio input buffer (left)
+ * @param audio_in_right Pointer to floating point audio input buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    loudness_meter_push(LOUDNESS_METER * c,
+                            float * audio_in_left,
+                            float * audio_in_right,
+                            uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    float * audio_in[LOUDNESS_CHANNELS] = {audio_in_left, audio_in_right};
+
+    uint32_t start = 0;
+    while (start < audio_block_size) {
+
+        // Stop at the end of the current 100 ms block
+        uint32_t n = audio_block_size - start;
+        if (n > c->block_length - c->block_fill) {
+            n = c->block_length - c->block_fill;
+        }
+
+        float sum = 0.0;
+        for (int ch=0;ch<LOUDNESS_CHANNELS;ch++) {
+            float * in = &audio_in[ch][start];
+
+            float s1_b0 = c->kw_b[0][0], s1_b1 = c->kw_b[0][1], s1_b2 = c->kw_b[0][2];
+            float s1_a1 = c->kw_a[0][0], s1_a2 = c->kw_a[0][1];
+            float s2_a1 = c->kw_a[1][0], s2_a2 = c->kw_a[1][1];
+            float s1_z1 = c->kw_z1[ch][0], s1_z2 = c->kw_z2[ch][0];
+            float s2_z1 = c->kw_z1[ch][1], s2_z2 = c->kw_z2[ch][1];
+
+            for (int i=0;i<n;i++) {
+                float x = in[i];
+
+                float y = s1_b0*x + s1_z1;
+                s1_z1 = s1_b1*x - s1_a1*y + s1_z2;
+                s1_z2 = s1_b2*x - s1_a2*y;
+
+                // High-pass numerator is 1, -2, 1
+                x = y;
+                y = x + s2_z1;
+                s2_z1 = -2.0*x - s2_a1*y + s2_z2;
+                s2_z2 = x - s2_a2*y;
+
+                sum += y*y;
+            }
+
+            c->kw_z1[ch][0] = s1_z1;
+            c->kw_z2[ch][0] = s1_z2;
+            c->kw_z1[ch][1] = s2_z1;
+            c->kw_z2[ch][1] = s2_z2;
+        }
+
+        c->block_sum += sum;
+        c->block_fill += n;
+        start += n;
+
+        // Hand the finished block to the background loop
+        if (c->block_fill == c->block_length) {
+            uint32_t written = c->blocks_written;
+            c->block_power[written & LOUDNESS_BLOCK_RING_MASK] = c->block_sum/c->block_length;
+            c->blocks_written = written + 1;
+            c->block_sum = 0.0;
+            c->block_fill = 0;
+        }
+    }
+
+    // Raw samples for the true-peak meter
+    uint32_t pos = c->samples_written;
+    for (int i=0;i<audio_block_size;i++) {
+        c->tp_ring[0][(pos + i) & LOUDNESS_TP_RING_MASK] = audio_in_left[i];
+        c->tp_ring[1][(pos + i) & LOUDNESS_TP_RING_MASK] = audio_in_right[i];
+    }
+    c->samples_written = pos + audio_block_size;
+}
+
+/**
+ * @brief Updates the loudness measurements from any new audio
+ *
+ * Call this from processaudio_background_loop().
+ *
+ * @param c Pointer to instance structure
+ * @return true if new loudness values were calculated
+ */
+bool    loudness_meter_process(LOUDNESS_METER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    loudness_true_peak(c);
+
+    uint32_t written = c->blocks_written;
+    if (written == c->blocks_read) {
+        return false;
+    }
+
+    // Skip blocks that have already been overwritten
+    if (written - c->blocks_read > LOUDNESS_BLOCK_RING_SIZE) {
+        c->blocks_dropped += written - c->blocks_read - LOUDNESS_BLOCK_RING_SIZE;
+        c->blocks_read = written - LOUDNESS_BLOCK_RING_SIZE;
+    }
+
+    while (c->blocks_read != written) {
+        loudness_add_block(c, c->block_power[c->blocks_read & LOUDNESS_BLOCK_RING_MASK]);
+        c->blocks_read++;
+    }
+
+    // Momentary and short-term loudness from the latest blocks
+    float momentary = 0.0, short_term = 0.0;
+    for (int i=0;i<LOUDNESS_SHORT_TERM_BLOCKS;i++) {
+        uint32_t pos = (c->history_pos + LOUDNESS_SHORT_TERM_BLOCKS - 1 - i) % LOUDNESS_SHORT_TERM_BLOCKS;
+        if (i < LOUDNESS_MOMENTARY_BLOCKS) {
+            momentary += c->history[pos];
+        }
+        short_term += c->history[pos];
+    }
+    c->momentary_lufs = loudness_from_power(momentary/LOUDNESS_MOMENTARY_BLOCKS);
+    c->short_term_lufs = loudness_from_power(short_term/LOUDNESS_SHORT_TERM_BLOCKS);
+    c->integrated_lufs = loudness_integrated(c);
+
+    return true;
+}
+
+/**
+ * @brief Converts a K-weighted mean square to LUFS
+ *
+ * @param power Sum of the channel mean squares
+ * @return Loudness in LUFS (LOUDNESS_SILENCE for silence)
+ */
+static float    loudness_from_power(float power) {
+
+    if (power <= 0.0) {
+        return LOUDNESS_SILENCE;
+    }
+    float lufs = -0.691 + 10.0*log10f(power);
+    return (lufs < LOUDNESS_SILENCE) ? LOUDNESS_SILENCE : lufs;
+}
+
+/**
+ * @brief Adds a 100 ms block to the history and the gating histogram
+ *
+ * @param c Pointer to instance structure
+ * @param power Mean square of the block
+ */
+static void     loudness_add_block(LOUDNESS_METER * c, float power) {
+
+    c->history[c->history_pos] = power;
+    c->history_pos = (c->history_pos + 1) % LOUDNESS_SHORT_TERM_BLOCKS;
+    if (c->history_count < LOUDNESS_MOMENTARY_BLOCKS) {
+        c->history_count++;
+        if (c->history_count < LOUDNESS_MOMENTARY_BLOCKS) {
+            return;
+        }
+    }
+
+    // The gating blocks are the 400 ms momentary windows, every 100 ms
+    float momentary = 0.0;
+    for (int i=0;i<LOUDNESS_MOMENTARY_BLOCKS;i++) {
+        momentary += c->history[(c->history_pos + LOUDNESS_SHORT_TERM_BLOCKS - 1 - i) % LOUDNESS_SHORT_TERM_BLOCKS];
+    }
+    float lufs = loudness_from_power(momentary/LOUDNESS_MOMENTARY_BLOCKS);
+
+    // Absolute gate
+    if (lufs < LOUDNESS_ABSOLUTE_GATE) {
+        return;
+    }
+
+    int bin = (int)((lufs - LOUDNESS_ABSOLUTE_GATE)/LOUDNESS_BIN_WIDTH);
+    if (bin >= LOUDNESS_HISTOGRAM_BINS) {
+        bin = LOUDNESS_HISTOGRAM_BINS - 1;
+    }
+    c->histogram[bin]++;
+}
+
+/**
+ * @brief Calculates the gated integrated loudness from the histogram
+ *
+ * @param c Pointer to instance structure
+ * @return Integrated loudness in LUFS (LOUDNESS_SILENCE if nothing passed the gates)
+ */
+static float    loudness_integrated(LOUDNESS_METER * c) {
+
+    // Loudness of every block above the absolute gate
+    float sum = 0.0;
+    uint32_t count = 0;
+    for (int b=0;b<LOUDNESS_HISTOGRAM_BINS;b++) {
+        sum += c->histogram[b]*c->bin_power[b];
+        count += c->histogram[b];
+    }
+    if (count == 0) {
+        return LOUDNESS_SILENCE;
+    }
+
+    // Relative gate
+    float gate = loudness_from_power(sum/count) + LOUDNESS_RELATIVE_GATE;
+    int start = (int)((gate - LOUDNESS_ABSOLUTE_GATE)/LOUDNESS_BIN_WIDTH);
+    if (start < 0) {
+        start = 0;
+    }
+
+    sum = 0.0;
+    count = 0;
+    for (int b=start;b<LOUDNESS_HISTOGRAM_BINS;b++) {
+        sum += c->histogram[b]*c->bin_power[b];
+        count += c->histogram[b];
+    }
+    if (count == 0) {
+        return LOUDNESS_SILENCE;
+    }
+
+    return loudness_from_power(sum/count);
+}
+
+/**
+ * @brief Runs the true-peak interpolator over any new samples
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     loudness_true_peak(LOUDNESS_METER * c) {
+
+    uint32_t written = c->samples_written;
+
+    // Skip samples that have already been (or are about to be) overwritten
+    if (written - c->samples_read > LOUDNESS_TP_RING_SIZE - LOUDNESS_TP_PHASE_TAPS) {
+        c->samples_read = written - (LOUDNESS_TP_RING_SIZE - LOUDNESS_TP_PHASE_TAPS);
+    }
+
+    float peak = c->tp_max;
+    float * h = c->tp_coeffs;
+
+    for (int ch=0;ch<LOUDNESS_CHANNELS;ch++) {
+        float * ring = c->tp_ring[ch];
+
+        for (uint32_t n=c->samples_read;n!=written;n++) {
+            for (int p=0;p<LOUDNESS_TP_OVERSAMPLE;p++) {
+                float y = 0.0;
+                for (int j=0;j<LOUDNESS_TP_PHASE_TAPS;j++) {
+                    y += h[p + j*LOUDNESS_TP_OVERSAMPLE]*ring[(n - j) & LOUDNESS_TP_RING_MASK];
+                }
+                y = fabsf(y);
+                if (y > peak) {
+                    peak = y;
+                }
+            }
+        }
+    }
+    c->samples_read = written;
+
+    c->tp_max = peak;
+    c->true_peak_dbtp = (peak > 0.0) ? 20.0*log10f(peak) : LOUDNESS_SILENCE;
+    if (c->true_peak_dbtp < LOUDNESS_SILENCE) {
+        c->true_peak_dbtp = LOUDNESS_SILENCE;
+    }
+}
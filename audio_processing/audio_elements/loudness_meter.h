@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _LOUDNESS_METER_H
+#define _LOUDNESS_METER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define LOUDNESS_CHANNELS           (2)
+#define LOUDNESS_BLOCK_RING_SIZE    (32)        // 100 ms blocks waiting for the background (power of 2)
+#define LOUDNESS_SHORT_TERM_BLOCKS  (30)        // 3 s
+#define LOUDNESS_MOMENTARY_BLOCKS   (4)         // 400 ms
+#define LOUDNESS_HISTOGRAM_BINS     (750)       // 0.1 LU bins from -70 to +5 LUFS
+#define LOUDNESS_TP_OVERSAMPLE      (4)
+#define LOUDNESS_TP_TAPS            (48)        // 12 taps per phase
+#define LOUDNESS_TP_RING_SIZE       (2048)      // Power of 2
+
+// Reported when there is nothing to measure (e.g. silence below the gate)
+#define LOUDNESS_SILENCE            (-100.0)
+
+// Result enumerations
+typedef enum
+{
+    LOUDNESS_OK,
+    LOUDNESS_INVALID_INSTANCE_POINTER,
+    LOUDNESS_INVALID_SAMPLE_RATE
+} RESULT_LOUDNESS;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    // K-weighting: a high shelf followed by a high-pass (normalized, a0 = 1)
+    float   kw_b[2][3];
+    float   kw_a[2][2];
+    float   kw_z1[LOUDNESS_CHANNELS][2];
+    float   kw_z2[LOUDNESS_CHANNELS][2];
+
+    // Square-sum of the current 100 ms block (audio callback)
+    uint32_t    block_length;
+    uint32_t    block_fill;
+    float       block_sum;
+
+    // Completed blocks handed to the background loop
+    float       block_power[LOUDNESS_BLOCK_RING_SIZE];
+    volatile uint32_t   blocks_written;
+    uint32_t    blocks_read;
+    uint32_t    blocks_dropped;
+
+    // Raw samples handed to the background loop for the true-peak meter
+    float       tp_ring[LOUDNESS_CHANNELS][LOUDNESS_TP_RING_SIZE];
+    volatile uint32_t   samples_written;
+    uint32_t    samples_read;
+    float       tp_coeffs[LOUDNESS_TP_TAPS];
+    float       tp_max;
+
+    // Last 3 s of block powers (background loop)
+    float       history[LOUDNESS_SHORT_TERM_BLOCKS];
+    uint32_t    history_pos;
+    uint32_t    history_count;
+
+    // Histogram of gated 400 ms block loudness for the integrated loudness
+    uint32_t    histogram[LOUDNESS_HISTOGRAM_BINS];
+    float       bin_power[LOUDNESS_HISTOGRAM_BINS];
+
+    // Results
+    float   momentary_lufs;
+    float   short_term_lufs;
+    float   integrated_lufs;
+    float   true_peak_dbtp;
+
+    float   audio_sample_rate;
+
+} LOUDNESS_METER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_LOUDNESS loudness_meter_setup(LOUDNESS_METER * c,
+                                     float audio_sample_rate);
+
+void    loudness_meter_reset(LOUDNESS_METER * c);
+
+void    loudness_meter_push(LOUDNESS_METER * c,
+                            float * audio_in_left,
+                            float * audio_in_right,
+                            uint32_t audio_block_size);
+
+bool    loudness_meter_process(LOUDNESS_METER * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _LOUDNESS_METER_H
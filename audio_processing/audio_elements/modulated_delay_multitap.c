@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A modulated multitap delay extends the basic multitap delay
+ * (integer_delay_multitap.c) for rhythmic delays and diffusion networks.
+ * It supports up to 32 taps and each tap has:
+ *
+ *  - a fractional read position modulated by its own sine LFO
+ *  - a one-pole low-pass "tone" filter
+ *  - a stereo pan position
+ *  - a feedback send into the left and right delay lines (together
+ *    the sends form a 2 x N feedback matrix)
+ *
+ * Rather than iterating over every tap for each sample, this element
+ * processes one tap's full block at a time.  Each tap's LFO is evaluated
+ * once per block and its delay is ramped linearly across the block, so the
+ * inner loops are simple and can be vectorized by the compiler.  This
+ * requires that every tap is longer than the audio block
+ * (MOD_MULTITAP_DELAY_MIN_DELAY) so taps never read samples that are written
+ * during the same block.
+ *
+ * The last word of each delay line is used as a guard sample (a copy of the
+ * first word) so the interpolation never needs to wrap.
+ *
+ * The modulation depth of a tap is limited so that its delay never changes by
+ * more than one sample per sample (depth * 2 * pi * rate <= sample rate), so
+ * the read head always moves forwards through the delay line.
+ *
+ * When a tap's offset is modified, it glides to the new offset over
+ * MOD_MT_DELAY_OFFSET_TRANS_STEPS samples (as integer_delay_lpf.c does for
+ * length changes) rather than jumping, which would scrub the read head
+ * through the delay line within one block.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "modulated_delay_multitap.h"
+#include "audio_utilities.h"
+#include "oscillators.h"
+
+// Min/max limits and other constants
+#define MOD_MT_DELAY_GAIN_MIN       (-1.0)
+#define MOD_MT_DELAY_GAIN_MAX       (1.0)
+#define MOD_MT_DELAY_PAN_MIN        (-1.0)
+#define MOD_MT_DELAY_PAN_MAX        (1.0)
+#define MOD_MT_DELAY_TONE_HZ_MIN    (10.0)
+#define MOD_MT_DELAY_TONE_HZ_MAX    (20000.0)
+#define MOD_MT_DELAY_RATE_HZ_MIN    (0.0)
+#define MOD_MT_DELAY_RATE_HZ_MAX    (10.0)
+#define MOD_MT_DELAY_FEEDBACK_MIN   (-1.0)
+#define MOD_MT_DELAY_FEEDBACK_MAX   (1.0)
+#define MOD_MT_DELAY_SLEW_MAX       (1.0)       // Max delay change in samples per sample
+#define MOD_MT_DELAY_OFFSET_TRANS_STEPS (16000) // Samples an offset change glides over
+
+// Static function prototypes
+static RESULT_MOD_MT_DELAY mod_multitap_delay_configure_tap(MOD_MULTITAP_DELAY * c,
+                                                            MOD_MULTITAP_TAP * t,
+                                                            MOD_MULTITAP_TAP_PARAMS * params);
+
+
+/**
+ * @brief Initializes instance of a modulated multi-tap delay
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line_left Pointer to left delay line
+ * @param delay_line_right Pointer to right delay line
+ * @param delay_line_size Length of each delay line in floating point words
+ * @param num_taps Number of delay line taps
+ * @param taps A pointer to an array of parameters for each tap
+ * @param feedthrough The clean mix of audio passed through
+ * @param audio_sample_rate The system audio sample rate
+ * @return Modulated multitap delay result (enumeration)
+ *
+ * Out of range tap parameters are clipped as in mod_multitap_delay_modify_tap().
+ * The delay is still set up and the flag for the last clipped parameter is
+ * returned.
+ */
+RESULT_MOD_MT_DELAY mod_multitap_delay_setup(MOD_MULTITAP_DELAY * c,
+                                             float * delay_line_left,
+                                             float * delay_line_right,
+                                             uint32_t delay_line_size,
+                                             uint32_t num_taps,
+                                             MOD_MULTITAP_TAP_PARAMS * taps,
+                                             float feedthrough,
+                                             float audio_sample_rate) {
+
+    if (c == NULL) {
+        return MOD_MT_DELAY_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (delay_line_left == NULL || delay_line_right == NULL) {
+        return MOD_MT_DELAY_INVALID_DELAY_LINE_POINTER;
+    }
+
+    // The shortest tap plus the guard sample has to fit in the delay line
+    if (delay_line_size < MOD_MULTITAP_DELAY_MIN_DELAY + 3) {
+        return MOD_MT_DELAY_INVALID_DELAY_LINE_LEN;
+    }
+
+    if (num_taps > MOD_MULTITAP_DELAY_MAX_TAPS) {
+        return MOD_MT_DELAY_TOO_MANY_TAPS;
+    }
+
+    if (taps == NULL) {
+        return MOD_MT_DELAY_INVALID_TAPS_POINTER;
+    }
+
+    // Set delay parameters (last word of each line is the guard sample)
+    c->delay_line_left = delay_line_left;
+    c->delay_line_right = delay_line_right;
+    c->delay_line_len = delay_line_size - 1;
+    c->feedthrough = feedthrough;
+    c->audio_sample_rate = audio_sample_rate;
+
+    RESULT_MOD_MT_DELAY res = MOD_MT_DELAY_OK;
+    c->num_taps = num_taps;
+    for (int tap=0;tap<c->num_taps;tap++) {
+        RESULT_MOD_MT_DELAY tap_res = mod_multitap_delay_configure_tap(c, &c->taps[tap], &taps[tap]);
+        if (tap_res != MOD_MT_DELAY_OK) {
+            res = tap_res;
+        }
+        c->taps[tap].offset = c->taps[tap].offset_target;
+        c->taps[tap].offset_steps = 0;
+        c->taps[tap].lfo_t = taps[tap].mod_phase - floor(taps[tap].mod_phase);
+        c->taps[tap].delay_last = c->taps[tap].offset +
+                                  c->taps[tap].mod_depth*oscillator_sine(c->taps[tap].lfo_t);
+        c->taps[tap].tone_hist = 0.0;
+    }
+
+    // Zero delay lines
+    for (int i=0;i<delay_line_size;i++) {
+        delay_line_left[i] = 0.0;
+        delay_line_right[i] = 0.0;
+    }
+    c->write_index = 0;
+
+    c->initialized = true;
+    return res;
+}
+
+/**
+ * @brief Modify the parameters of a single tap
+ *
+ * If an input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * The LFO phase of the tap is left untouched so the modulation stays
+ * continuous, and a new offset is glided to over
+ * MOD_MT_DELAY_OFFSET_TRANS_STEPS samples (which bends the pitch of the tap).
+ *
+ * @param c Pointer to instance structure
+ * @param tap Index of the tap to modify
+ * @param params Pointer to the new tap parameters
+ *
+ * @return Modulated multitap delay result (enumeration)
+ */
+RESULT_MOD_MT_DELAY mod_multitap_delay_modify_tap(MOD_MULTITAP_DELAY * c,
+                                                  uint32_t tap,
+                                                  MOD_MULTITAP_TAP_PARAMS * params) {
+
+    if (c == NULL) {
+        return MOD_MT_DELAY_INVALID_INSTANCE_POINTER;
+    }
+
+    if (tap >= c->num_taps) {
+        return MOD_MT_DELAY_TOO_MANY_TAPS;
+    }
+
+    if (params == NULL) {
+        return MOD_MT_DELAY_INVALID_TAPS_POINTER;
+    }
+
+    MOD_MULTITAP_TAP * t = &c->taps[tap];
+    RESULT_MOD_MT_DELAY res = mod_multitap_delay_configure_tap(c, t, params);
+
+    if (t->offset_target != t->offset) {
+        t->offset_inc = (t->offset_target - t->offset) * (1.0/MOD_MT_DELAY_OFFSET_TRANS_STEPS);
+        t->offset_steps = MOD_MT_DELAY_OFFSET_TRANS_STEPS;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * The input and output buffers may be the same buffers (in place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in_left Pointer to floating point audio input buffer (left)
+ * @param audio_in_right Pointer to floating point audio input buffer (right)
+ * @param audio_out_left Pointer to floating point audio output buffer (left)
+ * @param audio_out_right Pointer to floating point audio output buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    mod_multitap_delay_read(MOD_MULTITAP_DELAY * c,
+                                float * audio_in_left,
+                                float * audio_in_right,
+                                float * audio_out_left,
+                                float * audio_out_right,
+                                uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out_left[i] = audio_in_left[i];
+            audio_out_right[i] = audio_in_right[i];
+        }
+        return;
+    }
+
+    float   tap_span[MAX_AUDIO_BLOCK_SIZE];
+    float   wet_left[MAX_AUDIO_BLOCK_SIZE], wet_right[MAX_AUDIO_BLOCK_SIZE];
+    float   fb_left[MAX_AUDIO_BLOCK_SIZE], fb_right[MAX_AUDIO_BLOCK_SIZE];
+
+    uint32_t    len = c->delay_line_len;
+    float       len_f = (float) len;
+    uint32_t    write_indx = c->write_index;
+    float       inv_block_size = 1.0/(float) audio_block_size;
+
+    clear_buffer(wet_left, audio_block_size);
+    clear_buffer(wet_right, audio_block_size);
+    clear_buffer(fb_left, audio_block_size);
+    clear_buffer(fb_right, audio_block_size);
+
+    // Process each tap across the full block
+    for (int tap=0;tap<c->num_taps;tap++) {
+
+        MOD_MULTITAP_TAP * t = &c->taps[tap];
+        float * line = (t->source == MOD_MT_SOURCE_RIGHT) ? c->delay_line_right : c->delay_line_left;
+
+        // Glide the offset towards a new value
+        if (t->offset_steps) {
+            uint32_t steps = (t->offset_steps < audio_block_size) ? t->offset_steps : audio_block_size;
+            t->offset += t->offset_inc*(float) steps;
+            t->offset_steps -= steps;
+            if (t->offset_steps == 0) {
+                t->offset = t->offset_target;
+            }
+        }
+
+        // Evaluate LFO once for the end of this block and ramp delay towards it.
+        // The delay is kept in range in case the depth grew part way through
+        // an offset glide.
+        float lfo_t = t->lfo_t + t->lfo_inc*(float) audio_block_size;
+        lfo_t = lfo_t - floor(lfo_t);
+        float delay_end = t->offset + t->mod_depth*oscillator_sine(lfo_t);
+        if (delay_end < (float) MOD_MULTITAP_DELAY_MIN_DELAY) {
+            delay_end = (float) MOD_MULTITAP_DELAY_MIN_DELAY;
+        }
+        else if (delay_end > (float) (len - 1)) {
+            delay_end = (float) (len - 1);
+        }
+        float read_inc = 1.0 - (delay_end - t->delay_last)*inv_block_size;
+
+        float read_pos = (float) write_indx - t->delay_last;
+        if (read_pos < 0.0) {
+            read_pos += len_f;
+        }
+
+        // Read (interpolated) span of this tap
+        for (int i=0;i<audio_block_size;i++) {
+            uint32_t indx = (uint32_t) read_pos;
+            float delta = read_pos - (float) indx;
+            tap_span[i] = line[indx] + delta*(line[indx+1] - line[indx]);
+            read_pos += read_inc;
+            if (read_pos >= len_f) {
+                read_pos -= len_f;
+            }
+            else if (read_pos < 0.0) {
+                read_pos += len_f;
+            }
+        }
+
+        // Tone filter the span and mix it into the outputs and feedback sends
+        float   tone_hist = t->tone_hist;
+        float   tone_coeff = t->tone_coeff;
+        float   gain_l = t->gain_left, gain_r = t->gain_right;
+        float   fb_l = t->feedback_left, fb_r = t->feedback_right;
+        for (int i=0;i<audio_block_size;i++) {
+            tone_hist += tone_coeff * (tap_span[i] - tone_hist);
+            wet_left[i] += tone_hist*gain_l;
+            wet_right[i] += tone_hist*gain_r;
+            fb_left[i] += tone_hist*fb_l;
+            fb_right[i] += tone_hist*fb_r;
+        }
+
+        // Save tap state
+        t->tone_hist = tone_hist;
+        t->lfo_t = lfo_t;
+        t->delay_last = delay_end;
+    }
+
+    // Write input and feedback into delay lines and mix outputs
+    float * line_l = c->delay_line_left;
+    float * line_r = c->delay_line_right;
+    float   feedthrough = c->feedthrough;
+    for (int i=0;i<audio_block_size;i++) {
+        float in_l = audio_in_left[i];
+        float in_r = audio_in_right[i];
+
+        line_l[write_indx] = in_l + fb_left[i];
+        line_r[write_indx] = in_r + fb_right[i];
+        if (write_indx == 0) {
+            line_l[len] = line_l[0];
+            line_r[len] = line_r[0];
+        }
+
+        audio_out_left[i] = in_l*feedthrough + wet_left[i];
+        audio_out_right[i] = in_r*feedthrough + wet_right[i];
+
+        write_indx++;
+        if (write_indx >= len) {
+            write_indx = 0;
+        }
+    }
+
+    // Store index back into instance struct
+    c->write_index = write_indx;
+}
+
+/**
+ * @brief Validate tap parameters and compute the tap's coefficients
+ *
+ * Out of range values are clipped to the corresponding min/max.
+ *
+ * @param c Pointer to instance structure
+ * @param t Pointer to tap state
+ * @param params Pointer to tap parameters
+ * @return Modulated multitap delay result (enumeration)
+ */
+static RESULT_MOD_MT_DELAY mod_multitap_delay_configure_tap(MOD_MULTITAP_DELAY * c,
+                                                            MOD_MULTITAP_TAP * t,
+                                                            MOD_MULTITAP_TAP_PARAMS * params) {
+
+    RESULT_MOD_MT_DELAY res = MOD_MT_DELAY_OK;
+
+    float gain = params->gain;
+    if (gain > MOD_MT_DELAY_GAIN_MAX) {
+        gain = MOD_MT_DELAY_GAIN_MAX;
+        res = MOD_MT_DELAY_INVALID_GAIN;
+    } else if (gain < MOD_MT_DELAY_GAIN_MIN) {
+        gain = MOD_MT_DELAY_GAIN_MIN;
+        res = MOD_MT_DELAY_INVALID_GAIN;
+    }
+
+    float pan = params->pan;
+    if (pan > MOD_MT_DELAY_PAN_MAX) {
+        pan = MOD_MT_DELAY_PAN_MAX;
+        res = MOD_MT_DELAY_INVALID_PAN;
+    } else if (pan < MOD_MT_DELAY_PAN_MIN) {
+        pan = MOD_MT_DELAY_PAN_MIN;
+        res = MOD_MT_DELAY_INVALID_PAN;
+    }
+
+    float tone_hz = params->tone_hz;
+    if (tone_hz > MOD_MT_DELAY_TONE_HZ_MAX) {
+        tone_hz = MOD_MT_DELAY_TONE_HZ_MAX;
+        res = MOD_MT_DELAY_INVALID_TONE;
+    } else if (tone_hz < MOD_MT_DELAY_TONE_HZ_MIN) {
+        tone_hz = MOD_MT_DELAY_TONE_HZ_MIN;
+        res = MOD_MT_DELAY_INVALID_TONE;
+    }
+
+    float rate_hz = params->mod_rate_hz;
+    if (rate_hz > MOD_MT_DELAY_RATE_HZ_MAX) {
+        rate_hz = MOD_MT_DELAY_RATE_HZ_MAX;
+        res = MOD_MT_DELAY_INVALID_RATE;
+    } else if (rate_hz < MOD_MT_DELAY_RATE_HZ_MIN) {
+        rate_hz = MOD_MT_DELAY_RATE_HZ_MIN;
+        res = MOD_MT_DELAY_INVALID_RATE;
+    }
+
+    float feedback_left = params->feedback_left;
+    if (feedback_left > MOD_MT_DELAY_FEEDBACK_MAX) {
+        feedback_left = MOD_MT_DELAY_FEEDBACK_MAX;
+        res = MOD_MT_DELAY_INVALID_FEEDBACK;
+    } else if (feedback_left < MOD_MT_DELAY_FEEDBACK_MIN) {
+        feedback_left = MOD_MT_DELAY_FEEDBACK_MIN;
+        res = MOD_MT_DELAY_INVALID_FEEDBACK;
+    }
+
+    float feedback_right = params->feedback_right;
+    if (feedback_right > MOD_MT_DELAY_FEEDBACK_MAX) {
+        feedback_right = MOD_MT_DELAY_FEEDBACK_MAX;
+        res = MOD_MT_DELAY_INVALID_FEEDBACK;
+    } else if (feedback_right < MOD_MT_DELAY_FEEDBACK_MIN) {
+        feedback_right = MOD_MT_DELAY_FEEDBACK_MIN;
+        res = MOD_MT_DELAY_INVALID_FEEDBACK;
+    }
+
+    // Limit the depth so the read head never runs backwards
+    float mod_depth = fabs(params->mod_depth);
+    float depth_max = (rate_hz > 0.0) ?
+                      MOD_MT_DELAY_SLEW_MAX * c->audio_sample_rate / (PI2 * rate_hz) :
+                      mod_depth;
+    if (mod_depth > depth_max) {
+        mod_depth = depth_max;
+        res = MOD_MT_DELAY_INVALID_DEPTH;
+    }
+
+    // Limit the depth so the full LFO swing fits between the shortest tap and
+    // the end of the delay line
+    float span = (float) (c->delay_line_len - 1 - MOD_MULTITAP_DELAY_MIN_DELAY);
+    if (2.0*mod_depth > span) {
+        mod_depth = 0.5*span;
+        res = MOD_MT_DELAY_INVALID_DEPTH;
+    }
+
+    // Keep the modulated tap inside the delay line and longer than one block
+    float offset = params->offset;
+    if (offset + mod_depth > (float) (c->delay_line_len - 1)) {
+        offset = (float) (c->delay_line_len - 1) - mod_depth;
+        res = MOD_MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN;
+    }
+    if (offset - mod_depth < (float) MOD_MULTITAP_DELAY_MIN_DELAY) {
+        offset = (float) MOD_MULTITAP_DELAY_MIN_DELAY + mod_depth;
+        res = MOD_MT_DELAY_TAP_TOO_SHORT;
+    }
+
+    // Update tap state (equal-power pan law).  The offset itself is set by
+    // the caller, either straight away or as a glide.
+    t->source = params->source;
+    t->offset_target = offset;
+    t->mod_depth = mod_depth;
+    t->lfo_inc = rate_hz/c->audio_sample_rate;
+
+    float pan_angle = (pan + 1.0) * 0.25 * PI;
+    t->gain_left = gain * cosf(pan_angle);
+    t->gain_right = gain * sinf(pan_angle);
+
+    t->feedback_left = feedback_left;
+    t->feedback_right = feedback_right;
+
+    t->tone_coeff = gen_1pole_coeff(tone_hz, c->audio_sample_rate);
+
+    return res;
+}
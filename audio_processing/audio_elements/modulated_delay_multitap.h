@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _MODULATED_DELAY_MULTITAP_H
+#define _MODULATED_DELAY_MULTITAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define     MOD_MULTITAP_DELAY_MAX_TAPS     (32)
+
+/**
+ * Taps are processed one full block at a time so the shortest delay must be
+ * longer than the largest audio block (plus one sample for interpolation).
+ */
+#define     MOD_MULTITAP_DELAY_MIN_DELAY    (MAX_AUDIO_BLOCK_SIZE+2)
+
+// Result enumerations
+typedef enum
+{
+    MOD_MT_DELAY_OK,
+    MOD_MT_DELAY_INVALID_INSTANCE_POINTER,
+    MOD_MT_DELAY_INVALID_DELAY_LINE_POINTER,
+    MOD_MT_DELAY_INVALID_DELAY_LINE_LEN,
+    MOD_MT_DELAY_INVALID_TAPS_POINTER,
+    MOD_MT_DELAY_TOO_MANY_TAPS,
+    MOD_MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN,
+    MOD_MT_DELAY_TAP_TOO_SHORT,
+    MOD_MT_DELAY_INVALID_GAIN,
+    MOD_MT_DELAY_INVALID_PAN,
+    MOD_MT_DELAY_INVALID_TONE,
+    MOD_MT_DELAY_INVALID_RATE,
+    MOD_MT_DELAY_INVALID_DEPTH,
+    MOD_MT_DELAY_INVALID_FEEDBACK
+} RESULT_MOD_MT_DELAY;
+
+// Delay line that a tap reads from
+typedef enum
+{
+    MOD_MT_SOURCE_LEFT,
+    MOD_MT_SOURCE_RIGHT
+} MOD_MT_DELAY_SOURCE;
+
+// Parameters used to set up / modify a single tap
+typedef struct {
+    MOD_MT_DELAY_SOURCE source;     // Delay line the tap reads from
+    float   offset;                 // Center delay in samples
+    float   gain;                   // Tap gain (-1.0->1.0)
+    float   pan;                    // Stereo position (-1.0 = left, 1.0 = right)
+    float   tone_hz;                // Cutoff of the tap's one-pole low-pass filter
+    float   mod_depth;              // LFO depth in samples
+    float   mod_rate_hz;            // LFO rate in Hz
+    float   mod_phase;              // Initial LFO phase (0.0->1.0)
+    float   feedback_left;          // Amount of tap fed back into left delay line
+    float   feedback_right;         // Amount of tap fed back into right delay line
+} MOD_MULTITAP_TAP_PARAMS;
+
+// Per-tap state
+typedef struct {
+    MOD_MT_DELAY_SOURCE source;
+    float   offset;
+    float   offset_target;          // Offset being glided to after a modify
+    float   offset_inc;             // Per sample
+    uint32_t    offset_steps;       // Samples left in the glide
+    float   mod_depth;
+    float   lfo_t;
+    float   lfo_inc;
+    float   delay_last;
+
+    float   gain_left;
+    float   gain_right;
+    float   feedback_left;
+    float   feedback_right;
+
+    float   tone_coeff;
+    float   tone_hist;
+} MOD_MULTITAP_TAP;
+
+// C struct with parameters and state information
+typedef struct  {
+    bool        initialized;
+
+    float    *  delay_line_left;
+    float    *  delay_line_right;
+    uint32_t    delay_line_len;
+    uint32_t    write_index;
+
+    MOD_MULTITAP_TAP    taps[MOD_MULTITAP_DELAY_MAX_TAPS];
+    uint32_t    num_taps;
+
+    float       feedthrough;
+    float       audio_sample_rate;
+} MOD_MULTITAP_DELAY;
+
+
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_MOD_MT_DELAY mod_multitap_delay_setup(MOD_MULTITAP_DELAY * c,
+                                             float * delay_line_left,
+                                             float * delay_line_right,
+                                             uint32_t delay_line_size,
+                                             uint32_t num_taps,
+                                             MOD_MULTITAP_TAP_PARAMS * taps,
+                                             float feedthrough,
+                                             float audio_sample_rate);
+
+RESULT_MOD_MT_DELAY mod_multitap_delay_modify_tap(MOD_MULTITAP_DELAY * c,
+                                                  uint32_t tap,
+                                                  MOD_MULTITAP_TAP_PARAMS * params);
+
+void    mod_multitap_delay_read(MOD_MULTITAP_DELAY * c,
+                                float * audio_in_left,
+                                float * audio_in_right,
+                                float * audio_out_left,
+                                float * audio_out_right,
+                                uint32_t audio_block_size);
+
+#if __cplusplus
+}
+#endif
+
+
+#endif  // _MODULATED_DELAY_MULTITAP_H
@@ -0,0 +1,551 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A noise gate mutes (or strongly attenuates) a signal when it falls below a
+ * threshold.  With guitar this removes the hiss and hum from the pickups
+ * between notes, which is especially noticeable after high gain distortion.
+ *
+ * Features of this implementation:
+ *
+ *  - Hysteresis: the gate opens when the level rises above the open
+ *    threshold and only starts to close once it falls below a lower close
+ *    threshold.  This stops the gate chattering on notes that decay around
+ *    the threshold.
+ *  - Hold: once the level falls below the close threshold, the gate stays
+ *    open for the hold time before closing.
+ *  - Lookahead: the audio path is delayed by a few milliseconds so the gate
+ *    is already open when the attack of a note arrives.
+ *  - Sidechain filter: the level detector listens to a high-passed copy of
+ *    the input so low frequency hum and rumble don't hold the gate open.
+ *  - Expander mode: when closed, the signal is attenuated by 'ratio' dB per
+ *    dB below the open threshold (limited by 'range').  A high ratio gives a
+ *    classic gate, a low ratio a gentle downward expander.
+ *
+ * The detector and gate logic run at a control rate of one update every
+ * NOISE_GATE_CONTROL_PERIOD samples and the gain is ramped between updates.
+ *
+ * noise_gate_read() returns true when the gate was fully closed for the
+ * whole block (the output is silent).  Effects downstream of the gate can
+ * use this to skip expensive processing.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "noise_gate.h"
+
+// Min/max limits and other constants
+#define NOISE_GATE_THRESHOLD_MIN        (-100.0)
+#define NOISE_GATE_THRESHOLD_MAX        (0.0)
+#define NOISE_GATE_HOLD_MS_MIN          (0.0)
+#define NOISE_GATE_HOLD_MS_MAX          (2000.0)
+#define NOISE_GATE_RELEASE_MS_MIN       (1.0)
+#define NOISE_GATE_RELEASE_MS_MAX       (2000.0)
+#define NOISE_GATE_RANGE_MIN            (-100.0)
+#define NOISE_GATE_RANGE_MAX            (0.0)
+#define NOISE_GATE_RATIO_MIN            (1.0)
+#define NOISE_GATE_RATIO_MAX            (100.0)
+#define NOISE_GATE_SIDECHAIN_FREQ_MIN   (20.0)
+#define NOISE_GATE_SIDECHAIN_FREQ_MAX   (2000.0)
+
+#define NOISE_GATE_CONTROL_PERIOD       (8)         // Samples per gain update
+#define NOISE_GATE_ATTACK_MS            (0.5)       // Gain attack when opening
+#define NOISE_GATE_DETECTOR_ATTACK_MS   (1.0)
+#define NOISE_GATE_DETECTOR_RELEASE_MS  (20.0)
+#define NOISE_GATE_DEFAULT_RANGE_DB     (-80.0)
+#define NOISE_GATE_DEFAULT_RATIO        (NOISE_GATE_RATIO_MAX)
+#define NOISE_GATE_DEFAULT_SIDECHAIN_HZ (100.0)
+#define NOISE_GATE_CLOSED_MARGIN        (1.01)      // Gain within 1% of range
+
+// Static function prototypes
+static float    noise_gate_coeff(NOISE_GATE * c, float time_ms);
+static uint32_t noise_gate_hold_periods(NOISE_GATE * c, float hold_ms);
+
+
+/**
+ * @brief Initializes instance of a noise gate
+ *
+ * The gate is set up with a range of -80dB, a hard gate ratio and a 100Hz
+ * sidechain high-pass filter.  These can be changed with the modify functions.
+ *
+ * @param c Pointer to instance structure
+ * @param open_threshold_db Level at which the gate opens (-100.0->0.0 dB)
+ * @param close_threshold_db Level at which the gate closes (<= open threshold)
+ * @param hold_ms Time the gate is held open after the level falls below the
+ *                close threshold (0.0->2000.0 ms)
+ * @param release_ms Time constant of the gate closing (1.0->2000.0 ms)
+ * @param lookahead_ms Delay of the audio path relative to the detector
+ *                     (0 -> NOISE_GATE_MAX_LOOKAHEAD samples)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_setup(NOISE_GATE * c,
+                                     float open_threshold_db,
+                                     float close_threshold_db,
+                                     float hold_ms,
+                                     float release_ms,
+                                     float lookahead_ms,
+                                     float audio_sample_rate) {
+
+    if (c == NULL) {
+        return NOISE_GATE_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (open_threshold_db < NOISE_GATE_THRESHOLD_MIN ||
+        open_threshold_db > NOISE_GATE_THRESHOLD_MAX ||
+        close_threshold_db < NOISE_GATE_THRESHOLD_MIN ||
+        close_threshold_db > open_threshold_db) {
+        return NOISE_GATE_INVALID_THRESHOLD;
+    }
+
+    if (hold_ms < NOISE_GATE_HOLD_MS_MIN ||
+        hold_ms > NOISE_GATE_HOLD_MS_MAX) {
+        return NOISE_GATE_INVALID_HOLD;
+    }
+
+    if (release_ms < NOISE_GATE_RELEASE_MS_MIN ||
+        release_ms > NOISE_GATE_RELEASE_MS_MAX) {
+        return NOISE_GATE_INVALID_RELEASE;
+    }
+
+    uint32_t lookahead_len = (uint32_t) (lookahead_ms*1e-3*audio_sample_rate);
+    if (lookahead_ms < 0.0 || lookahead_len > NOISE_GATE_MAX_LOOKAHEAD) {
+        return NOISE_GATE_INVALID_LOOKAHEAD;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->open_threshold_db = open_threshold_db;
+    c->close_threshold_db = close_threshold_db;
+
+    c->range_db = NOISE_GATE_DEFAULT_RANGE_DB;
+    c->range_gain = powf(10.0, c->range_db/20.0);
+    c->ratio = NOISE_GATE_DEFAULT_RATIO;
+
+    c->hold_ms = hold_ms;
+    c->hold_periods = noise_gate_hold_periods(c, hold_ms);
+    c->hold_counter = 0;
+
+    c->release_ms = release_ms;
+    c->attack_coeff = noise_gate_coeff(c, NOISE_GATE_ATTACK_MS);
+    c->release_coeff = noise_gate_coeff(c, release_ms);
+
+    // Start closed
+    c->state = NOISE_GATE_STATE_CLOSED;
+    c->gain = c->range_gain;
+
+    // Sidechain filter and level detector
+    filter_setup(&c->sidechain_hpf,
+                 BIQUAD_TYPE_HPF,
+                 BIQUAD_TRANS_MED,
+                 (pm float *) c->sidechain_coeffs,
+                 NOISE_GATE_DEFAULT_SIDECHAIN_HZ,
+                 0.707,
+                 1.0,
+                 audio_sample_rate);
+
+    envelope_follower_setup(&c->detector,
+                            ENV_FOLLOWER_LOG,
+                            NOISE_GATE_DETECTOR_ATTACK_MS,
+                            NOISE_GATE_DETECTOR_RELEASE_MS,
+                            NOISE_GATE_CONTROL_PERIOD,
+                            audio_sample_rate);
+
+    // Lookahead delay
+    c->lookahead_len = lookahead_len;
+    c->lookahead_index = 0;
+    for (int i=0;i<NOISE_GATE_MAX_LOOKAHEAD;i++) {
+        c->lookahead_line[i] = 0.0;
+    }
+
+    c->initialized = true;
+    return NOISE_GATE_OK;
+}
+
+/**
+ * @brief Modify the open and close thresholds
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  The close threshold is clipped so that it is never
+ * above the open threshold.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param open_threshold_db_new Updated open threshold (-100.0->0.0 dB)
+ * @param close_threshold_db_new Updated close threshold (-100.0->open threshold)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_thresholds(NOISE_GATE * c,
+                                                 float open_threshold_db_new,
+                                                 float close_threshold_db_new) {
+
+    RESULT_NOISE_GATE res = NOISE_GATE_OK;
+
+    float open_threshold_db = open_threshold_db_new;
+    if (open_threshold_db > NOISE_GATE_THRESHOLD_MAX) {
+        open_threshold_db = NOISE_GATE_THRESHOLD_MAX;
+        res = NOISE_GATE_INVALID_THRESHOLD;
+    }
+    else if (open_threshold_db < NOISE_GATE_THRESHOLD_MIN) {
+        open_threshold_db = NOISE_GATE_THRESHOLD_MIN;
+        res = NOISE_GATE_INVALID_THRESHOLD;
+    }
+
+    float close_threshold_db = close_threshold_db_new;
+    if (close_threshold_db > open_threshold_db) {
+        close_threshold_db = open_threshold_db;
+        res = NOISE_GATE_INVALID_THRESHOLD;
+    }
+    else if (close_threshold_db < NOISE_GATE_THRESHOLD_MIN) {
+        close_threshold_db = NOISE_GATE_THRESHOLD_MIN;
+        res = NOISE_GATE_INVALID_THRESHOLD;
+    }
+
+    c->open_threshold_db = open_threshold_db;
+    c->close_threshold_db = close_threshold_db;
+
+    return res;
+}
+
+/**
+ * @brief Modify the hold time
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param hold_ms_new Updated hold time (0.0->2000.0 ms)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_hold(NOISE_GATE * c,
+                                           float hold_ms_new) {
+
+    RESULT_NOISE_GATE res;
+
+    float hold_ms;
+    if (hold_ms_new > NOISE_GATE_HOLD_MS_MAX) {
+        hold_ms = NOISE_GATE_HOLD_MS_MAX;
+        res = NOISE_GATE_INVALID_HOLD;
+    }
+    else if (hold_ms_new < NOISE_GATE_HOLD_MS_MIN) {
+        hold_ms = NOISE_GATE_HOLD_MS_MIN;
+        res = NOISE_GATE_INVALID_HOLD;
+    }
+    else {
+        hold_ms = hold_ms_new;
+        res = NOISE_GATE_OK;
+    }
+
+    c->hold_ms = hold_ms;
+    c->hold_periods = noise_gate_hold_periods(c, hold_ms);
+
+    return res;
+}
+
+/**
+ * @brief Modify the release time
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param release_ms_new Updated release time constant (1.0->2000.0 ms)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_release(NOISE_GATE * c,
+                                              float release_ms_new) {
+
+    RESULT_NOISE_GATE res;
+
+    float release_ms;
+    if (release_ms_new > NOISE_GATE_RELEASE_MS_MAX) {
+        release_ms = NOISE_GATE_RELEASE_MS_MAX;
+        res = NOISE_GATE_INVALID_RELEASE;
+    }
+    else if (release_ms_new < NOISE_GATE_RELEASE_MS_MIN) {
+        release_ms = NOISE_GATE_RELEASE_MS_MIN;
+        res = NOISE_GATE_INVALID_RELEASE;
+    }
+    else {
+        release_ms = release_ms_new;
+        res = NOISE_GATE_OK;
+    }
+
+    if (release_ms != c->release_ms) {
+        c->release_ms = release_ms;
+        c->release_coeff = noise_gate_coeff(c, release_ms);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Modify the range (attenuation when the gate is fully closed)
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param range_db_new Updated range (-100.0->0.0 dB)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_range(NOISE_GATE * c,
+                                            float range_db_new) {
+
+    RESULT_NOISE_GATE res;
+
+    float range_db;
+    if (range_db_new > NOISE_GATE_RANGE_MAX) {
+        range_db = NOISE_GATE_RANGE_MAX;
+        res = NOISE_GATE_INVALID_RANGE;
+    }
+    else if (range_db_new < NOISE_GATE_RANGE_MIN) {
+        range_db = NOISE_GATE_RANGE_MIN;
+        res = NOISE_GATE_INVALID_RANGE;
+    }
+    else {
+        range_db = range_db_new;
+        res = NOISE_GATE_OK;
+    }
+
+    if (range_db != c->range_db) {
+        c->range_db = range_db;
+        c->range_gain = powf(10.0, range_db/20.0);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Modify the expansion ratio applied when the gate is closed
+ *
+ * A ratio of 2.0 attenuates the signal by 2dB for every dB it is below the
+ * open threshold.  The maximum ratio behaves as a hard gate.
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param ratio_new Updated ratio (1.0->100.0)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_ratio(NOISE_GATE * c,
+                                            float ratio_new) {
+
+    RESULT_NOISE_GATE res;
+
+    float ratio;
+    if (ratio_new > NOISE_GATE_RATIO_MAX) {
+        ratio = NOISE_GATE_RATIO_MAX;
+        res = NOISE_GATE_INVALID_RATIO;
+    }
+    else if (ratio_new < NOISE_GATE_RATIO_MIN) {
+        ratio = NOISE_GATE_RATIO_MIN;
+        res = NOISE_GATE_INVALID_RATIO;
+    }
+    else {
+        ratio = ratio_new;
+        res = NOISE_GATE_OK;
+    }
+
+    c->ratio = ratio;
+
+    return res;
+}
+
+/**
+ * @brief Modify the cutoff frequency of the sidechain high-pass filter
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param freq_new Updated cutoff frequency (20.0->2000.0 Hz)
+ * @return Noise gate result (enumeration)
+ */
+RESULT_NOISE_GATE   noise_gate_modify_sidechain_freq(NOISE_GATE * c,
+                                                     float freq_new) {
+
+    RESULT_NOISE_GATE res;
+
+    float freq;
+    if (freq_new > NOISE_GATE_SIDECHAIN_FREQ_MAX) {
+        freq = NOISE_GATE_SIDECHAIN_FREQ_MAX;
+        res = NOISE_GATE_INVALID_SIDECHAIN_FREQ;
+    }
+    else if (freq_new < NOISE_GATE_SIDECHAIN_FREQ_MIN) {
+        freq = NOISE_GATE_SIDECHAIN_FREQ_MIN;
+        res = NOISE_GATE_INVALID_SIDECHAIN_FREQ;
+    }
+    else {
+        freq = freq_new;
+        res = NOISE_GATE_OK;
+    }
+
+    filter_modify_freq(&c->sidechain_hpf, freq);
+
+    return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * The audio can be processed in place (audio_in == audio_out).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ * @return true if the gate was fully closed for the whole block
+ */
+#pragma optimize_for_speed
+bool    noise_gate_read(NOISE_GATE * c,
+                        float * audio_in,
+                        float * audio_out,
+                        uint32_t audio_block_size) {
+
+    // If this instance hasn't been properly initialized, pass audio through
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            audio_out[i] = audio_in[i];
+        }
+        return false;
+    }
+
+    float sidechain[MAX_AUDIO_BLOCK_SIZE];
+    float level_db[MAX_AUDIO_BLOCK_SIZE/NOISE_GATE_CONTROL_PERIOD+1];
+
+    // Measure the level of the filtered sidechain signal
+    filter_read(&c->sidechain_hpf, audio_in, sidechain, audio_block_size);
+    float level_end = envelope_follower_read(&c->detector,
+                                             sidechain,
+                                             level_db,
+                                             audio_block_size);
+    uint32_t num_levels = audio_block_size/NOISE_GATE_CONTROL_PERIOD;
+
+    float gain = c->gain;
+    bool fully_closed = true;
+
+    float * line = c->lookahead_line;
+    uint32_t la_len = c->lookahead_len;
+    uint32_t la_index = c->lookahead_index;
+
+    uint32_t k = 0;
+    for (int i=0;i<audio_block_size;i+=NOISE_GATE_CONTROL_PERIOD) {
+
+        uint32_t len = audio_block_size - i;
+        if (len > NOISE_GATE_CONTROL_PERIOD) {
+            len = NOISE_GATE_CONTROL_PERIOD;
+        }
+
+        float level = (k < num_levels) ? level_db[k] : level_end;
+        k++;
+
+        // Update gate state
+        if (level >= c->open_threshold_db) {
+            c->state = NOISE_GATE_STATE_OPEN;
+            c->hold_counter = c->hold_periods;
+        }
+        else if (c->state != NOISE_GATE_STATE_CLOSED) {
+            if (level >= c->close_threshold_db) {
+                c->hold_counter = c->hold_periods;
+            }
+            else if (c->hold_counter > 0) {
+                c->state = NOISE_GATE_STATE_HOLD;
+                c->hold_counter--;
+            }
+            else {
+                c->state = NOISE_GATE_STATE_CLOSED;
+            }
+        }
+
+        // Target gain (downward expansion below the open threshold when closed)
+        float target = 1.0;
+        if (c->state == NOISE_GATE_STATE_CLOSED) {
+            float target_db = (level - c->open_threshold_db)*(c->ratio - 1.0);
+            if (target_db < c->range_db) {
+                target = c->range_gain;
+            } else {
+                target = powf(10.0, target_db/20.0);
+            }
+        }
+
+        float coeff = (target > gain) ? c->attack_coeff : c->release_coeff;
+        float gain_new = gain + coeff*(target - gain);
+
+        // The gain is ramped from gain to gain_new, so both ends must be closed
+        float closed_gain = c->range_gain*NOISE_GATE_CLOSED_MARGIN;
+        if (gain > closed_gain || gain_new > closed_gain) {
+            fully_closed = false;
+        }
+
+        // Ramp gain across the control period and apply to delayed audio
+        float gain_step = (gain_new - gain)/(float) len;
+        for (int j=0;j<len;j++) {
+            gain += gain_step;
+            float x = audio_in[i+j];
+            if (la_len > 0) {
+                float delayed = line[la_index];
+                line[la_index] = x;
+                if (++la_index >= la_len) {
+                    la_index = 0;
+                }
+                x = delayed;
+            }
+            audio_out[i+j] = x*gain;
+        }
+        gain = gain_new;
+    }
+
+    c->gain = gain;
+    c->lookahead_index = la_index;
+
+    return fully_closed;
+}
+
+/**
+ * @brief Returns whether the gate is currently fully closed
+ *
+ * @param c Pointer to instance structure
+ * @return true if the gate is closed and its gain has reached the range
+ */
+bool    noise_gate_is_closed(NOISE_GATE * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+    return (c->state == NOISE_GATE_STATE_CLOSED &&
+            c->gain <= c->range_gain*NOISE_GATE_CLOSED_MARGIN);
+}
+
+/**
+ * @brief Calculates a control-rate one-pole coefficient from a time constant
+ *
+ * @param c Pointer to instance structure
+ * @param time_ms Time constant in ms
+ * @return Coefficient
+ */
+static float    noise_gate_coeff(NOISE_GATE * c, float time_ms) {
+
+    float control_rate = c->audio_sample_rate/NOISE_GATE_CONTROL_PERIOD;
+    return 1.0 - expf(-1.0/(1e-3*time_ms*control_rate));
+}
+
+/**
+ * @brief Converts a hold time into a number of control periods
+ *
+ * @param c Pointer to instance structure
+ * @param hold_ms Hold time in ms
+ * @return Number of control periods
+ */
+static uint32_t noise_gate_hold_periods(NOISE_GATE * c, float hold_ms) {
+
+    return (uint32_t) (hold_ms*1e-3*c->audio_sample_rate/NOISE_GATE_CONTROL_PERIOD);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _NOISE_GATE_H
+#define _NOISE_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "biquad_filter.h"
+#include "envelope_follower.h"
+
+#define NOISE_GATE_MAX_LOOKAHEAD    (256)       // In samples (~5ms at 48kHz)
+
+// Result enumerations
+typedef enum
+{
+    NOISE_GATE_OK,
+    NOISE_GATE_INVALID_INSTANCE_POINTER,
+    NOISE_GATE_INVALID_THRESHOLD,
+    NOISE_GATE_INVALID_HOLD,
+    NOISE_GATE_INVALID_RELEASE,
+    NOISE_GATE_INVALID_LOOKAHEAD,
+    NOISE_GATE_INVALID_RANGE,
+    NOISE_GATE_INVALID_RATIO,
+    NOISE_GATE_INVALID_SIDECHAIN_FREQ
+} RESULT_NOISE_GATE;
+
+// Gate states
+typedef enum
+{
+    NOISE_GATE_STATE_CLOSED,
+    NOISE_GATE_STATE_OPEN,
+    NOISE_GATE_STATE_HOLD
+} NOISE_GATE_STATE;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    NOISE_GATE_STATE    state;
+
+    float   open_threshold_db;
+    float   close_threshold_db;
+    float   range_db;
+    float   range_gain;
+    float   ratio;
+
+    float   hold_ms;
+    uint32_t    hold_periods;
+    uint32_t    hold_counter;
+
+    float   release_ms;
+    float   attack_coeff;
+    float   release_coeff;
+
+    float   gain;               // Current gain (linear)
+
+    // Sidechain (detector) path
+    BIQUAD_FILTER       sidechain_hpf;
+    float               sidechain_coeffs[6];
+    ENVELOPE_FOLLOWER   detector;
+
+    // Lookahead delay for the audio path
+    float       lookahead_line[NOISE_GATE_MAX_LOOKAHEAD];
+    uint32_t    lookahead_len;
+    uint32_t    lookahead_index;
+
+    float   audio_sample_rate;
+
+} NOISE_GATE;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_NOISE_GATE   noise_gate_setup(NOISE_GATE * c,
+                                     float open_threshold_db,
+                                     float close_threshold_db,
+                                     float hold_ms,
+                                     float release_ms,
+                                     float lookahead_ms,
+                                     float audio_sample_rate);
+
+RESULT_NOISE_GATE   noise_gate_modify_thresholds(NOISE_GATE * c,
+                                                 float open_threshold_db_new,
+                                                 float close_threshold_db_new);
+
+RESULT_NOISE_GATE   noise_gate_modify_hold(NOISE_GATE * c,
+                                           float hold_ms_new);
+
+RESULT_NOISE_GATE   noise_gate_modify_release(NOISE_GATE * c,
+                                              float release_ms_new);
+
+RESULT_NOISE_GATE   noise_gate_modify_range(NOISE_GATE * c,
+                                            float range_db_new);
+
+RESULT_NOISE_GATE   noise_gate_modify_ratio(NOISE_GATE * c,
+                                            float ratio_new);
+
+RESULT_NOISE_GATE   noise_gate_modify_sidechain_freq(NOISE_GATE * c,
+                                                     float freq_new);
+
+bool    noise_gate_read(NOISE_GATE * c,
+                        float * audio_in,
+                        float * audio_out,
+                        uint32_t audio_block_size);
+
+bool    noise_gate_is_closed(NOISE_GATE * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _NOISE_GATE_H
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A pitch detector based on the McLeod Pitch Method (MPM).  Rather than
+ * timing zero crossings, it measures how similar the waveform is to a
+ * delayed copy of itself using the normalized square difference function
+ * (NSDF):
+ *
+ *                      2 * sum( x[k] * x[k-tau] )
+ *      nsdf(tau) = ---------------------------------
+ *                   sum( x[k]^2 ) + sum( x[k-tau]^2 )
+ *
+ * The NSDF is 1.0 at a lag equal to the period of a perfectly periodic
+ * signal.  The first peak that comes close to the highest peak is taken as
+ * the period, which avoids locking onto harmonics (or sub-harmonics) the way
+ * a zero-crossing detector does on chords and bright tones.  The peak value
+ * is reported as a confidence measure (0.0 -> 1.0).
+ *
+ * To keep the cost per block low and bounded:
+ *
+ *  - The input is low-pass filtered and decimated by PITCH_DETECT_DECIMATION
+ *    before analysis (the fundamental of a guitar is well below 2kHz).
+ *  - The autocorrelation over the analysis window is updated incrementally:
+ *    for each new decimated sample, the product entering the window is added
+ *    and the product leaving it is subtracted.  The cost is 2 multiply/adds
+ *    per lag per decimated sample regardless of the window length.
+ *  - The window energy ending at each sample (lag 0 of the autocorrelation)
+ *    is kept so the NSDF denominator is a simple sum.
+ *  - To stop rounding errors accumulating in the running sums, one lag is
+ *    recomputed exactly every block in round-robin order.
+ *  - The NSDF and peak picking run once per block.
+ *
+ * With a 48kHz sample rate, the analysis runs at 12kHz with a 512 sample
+ * (~43ms) window and covers periods up to 408 samples (~29.4Hz), so
+ * min_freq can go down to 30Hz (the low B of a five string bass is 30.9Hz).
+ * The cost of each block is proportional to the longest period, i.e. to
+ * audio_sample_rate / (PITCH_DETECT_DECIMATION * min_freq).
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "pitch_detector.h"
+
+// Min/max limits and other constants
+#define PITCH_DETECT_FREQ_MIN           (30.0)
+#define PITCH_DETECT_FREQ_MAX           (2000.0)
+#define PITCH_DETECT_THRESHOLD_MIN      (0.0)
+#define PITCH_DETECT_THRESHOLD_MAX      (1.0)
+
+#define PITCH_DETECT_HISTORY_MASK       (PITCH_DETECT_HISTORY-1)
+#define PITCH_DETECT_AA_FREQ_RATIO      (0.25)      // AA cutoff relative to decimated rate
+#define PITCH_DETECT_PEAK_RATIO         (0.9)       // Key maximum relative to highest
+#define PITCH_DETECT_MIN_LEVEL_DB       (-50.0)     // Minimum RMS level for a lock
+#define PITCH_DETECT_MAX_KEY_MAXIMA     (32)
+
+// Static function prototypes
+static void     pitch_detect_push(PITCH_DETECTOR * c, float x);
+static void     pitch_detect_refresh(PITCH_DETECTOR * c);
+static void     pitch_detect_analyze(PITCH_DETECTOR * c);
+
+
+/**
+ * @brief Initializes instance of a pitch detector
+ *
+ * @param c Pointer to instance structure
+ * @param min_freq Lowest frequency to detect (30.0->2000.0 Hz)
+ * @param max_freq Highest frequency to detect (min_freq->2000.0 Hz)
+ * @param threshold Confidence required for a lock (0.0->1.0, ~0.8 works well)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Pitch detector result (enumeration)
+ */
+RESULT_PITCH_DETECT pitch_detect_setup(PITCH_DETECTOR * c,
+                                       float min_freq,
+                                       float max_freq,
+                                       float threshold,
+                                       float audio_sample_rate) {
+
+    if (c == NULL) {
+        return PITCH_DETECT_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    float decimated_rate = audio_sample_rate/PITCH_DETECT_DECIMATION;
+
+    if (min_freq < PITCH_DETECT_FREQ_MIN ||
+        max_freq > PITCH_DETECT_FREQ_MAX ||
+        min_freq >= max_freq ||
+        decimated_rate/min_freq > PITCH_DETECT_MAX_LAG - 1) {
+        return PITCH_DETECT_INVALID_FREQ_RANGE;
+    }
+
+    if (threshold < PITCH_DETECT_THRESHOLD_MIN ||
+        threshold > PITCH_DETECT_THRESHOLD_MAX) {
+        return PITCH_DETECT_INVALID_THRESHOLD;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->min_freq = min_freq;
+    c->max_freq = max_freq;
+    c->lag_min = (uint32_t) (decimated_rate/max_freq);
+    if (c->lag_min < 2) {
+        c->lag_min = 2;
+    }
+    c->lag_max = (uint32_t) (decimated_rate/min_freq) + 1;
+
+    c->threshold = threshold;
+    c->min_power = powf(10.0, PITCH_DETECT_MIN_LEVEL_DB/10.0);
+
+    filter_setup(&c->aa_lpf,
+                 BIQUAD_TYPE_LPF,
+                 BIQUAD_TRANS_VERY_SLOW,
+                 (pm float *) c->aa_lpf_coeffs,
+                 decimated_rate*PITCH_DETECT_AA_FREQ_RATIO,
+                 0.707,
+                 1.0,
+                 audio_sample_rate);
+    c->decimation_phase = 0;
+
+    for (int i=0;i<PITCH_DETECT_HISTORY;i++) {
+        c->history[i] = 0.0;
+        c->energy[i] = 0.0;
+    }
+    for (int i=0;i<=PITCH_DETECT_MAX_LAG;i++) {
+        c->acf[i] = 0.0;
+    }
+    c->write_index = 0;
+    c->refresh_lag = 0;
+
+    c->frequency = 0.0;
+    c->confidence = 0.0;
+    c->lock = false;
+
+    c->initialized = true;
+    return PITCH_DETECT_OK;
+}
+
+/**
+ * @brief Modify the confidence required for a pitch lock
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param threshold_new Updated confidence threshold (0.0->1.0)
+ * @return Pitch detector result (enumeration)
+ */
+RESULT_PITCH_DETECT pitch_detect_modify_threshold(PITCH_DETECTOR * c,
+                                                  float threshold_new) {
+
+    RESULT_PITCH_DETECT res;
+
+    float threshold;
+    if (threshold_new > PITCH_DETECT_THRESHOLD_MAX) {
+        threshold = PITCH_DETECT_THRESHOLD_MAX;
+        res = PITCH_DETECT_INVALID_THRESHOLD;
+    }
+    else if (threshold_new < PITCH_DETECT_THRESHOLD_MIN) {
+        threshold = PITCH_DETECT_THRESHOLD_MIN;
+        res = PITCH_DETECT_INVALID_THRESHOLD;
+    }
+    else {
+        threshold = threshold_new;
+        res = PITCH_DETECT_OK;
+    }
+
+    c->threshold = threshold;
+
+    return res;
+}
+
+/**
+ * @brief Process a block of audio and update the pitch estimate
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ * @param detected_frequency Pointer to variable that receives the frequency
+ * @param confidence Pointer to variable that receives the confidence (or NULL)
+ * @return true if the detector is locked onto a pitch
+ */
+#pragma optimize_for_speed
+bool    pitch_detect_read(PITCH_DETECTOR * c,
+                          float * audio_in,
+                          uint32_t audio_block_size,
+                          float * detected_frequency,
+                          float * confidence) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    float filtered[MAX_AUDIO_BLOCK_SIZE];
+    filter_read(&c->aa_lpf, audio_in, filtered, audio_block_size);
+
+    // Decimate and update the running sums
+    uint32_t phase = c->decimation_phase;
+    bool new_samples = false;
+    for (int i=0;i<audio_block_size;i++) {
+        if (phase == 0) {
+            pitch_detect_push(c, filtered[i]);
+            new_samples = true;
+        }
+        if (++phase >= PITCH_DETECT_DECIMATION) {
+            phase = 0;
+        }
+    }
+    c->decimation_phase = phase;
+
+    if (new_samples) {
+        pitch_detect_refresh(c);
+        pitch_detect_analyze(c);
+    }
+
+    *detected_frequency = c->frequency;
+    if (confidence != NULL) {
+        *confidence = c->confidence;
+    }
+
+    return c->lock;
+}
+
+/**
+ * @brief Adds a decimated sample to the history and the running sums
+ *
+ * @param c Pointer to instance structure
+ * @param x New (decimated) sample
+ */
+#pragma optimize_for_speed
+static void     pitch_detect_push(PITCH_DETECTOR * c, float x) {
+
+    uint32_t n = c->write_index;
+    uint32_t n_old = n - PITCH_DETECT_WINDOW;
+    float * h = c->history;
+    float * acf = c->acf;
+
+    h[n & PITCH_DETECT_HISTORY_MASK] = x;
+    float x_old = h[n_old & PITCH_DETECT_HISTORY_MASK];
+
+    // Add the products entering the window, remove those leaving it
+    for (int tau=0;tau<=c->lag_max;tau++) {
+        acf[tau] += x*h[(n - tau) & PITCH_DETECT_HISTORY_MASK] -
+                    x_old*h[(n_old - tau) & PITCH_DETECT_HISTORY_MASK];
+    }
+
+    // Lag 0 is the energy of the window ending at this sample
+    c->energy[n & PITCH_DETECT_HISTORY_MASK] = acf[0];
+
+    c->write_index = n + 1;
+}
+
+/**
+ * @brief Recomputes one lag of the autocorrelation exactly
+ *
+ * Called once per block to stop rounding errors building up in the running
+ * sums.  Every lag is refreshed within lag_max+1 blocks.
+ *
+ * @param c Pointer to instance structure
+ */
+static void     pitch_detect_refresh(PITCH_DETECTOR * c) {
+
+    uint32_t n = c->write_index - 1;
+    uint32_t tau = c->refresh_lag;
+    float * h = c->history;
+
+    float sum = 0.0;
+    for (int k=0;k<PITCH_DETECT_WINDOW;k++) {
+        sum += h[(n - k) & PITCH_DETECT_HISTORY_MASK] *
+               h[(n - k - tau) & PITCH_DETECT_HISTORY_MASK];
+    }
+    c->acf[tau] = sum;
+    if (tau == 0) {
+        c->energy[n & PITCH_DETECT_HISTORY_MASK] = sum;
+    }
+
+    if (++c->refresh_lag > c->lag_max) {
+        c->refresh_lag = 0;
+    }
+}
+
+/**
+ * @brief Calculates the NSDF and picks the period
+ *
+ * @param c Pointer to instance structure
+ */
+static void     pitch_detect_analyze(PITCH_DETECTOR * c) {
+
+    uint32_t n = c->write_index - 1;
+    float energy_now = c->acf[0];
+
+    // Not enough signal for a reliable estimate
+    if (energy_now < c->min_power*PITCH_DETECT_WINDOW) {
+        c->confidence = 0.0;
+        c->lock = false;
+        return;
+    }
+
+    float nsdf[PITCH_DETECT_MAX_LAG+1];
+    uint32_t lag_max = c->lag_max;
+    for (int tau=0;tau<=lag_max;tau++) {
+        float m = energy_now + c->energy[(n - tau) & PITCH_DETECT_HISTORY_MASK];
+        nsdf[tau] = (m > 0.0) ? 2.0*c->acf[tau]/m : 0.0;
+    }
+
+    // Find the key maxima: the highest point of each positive region after
+    // the NSDF first goes negative
+    uint32_t key_max[PITCH_DETECT_MAX_KEY_MAXIMA];
+    uint32_t num_key_max = 0;
+    float highest = 0.0;
+
+    uint32_t tau = 1;
+    while (tau < lag_max && nsdf[tau] > 0.0) {
+        tau++;
+    }
+
+    uint32_t best = 0;
+    for (;tau<=lag_max;tau++) {
+        if (nsdf[tau] > 0.0 && tau < lag_max) {
+            if (best == 0 || nsdf[tau] > nsdf[best]) {
+                best = tau;
+            }
+        }
+        else if (best != 0) {
+            // End of a positive region (or of the lag range)
+            if (best >= c->lag_min && num_key_max < PITCH_DETECT_MAX_KEY_MAXIMA) {
+                key_max[num_key_max++] = best;
+                if (nsdf[best] > highest) {
+                    highest = nsdf[best];
+                }
+            }
+            best = 0;
+        }
+    }
+
+    if (num_key_max == 0) {
+        c->confidence = 0.0;
+        c->lock = false;
+        return;
+    }
+
+    // The period is the first key maximum close to the highest
+    uint32_t period = key_max[0];
+    for (int i=0;i<num_key_max;i++) {
+        if (nsdf[key_max[i]] >= PITCH_DETECT_PEAK_RATIO*highest) {
+            period = key_max[i];
+            break;
+        }
+    }
+
+    // Parabolic interpolation around the peak
+    float y0 = nsdf[period-1];
+    float y1 = nsdf[period];
+    float y2 = nsdf[period+1];
+    float denom = y0 - 2.0*y1 + y2;
+    float offset = 0.0;
+    float peak = y1;
+    if (denom < 0.0) {
+        offset = 0.5*(y0 - y2)/denom;
+        peak = y1 - 0.25*(y0 - y2)*offset;
+    }
+    if (peak > 1.0) {
+        peak = 1.0;
+    }
+
+    float decimated_rate = c->audio_sample_rate/PITCH_DETECT_DECIMATION;
+    float frequency = decimated_rate/((float) period + offset);
+
+    c->confidence = peak;
+    c->lock = (peak >= c->threshold &&
+               frequency >= c->min_freq &&
+               frequency <= c->max_freq);
+    if (c->lock) {
+        c->frequency = frequency;
+    }
+}
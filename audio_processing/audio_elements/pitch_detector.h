@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _PITCH_DETECTOR_H
+#define _PITCH_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "biquad_filter.h"
+
+#define PITCH_DETECT_DECIMATION     (4)         // Analysis runs at fs/4
+#define PITCH_DETECT_WINDOW         (512)       // Analysis window (decimated samples)
+#define PITCH_DETECT_MAX_LAG        (408)       // Longest period (decimated samples)
+#define PITCH_DETECT_HISTORY        (1024)      // Power of 2 >= WINDOW + MAX_LAG
+
+// Result enumerations
+typedef enum
+{
+    PITCH_DETECT_OK,
+    PITCH_DETECT_INVALID_INSTANCE_POINTER,
+    PITCH_DETECT_INVALID_FREQ_RANGE,
+    PITCH_DETECT_INVALID_THRESHOLD
+} RESULT_PITCH_DETECT;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    float   min_freq;
+    float   max_freq;
+    uint32_t    lag_min;
+    uint32_t    lag_max;
+
+    float   threshold;          // Minimum confidence for a pitch lock
+    float   min_power;          // Minimum mean power of the window for a lock
+
+    // Anti-alias filter and decimation
+    BIQUAD_FILTER   aa_lpf;
+    float   aa_lpf_coeffs[6];
+    uint32_t    decimation_phase;
+
+    // Decimated history and running (sliding window) sums
+    float   history[PITCH_DETECT_HISTORY];
+    float   energy[PITCH_DETECT_HISTORY];   // Window energy ending at each sample
+    uint32_t    write_index;
+    float   acf[PITCH_DETECT_MAX_LAG+1];    // Autocorrelation over the window
+    uint32_t    refresh_lag;                // Next lag to recompute exactly
+
+    float   frequency;
+    float   confidence;
+    bool    lock;
+
+    float   audio_sample_rate;
+
+} PITCH_DETECTOR;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_PITCH_DETECT pitch_detect_setup(PITCH_DETECTOR * c,
+                                       float min_freq,
+                                       float max_freq,
+                                       float threshold,
+                                       float audio_sample_rate);
+
+RESULT_PITCH_DETECT pitch_detect_modify_threshold(PITCH_DETECTOR * c,
+                                                  float threshold_new);
+
+bool    pitch_detect_read(PITCH_DETECTOR * c,
+                          float * audio_in,
+                          uint32_t audio_block_size,
+                          float * detected_frequency,
+                          float * confidence);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _PITCH_DETECTOR_H
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A quadrature oscillator generates a sine and cosine at the same frequency.
+ * Rather than calling oscillator_sine() for every sample, this element keeps
+ * a unit-length phasor (cos, sin) and rotates it by the per-sample phase
+ * increment with one complex multiply per sample (the coupled-form
+ * oscillator):
+ *
+ *      re' = re*cos(w) - im*sin(w)
+ *      im' = re*sin(w) + im*cos(w)
+ *
+ * Rounding errors make the amplitude of the phasor drift slowly, so it is
+ * pulled back to unit length once per block.  Since the error is tiny, a
+ * single Newton step of 1/sqrt(x) around 1.0 (g = 1.5 - 0.5*|z|^2) is used
+ * instead of a square root and divide.
+ *
+ * Negative frequencies are supported and simply rotate the phasor the other
+ * way, which is handy for frequency shifting.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "quadrature_oscillator.h"
+
+// Static function prototypes
+static void quad_osc_update_rotation(QUAD_OSC * c);
+
+
+/**
+ * @brief Initializes instance of a quadrature oscillator
+ *
+ * @param c Pointer to instance structure
+ * @param freq_hz Oscillator frequency (-fs/2 -> fs/2)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Quadrature oscillator result (enumeration)
+ */
+RESULT_QUAD_OSC quad_osc_setup(QUAD_OSC * c,
+                               float freq_hz,
+                               float audio_sample_rate) {
+
+    if (c == NULL) {
+        return QUAD_OSC_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (freq_hz > 0.5*audio_sample_rate ||
+        freq_hz < -0.5*audio_sample_rate) {
+        return QUAD_OSC_INVALID_FREQ;
+    }
+
+    c->freq_hz = freq_hz;
+    c->audio_sample_rate = audio_sample_rate;
+    quad_osc_update_rotation(c);
+    quad_osc_reset_phase(c);
+
+    c->initialized = true;
+    return QUAD_OSC_OK;
+}
+
+/**
+ * @brief Modify the oscillator frequency
+ *
+ * The phase of the oscillator is preserved so the frequency can be changed
+ * while running without clicks.
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param new_freq_hz Updated frequency (-fs/2 -> fs/2)
+ * @return Quadrature oscillator result (enumeration)
+ */
+RESULT_QUAD_OSC quad_osc_modify_freq(QUAD_OSC * c,
+                                     float freq_hz_new) {
+
+    RESULT_QUAD_OSC res;
+
+    float freq_max = 0.5*c->audio_sample_rate;
+    float freq_hz;
+    if (freq_hz_new > freq_max) {
+        freq_hz = freq_max;
+        res = QUAD_OSC_INVALID_FREQ;
+    }
+    else if (freq_hz_new < -freq_max) {
+        freq_hz = -freq_max;
+        res = QUAD_OSC_INVALID_FREQ;
+    }
+    else {
+        freq_hz = freq_hz_new;
+        res = QUAD_OSC_OK;
+    }
+
+    if (freq_hz != c->freq_hz) {
+        c->freq_hz = freq_hz;
+        quad_osc_update_rotation(c);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Resets the oscillator phase to zero (sine = 0, cosine = 1)
+ *
+ * @param c Pointer to instance structure
+ */
+void    quad_osc_reset_phase(QUAD_OSC * c) {
+
+    c->re = 1.0;
+    c->im = 0.0;
+}
+
+/**
+ * @brief Generates a block of sine and cosine samples
+ *
+ * @param c Pointer to instance structure
+ * @param sin_out Pointer to sine output buffer (or NULL)
+ * @param cos_out Pointer to cosine output buffer (or NULL)
+ * @param audio_block_size The number of floating-point words to generate
+ */
+#pragma optimize_for_speed
+void    quad_osc_read(QUAD_OSC * c,
+                      float * sin_out,
+                      float * cos_out,
+                      uint32_t audio_block_size) {
+
+    if (c == NULL || !c->initialized) {
+        for (int i=0;i<audio_block_size;i++) {
+            if (sin_out != NULL) sin_out[i] = 0.0;
+            if (cos_out != NULL) cos_out[i] = 1.0;
+        }
+        return;
+    }
+
+    float re = c->re;
+    float im = c->im;
+    float rc = c->rot_cos;
+    float rs = c->rot_sin;
+    float re_next;
+
+    if (sin_out != NULL && cos_out != NULL) {
+        for (int i=0;i<audio_block_size;i++) {
+            cos_out[i] = re;
+            sin_out[i] = im;
+            re_next = re*rc - im*rs;
+            im = re*rs + im*rc;
+            re = re_next;
+        }
+    }
+    else if (sin_out != NULL) {
+        for (int i=0;i<audio_block_size;i++) {
+            sin_out[i] = im;
+            re_next = re*rc - im*rs;
+            im = re*rs + im*rc;
+            re = re_next;
+        }
+    }
+    else if (cos_out != NULL) {
+        for (int i=0;i<audio_block_size;i++) {
+            cos_out[i] = re;
+            re_next = re*rc - im*rs;
+            im = re*rs + im*rc;
+            re = re_next;
+        }
+    }
+
+    // Pull the phasor back to unit length
+    float g = 1.5 - 0.5*(re*re + im*im);
+    c->re = re*g;
+    c->im = im*g;
+}
+
+/**
+ * @brief Recalculates the per-sample rotation from the frequency
+ *
+ * @param c Pointer to instance structure
+ */
+static void quad_osc_update_rotation(QUAD_OSC * c) {
+
+    float w = PI2 * c->freq_hz / c->audio_sample_rate;
+    c->rot_cos = cosf(w);
+    c->rot_sin = sinf(w);
+}
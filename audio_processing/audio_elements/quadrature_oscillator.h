@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _QUADRATURE_OSCILLATOR_H
+#define _QUADRATURE_OSCILLATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum
+{
+    QUAD_OSC_OK,
+    QUAD_OSC_INVALID_INSTANCE_POINTER,
+    QUAD_OSC_INVALID_FREQ
+} RESULT_QUAD_OSC;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    float   freq_hz;
+
+    float   rot_cos;        // Per-sample rotation (cos/sin of 2*pi*f/fs)
+    float   rot_sin;
+
+    float   re;             // Current phasor (cosine output)
+    float   im;             // Current phasor (sine output)
+
+    float   audio_sample_rate;
+
+} QUAD_OSC;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_QUAD_OSC quad_osc_setup(QUAD_OSC * c,
+                               float freq_hz,
+                               float audio_sample_rate);
+
+RESULT_QUAD_OSC quad_osc_modify_freq(QUAD_OSC * c,
+                                     float new_freq_hz);
+
+void    quad_osc_reset_phase(QUAD_OSC * c);
+
+void    quad_osc_read(QUAD_OSC * c,
+                      float * sin_out,
+                      float * cos_out,
+                      uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _QUADRATURE_OSCILLATOR_H
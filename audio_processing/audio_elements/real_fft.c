@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * Forward and inverse FFTs of real signals, shared by the spectral audio
+ * elements and effects (STFT analyzer, phase vocoder, etc.).
+ *
+ * A real FFT of N points is computed with a complex FFT of N/2 points: the
+ * even samples are packed into the real part and the odd samples into the
+ * imaginary part, the complex FFT is run in place, and the two interleaved
+ * spectra are then separated to give the N/2+1 bins of the real spectrum.
+ * The inverse runs the same steps backwards.  This is roughly twice as fast
+ * as running an N point complex FFT with a zero imaginary part.
+ *
+ * Spectra are held as separate real / imaginary arrays of N/2+1 bins.  The
+ * transforms are scaled so that real_fft_inverse(real_fft_forward(x)) == x.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "real_fft.h"
+
+// Static function prototypes
+static void     real_fft_complex(REAL_FFT * c, float * re, float * im);
+
+
+/**
+ * @brief Initializes instance of a real FFT
+ *
+ * @param c Pointer to instance structure
+ * @param size FFT length (power of 2, 16->2048)
+ * @return Real FFT result (enumeration)
+ */
+RESULT_REAL_FFT real_fft_setup(REAL_FFT * c,
+                               uint32_t size) {
+
+    if (c == NULL) {
+        return REAL_FFT_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (size < REAL_FFT_MIN_SIZE ||
+        size > REAL_FFT_MAX_SIZE ||
+        (size & (size - 1)) != 0) {
+        return REAL_FFT_INVALID_SIZE;
+    }
+
+    c->size = size;
+    c->half_size = size/2;
+
+    c->log2_half_size = 0;
+    while ((1u << c->log2_half_size) < c->half_size) {
+        c->log2_half_size++;
+    }
+
+    for (int k=0;k<=size/2;k++) {
+        c->twiddle_cos[k] = cosf(PI2*k/size);
+        c->twiddle_sin[k] = sinf(PI2*k/size);
+    }
+
+    c->initialized = true;
+    return REAL_FFT_OK;
+}
+
+/**
+ * @brief Forward FFT of a real signal
+ *
+ * @param c Pointer to instance structure
+ * @param input Pointer to 'size' real samples (not modified)
+ * @param re Pointer to buffer that receives the real part (size/2+1 bins)
+ * @param im Pointer to buffer that receives the imaginary part (size/2+1 bins)
+ */
+#pragma optimize_for_speed
+void    real_fft_forward(REAL_FFT * c,
+                         float * input,
+                         float * re,
+                         float * im) {
+
+    uint32_t m = c->half_size;
+
+    // Pack even / odd samples as real / imaginary
+    for (int i=0;i<m;i++) {
+        re[i] = input[2*i];
+        im[i] = input[2*i+1];
+    }
+
+    real_fft_complex(c, re, im);
+
+    // Separate the spectra of the even and odd samples, a pair of bins
+    // (k, m-k) at a time so it can be done in place:
+    //   X[k]   = E + W^k O
+    //   X[m-k] = conj(E - W^k O)
+    for (uint32_t k=1;k<=m/2;k++) {
+        uint32_t k2 = m - k;
+        float zr = re[k], zi = im[k];
+        float cr = re[k2], ci = -im[k2];
+
+        float er = 0.5*(zr + cr);
+        float ei = 0.5*(zi + ci);
+        float odd_r = 0.5*(zi - ci);
+        float odd_i = -0.5*(zr - cr);
+
+        float wr = c->twiddle_cos[k];
+        float wi = -c->twiddle_sin[k];
+        float tr = wr*odd_r - wi*odd_i;
+        float ti = wr*odd_i + wi*odd_r;
+
+        re[k] = er + tr;
+        im[k] = ei + ti;
+        re[k2] = er - tr;
+        im[k2] = -(ei - ti);
+    }
+
+    // DC and Nyquist are both real
+    float z0r = re[0];
+    float z0i = im[0];
+    re[0] = z0r + z0i;
+    im[0] = 0.0;
+    re[m] = z0r - z0i;
+    im[m] = 0.0;
+}
+
+/**
+ * @brief Inverse FFT to a real signal
+ *
+ * @param c Pointer to instance structure
+ * @param re Pointer to real part of spectrum (size/2+1 bins, overwritten)
+ * @param im Pointer to imaginary part of spectrum (size/2+1 bins, overwritten)
+ * @param output Pointer to buffer that receives 'size' real samples
+ */
+#pragma optimize_for_speed
+void    real_fft_inverse(REAL_FFT * c,
+                         float * re,
+                         float * im,
+                         float * output) {
+
+    uint32_t m = c->half_size;
+
+    // Recombine into the packed spectrum, a pair of bins at a time
+    for (uint32_t k=1;k<=m/2;k++) {
+        uint32_t k2 = m - k;
+        float ar = re[k], ai = im[k];
+        float br = re[k2], bi = -im[k2];
+
+        float er = 0.5*(ar + br);
+        float ei = 0.5*(ai + bi);
+        float dr = 0.5*(ar - br);
+        float di = 0.5*(ai - bi);
+
+        // O = conj(W^k) * (X[k] - conj(X[m-k])) / 2
+        float wr = c->twiddle_cos[k];
+        float wi = c->twiddle_sin[k];
+        float odd_r = wr*dr - wi*di;
+        float odd_i = wr*di + wi*dr;
+
+        // Z[k] = E + jO, Z[m-k] = conj(E) + j conj(O)
+        re[k] = er - odd_i;
+        im[k] = ei + odd_r;
+        re[k2] = er + odd_i;
+        im[k2] = -ei + odd_r;
+    }
+
+    float x0 = re[0];
+    float xm = re[m];
+    re[0] = 0.5*(x0 + xm);
+    im[0] = 0.5*(x0 - xm);
+
+    // Inverse complex FFT using the forward FFT on the conjugate
+    for (int i=0;i<m;i++) {
+        im[i] = -im[i];
+    }
+
+    real_fft_complex(c, re, im);
+
+    float scale = 1.0/m;
+    for (int i=0;i<m;i++) {
+        output[2*i] = re[i]*scale;
+        output[2*i+1] = -im[i]*scale;
+    }
+}
+
+/**
+ * @brief In-place radix-2 complex FFT of size/2 points
+ *
+ * @param c Pointer to instance structure
+ * @param re Pointer to real part
+ * @param im Pointer to imaginary part
+ */
+#pragma optimize_for_speed
+static void     real_fft_complex(REAL_FFT * c, float * re, float * im) {
+
+    uint32_t n = c->half_size;
+    uint32_t bits = c->log2_half_size;
+
+    // Bit reversal permutation
+    for (uint32_t i=0;i<n;i++) {
+        uint32_t j = 0;
+        for (uint32_t b=0;b<bits;b++) {
+            j |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    // Butterflies.  The twiddle table covers 'size' points so the stride
+    // for a span of 'len' is size/len.
+    for (uint32_t len=2;len<=n;len<<=1) {
+        uint32_t half = len >> 1;
+        uint32_t stride = c->size/len;
+        for (uint32_t i=0;i<n;i+=len) {
+            for (uint32_t k=0;k<half;k++) {
+                float wr = c->twiddle_cos[k*stride];
+                float wi = -c->twiddle_sin[k*stride];
+                uint32_t a = i + k;
+                uint32_t b = a + half;
+                float tr = re[b]*wr - im[b]*wi;
+                float ti = re[b]*wi + im[b]*wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
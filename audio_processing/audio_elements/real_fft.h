@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _REAL_FFT_H
+#define _REAL_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define REAL_FFT_MIN_SIZE       (16)
+#define REAL_FFT_MAX_SIZE       (2048)
+#define REAL_FFT_MAX_BINS       (REAL_FFT_MAX_SIZE/2+1)
+
+// Result enumerations
+typedef enum
+{
+    REAL_FFT_OK,
+    REAL_FFT_INVALID_INSTANCE_POINTER,
+    REAL_FFT_INVALID_SIZE
+} RESULT_REAL_FFT;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    uint32_t    size;
+    uint32_t    half_size;
+    uint32_t    log2_half_size;
+
+    float   twiddle_cos[REAL_FFT_MAX_SIZE/2+1];
+    float   twiddle_sin[REAL_FFT_MAX_SIZE/2+1];
+
+} REAL_FFT;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_REAL_FFT real_fft_setup(REAL_FFT * c,
+                               uint32_t size);
+
+void    real_fft_forward(REAL_FFT * c,
+                         float * input,
+                         float * re,
+                         float * im);
+
+void    real_fft_inverse(REAL_FFT * c,
+                         float * re,
+                         float * im,
+                         float * output);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _REAL_FFT_H
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A streaming short-time Fourier transform (STFT) analyzer.  It measures the
+ * magnitude spectrum of an audio stream for metering and spectral effects.
+ *
+ * The work is split so that the audio callback does almost nothing:
+ *
+ *  - stft_analyzer_push() is called from the audio callback.  It only copies
+ *    the block into a ring buffer and bumps a sample counter.
+ *  - stft_analyzer_process() is called from processaudio_background_loop().
+ *    Each time hop_size new samples are available, it windows the latest
+ *    fft_size samples (Hann), runs a real FFT, smooths the magnitude of each
+ *    bin and publishes the result.
+ *
+ * The FFT itself is done by the shared real FFT element (real_fft.c).
+ *
+ * Results are published through a double-buffered STFT_SNAPSHOT.  The
+ * analyzer writes the buffer that is not currently published, then flips
+ * 'published' and increments 'sequence'.  stft_snapshot_read() copies the
+ * published buffer and checks that 'sequence' didn't change while it was
+ * copying (retrying if it did), so readers on this or other cores never need
+ * to take a lock and never stall the analyzer.  Place the snapshot in memory
+ * that all cores can access (e.g. SDRAM) to share it.
+ *
+ * SDRAM is cached on the SHARC+ cores and the caches aren't coherent, so the
+ * analyzer flushes each frame out of its data cache before publishing it, and
+ * stft_snapshot_read() invalidates its cached copy of the snapshot before
+ * reading it.  The magnitudes are accessed through volatile pointers so the
+ * compiler can't move them across the sequence / published updates.
+ *
+ * If the background loop falls too far behind the callback, whole frames are
+ * skipped and counted in frames_dropped rather than analyzing stale audio.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "stft_analyzer.h"
+
+// Min/max limits and other constants
+#define STFT_SMOOTHING_MIN          (0.0)
+#define STFT_SMOOTHING_MAX          (0.99)
+#define STFT_RING_MASK              (STFT_RING_SIZE-1)
+#define STFT_SNAPSHOT_READ_RETRIES  (4)
+
+// Write back / discard the data cache lines covering part of the snapshot
+#if defined(__ADSPSHARC__)
+#include <sys/cache.h>
+#define STFT_CACHE_FLUSH(start, bytes)      flush_data_buffer((void *) (start), \
+                                                              (void *) ((char *) (start) + (bytes)), \
+                                                              ADI_FLUSH_DATA_NOINV)
+#define STFT_CACHE_INVALIDATE(start, bytes) flush_data_buffer((void *) (start), \
+                                                              (void *) ((char *) (start) + (bytes)), \
+                                                              ADI_FLUSH_DATA_INV)
+#else
+#define STFT_CACHE_FLUSH(start, bytes)
+#define STFT_CACHE_INVALIDATE(start, bytes)
+#endif
+
+// Static function prototypes
+static void     stft_publish(STFT_ANALYZER * c);
+
+
+/**
+ * @brief Initializes instance of an STFT analyzer
+ *
+ * @param c Pointer to instance structure
+ * @param snapshot Pointer to the snapshot that results are published to
+ * @param fft_size FFT length (power of 2, 64->2048)
+ * @param hop_size Samples between frames (1->fft_size)
+ * @param smoothing Per-bin magnitude smoothing between frames (0.0->0.99)
+ * @param audio_sample_rate The system audio sample rate
+ * @return STFT result (enumeration)
+ */
+RESULT_STFT stft_analyzer_setup(STFT_ANALYZER * c,
+                                STFT_SNAPSHOT * snapshot,
+                                uint32_t fft_size,
+                                uint32_t hop_size,
+                                float smoothing,
+                                float audio_sample_rate) {
+
+    if (c == NULL) {
+        return STFT_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    if (snapshot == NULL) {
+        return STFT_INVALID_SNAPSHOT_POINTER;
+    }
+
+    if (fft_size < STFT_MIN_FFT_SIZE ||
+        fft_size > STFT_MAX_FFT_SIZE ||
+        (fft_size & (fft_size - 1)) != 0) {
+        return STFT_INVALID_FFT_SIZE;
+    }
+
+    if (hop_size < 1 || hop_size > fft_size) {
+        return STFT_INVALID_HOP_SIZE;
+    }
+
+    if (smoothing < STFT_SMOOTHING_MIN || smoothing > STFT_SMOOTHING_MAX) {
+        return STFT_INVALID_SMOOTHING;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+
+    c->fft_size = fft_size;
+    c->hop_size = hop_size;
+    c->num_bins = fft_size/2 + 1;
+    c->smoothing = smoothing;
+
+    // Hann window.  Magnitudes are scaled so a full scale sine reads 1.0
+    float window_sum = 0.0;
+    for (int i=0;i<fft_size;i++) {
+        c->window[i] = 0.5 - 0.5*cosf(PI2*i/fft_size);
+        window_sum += c->window[i];
+    }
+    c->window_gain = 2.0/window_sum;
+
+    real_fft_setup(&c->fft, fft_size);
+
+    for (int i=0;i<STFT_RING_SIZE;i++) {
+        c->ring[i] = 0.0;
+    }
+    c->write_count = 0;
+    c->next_frame_end = fft_size;
+    c->frames_dropped = 0;
+
+    for (int k=0;k<STFT_MAX_BINS;k++) {
+        c->smoothed[k] = 0.0;
+    }
+
+    c->snapshot = snapshot;
+    snapshot->num_bins = c->num_bins;
+    snapshot->bin_hz = audio_sample_rate/fft_size;
+    for (int k=0;k<STFT_MAX_BINS;k++) {
+        snapshot->magnitude[0][k] = 0.0;
+        snapshot->magnitude[1][k] = 0.0;
+    }
+    snapshot->published = 0;
+    snapshot->sequence = 0;
+    STFT_CACHE_FLUSH(snapshot, sizeof(STFT_SNAPSHOT));
+
+    c->initialized = true;
+    return STFT_OK;
+}
+
+/**
+ * @brief Modify the amount of magnitude smoothing between frames
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param smoothing_new Updated smoothing (0.0->0.99)
+ * @return STFT result (enumeration)
+ */
+RESULT_STFT stft_analyzer_modify_smoothing(STFT_ANALYZER * c,
+                                           float smoothing_new) {
+
+    RESULT_STFT res;
+
+    float smoothing;
+    if (smoothing_new > STFT_SMOOTHING_MAX) {
+        smoothing = STFT_SMOOTHING_MAX;
+        res = STFT_INVALID_SMOOTHING;
+    }
+    else if (smoothing_new < STFT_SMOOTHING_MIN) {
+        smoothing = STFT_SMOOTHING_MIN;
+        res = STFT_INVALID_SMOOTHING;
+    }
+    else {
+        smoothing = smoothing_new;
+        res = STFT_OK;
+    }
+
+    c->smoothing = smoothing;
+
+    return res;
+}
+
+/**
+ * @brief Adds a block of audio to the analyzer (call from the audio callback)
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_block_size The number of floating-point words to add
+ */
+#pragma optimize_for_speed
+void    stft_analyzer_push(STFT_ANALYZER * c,
+                           float * audio_in,
+                           uint32_t audio_block_size) {
+
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t count = c->write_count;
+    for (int i=0;i<audio_block_size;i++) {
+        c->ring[(count + i) & STFT_RING_MASK] = audio_in[i];
+    }
+
+    // Only advance the counter once the samples are in the ring
+    c->write_count = count + audio_block_size;
+}
+
+/**
+ * @brief Analyzes the next frame if enough audio has arrived
+ *
+ * Call this from the background loop.  At most one frame is analyzed per call.
+ *
+ * @param c Pointer to instance structure
+ * @return true if a new frame was analyzed and published
+ */
+#pragma optimize_for_speed
+bool    stft_analyzer_process(STFT_ANALYZER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    uint32_t fft_size = c->fft_size;
+    uint32_t count = c->write_count;
+
+    // Not enough new audio for the next frame yet
+    if ((int32_t) (count - c->next_frame_end) < 0) {
+        return false;
+    }
+
+    // If we've fallen behind, skip to the most recent complete frame
+    if (count - c->next_frame_end > STFT_RING_SIZE - fft_size) {
+        uint32_t hops = (count - c->next_frame_end)/c->hop_size;
+        c->next_frame_end += hops*c->hop_size;
+        c->frames_dropped += hops;
+    }
+
+    // Window the frame
+    uint32_t start = c->next_frame_end - fft_size;
+    for (int i=0;i<fft_size;i++) {
+        c->frame[i] = c->ring[(start + i) & STFT_RING_MASK]*c->window[i];
+    }
+
+    // Make sure the callback didn't overwrite the frame while we copied it
+    if (c->write_count - start > STFT_RING_SIZE) {
+        c->next_frame_end += c->hop_size;
+        c->frames_dropped++;
+        return false;
+    }
+    c->next_frame_end += c->hop_size;
+
+    real_fft_forward(&c->fft, c->frame, c->work_re, c->work_im);
+    stft_publish(c);
+
+    return true;
+}
+
+/**
+ * @brief Copies the latest published spectrum without taking a lock
+ *
+ * @param snapshot Pointer to the snapshot
+ * @param magnitude_out Pointer to buffer that receives the magnitudes
+ * @param max_bins Size of magnitude_out (number of bins copied is limited to this)
+ * @param sequence Sequence number of the last frame the caller read (or NULL).
+ *                 Updated with the sequence number of the frame copied.
+ * @return true if a new, consistent frame was copied
+ */
+bool    stft_snapshot_read(STFT_SNAPSHOT * snapshot,
+                           float * magnitude_out,
+                           uint32_t max_bins,
+                           uint32_t * sequence) {
+
+    if (snapshot == NULL) {
+        return false;
+    }
+
+    // Pick up the latest header written by the analyzer's core
+    STFT_CACHE_INVALIDATE(snapshot, offsetof(STFT_SNAPSHOT, magnitude));
+
+    uint32_t num_bins = snapshot->num_bins;
+    if (num_bins > max_bins) {
+        num_bins = max_bins;
+    }
+
+    for (int attempt=0;attempt<STFT_SNAPSHOT_READ_RETRIES;attempt++) {
+
+        uint32_t seq = snapshot->sequence;
+        if (sequence != NULL && seq == *sequence) {
+            return false;
+        }
+
+        uint32_t buffer = snapshot->published;
+        volatile float * src = snapshot->magnitude[buffer];
+        STFT_CACHE_INVALIDATE(src, num_bins*sizeof(float));
+        for (int k=0;k<num_bins;k++) {
+            magnitude_out[k] = src[k];
+        }
+
+        // The buffer we copied can only be overwritten after another frame
+        // has been published, which changes the sequence number
+        STFT_CACHE_INVALIDATE(snapshot, offsetof(STFT_SNAPSHOT, magnitude));
+        if (snapshot->sequence == seq) {
+            if (sequence != NULL) {
+                *sequence = seq;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Smooths the magnitude spectrum and publishes it to the snapshot
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void     stft_publish(STFT_ANALYZER * c) {
+
+    STFT_SNAPSHOT * snapshot = c->snapshot;
+    uint32_t n = c->fft_size/2;
+    float * re = c->work_re;
+    float * im = c->work_im;
+    float a = 1.0 - c->smoothing;
+
+    // Write the buffer that isn't currently published
+    uint32_t buffer = snapshot->published ^ 1;
+    volatile float * out = snapshot->magnitude[buffer];
+
+    for (uint32_t k=0;k<=n;k++) {
+        float xr = re[k];
+        float xi = im[k];
+        float mag = sqrtf(xr*xr + xi*xi)*c->window_gain;
+        c->smoothed[k] += a*(mag - c->smoothed[k]);
+        out[k] = c->smoothed[k];
+    }
+
+    // Make sure the frame has reached memory before it's published
+    STFT_CACHE_FLUSH(out, (n+1)*sizeof(float));
+
+    // Publish
+    snapshot->published = buffer;
+    snapshot->sequence = snapshot->sequence + 1;
+    STFT_CACHE_FLUSH(snapshot, offsetof(STFT_SNAPSHOT, magnitude));
+}
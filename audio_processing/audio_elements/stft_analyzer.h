@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _STFT_ANALYZER_H
+#define _STFT_ANALYZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+#include "real_fft.h"
+
+#define STFT_MIN_FFT_SIZE       (64)
+#define STFT_MAX_FFT_SIZE       (2048)
+#define STFT_MAX_BINS           (STFT_MAX_FFT_SIZE/2+1)
+#define STFT_RING_SIZE          (2*STFT_MAX_FFT_SIZE)   // Power of 2
+
+// Result enumerations
+typedef enum
+{
+    STFT_OK,
+    STFT_INVALID_INSTANCE_POINTER,
+    STFT_INVALID_SNAPSHOT_POINTER,
+    STFT_INVALID_FFT_SIZE,
+    STFT_INVALID_HOP_SIZE,
+    STFT_INVALID_SMOOTHING
+} RESULT_STFT;
+
+/*
+ * Double-buffered magnitude spectrum published by the analyzer.  This can be
+ * placed in memory that other cores can see (e.g. SDRAM) and read with
+ * stft_snapshot_read() without any locks.  Don't read it directly from
+ * another core: stft_snapshot_read() handles the data cache maintenance.
+ */
+typedef struct {
+
+    volatile uint32_t   sequence;       // Incremented each time a frame is published
+    volatile uint32_t   published;      // Buffer holding the latest frame (0 or 1)
+
+    uint32_t    num_bins;
+    float       bin_hz;
+
+    float       magnitude[2][STFT_MAX_BINS];
+
+} STFT_SNAPSHOT;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    uint32_t    fft_size;
+    uint32_t    hop_size;
+    uint32_t    num_bins;
+
+    float   smoothing;              // 0.0 = none, ->1.0 = heavy
+    float   window_gain;            // Scales magnitudes to peak amplitude
+
+    float   window[STFT_MAX_FFT_SIZE];
+    REAL_FFT    fft;
+
+    // Sample ring written by the audio callback
+    float   ring[STFT_RING_SIZE];
+    volatile uint32_t   write_count;
+    uint32_t    next_frame_end;
+    uint32_t    frames_dropped;
+
+    // Work buffers for the background FFT
+    float   frame[STFT_MAX_FFT_SIZE];
+    float   work_re[STFT_MAX_BINS];
+    float   work_im[STFT_MAX_BINS];
+    float   smoothed[STFT_MAX_BINS];
+
+    STFT_SNAPSHOT * snapshot;
+
+    float   audio_sample_rate;
+
+} STFT_ANALYZER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_STFT stft_analyzer_setup(STFT_ANALYZER * c,
+                                STFT_SNAPSHOT * snapshot,
+                                uint32_t fft_size,
+                                uint32_t hop_size,
+                                float smoothing,
+                                float audio_sample_rate);
+
+RESULT_STFT stft_analyzer_modify_smoothing(STFT_ANALYZER * c,
+                                           float smoothing_new);
+
+void    stft_analyzer_push(STFT_ANALYZER * c,
+                           float * audio_in,
+                           uint32_t audio_block_size);
+
+bool    stft_analyzer_process(STFT_ANALYZER * c);
+
+bool    stft_snapshot_read(STFT_SNAPSHOT * snapshot,
+                           float * magnitude_out,
+                           uint32_t max_bins,
+                           uint32_t * sequence);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _STFT_ANALYZER_H
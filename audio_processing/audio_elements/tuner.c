@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * A chromatic tuner.  It measures the pitch of a monophonic input (e.g. a
+ * single guitar string) to well under a cent and reports the nearest note
+ * and the offset from it in cents.
+ *
+ * The zero crossing detector and the pitch detector element are built for
+ * tracking inside the audio callback and only resolve the period to a
+ * (decimated) sample, which is several cents at guitar pitches.  Here all of
+ * the analysis runs in the background loop instead:
+ *
+ *  - tuner_push() is called from the audio callback and only copies the
+ *    block into a ring buffer.
+ *  - tuner_process() is called from processaudio_background_loop().  Each
+ *    time TUNER_HOP_SIZE new samples are available it analyzes the latest
+ *    TUNER_FRAME_SIZE samples.
+ *
+ * The analysis uses the normalized square difference function (NSDF, McLeod
+ * and Wyvill), which is the autocorrelation normalized so that a perfectly
+ * periodic signal gives 1.0 at its period regardless of level or window
+ * position:
+ *
+ *      nsdf(lag) = 2*sum(x[i]*x[i+lag]) / sum(x[i]^2 + x[i+lag]^2)
+ *
+ * To keep the cost down this is done in two passes:
+ *
+ *  1. Coarse: the frame is decimated by TUNER_DECIMATION (box filter) and
+ *     the NSDF is calculated for every lag in range.  The period is the first
+ *     peak within 90% of the highest peak, which avoids picking a multiple of
+ *     the period.
+ *  2. Fine: the NSDF of the full rate frame is calculated only for the lags
+ *     around the coarse period.  A parabola through the best lag and its
+ *     neighbours gives the period to a fraction of a sample.
+ *
+ * Consecutive readings of the same note are smoothed to steady the display.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "tuner.h"
+
+// Min/max limits and other constants
+#define TUNER_THRESHOLD_MIN         (0.1)
+#define TUNER_THRESHOLD_MAX         (1.0)
+#define TUNER_RING_MASK             (TUNER_RING_SIZE-1)
+#define TUNER_DECIMATED_SIZE        (TUNER_FRAME_SIZE/TUNER_DECIMATION)
+#define TUNER_PEAK_RATIO            (0.9)       // Key maximum picking (fraction of the highest peak)
+#define TUNER_MIN_POWER             (1.0e-6)    // About -60 dBFS
+#define TUNER_SMOOTHING             (0.3)       // Weight of each new reading of the same note
+
+// Static function prototypes
+static float    tuner_nsdf_full(float * x, uint32_t lag);
+
+
+/**
+ * @brief Initializes instance of a tuner
+ *
+ * @param c Pointer to instance structure
+ * @param min_freq Lowest frequency to detect in Hz
+ * @param max_freq Highest frequency to detect in Hz
+ * @param threshold Minimum clarity for a lock (0.1->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Tuner result (enumeration)
+ */
+RESULT_TUNER    tuner_setup(TUNER * c,
+                            float min_freq,
+                            float max_freq,
+                            float threshold,
+                            float audio_sample_rate) {
+
+    if (c == NULL) {
+        return TUNER_INVALID_INSTANCE_POINTER;
+    }
+    c->initialized = false;
+
+    // The longest period has to fit in the lag range and the shortest has to
+    // be resolvable by the coarse search
+    if (min_freq <= 0.0 ||
+        max_freq <= min_freq ||
+        audio_sample_rate/min_freq > TUNER_MAX_LAG ||
+        audio_sample_rate/max_freq < 4*TUNER_DECIMATION) {
+        return TUNER_INVALID_FREQ_RANGE;
+    }
+    if (threshold < TUNER_THRESHOLD_MIN || threshold > TUNER_THRESHOLD_MAX) {
+        return TUNER_INVALID_THRESHOLD;
+    }
+
+    c->audio_sample_rate = audio_sample_rate;
+    c->min_freq = min_freq;
+    c->max_freq = max_freq;
+    c->lag_min = (uint32_t)(audio_sample_rate/max_freq);
+    c->lag_max = (uint32_t)(audio_sample_rate/min_freq + 0.5);
+    c->threshold = threshold;
+    c->min_power = TUNER_MIN_POWER;
+
+    tuner_reset(c);
+
+    c->initialized = true;
+    return TUNER_OK;
+}
+
+/**
+ * @brief Clears the sample history and the last reading
+ *
+ * Call this when the tuner is switched on, before the first tuner_push().
+ *
+ * @param c Pointer to instance structure
+ */
+void    tuner_reset(TUNER * c) {
+
+    for (int i=0;i<TUNER_RING_SIZE;i++) {
+        c->ring[i] = 0.0;
+    }
+    c->write_count = 0;
+    c->next_frame_end = TUNER_FRAME_SIZE;
+
+    c->frequency = 0.0;
+    c->clarity = 0.0;
+    c->locked = false;
+    c->note = 0;
+    c->cents = 0.0;
+    c->midi_smoothed = 0.0;
+}
+
+/**
+ * @brief Adds a block of audio for analysis
+ *
+ * Called from the audio callback.  This only copies the samples.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void    tuner_push(TUNER * c,
+                   float * audio_in,
+                   uint32_t audio_block_size) {
+
+    // Nothing to do if this instance hasn't been properly initialized
+    if (c == NULL || !c->initialized) {
+        return;
+    }
+
+    uint32_t pos = c->write_count;
+    for (int i=0;i<audio_block_size;i++) {
+        c->ring[(pos + i) & TUNER_RING_MASK] = audio_in[i];
+    }
+    c->write_count = pos + audio_block_size;
+}
+
+/**
+ * @brief Analyzes the next frame of audio if one is ready
+ *
+ * Call this from processaudio_background_loop().  At most one frame is
+ * analyzed per call.
+ *
+ * @param c Pointer to instance structure
+ * @return true if a new reading is available (check 'locked')
+ */
+#pragma optimize_for_speed
+bool    tuner_process(TUNER * c) {
+
+    if (c == NULL || !c->initialized) {
+        return false;
+    }
+
+    uint32_t written = c->write_count;
+    if ((int32_t)(written - c->next_frame_end) < 0) {
+        return false;
+    }
+
+    // If we've fallen behind, jump to the latest frame
+    if (written - c->next_frame_end > TUNER_RING_SIZE - TUNER_FRAME_SIZE) {
+        c->next_frame_end = written;
+    }
+
+    // Copy the frame out of the ring and remove any DC offset
+    uint32_t start = c->next_frame_end - TUNER_FRAME_SIZE;
+    float mean = 0.0;
+    for (int i=0;i<TUNER_FRAME_SIZE;i++) {
+        c->frame[i] = c->ring[(start + i) & TUNER_RING_MASK];
+        mean += c->frame[i];
+    }
+    mean *= (1.0/TUNER_FRAME_SIZE);
+
+    float power = 0.0;
+    for (int i=0;i<TUNER_FRAME_SIZE;i++) {
+        c->frame[i] -= mean;
+        power += c->frame[i]*c->frame[i];
+    }
+    power *= (1.0/TUNER_FRAME_SIZE);
+
+    c->next_frame_end += TUNER_HOP_SIZE;
+
+    if (power < c->min_power) {
+        c->locked = false;
+        c->clarity = 0.0;
+        return true;
+    }
+
+    /*
+     * Coarse search on the decimated frame
+     */
+    float * x = c->decimated;
+    for (int k=0;k<TUNER_DECIMATED_SIZE;k++) {
+        float * in = &c->frame[k*TUNER_DECIMATION];
+        float sum = 0.0;
+        for (int j=0;j<TUNER_DECIMATION;j++) {
+            sum += in[j];
+        }
+        x[k] = sum*(1.0/TUNER_DECIMATION);
+    }
+
+    int lag_min = c->lag_min/TUNER_DECIMATION;
+    int lag_max = c->lag_max/TUNER_DECIMATION + 1;
+    if (lag_min < 1) {
+        lag_min = 1;
+    }
+
+    // m(lag) = sum over the overlap of x[i]^2 + x[i+lag]^2, updated incrementally
+    float m = 0.0;
+    for (int i=0;i<TUNER_DECIMATED_SIZE;i++) {
+        m += 2.0*x[i]*x[i];
+    }
+    for (int lag=1;lag<=lag_max;lag++) {
+        m -= x[lag-1]*x[lag-1] + x[TUNER_DECIMATED_SIZE-lag]*x[TUNER_DECIMATED_SIZE-lag];
+
+        float r = 0.0;
+        for (int i=0;i<TUNER_DECIMATED_SIZE-lag;i++) {
+            r += x[i]*x[i+lag];
+        }
+        c->nsdf[lag] = (m > 0.0) ? 2.0*r/m : 0.0;
+    }
+    c->nsdf[0] = 1.0;
+
+    // Skip the lobe around lag 0, then find the maximum of each positive lobe
+    int lag = 1;
+    while (lag <= lag_max && c->nsdf[lag] > 0.0) {
+        lag++;
+    }
+
+    int peak_lags[32];
+    int num_peaks = 0;
+    float highest = 0.0;
+    while (lag <= lag_max && num_peaks < 32) {
+        while (lag <= lag_max && c->nsdf[lag] <= 0.0) {
+            lag++;
+        }
+        int best = lag;
+        while (lag <= lag_max && c->nsdf[lag] > 0.0) {
+            if (c->nsdf[lag] > c->nsdf[best]) {
+                best = lag;
+            }
+            lag++;
+        }
+        if (best <= lag_max && best >= lag_min) {
+            peak_lags[num_peaks++] = best;
+            if (c->nsdf[best] > highest) {
+                highest = c->nsdf[best];
+            }
+        }
+    }
+
+    int coarse = -1;
+    for (int p=0;p<num_peaks;p++) {
+        if (c->nsdf[peak_lags[p]] >= TUNER_PEAK_RATIO*highest) {
+            coarse = peak_lags[p];
+            break;
+        }
+    }
+    if (coarse < 0 || highest < 0.5*c->threshold) {
+        c->locked = false;
+        c->clarity = highest;
+        return true;
+    }
+
+    /*
+     * Fine search at the full rate around the coarse period
+     */
+    int fine_min = (coarse - 1)*TUNER_DECIMATION;
+    int fine_max = (coarse + 1)*TUNER_DECIMATION;
+    if (fine_min < 2) {
+        fine_min = 2;
+    }
+    if (fine_max > TUNER_MAX_LAG) {
+        fine_max = TUNER_MAX_LAG;
+    }
+
+    int best_lag = fine_min;
+    float best = -1.0, before = 0.0, after = 0.0, prev = tuner_nsdf_full(c->frame, fine_min - 1);
+    float value = tuner_nsdf_full(c->frame, fine_min);
+    for (int l=fine_min;l<=fine_max;l++) {
+        float next = tuner_nsdf_full(c->frame, l + 1);
+        if (value > best) {
+            best = value;
+            best_lag = l;
+            before = prev;
+            after = next;
+        }
+        prev = value;
+        value = next;
+    }
+
+    // Parabolic interpolation of the peak
+    float period = best_lag;
+    float peak = best;
+    float denom = before - 2.0*best + after;
+    if (denom < 0.0) {
+        float delta = 0.5*(before - after)/denom;
+        if (delta > -1.0 && delta < 1.0) {
+            period += delta;
+            peak = best - 0.25*(before - after)*delta;
+        }
+    }
+
+    c->clarity = peak;
+    if (peak < c->threshold) {
+        c->locked = false;
+        return true;
+    }
+
+    c->frequency = c->audio_sample_rate/period;
+    float midi = 69.0 + 12.0*log2f(c->frequency/440.0);
+
+    // Smooth consecutive readings of the same note
+    if (c->locked && fabsf(midi - c->midi_smoothed) < 0.5) {
+        c->midi_smoothed += TUNER_SMOOTHING*(midi - c->midi_smoothed);
+    }
+    else {
+        c->midi_smoothed = midi;
+    }
+
+    c->note = (int32_t)floorf(c->midi_smoothed + 0.5);
+    c->cents = 100.0*(c->midi_smoothed - c->note);
+    c->locked = true;
+
+    return true;
+}
+
+/**
+ * @brief Returns the name of a note (e.g. "A4")
+ *
+ * @param note MIDI note number (0->127)
+ * @return Pointer to a constant string
+ */
+const char *    tuner_note_name(int32_t note) {
+
+    static const char * names[128] = {
+        "C-1","C#-1","D-1","D#-1","E-1","F-1","F#-1","G-1","G#-1","A-1","A#-1","B-1",
+        "C0","C#0","D0","D#0","E0","F0","F#0","G0","G#0","A0","A#0","B0",
+        "C1","C#1","D1","D#1","E1","F1","F#1","G1","G#1","A1","A#1","B1",
+        "C2","C#2","D2","D#2","E2","F2","F#2","G2","G#2","A2","A#2","B2",
+        "C3","C#3","D3","D#3","E3","F3","F#3","G3","G#3","A3","A#3","B3",
+        "C4","C#4","D4","D#4","E4","F4","F#4","G4","G#4","A4","A#4","B4",
+        "C5","C#5","D5","D#5","E5","F5","F#5","G5","G#5","A5","A#5","B5",
+        "C6","C#6","D6","D#6","E6","F6","F#6","G6","G#6","A6","A#6","B6",
+        "C7","C#7","D7","D#7","E7","F7","F#7","G7","G#7","A7","A#7","B7",
+        "C8","C#8","D8","D#8","E8","F8","F#8","G8","G#8","A8","A#8","B8",
+        "C9","C#9","D9","D#9","E9","F9","F#9","G9"
+    };
+
+    if (note < 0 || note > 127) {
+        return "?";
+    }
+    return names[note];
+}
+
+/**
+ * @brief NSDF of the full rate frame at one lag
+ *
+ * @param x Pointer to the frame (TUNER_FRAME_SIZE samples)
+ * @param lag Lag in samples
+ * @return Normalized correlation (-1.0->1.0)
+ */
+#pragma optimize_for_speed
+static float    tuner_nsdf_full(float * x, uint32_t lag) {
+
+    float r = 0.0, m = 0.0;
+    for (int i=0;i<TUNER_FRAME_SIZE-lag;i++) {
+        float a = x[i];
+        float b = x[i+lag];
+        r += a*b;
+        m += a*a + b*b;
+    }
+    return (m > 0.0) ? 2.0*r/m : 0.0;
+}
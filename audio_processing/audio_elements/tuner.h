@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _TUNER_H
+#define _TUNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_elements_common.h"
+
+#define TUNER_FRAME_SIZE        (2048)      // Analysis frame (full rate samples)
+#define TUNER_HOP_SIZE          (1024)      // Samples between analyses
+#define TUNER_RING_SIZE         (4096)      // Power of 2 >= FRAME_SIZE + HOP_SIZE
+#define TUNER_DECIMATION        (4)         // Coarse search runs at fs/4
+#define TUNER_MAX_LAG           (1280)      // Longest period (full rate samples)
+
+// Result enumerations
+typedef enum
+{
+    TUNER_OK,
+    TUNER_INVALID_INSTANCE_POINTER,
+    TUNER_INVALID_FREQ_RANGE,
+    TUNER_INVALID_THRESHOLD
+} RESULT_TUNER;
+
+// C struct with parameters and state information
+typedef struct  {
+
+    bool    initialized;
+
+    float   min_freq;
+    float   max_freq;
+    uint32_t    lag_min;
+    uint32_t    lag_max;
+
+    float   threshold;              // Minimum clarity for a lock
+    float   min_power;              // Minimum mean power of the frame for a lock
+
+    // Sample ring written by the audio callback
+    float   ring[TUNER_RING_SIZE];
+    volatile uint32_t   write_count;
+    uint32_t    next_frame_end;
+
+    // Work buffers for the background analysis
+    float   frame[TUNER_FRAME_SIZE];
+    float   decimated[TUNER_FRAME_SIZE/TUNER_DECIMATION];
+    float   nsdf[TUNER_MAX_LAG/TUNER_DECIMATION + 2];
+
+    // Results
+    float   frequency;              // Hz
+    float   clarity;                // Normalized correlation at the period (0.0->1.0)
+    bool    locked;
+    int32_t note;                   // Nearest MIDI note number
+    float   cents;                  // Offset from that note (-50.0->50.0)
+    float   midi_smoothed;          // Fractional MIDI note, smoothed between frames
+
+    float   audio_sample_rate;
+
+} TUNER;
+
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_TUNER    tuner_setup(TUNER * c,
+                            float min_freq,
+                            float max_freq,
+                            float threshold,
+                            float audio_sample_rate);
+
+void    tuner_reset(TUNER * c);
+
+void    tuner_push(TUNER * c,
+                   float * audio_in,
+                   uint32_t audio_block_size);
+
+bool    tuner_process(TUNER * c);
+
+const char *    tuner_note_name(int32_t note);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif  // _TUNER_H
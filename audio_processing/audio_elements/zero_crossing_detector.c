@@ -18,6 +18,7 @@
 
 #define ZERO_CROSS_THRESHOLD_MIN    (0.0)
 #define ZERO_CROSS_THRESHOLD_MAX    (1.0)
+#define ZC_PEAK_RELEASE_MS          (208.0)     // ~0.9999 decay per sample at 48kHz
 
 
 // Min/max limits and other constants
@@ -46,8 +47,13 @@ RESULT_ZERO_CROSSING zero_cross_setup(ZERO_CROSSING_DETECTOR * c,
         return ZERO_CROSS_INVALID_THRESHOLD;
     }
 
-    c->peak_amplitude_pos = 0;
-    c->peak_amplitude_neg = 0;
+    // Peak follower with instant attack and ~200ms release
+    envelope_follower_setup(&c->peak_env,
+                            ENV_FOLLOWER_PEAK,
+                            0.0,
+                            ZC_PEAK_RELEASE_MS,
+                            1,
+                            audio_sample_rate);
 
     filter_setup(&c->lpf,
                  BIQUAD_TYPE_LPF,
@@ -133,14 +139,14 @@ bool  zero_crossing_read(ZERO_CROSSING_DETECTOR * c,
 
     // Measure current peak amplitude of waveform and pick a threshold value that's
     // a fraction of this
-    for (int i=0;i<audio_block_size;i++) {
-        measure_amp_peak(filtered_audio_in[i], &c->peak_amplitude_pos, 0.9999);
-        measure_amp_peak(-filtered_audio_in[i], &c->peak_amplitude_neg, 0.9999);
-    }
-    float vol_threshold_pos = c->peak_amplitude_pos*0.5;
-    float vol_threshold_neg = c->peak_amplitude_neg*0.5;
-
-    if (c->peak_amplitude_pos < 0.001) {
+    float peak_amplitude = envelope_follower_read(&c->peak_env,
+                                                  filtered_audio_in,
+                                                  NULL,
+                                                  audio_block_size);
+    float vol_threshold_pos = peak_amplitude*0.5;
+    float vol_threshold_neg = peak_amplitude*0.5;
+
+    if (peak_amplitude < 0.001) {
         return false;
     }
 
@@ -13,6 +13,7 @@
 
 #include "audio_elements_common.h"
 #include "biquad_filter.h"
+#include "envelope_follower.h"
 
 // Effect definitions
 #define MAX_AUDIO_BLOCK_SIZE    (128)
@@ -47,8 +48,7 @@ typedef struct  {
     float   dc_coeff;
 
   
-    float peak_amplitude_pos;
-    float peak_amplitude_neg;
+    ENVELOPE_FOLLOWER   peak_env;
     float threshold;
     
     uint32_t period_counter;
@@ -181,6 +181,13 @@
 
 #endif
 
+/*
+ * Set to TRUE to run the audio element benchmarks (audio_benchmarks.cpp) on
+ * SHARC core 1 before the audio framework starts.  Results are sent to the
+ * event log.
+ */
+#define RUN_AUDIO_BENCHMARKS                          FALSE
+
 /*******************************************************************************
  * 7. CPU clock speed
  ******************************************************************************/
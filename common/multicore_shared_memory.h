@@ -92,7 +92,11 @@ typedef struct
         float audioproj_fin_aux_hadc5;
         float audioproj_fin_aux_hadc6;
 
+        // Input level for the VU LEDs (peak hold in dBFS, written by SHARC core 1
+        // once per metering period)
         float audio_in_amplitude;
+        uint32_t audio_in_clipped;
+        uint32_t audio_level_sequence;
 
         uint32_t audioproj_fin_rev_3_20_or_later;
         
@@ -110,6 +114,9 @@ typedef struct
     float *sharc_core2_audio_in;
     float *sharc_core2_audio_out;
 
+    // Latest spectrum of SHARC Core 2's output (an STFT_SNAPSHOT in SDRAM, see stft_analyzer.h)
+    void *sharc_core2_spectrum;
+
     // Buffers for passing message data to ARM core
     uint32_t sharc_core1_new_message_ready;
     uint32_t sharc_core2_new_message_ready;
@@ -144,6 +151,26 @@ typedef struct
 	uint32_t reverb_preset;
 	uint32_t total_effects_presets;
 
+	// Input automatic gain control state (written by SHARC core 1)
+	float agc_level_db_left;
+	float agc_level_db_right;
+	float agc_gain_db_left;
+	float agc_gain_db_right;
+	uint32_t agc_frozen;
+
+	// Output loudness, EBU R128 (written by SHARC core 2)
+	float loudness_momentary_lufs;
+	float loudness_short_term_lufs;
+	float loudness_integrated_lufs;
+	float loudness_true_peak_dbtp;
+
+	// Chromatic tuner (written by SHARC core 1)
+	uint32_t tuner_active;
+	uint32_t tuner_locked;
+	int32_t tuner_note;			// MIDI note number
+	float tuner_cents;
+	uint32_t tuner_sequence;	// Incremented for every new reading
+
 	// MIDI state
     midi_note_state midi_note[128];
     char midi_cc_values[128];